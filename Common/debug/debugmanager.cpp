@@ -119,6 +119,7 @@ DebugManager::DebugManager(bool buffer_messages)
     RegisterGroup(DebugGroupID(kDbgGroup_ManObj, "manobj"), "Managed obj");
     RegisterGroup(DebugGroupID(kDbgGroup_SDL, "sdl"), "SDL");
     RegisterGroup(DebugGroupID(kDbgGroup_Plugin, "plugin"), "Plugin");
+    RegisterGroup(DebugGroupID(kDbgGroup_Init, "init"), "Init");
 
     if (buffer_messages)
     {
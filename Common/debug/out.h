@@ -127,7 +127,9 @@ enum CommonDebugGroup : MessageGroupHandle
     // SDL backend group
     kDbgGroup_SDL,
     // Game plugins group
-    kDbgGroup_Plugin
+    kDbgGroup_Plugin,
+    // Engine startup timings
+    kDbgGroup_Init
 };
 
 namespace Debug
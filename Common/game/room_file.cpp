@@ -11,6 +11,7 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <algorithm>
 #include "ac/common.h" // update_polled_stuff
 #include "ac/common_defines.h"
 #include "ac/gamestructdefines.h"
@@ -25,6 +26,8 @@
 #include "script/cc_script.h"
 #include "util/compress.h"
 #include "util/data_ext.h"
+#include "util/memory_compat.h"
+#include "util/memorystream.h"
 #include "util/string_utils.h"
 
 // default number of hotspots to read from the room file
@@ -82,8 +85,98 @@ void WriteRoomObject(const RoomObjectInfo &obj, Stream *out)
 
 
 // Main room data
-HError ReadMainBlock(RoomStruct *room, Stream *in, RoomFileVersion data_ver)
+// Room images are read from the stream first, and unpacked after the whole
+// room data is read; this lets unpack them all in parallel.
+// Each job returns whether its image was unpacked successfully.
+typedef std::vector<std::function<bool()>> RoomDecodeJobs;
+
+// Reads the LZW-compressed background, and schedules its unpacking
+static void ReadLzwBackground(PBitmap &bmp, Stream *in, int bpp, RGB (*pal)[256], RoomDecodeJobs &jobs)
+{
+    auto data = std::make_shared<std::vector<uint8_t>>();
+    size_t uncomp_sz;
+    read_lzw(in, *data, uncomp_sz, pal);
+    PBitmap *dst = &bmp;
+    jobs.push_back([dst, data, uncomp_sz, bpp]()
+        { *dst = unpack_lzw(data->data(), data->size(), uncomp_sz, bpp); return *dst != nullptr; });
+}
+
+// Reads the Deflate-compressed image, and schedules its unpacking
+static HError ReadDeflateImage(PBitmap &bmp, Stream *in, soff_t block_end, RoomDecodeJobs &jobs)
+{
+    auto data = std::make_shared<std::vector<uint8_t>>();
+    if (!read_deflate_bitmap(in, *data, block_end - in->GetPosition()))
+        return new RoomFileError(kRoomFileErr_InconsistentData, "Room image data is incomplete.");
+    PBitmap *dst = &bmp;
+    jobs.push_back([dst, data]()
+        { *dst = unpack_deflate_bitmap(data->data(), data->size()); return *dst != nullptr; });
+    return HError::None();
+}
+
+// Reads the background of the given compression type, with its palette
+static HError ReadBackground(PBitmap &bmp, Stream *in, RoomImageCompression compress,
+    int bpp, RGB (*pal)[256], soff_t block_end, RoomDecodeJobs &jobs)
 {
+    if (compress == kRoomImgCompress_Legacy)
+    {
+        ReadLzwBackground(bmp, in, bpp, pal, jobs);
+        return HError::None();
+    }
+    // NOTE: full RGB struct is stored here (4 bytes, including the filler), same as with LZW
+    in->Read(*pal, sizeof(RGB) * 256);
+    return ReadDeflateImage(bmp, in, block_end, jobs);
+}
+
+// Reads a sequence of the RLE-compressed masks, which are expected to be
+// in the end of the block, and schedules their unpacking; null destinations
+// mean that the corresponding mask should be skipped
+static void ReadRleMasks(Stream *in, soff_t block_end, const std::vector<PBitmap*> &dsts, RoomDecodeJobs &jobs)
+{
+    const soff_t masks_at = in->GetPosition();
+    auto data = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(std::max<soff_t>(0, block_end - masks_at)));
+    data->resize(in->Read(data->data(), data->size()));
+
+    // Find out where each mask begins, without unpacking them
+    std::vector<std::pair<size_t, size_t>> ranges;
+    size_t offset = 0;
+    for (size_t i = 0; i < dsts.size(); ++i)
+    {
+        const size_t mask_sz = rle_bitmap8_size(data->data() + offset, data->size() - offset);
+        if (mask_sz == 0)
+        { // the block has an unexpected layout, read the masks right from the stream
+            in->Seek(masks_at, kSeekBegin);
+            for (PBitmap *dst : dsts)
+            {
+                if (dst)
+                    *dst = load_rle_bitmap8(in);
+                else
+                    skip_rle_bitmap8(in);
+            }
+            return;
+        }
+        ranges.push_back(std::make_pair(offset, mask_sz));
+        offset += mask_sz;
+    }
+    in->Seek(masks_at + offset, kSeekBegin);
+
+    for (size_t i = 0; i < dsts.size(); ++i)
+    {
+        if (!dsts[i])
+            continue;
+        PBitmap *dst = dsts[i];
+        const size_t mask_at = ranges[i].first, mask_sz = ranges[i].second;
+        jobs.push_back([dst, data, mask_at, mask_sz]()
+        {
+            Stream mem_in(std::make_unique<MemoryStream>(data->data() + mask_at, mask_sz));
+            *dst = load_rle_bitmap8(&mem_in);
+            return *dst != nullptr;
+        });
+    }
+}
+
+HError ReadMainBlock(RoomStruct *room, Stream *in, RoomFileVersion data_ver, soff_t block_len, RoomDecodeJobs &jobs)
+{
+    const soff_t block_end = in->GetPosition() + block_len;
     int bpp;
     if (data_ver >= kRoomVersion_208)
         bpp = in->ReadInt32();
@@ -323,21 +416,47 @@ HError ReadMainBlock(RoomStruct *room, Stream *in, RoomFileVersion data_ver)
             room->Regions[i].Tint = in->ReadInt32();
     }
 
+    // Backgrounds and masks compression
+    room->ImageCompression = kRoomImgCompress_Legacy;
+    if (data_ver >= kRoomVersion_363)
+    {
+        const int compress = in->ReadInt8();
+        if ((compress < kRoomImgCompress_Legacy) || (compress > kRoomImgCompress_Last))
+            return new RoomFileError(kRoomFileErr_IncompatibleEngine, String::FromFormat("Unknown room image compression: %d.", compress));
+        room->ImageCompression = static_cast<RoomImageCompression>(compress);
+    }
+
+    if (room->ImageCompression != kRoomImgCompress_Legacy)
+    {
+        HError err = ReadBackground(room->BgFrames[0].Graphic, in, room->ImageCompression,
+            room->BackgroundBPP, &room->Palette, block_end, jobs);
+        if (!err)
+            return err;
+        for (PBitmap *mask : { &room->RegionMask, &room->WalkAreaMask, &room->WalkBehindMask, &room->HotspotMask })
+        {
+            err = ReadDeflateImage(*mask, in, block_end, jobs);
+            if (!err)
+                return err;
+        }
+        return HError::None();
+    }
+
     // Primary background (LZW or RLE compressed depending on format)
     if (data_ver >= kRoomVersion_pre114_5)
-        room->BgFrames[0].Graphic =
-            load_lzw(in, room->BackgroundBPP, &room->Palette);
+        ReadLzwBackground(room->BgFrames[0].Graphic, in, room->BackgroundBPP, &room->Palette, jobs);
     else
         room->BgFrames[0].Graphic = load_rle_bitmap8(in);
 
     // Area masks
+    std::vector<PBitmap*> masks;
     if (data_ver >= kRoomVersion_255b)
-        room->RegionMask = load_rle_bitmap8(in);
+        masks.push_back(&room->RegionMask);
     else if (data_ver >= kRoomVersion_114)
-        skip_rle_bitmap8(in); // an old version - clear the 'shadow' area into a blank regions bmp (???)
-    room->WalkAreaMask = load_rle_bitmap8(in);
-    room->WalkBehindMask = load_rle_bitmap8(in);
-    room->HotspotMask = load_rle_bitmap8(in);
+        masks.push_back(nullptr); // an old version - clear the 'shadow' area into a blank regions bmp (???)
+    masks.push_back(&room->WalkAreaMask);
+    masks.push_back(&room->WalkBehindMask);
+    masks.push_back(&room->HotspotMask);
+    ReadRleMasks(in, block_end, masks, jobs);
     return HError::None();
 }
 
@@ -399,8 +518,9 @@ HError ReadObjScNamesBlock(RoomStruct *room, Stream *in, RoomFileVersion data_ve
 }
 
 // Secondary backgrounds
-HError ReadAnimBgBlock(RoomStruct *room, Stream *in, RoomFileVersion data_ver)
+HError ReadAnimBgBlock(RoomStruct *room, Stream *in, RoomFileVersion data_ver, soff_t block_len, RoomDecodeJobs &jobs)
 {
+    const soff_t block_end = in->GetPosition() + block_len;
     room->BgFrameCount = in->ReadInt8();
     if (room->BgFrameCount > MAX_ROOM_BGFRAMES)
         return new RoomFileError(kRoomFileErr_IncompatibleEngine, String::FromFormat("Too many room backgrounds (in room: %d, max: %d).", room->BgFrameCount, MAX_ROOM_BGFRAMES));
@@ -414,8 +534,10 @@ HError ReadAnimBgBlock(RoomStruct *room, Stream *in, RoomFileVersion data_ver)
 
     for (size_t i = 1; i < room->BgFrameCount; ++i)
     {
-        room->BgFrames[i].Graphic =
-            load_lzw(in, room->BackgroundBPP, &room->BgFrames[i].Palette);
+        HError err = ReadBackground(room->BgFrames[i].Graphic, in, room->ImageCompression,
+            room->BackgroundBPP, &room->BgFrames[i].Palette, block_end, jobs);
+        if (!err)
+            return err;
     }
     return HError::None();
 }
@@ -440,7 +562,7 @@ HError ReadPropertiesBlock(RoomStruct *room, Stream *in, RoomFileVersion /*data_
 }
 
 HError ReadRoomBlock(RoomStruct *room, Stream *in, RoomFileBlock block, const String &ext_id,
-    soff_t block_len, RoomFileVersion data_ver)
+    soff_t block_len, RoomFileVersion data_ver, RoomDecodeJobs &jobs)
 {
     //
     // First check classic block types, identified with a numeric id
@@ -448,7 +570,7 @@ HError ReadRoomBlock(RoomStruct *room, Stream *in, RoomFileBlock block, const St
     switch (block)
     {
     case kRoomFblk_Main:
-        return ReadMainBlock(room, in, data_ver);
+        return ReadMainBlock(room, in, data_ver, block_len, jobs);
     case kRoomFblk_Script:
         in->Seek(block_len); // no longer read source script text into RoomStruct
         return HError::None();
@@ -459,7 +581,7 @@ HError ReadRoomBlock(RoomStruct *room, Stream *in, RoomFileBlock block, const St
     case kRoomFblk_ObjectScNames:
         return ReadObjScNamesBlock(room, in, data_ver);
     case kRoomFblk_AnimBg:
-        return ReadAnimBgBlock(room, in, data_ver);
+        return ReadAnimBgBlock(room, in, data_ver, block_len, jobs);
     case kRoomFblk_Properties:
         return ReadPropertiesBlock(room, in, data_ver);
     case kRoomFblk_CompScript:
@@ -496,6 +618,9 @@ public:
         , _dataVer(data_ver)
     {}
 
+    // Gets the room images which were read but not unpacked yet
+    RoomDecodeJobs &GetDecodeJobs() { return _decodeJobs; }
+
     // Helper function that extracts legacy room script
     HError ReadRoomScript(String &script)
     {
@@ -516,20 +641,37 @@ private:
         soff_t block_len, bool &read_next) override
     {
         read_next = true;
-        return ReadRoomBlock(_room, in, (RoomFileBlock)block_id, ext_id, block_len, _dataVer);
+        return ReadRoomBlock(_room, in, (RoomFileBlock)block_id, ext_id, block_len, _dataVer, _decodeJobs);
     }
 
     RoomStruct *_room {};
     RoomFileVersion _dataVer {};
+    RoomDecodeJobs _decodeJobs;
 };
 
 
-HRoomFileError ReadRoomData(RoomStruct *room, std::unique_ptr<Stream> &&in, RoomFileVersion data_ver)
+HRoomFileError ReadRoomData(RoomStruct *room, std::unique_ptr<Stream> &&in, RoomFileVersion data_ver,
+    const PfnRunParallel &run_parallel)
 {
     room->DataVersion = data_ver;
     RoomBlockReader reader(room, data_ver, std::move(in));
     HError err = reader.Read();
-    return err ? HRoomFileError::None() : new RoomFileError(kRoomFileErr_BlockListFailed, err);
+    if (!err)
+        return new RoomFileError(kRoomFileErr_BlockListFailed, err);
+
+    // Unpack backgrounds and masks; each job writes only its own bitmap and result
+    RoomDecodeJobs &jobs = reader.GetDecodeJobs();
+    std::vector<uint8_t> job_ok(jobs.size());
+    if (run_parallel)
+        run_parallel(jobs.size(), [&jobs, &job_ok](size_t index) { job_ok[index] = jobs[index](); });
+    else
+        for (size_t i = 0; i < jobs.size(); ++i)
+            job_ok[i] = jobs[i]();
+    if (std::find(job_ok.begin(), job_ok.end(), 0) != job_ok.end())
+        return new RoomFileError(kRoomFileErr_InconsistentData, "Failed to unpack room image data.");
+    if (!room->BgFrames[0].Graphic)
+        return new RoomFileError(kRoomFileErr_InconsistentData, "Room background is missing.");
+    return HRoomFileError::None();
 }
 
 HRoomFileError UpdateRoomData(RoomStruct *room, RoomFileVersion data_ver, bool game_is_hires, const std::vector<SpriteInfo> &sprinfos)
@@ -687,7 +829,7 @@ HRoomFileError UpdateRoomData(RoomStruct *room, RoomFileVersion data_ver, bool g
 }
 
 HError LoadRoom(const String &filename, RoomStruct *room, AssetManager *mgr,
-    bool game_is_hires, const std::vector<SpriteInfo> &sprinfos)
+    bool game_is_hires, const std::vector<SpriteInfo> &sprinfos, const PfnRunParallel &run_parallel)
 {
     room->Free();
     room->InitDefaults();
@@ -696,7 +838,7 @@ HError LoadRoom(const String &filename, RoomStruct *room, AssetManager *mgr,
     HRoomFileError err = OpenRoomFileFromAsset(filename, src, mgr);
     if (err)
     {
-        err = ReadRoomData(room, std::move(src.InputStream), src.DataVersion);
+        err = ReadRoomData(room, std::move(src.InputStream), src.DataVersion, run_parallel);
         if (err)
             err = UpdateRoomData(room, src.DataVersion, game_is_hires, sprinfos);
     }
@@ -714,7 +856,31 @@ HRoomFileError ExtractScriptText(String &script, std::unique_ptr<Stream> &&in, R
     return HRoomFileError::None();
 }
 
-void WriteMainBlock(const RoomStruct *room, Stream *out)
+// Writes the room background with its palette, using room's image compression
+static void WriteBackground(const RoomStruct *room, const Bitmap *bmp, const RGB (*pal)[256], Stream *out)
+{
+    if (room->ImageCompression == kRoomImgCompress_Legacy)
+    {
+        save_lzw(out, bmp, pal);
+        return;
+    }
+    out->WriteArray(*pal, sizeof(RGB), 256);
+    // NOTE: the row filters are only meaningful for the RGB pixels,
+    // same as in PNG they are not applied to the palette indexes
+    save_deflate_bitmap(out, bmp,
+        (room->ImageCompression == kRoomImgCompress_DeflateFiltered) && (bmp->GetBPP() > 1));
+}
+
+// Writes the room mask, using room's image compression
+static void WriteMask(const RoomStruct *room, const Bitmap *bmp, Stream *out)
+{
+    if (room->ImageCompression == kRoomImgCompress_Legacy)
+        save_rle_bitmap8(out, bmp);
+    else
+        save_deflate_bitmap(out, bmp, false);
+}
+
+void WriteMainBlock(const RoomStruct *room, Stream *out, RoomFileVersion data_ver)
 {
     out->WriteInt32(room->BackgroundBPP);
     out->WriteInt16((uint16_t)room->WalkBehindCount);
@@ -805,11 +971,13 @@ void WriteMainBlock(const RoomStruct *room, Stream *out)
     for (uint32_t i = 0; i < (uint32_t)MAX_ROOM_REGIONS; ++i)
         out->WriteInt32(room->Regions[i].Tint);
 
-    save_lzw(out, room->BgFrames[0].Graphic.get(), &room->Palette);
-    save_rle_bitmap8(out, room->RegionMask.get());
-    save_rle_bitmap8(out, room->WalkAreaMask.get());
-    save_rle_bitmap8(out, room->WalkBehindMask.get());
-    save_rle_bitmap8(out, room->HotspotMask.get());
+    if (data_ver >= kRoomVersion_363)
+        out->WriteInt8(room->ImageCompression);
+    WriteBackground(room, room->BgFrames[0].Graphic.get(), &room->Palette, out);
+    WriteMask(room, room->RegionMask.get(), out);
+    WriteMask(room, room->WalkAreaMask.get(), out);
+    WriteMask(room, room->WalkBehindMask.get(), out);
+    WriteMask(room, room->HotspotMask.get(), out);
 }
 
 void WriteCompSc3Block(const RoomStruct *room, Stream *out)
@@ -839,7 +1007,7 @@ void WriteAnimBgBlock(const RoomStruct *room, Stream *out)
     for (size_t i = 0; i < room->BgFrameCount; ++i)
         out->WriteInt8(room->BgFrames[i].IsPaletteShared ? 1 : 0);
     for (size_t i = 1; i < room->BgFrameCount; ++i)
-        save_lzw(out, room->BgFrames[i].Graphic.get(), &room->BgFrames[i].Palette);
+        WriteBackground(room, room->BgFrames[i].Graphic.get(), &room->BgFrames[i].Palette, out);
 }
 
 void WritePropertiesBlock(const RoomStruct *room, Stream *out)
@@ -857,15 +1025,27 @@ void WriteStrOptions(const RoomStruct *room, Stream *out)
     StrUtil::WriteStringMap(room->StrOptions, out);
 }
 
+RoomFileVersion GetMinRoomFileVersion(const RoomStruct *room)
+{
+    // the image compression type is only stored since v3.6.3
+    if (room->ImageCompression != kRoomImgCompress_Legacy)
+        return kRoomVersion_363;
+    return kRoomVersion_3508;
+}
+
 HRoomFileError WriteRoomData(const RoomStruct *room, Stream *out, RoomFileVersion data_ver)
 {
-    if (data_ver < kRoomVersion_Current)
+    if (data_ver < kRoomVersion_3508)
         return new RoomFileError(kRoomFileErr_FormatNotSupported, "We no longer support saving room in the older format.");
+    if (data_ver < GetMinRoomFileVersion(room))
+        return new RoomFileError(kRoomFileErr_FormatNotSupported,
+            String::FromFormat("Room image compression requires format version %d or higher.", GetMinRoomFileVersion(room)));
 
     // Header
     out->WriteInt16(data_ver);
     // Main data
-    WriteRoomBlock(room, kRoomFblk_Main, WriteMainBlock, out);
+    WriteRoomBlock(room, kRoomFblk_Main,
+        [data_ver](const RoomStruct *room, Stream *out) { WriteMainBlock(room, out, data_ver); }, out);
     // Compiled script
     if (room->CompiledScript)
         WriteRoomBlock(room, kRoomFblk_CompScript3, WriteCompSc3Block, out);
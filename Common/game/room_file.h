@@ -105,16 +105,25 @@ struct RoomDataSource
 HRoomFileError OpenRoomFile(const String &filename, RoomDataSource &src);
 // Opens room data for reading from asset of a given name
 HRoomFileError OpenRoomFileFromAsset(const String &filename, RoomDataSource &src, AssetManager *mgr);
-// Reads room data
-HRoomFileError ReadRoomData(RoomStruct *room, std::unique_ptr<Stream> &&in, RoomFileVersion data_ver);
+// Type of function that runs a number of independent jobs, possibly
+// in parallel, and returns only after all of them are complete
+typedef std::function<void(size_t count, const std::function<void(size_t index)> &job)> PfnRunParallel;
+// Reads room data; room backgrounds and masks are unpacked after all data
+// is read, either one by one, or using the optional run_parallel function
+HRoomFileError ReadRoomData(RoomStruct *room, std::unique_ptr<Stream> &&in, RoomFileVersion data_ver,
+    const PfnRunParallel &run_parallel = nullptr);
 // Applies necessary updates, conversions and fixups to the loaded data
 // making it compatible with current engine
 HRoomFileError UpdateRoomData(RoomStruct *room, RoomFileVersion data_ver, bool game_is_hires, const std::vector<SpriteInfo> &sprinfos);
 // Loads new room data into the given RoomStruct object and upgrade it to the latest version
-HError LoadRoom(const String &filename, RoomStruct *room, AssetManager *mgr, bool game_is_hires, const std::vector<SpriteInfo> &sprinfos);
+HError LoadRoom(const String &filename, RoomStruct *room, AssetManager *mgr, bool game_is_hires, const std::vector<SpriteInfo> &sprinfos,
+    const PfnRunParallel &run_parallel = nullptr);
 // Extracts text script from the room file, if it's available.
 // Historically, text sources were kept inside packed room files before AGS 3.*.
 HRoomFileError ExtractScriptText(String &script, std::unique_ptr<Stream> &&in, RoomFileVersion data_ver);
+// Gets the oldest room format version which can store all of this room's data;
+// rooms saved in that version may also be loaded by the older engines
+RoomFileVersion GetMinRoomFileVersion(const RoomStruct *room);
 // Writes all room data to the stream
 HRoomFileError WriteRoomData(const RoomStruct *room, Stream *out, RoomFileVersion data_ver);
 
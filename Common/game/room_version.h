@@ -47,6 +47,10 @@
 32:  v3.5.0 - 64-bit file offsets
 33:  v3.5.0.8 - deprecated room resolution, added mask resolution
 Since then format value is defined as AGS version represented as NN,NN,NN,NN.
+34:  v3.6.3 - selectable compression of backgrounds and masks (Deflate);
+     numbered in sequence, as an exception, because the room header stores
+     the version as a 16-bit value. Rooms are saved in this version only if
+     they use a non-legacy image compression, otherwise as v3.5.0.8.
 */
 enum RoomFileVersion
 {
@@ -81,7 +85,8 @@ enum RoomFileVersion
     kRoomVersion_3415 = 31,
     kRoomVersion_350 = 32,
     kRoomVersion_3508 = 33,
-    kRoomVersion_Current = kRoomVersion_3508
+    kRoomVersion_363 = 34,
+    kRoomVersion_Current = kRoomVersion_363
 };
 
 #endif // __AGS_CN_AC__ROOMVERSION_H
@@ -184,6 +184,7 @@ void RoomStruct::InitDefaults()
     
     BackgroundBPP = 1;
     BgAnimSpeed = 5;
+    ImageCompression = kRoomImgCompress_Legacy;
 
     memset(Palette, 0, sizeof(Palette));
 }
@@ -86,6 +86,18 @@ enum RoomFlags
     kRoomFlag_BkgFrameLocked = 0x01
 };
 
+// Compression of the room backgrounds and masks in the room file
+enum RoomImageCompression
+{
+    // LZW for backgrounds and RLE for masks
+    kRoomImgCompress_Legacy = 0,
+    // Deflate
+    kRoomImgCompress_Deflate = 1,
+    // Deflate, with PNG-like row filters applied prior to compression
+    kRoomImgCompress_DeflateFiltered = 2,
+    kRoomImgCompress_Last = kRoomImgCompress_DeflateFiltered
+};
+
 // Flag tells that walkable area does not have continious zoom
 #define NOT_VECTOR_SCALED  -10000
 // Flags tells that room is not linked to particular game ID
@@ -286,8 +298,11 @@ public:
     static const int LegacyMaskHiresFactor = 2;
 
     RoomStruct();
+    RoomStruct(RoomStruct &&) = default;
     ~RoomStruct();
 
+    RoomStruct &operator =(RoomStruct &&) = default;
+
     // Gets if room should adjust its size to match the game's resolution
     inline bool IsRelativeRes() const { return _legacyResolution > kRoomResolution_Real; }
     // Gets the legacy room resolution type
@@ -348,6 +363,8 @@ public:
     RoomBgFrame             BgFrames[MAX_ROOM_BGFRAMES];
     // Speed at which background frames are changing, 0 - no auto animation
     int32_t                 BgAnimSpeed;
+    // Compression of the backgrounds and masks, used when saving room file
+    RoomImageCompression    ImageCompression;
     // Edges
     RoomEdges               Edges;
     // Region masks
@@ -17,6 +17,7 @@
 #include <string.h> // memcpy
 #include <aastr.h>
 #include "gfx/allegrobitmap.h"
+#include "gfx/image_scale.h"
 #include "util/filestream.h"
 #include "debug/assert.h"
 
@@ -276,6 +277,10 @@ void Bitmap::MaskedBlit(const Bitmap *src, int dst_x, int dst_y)
 
 void Bitmap::StretchBlt(const Bitmap *src, const Rect &dst_rc, BitmapMaskOption mask)
 {
+	if (ImageScale::StretchNearest(this, src, RectWH(0, 0, src->GetWidth(), src->GetHeight()), dst_rc,
+			mask == kBitmap_Transparency))
+		return;
+
 	BITMAP *al_src_bmp = src->_alBitmap;
 	// WARNING: For some evil reason Allegro expects dest and src bitmaps in different order for blit and draw_sprite
 	if (mask == kBitmap_Transparency)
@@ -293,6 +298,9 @@ void Bitmap::StretchBlt(const Bitmap *src, const Rect &dst_rc, BitmapMaskOption
 
 void Bitmap::StretchBlt(const Bitmap *src, const Rect &src_rc, const Rect &dst_rc, BitmapMaskOption mask)
 {
+	if (ImageScale::StretchNearest(this, src, src_rc, dst_rc, mask == kBitmap_Transparency))
+		return;
+
 	BITMAP *al_src_bmp = src->_alBitmap;
 	if (mask == kBitmap_Transparency)
 	{
@@ -310,6 +318,10 @@ void Bitmap::StretchBlt(const Bitmap *src, const Rect &src_rc, const Rect &dst_r
 
 void Bitmap::AAStretchBlt(const Bitmap *src, const Rect &dst_rc, BitmapMaskOption mask)
 {
+	if (ImageScale::StretchAA(this, src, RectWH(0, 0, src->GetWidth(), src->GetHeight()), dst_rc,
+			mask == kBitmap_Transparency))
+		return;
+
 	BITMAP *al_src_bmp = src->_alBitmap;
 	// WARNING: For some evil reason Allegro expects dest and src bitmaps in different order for blit and draw_sprite
 	if (mask == kBitmap_Transparency)
@@ -327,11 +339,14 @@ void Bitmap::AAStretchBlt(const Bitmap *src, const Rect &dst_rc, BitmapMaskOptio
 
 void Bitmap::AAStretchBlt(const Bitmap *src, const Rect &src_rc, const Rect &dst_rc, BitmapMaskOption mask)
 {
+	if (ImageScale::StretchAA(this, src, src_rc, dst_rc, mask == kBitmap_Transparency))
+		return;
+
 	BITMAP *al_src_bmp = src->_alBitmap;
 	if (mask == kBitmap_Transparency)
 	{
-		// TODO: aastr lib does not expose method for masked stretch blit; should do that at some point since 
-		// the source code is a gift-ware anyway
+		// TODO: aastr lib does not expose method for masked stretch blit, and ImageScale
+		// does not support this pixel format (8-bit or 24-bit)
 		// aa_masked_blit(_alBitmap, al_src_bmp, src_rc.Left, src_rc.Top, src_rc.GetWidth(), src_rc.GetHeight(), dst_rc.Left, dst_rc.Top, dst_rc.GetWidth(), dst_rc.GetHeight());
 		throw std::runtime_error("aa_masked_blit is not yet supported!");
 	}
@@ -343,6 +358,18 @@ void Bitmap::AAStretchBlt(const Bitmap *src, const Rect &src_rc, const Rect &dst
 	}
 }
 
+void Bitmap::BilinearStretchBlt(const Bitmap *src, const Rect &dst_rc, BitmapMaskOption mask)
+{
+	BilinearStretchBlt(src, RectWH(0, 0, src->GetWidth(), src->GetHeight()), dst_rc, mask);
+}
+
+void Bitmap::BilinearStretchBlt(const Bitmap *src, const Rect &src_rc, const Rect &dst_rc, BitmapMaskOption mask)
+{
+	if (ImageScale::StretchBilinear(this, src, src_rc, dst_rc, mask == kBitmap_Transparency))
+		return;
+	StretchBlt(src, src_rc, dst_rc, mask);
+}
+
 void Bitmap::TransBlendBlt(const Bitmap *src, int dst_x, int dst_y)
 {
 	BITMAP *al_src_bmp = src->_alBitmap;
@@ -221,6 +221,10 @@ public:
     // Antia-aliased stretch-blit
     void    AAStretchBlt(const Bitmap *src, const Rect &dst_rc, BitmapMaskOption mask = kBitmap_Copy);
     void    AAStretchBlt(const Bitmap *src, const Rect &src_rc, const Rect &dst_rc, BitmapMaskOption mask = kBitmap_Copy);
+    // Bilinear-filtered stretch-blit; falls back to StretchBlt for the pixel
+    // formats which cannot be interpolated (8-bit)
+    void    BilinearStretchBlt(const Bitmap *src, const Rect &dst_rc, BitmapMaskOption mask = kBitmap_Copy);
+    void    BilinearStretchBlt(const Bitmap *src, const Rect &src_rc, const Rect &dst_rc, BitmapMaskOption mask = kBitmap_Copy);
     // TODO: find more general way to call these operations, probably require pointer to Blending data struct?
     // Draw bitmap using translucency preset
     void    TransBlendBlt(const Bitmap *src, int dst_x = 0, int dst_y = 0);
@@ -0,0 +1,781 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gfx/image_scale.h"
+#include <algorithm>
+#include <string.h>
+#include <vector>
+#include <allegro.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define AGS_IMAGESCALE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AGS_IMAGESCALE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace ImageScale
+{
+
+// Destination area, clipped by the bitmap's clipping rectangle
+struct DstClip
+{
+    int XBeg = 0, XEnd = 0;
+    int YBeg = 0, YEnd = 0;
+};
+
+// Calculates the clipped destination area, same way as Allegro and aastr do;
+// returns false if there's nothing to draw
+static bool GetDstClip(const BITMAP *dst, const Rect &dst_rc, DstClip &clip)
+{
+    const int dx = dst_rc.Left, dy = dst_rc.Top;
+    const int dw = dst_rc.GetWidth(), dh = dst_rc.GetHeight();
+    if (dst->clip)
+    {
+        clip.XBeg = std::max(dx, dst->cl);
+        clip.XEnd = std::min(dx + dw, dst->cr);
+        clip.YBeg = std::max(dy, dst->ct);
+        clip.YEnd = std::min(dy + dh, dst->cb);
+    }
+    else
+    {
+        clip.XBeg = dx;
+        clip.XEnd = dx + dw;
+        clip.YBeg = dy;
+        clip.YEnd = dy + dh;
+    }
+    return (clip.XBeg < clip.XEnd) && (clip.YBeg < clip.YEnd);
+}
+
+//-----------------------------------------------------------------------------
+// Nearest-neighbour stretching
+//-----------------------------------------------------------------------------
+
+void CalcNearestSteps(int s, int sw, int d, int dw, int dbeg, int dend, std::vector<int> &steps)
+{
+    const int sinc = sw / dw;
+    const int cdec = sw - sinc * dw;
+    const int cinc = dw - cdec;
+    int c = cinc;
+    steps.resize(dend - dbeg);
+    for (; d < dend; ++d)
+    {
+        if (d >= dbeg)
+            steps[d - dbeg] = s;
+        s += sinc;
+        if (c <= 0)
+        {
+            s++;
+            c += cinc;
+        }
+        else
+        {
+            c -= cdec;
+        }
+    }
+}
+
+template <typename T>
+static void StretchRow(T *dst, const T *src, const int *xs, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = src[xs[i]];
+}
+
+template <typename T>
+static void StretchRowMasked(T *dst, const T *src, const int *xs, size_t count, T mask)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const T c = src[xs[i]];
+        if (c != mask)
+            dst[i] = c;
+    }
+}
+
+#if defined(AGS_IMAGESCALE_SSE2)
+static void StretchRow(uint32_t *dst, const uint32_t *src, const int *xs, size_t count)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i px = _mm_set_epi32(static_cast<int>(src[xs[i + 3]]), static_cast<int>(src[xs[i + 2]]),
+            static_cast<int>(src[xs[i + 1]]), static_cast<int>(src[xs[i]]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), px);
+    }
+    for (; i < count; ++i)
+        dst[i] = src[xs[i]];
+}
+
+static void StretchRowMasked(uint32_t *dst, const uint32_t *src, const int *xs, size_t count, uint32_t mask)
+{
+    const __m128i vmask = _mm_set1_epi32(static_cast<int>(mask));
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i px = _mm_set_epi32(static_cast<int>(src[xs[i + 3]]), static_cast<int>(src[xs[i + 2]]),
+            static_cast<int>(src[xs[i + 1]]), static_cast<int>(src[xs[i]]));
+        const __m128i is_mask = _mm_cmpeq_epi32(px, vmask);
+        const __m128i old = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        const __m128i res = _mm_or_si128(_mm_and_si128(is_mask, old), _mm_andnot_si128(is_mask, px));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), res);
+    }
+    for (; i < count; ++i)
+    {
+        const uint32_t c = src[xs[i]];
+        if (c != mask)
+            dst[i] = c;
+    }
+}
+#elif defined(AGS_IMAGESCALE_NEON)
+static void StretchRowMasked(uint32_t *dst, const uint32_t *src, const int *xs, size_t count, uint32_t mask)
+{
+    const uint32x4_t vmask = vdupq_n_u32(mask);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32_t gather[4] = { src[xs[i]], src[xs[i + 1]], src[xs[i + 2]], src[xs[i + 3]] };
+        const uint32x4_t px = vld1q_u32(gather);
+        const uint32x4_t is_mask = vceqq_u32(px, vmask);
+        vst1q_u32(dst + i, vbslq_u32(is_mask, vld1q_u32(dst + i), px));
+    }
+    for (; i < count; ++i)
+    {
+        const uint32_t c = src[xs[i]];
+        if (c != mask)
+            dst[i] = c;
+    }
+}
+#endif
+
+template <typename T>
+static void StretchNearestImpl(BITMAP *dst, const BITMAP *src, const std::vector<int> &xs,
+    const std::vector<int> &ys, int dxbeg, int dybeg, bool masked, T mask)
+{
+    const size_t count = xs.size();
+    for (size_t row = 0; row < ys.size(); ++row)
+    {
+        T *dline = reinterpret_cast<T*>(dst->line[dybeg + row]) + dxbeg;
+        const T *sline = reinterpret_cast<const T*>(src->line[ys[row]]);
+        if (masked)
+        {
+            StretchRowMasked(dline, sline, xs.data(), count, mask);
+        }
+        else if ((row > 0) && (ys[row] == ys[row - 1]))
+        {
+            // Same source row as the previous one, copy already stretched pixels
+            memcpy(dline, reinterpret_cast<const T*>(dst->line[dybeg + row - 1]) + dxbeg, count * sizeof(T));
+        }
+        else
+        {
+            StretchRow(dline, sline, xs.data(), count);
+        }
+    }
+}
+
+bool StretchNearest(Bitmap *dst, const Bitmap *src, const Rect &src_rc, const Rect &dst_rc, bool masked)
+{
+    const int depth = dst->GetColorDepth();
+    if ((src->GetColorDepth() != depth) ||
+        ((depth != 8) && (depth != 15) && (depth != 16) && (depth != 32)))
+        return false;
+
+    const int sw = src_rc.GetWidth(), sh = src_rc.GetHeight();
+    const int dw = dst_rc.GetWidth(), dh = dst_rc.GetHeight();
+    if ((sw <= 0) || (sh <= 0) || (dw <= 0) || (dh <= 0))
+        return true; // nothing to draw
+    BITMAP *al_dst = dst->GetAllegroBitmap();
+    const BITMAP *al_src = src->GetAllegroBitmap();
+    DstClip clip;
+    if (!GetDstClip(al_dst, dst_rc, clip))
+        return true; // nothing to draw
+
+    std::vector<int> xs, ys;
+    CalcNearestSteps(src_rc.Left, sw, dst_rc.Left, dw, clip.XBeg, clip.XEnd, xs);
+    CalcNearestSteps(src_rc.Top, sh, dst_rc.Top, dh, clip.YBeg, clip.YEnd, ys);
+    switch (depth)
+    {
+    case 8:
+        StretchNearestImpl<uint8_t>(al_dst, al_src, xs, ys, clip.XBeg, clip.YBeg, masked, MASK_COLOR_8);
+        break;
+    case 15:
+        StretchNearestImpl<uint16_t>(al_dst, al_src, xs, ys, clip.XBeg, clip.YBeg, masked, MASK_COLOR_15);
+        break;
+    case 16:
+        StretchNearestImpl<uint16_t>(al_dst, al_src, xs, ys, clip.XBeg, clip.YBeg, masked, MASK_COLOR_16);
+        break;
+    case 32:
+        StretchNearestImpl<uint32_t>(al_dst, al_src, xs, ys, clip.XBeg, clip.YBeg, masked, MASK_COLOR_32);
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Anti-aliased stretching
+//
+// This is a reimplementation of the aastr's algorithm
+// (Copyright (C) 1998, 1999 Michael Bukin, gift-ware), which calculates
+// a weighted sum of the source pixels covered by each destination pixel.
+// The weights are separable, so here the sums are calculated in two passes:
+// first each source row is summed horizontally for all the destination
+// columns, and these row sums are cached, as the neighbouring destination
+// rows share some of the source rows; then the row sums are accumulated
+// vertically. All the color components and the transparency weight are
+// kept together in 4 x 32-bit lanes, in [b, g, r, t] order.
+// The integer arithmetic is kept same as in aastr, so the results match.
+//-----------------------------------------------------------------------------
+
+// Fixed-point precision, same as used by aastr
+static const int AA_BITS = 8;
+static const int AA_SIZE = 1 << AA_BITS;
+static const int AA_MASK = AA_SIZE - 1;
+static const uint32_t AA_MAX_SIZE = 1u << 12;
+static const uint32_t AA_MAX_NUM = AA_MAX_SIZE * AA_MAX_SIZE;
+// Max number of source rows which horizontal sums are kept cached
+static const size_t AAMaxCachedRows = 4;
+
+#if defined(AGS_IMAGESCALE_SSE2)
+typedef __m128i AAVec;
+
+inline AAVec AAZero() { return _mm_setzero_si128(); }
+inline AAVec AASet(uint32_t b, uint32_t g, uint32_t r, uint32_t t)
+{
+    return _mm_set_epi32(static_cast<int>(t), static_cast<int>(r), static_cast<int>(g), static_cast<int>(b));
+}
+inline AAVec AALoad(const uint32_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+inline void AAStore(uint32_t *p, AAVec v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+inline AAVec AAAdd(AAVec a, AAVec b) { return _mm_add_epi32(a, b); }
+inline AAVec AAMul(AAVec a, uint32_t w)
+{
+    if (w == AA_SIZE)
+        return _mm_slli_epi32(a, AA_BITS);
+    // SSE2 has no 32-bit lane multiplication, so do even and odd lanes separately
+    const __m128i vw = _mm_set1_epi32(static_cast<int>(w));
+    const __m128i even = _mm_mul_epu32(a, vw);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), vw);
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+// Multiplies lanes by the weight, when the result is known to fit in 16 bits
+inline AAVec AAMulSmall(AAVec a, uint32_t w)
+{
+    return _mm_mullo_epi16(a, _mm_set1_epi32(static_cast<int>(w)));
+}
+// Unpacks 32-bit pixel of a standard "ARGB" layout into [b, g, r, 0]
+inline AAVec AAUnpack32(uint32_t c)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i px = _mm_unpacklo_epi16(
+        _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(c)), zero), zero);
+    return _mm_and_si128(px, _mm_set_epi32(0, -1, -1, -1));
+}
+#elif defined(AGS_IMAGESCALE_NEON)
+typedef uint32x4_t AAVec;
+
+inline AAVec AAZero() { return vdupq_n_u32(0); }
+inline AAVec AASet(uint32_t b, uint32_t g, uint32_t r, uint32_t t)
+{
+    const uint32_t v[4] = { b, g, r, t };
+    return vld1q_u32(v);
+}
+inline AAVec AALoad(const uint32_t *p) { return vld1q_u32(p); }
+inline void AAStore(uint32_t *p, AAVec v) { vst1q_u32(p, v); }
+inline AAVec AAAdd(AAVec a, AAVec b) { return vaddq_u32(a, b); }
+inline AAVec AAMul(AAVec a, uint32_t w) { return vmulq_n_u32(a, w); }
+inline AAVec AAMulSmall(AAVec a, uint32_t w) { return vmulq_n_u32(a, w); }
+// Unpacks 32-bit pixel of a standard "ARGB" layout into [b, g, r, 0]
+inline AAVec AAUnpack32(uint32_t c)
+{
+    const uint16x8_t px16 = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(c)));
+    return vsetq_lane_u32(0, vmovl_u16(vget_low_u16(px16)), 3);
+}
+#else
+struct AAVec
+{
+    uint32_t V[4];
+};
+
+inline AAVec AAZero() { return AAVec{ { 0u, 0u, 0u, 0u } }; }
+inline AAVec AASet(uint32_t b, uint32_t g, uint32_t r, uint32_t t) { return AAVec{ { b, g, r, t } }; }
+inline AAVec AALoad(const uint32_t *p) { return AAVec{ { p[0], p[1], p[2], p[3] } }; }
+inline void AAStore(uint32_t *p, AAVec v) { memcpy(p, v.V, sizeof(v.V)); }
+inline AAVec AAAdd(AAVec a, AAVec b)
+{
+    return AAVec{ { a.V[0] + b.V[0], a.V[1] + b.V[1], a.V[2] + b.V[2], a.V[3] + b.V[3] } };
+}
+inline AAVec AAMul(AAVec a, uint32_t w)
+{
+    return AAVec{ { a.V[0] * w, a.V[1] * w, a.V[2] * w, a.V[3] * w } };
+}
+inline AAVec AAMulSmall(AAVec a, uint32_t w) { return AAMul(a, w); }
+// Unpacks 32-bit pixel of a standard "ARGB" layout into [b, g, r, 0]
+inline AAVec AAUnpack32(uint32_t c)
+{
+    return AAVec{ { c & 0xFF, (c >> 8) & 0xFF, (c >> 16) & 0xFF, 0u } };
+}
+#endif
+
+// Pixel formats: unpack pixels into color components, pack them back,
+// and test for the mask color
+
+// 32-bit pixels in a standard "ARGB" layout
+struct AAPixel32Std
+{
+    typedef uint32_t T;
+    static AAVec Unpack(T c) { return AAUnpack32(c); }
+    static T Pack(uint32_t r, uint32_t g, uint32_t b) { return (r << 16) | (g << 8) | b; }
+    static bool IsMask(T c) { return c == MASK_COLOR_32; }
+};
+
+// 32-bit pixels in any layout
+struct AAPixel32
+{
+    typedef uint32_t T;
+    static AAVec Unpack(T c) { return AASet(getb32(c), getg32(c), getr32(c), 0u); }
+    static T Pack(uint32_t r, uint32_t g, uint32_t b) { return makecol32(r, g, b); }
+    static bool IsMask(T c) { return c == MASK_COLOR_32; }
+};
+
+struct AAPixel16
+{
+    typedef uint16_t T;
+    static AAVec Unpack(T c) { return AASet(getb16(c), getg16(c), getr16(c), 0u); }
+    static T Pack(uint32_t r, uint32_t g, uint32_t b) { return static_cast<T>(makecol16(r, g, b)); }
+    static bool IsMask(T c) { return c == MASK_COLOR_16; }
+};
+
+struct AAPixel15
+{
+    typedef uint16_t T;
+    static AAVec Unpack(T c) { return AASet(getb15(c), getg15(c), getr15(c), 0u); }
+    static T Pack(uint32_t r, uint32_t g, uint32_t b) { return static_cast<T>(makecol15(r, g, b)); }
+    static bool IsMask(T c) { return c == MASK_COLOR_15; }
+};
+
+// Bresenham stepping, same as aastr's aa_PREPARE and aa_ADVANCE
+struct AAStepper
+{
+    int Inc = 0, DD = 0, I1 = 0, I2 = 0;
+
+    AAStepper(int yw, int xw)
+    {
+        if ((xw == 0) || ((yw < xw) && (yw > -xw)))
+        {
+            Inc = 0;
+        }
+        else
+        {
+            Inc = yw / xw;
+            yw %= xw;
+        }
+        if (yw < 0)
+        {
+            Inc -= 1;
+            yw += xw;
+        }
+        I1 = 2 * yw;
+        DD = I1 - xw;
+        I2 = DD - xw;
+    }
+
+    void Advance(int &y)
+    {
+        if (DD >= 0)
+        {
+            y += Inc + 1;
+            DD += I2;
+        }
+        else
+        {
+            y += Inc;
+            DD += I1;
+        }
+    }
+};
+
+// Source pixels covered by a destination pixel along one axis:
+// the first and last pixel index, and their partial weights
+// (the last pixel is not covered if its weight is 0).
+// All the pixels in between have a full weight of AA_SIZE.
+struct AASpan
+{
+    int I1 = 0, F1 = 0;
+    int I2 = 0, F2 = 0;
+};
+
+// Calculates the source spans for the destination pixels in [dbeg, dend);
+// s, sw are fixed-point source position and size, d, dw are the destination
+// ones, ds is the fixed-point source size of one destination pixel.
+static void CalcAASpans(int s, int sw, int d, int dw, int ds, int dbeg, int dend, std::vector<AASpan> &spans)
+{
+    AAStepper step(sw, dw);
+    spans.resize(dend - dbeg);
+    for (; d < dend; ++d)
+    {
+        if (d >= dbeg)
+        {
+            AASpan &span = spans[d - dbeg];
+            span.I1 = s >> AA_BITS;
+            span.F1 = AA_SIZE - (s & AA_MASK);
+            span.I2 = (s + ds) >> AA_BITS;
+            span.F2 = (s + ds) & AA_MASK;
+        }
+        step.Advance(s);
+    }
+}
+
+// Integer division by a constant divisor, using multiplication by
+// a reciprocal; the result is corrected to match the exact division
+struct AADivider
+{
+    const uint32_t Num;
+    const double Inv;
+
+    AADivider(uint32_t num) : Num(num), Inv(1.0 / num) {}
+
+    uint32_t Div(uint32_t v) const
+    {
+        uint32_t q = static_cast<uint32_t>(v * Inv);
+        // the floating-point quotient may be off by one at most
+        if (static_cast<uint64_t>(q) * Num > v)
+            q--;
+        else if (static_cast<uint64_t>(q + 1) * Num <= v)
+            q++;
+        return q;
+    }
+};
+
+template <class TPx, bool Masked>
+inline AAVec AAAddPixel(AAVec acc, typename TPx::T c, uint32_t w)
+{
+    if (Masked && TPx::IsMask(c))
+        return AAAdd(acc, AASet(0u, 0u, 0u, w));
+    // color component (max 255) multiplied by the weight (max AA_SIZE) fits in 16 bits
+    return AAAdd(acc, AAMulSmall(TPx::Unpack(c), w));
+}
+
+// Sums the source row horizontally, for each of the destination columns
+template <class TPx, bool Masked>
+static void AASumRow(const BITMAP *src, int sy, const std::vector<AASpan> &xspans, uint32_t *hsum)
+{
+    typedef typename TPx::T T;
+    const T *sline = reinterpret_cast<const T*>(src->line[sy]);
+    for (const auto &span : xspans)
+    {
+        AAVec acc = AAAddPixel<TPx, Masked>(AAZero(), sline[span.I1], span.F1);
+        for (int x = span.I1 + 1; x < span.I2; ++x)
+            acc = AAAddPixel<TPx, Masked>(acc, sline[x], AA_SIZE);
+        if (span.F2 != 0)
+            acc = AAAddPixel<TPx, Masked>(acc, sline[span.I2], span.F2);
+        AAStore(hsum, acc);
+        hsum += 4;
+    }
+}
+
+// Adds weighted row sums to the accumulated column sums
+static void AAAccumulate(uint32_t *acc, const uint32_t *hsum, size_t cols, uint32_t w)
+{
+    for (size_t i = 0; i < cols; ++i, acc += 4, hsum += 4)
+        AAStore(acc, AAAdd(AALoad(acc), AAMul(AALoad(hsum), w)));
+}
+
+template <class TPx>
+static void StretchAAImpl(BITMAP *dst, const BITMAP *src, const std::vector<AASpan> &xspans,
+    const std::vector<AASpan> &yspans, int dxbeg, int dybeg, uint32_t num, bool masked)
+{
+    typedef typename TPx::T T;
+    const size_t cols = xspans.size();
+    // Each destination row covers a number of source rows, keep some of the
+    // most recent row sums, so that the next destination row could reuse them
+    size_t max_span = 1;
+    for (const auto &span : yspans)
+        max_span = std::max(max_span, static_cast<size_t>(span.I2 - span.I1 + 1));
+    const size_t slots = std::min(max_span, AAMaxCachedRows);
+    std::vector<uint32_t> hsums(slots * cols * 4);
+    std::vector<int> slot_rows(slots, -1);
+    std::vector<uint32_t> acc(cols * 4);
+    const AADivider div(num);
+
+    for (size_t row = 0; row < yspans.size(); ++row)
+    {
+        const AASpan &span = yspans[row];
+        std::fill(acc.begin(), acc.end(), 0u);
+        const int last_sy = (span.F2 != 0) ? span.I2 : span.I2 - 1;
+        for (int sy = span.I1; sy <= last_sy; ++sy)
+        {
+            const uint32_t w = (sy == span.I1) ? span.F1 : ((sy == span.I2) ? span.F2 : AA_SIZE);
+            const size_t slot = sy % slots;
+            uint32_t *hsum = &hsums[slot * cols * 4];
+            if (slot_rows[slot] != sy)
+            {
+                if (masked)
+                    AASumRow<TPx, true>(src, sy, xspans, hsum);
+                else
+                    AASumRow<TPx, false>(src, sy, xspans, hsum);
+                slot_rows[slot] = sy;
+            }
+            AAAccumulate(acc.data(), hsum, cols, w);
+        }
+
+        T *dline = reinterpret_cast<T*>(dst->line[dybeg + row]) + dxbeg;
+        const uint32_t *sum = acc.data();
+        for (size_t i = 0; i < cols; ++i, sum += 4)
+        {
+            // Skip pixels mostly covered by transparency
+            if (masked && !(num >= 2 * sum[3]))
+                continue;
+            if (num == AA_SIZE * AA_SIZE)
+                dline[i] = TPx::Pack(sum[2] >> (2 * AA_BITS), sum[1] >> (2 * AA_BITS), sum[0] >> (2 * AA_BITS));
+            else
+                dline[i] = TPx::Pack(div.Div(sum[2]), div.Div(sum[1]), div.Div(sum[0]));
+        }
+    }
+}
+
+bool StretchAA(Bitmap *dst, const Bitmap *src, const Rect &src_rc, const Rect &dst_rc, bool masked)
+{
+    const int depth = dst->GetColorDepth();
+    if ((src->GetColorDepth() != depth) ||
+        ((depth != 15) && (depth != 16) && (depth != 32)))
+        return false;
+
+    int sw = src_rc.GetWidth(), sh = src_rc.GetHeight();
+    int dw = dst_rc.GetWidth(), dh = dst_rc.GetHeight();
+    if ((sw <= 0) || (sh <= 0) || (dw <= 0) || (dh <= 0))
+        return true; // nothing to draw
+    BITMAP *al_dst = dst->GetAllegroBitmap();
+    const BITMAP *al_src = src->GetAllegroBitmap();
+    DstClip clip;
+    if (!GetDstClip(al_dst, dst_rc, clip))
+        return true; // nothing to draw
+
+    // Calculate the fixed-point source size of a destination pixel;
+    // when enlarging, the last source pixel is not stepped over, and each
+    // destination pixel covers exactly one source pixel's area.
+    const int sx = src_rc.Left << AA_BITS;
+    sw <<= AA_BITS;
+    int dsx = sw / dw;
+    if (dsx < AA_SIZE)
+    {
+        dw--;
+        sw -= AA_SIZE;
+        dsx = AA_SIZE;
+    }
+    const int sy = src_rc.Top << AA_BITS;
+    sh <<= AA_BITS;
+    int dsy = sh / dh;
+    if (dsy < AA_SIZE)
+    {
+        dh--;
+        sh -= AA_SIZE;
+        dsy = AA_SIZE;
+    }
+    if (static_cast<uint64_t>(dsx) * static_cast<uint64_t>(dsy) > AA_MAX_NUM)
+    {
+        dsx = std::min<int>(dsx, AA_MAX_SIZE);
+        dsy = std::min<int>(dsy, AA_MAX_SIZE);
+    }
+    const uint32_t num = static_cast<uint32_t>(dsx) * static_cast<uint32_t>(dsy);
+
+    std::vector<AASpan> xspans, yspans;
+    CalcAASpans(sx, sw, dst_rc.Left, dw, dsx, clip.XBeg, clip.XEnd, xspans);
+    CalcAASpans(sy, sh, dst_rc.Top, dh, dsy, clip.YBeg, clip.YEnd, yspans);
+    switch (depth)
+    {
+    case 15:
+        StretchAAImpl<AAPixel15>(al_dst, al_src, xspans, yspans, clip.XBeg, clip.YBeg, num, masked);
+        break;
+    case 16:
+        StretchAAImpl<AAPixel16>(al_dst, al_src, xspans, yspans, clip.XBeg, clip.YBeg, num, masked);
+        break;
+    case 32:
+        if ((_rgb_r_shift_32 == 16) && (_rgb_g_shift_32 == 8) && (_rgb_b_shift_32 == 0))
+            StretchAAImpl<AAPixel32Std>(al_dst, al_src, xspans, yspans, clip.XBeg, clip.YBeg, num, masked);
+        else
+            StretchAAImpl<AAPixel32>(al_dst, al_src, xspans, yspans, clip.XBeg, clip.YBeg, num, masked);
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Bilinear stretching
+//
+// Each destination pixel center is mapped onto the source, and the color is
+// interpolated between the 4 nearest source pixels, using 8-bit fixed-point
+// weights. Same as with the anti-aliased stretching, the interpolation is
+// done in two passes: first the two source rows are interpolated
+// horizontally (and these are cached, as the neighbouring destination rows
+// often share them), then the results are interpolated vertically.
+// The pixel formats and the vector lanes are shared with StretchAA.
+//-----------------------------------------------------------------------------
+
+// Two neighbouring source pixels and the weight of the second one
+struct BLStep
+{
+    int I0 = 0, I1 = 0;
+    uint32_t F = 0;
+};
+
+// Calculates the source pixels for the destination pixels in [dbeg, dend);
+// s, sw are source position and size, d, dw are destination ones.
+static void CalcBilinearSteps(int s, int sw, int d, int dw, int dbeg, int dend, std::vector<BLStep> &steps)
+{
+    steps.resize(dend - dbeg);
+    for (int i = dbeg; i < dend; ++i)
+    {
+        // pixel center, in 16.16 fixed-point source coordinates
+        int64_t pos = ((static_cast<int64_t>(2 * (i - d) + 1) * sw) << 16) / (2 * dw) - (1 << 15);
+        pos = std::max<int64_t>(pos, 0);
+        int si = static_cast<int>(pos >> 16);
+        uint32_t f = static_cast<uint32_t>(pos & 0xFFFF) >> (16 - AA_BITS);
+        if (si >= sw - 1)
+        {
+            si = sw - 1;
+            f = 0;
+        }
+        BLStep &step = steps[i - dbeg];
+        step.I0 = s + si;
+        step.I1 = s + std::min(si + 1, sw - 1);
+        step.F = f;
+    }
+}
+
+// Interpolates the source row horizontally, for each of the destination columns
+template <class TPx, bool Masked>
+static void BLLerpRow(const BITMAP *src, int sy, const std::vector<BLStep> &xsteps, uint32_t *hrow)
+{
+    typedef typename TPx::T T;
+    const T *sline = reinterpret_cast<const T*>(src->line[sy]);
+    for (const auto &step : xsteps)
+    {
+        AAVec acc = AAAddPixel<TPx, Masked>(AAZero(), sline[step.I0], AA_SIZE - step.F);
+        if (step.F != 0)
+            acc = AAAddPixel<TPx, Masked>(acc, sline[step.I1], step.F);
+        AAStore(hrow, acc);
+        hrow += 4;
+    }
+}
+
+template <class TPx>
+static void StretchBilinearImpl(BITMAP *dst, const BITMAP *src, const std::vector<BLStep> &xsteps,
+    const std::vector<BLStep> &ysteps, int dxbeg, int dybeg, bool masked)
+{
+    typedef typename TPx::T T;
+    const uint32_t num = AA_SIZE * AA_SIZE;
+    const size_t cols = xsteps.size();
+    // Consecutive source rows always go into the different slots
+    std::vector<uint32_t> hrows(2 * cols * 4);
+    int slot_rows[2] = { -1, -1 };
+    std::vector<uint32_t> acc(cols * 4);
+
+    for (size_t row = 0; row < ysteps.size(); ++row)
+    {
+        const BLStep &step = ysteps[row];
+        const int srows[2] = { step.I0, step.I1 };
+        const uint32_t *h[2];
+        for (int i = 0; i < 2; ++i)
+        {
+            const size_t slot = srows[i] & 1;
+            uint32_t *hrow = &hrows[slot * cols * 4];
+            if (slot_rows[slot] != srows[i])
+            {
+                if (masked)
+                    BLLerpRow<TPx, true>(src, srows[i], xsteps, hrow);
+                else
+                    BLLerpRow<TPx, false>(src, srows[i], xsteps, hrow);
+                slot_rows[slot] = srows[i];
+            }
+            h[i] = hrow;
+        }
+
+        std::fill(acc.begin(), acc.end(), 0u);
+        AAAccumulate(acc.data(), h[0], cols, AA_SIZE - step.F);
+        if (step.F != 0)
+            AAAccumulate(acc.data(), h[1], cols, step.F);
+
+        T *dline = reinterpret_cast<T*>(dst->line[dybeg + row]) + dxbeg;
+        const uint32_t *sum = acc.data();
+        for (size_t i = 0; i < cols; ++i, sum += 4)
+        {
+            if (sum[3] == 0)
+            {
+                dline[i] = TPx::Pack((sum[2] + num / 2) >> (2 * AA_BITS),
+                    (sum[1] + num / 2) >> (2 * AA_BITS), (sum[0] + num / 2) >> (2 * AA_BITS));
+                continue;
+            }
+            // Skip pixels mostly covered by transparency,
+            // interpolate only between the opaque ones otherwise
+            if (!(num >= 2 * sum[3]))
+                continue;
+            const uint32_t w = num - sum[3];
+            dline[i] = TPx::Pack((sum[2] + w / 2) / w, (sum[1] + w / 2) / w, (sum[0] + w / 2) / w);
+        }
+    }
+}
+
+bool StretchBilinear(Bitmap *dst, const Bitmap *src, const Rect &src_rc, const Rect &dst_rc, bool masked)
+{
+    const int depth = dst->GetColorDepth();
+    if ((src->GetColorDepth() != depth) ||
+        ((depth != 15) && (depth != 16) && (depth != 32)))
+        return false;
+
+    const int sw = src_rc.GetWidth(), sh = src_rc.GetHeight();
+    const int dw = dst_rc.GetWidth(), dh = dst_rc.GetHeight();
+    if ((sw <= 0) || (sh <= 0) || (dw <= 0) || (dh <= 0))
+        return true; // nothing to draw
+    BITMAP *al_dst = dst->GetAllegroBitmap();
+    const BITMAP *al_src = src->GetAllegroBitmap();
+    DstClip clip;
+    if (!GetDstClip(al_dst, dst_rc, clip))
+        return true; // nothing to draw
+
+    std::vector<BLStep> xsteps, ysteps;
+    CalcBilinearSteps(src_rc.Left, sw, dst_rc.Left, dw, clip.XBeg, clip.XEnd, xsteps);
+    CalcBilinearSteps(src_rc.Top, sh, dst_rc.Top, dh, clip.YBeg, clip.YEnd, ysteps);
+    switch (depth)
+    {
+    case 15:
+        StretchBilinearImpl<AAPixel15>(al_dst, al_src, xsteps, ysteps, clip.XBeg, clip.YBeg, masked);
+        break;
+    case 16:
+        StretchBilinearImpl<AAPixel16>(al_dst, al_src, xsteps, ysteps, clip.XBeg, clip.YBeg, masked);
+        break;
+    case 32:
+        if ((_rgb_r_shift_32 == 16) && (_rgb_g_shift_32 == 8) && (_rgb_b_shift_32 == 0))
+            StretchBilinearImpl<AAPixel32Std>(al_dst, al_src, xsteps, ysteps, clip.XBeg, clip.YBeg, masked);
+        else
+            StretchBilinearImpl<AAPixel32>(al_dst, al_src, xsteps, ysteps, clip.XBeg, clip.YBeg, masked);
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+} // namespace ImageScale
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,70 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Optimized bitmap scaling routines.
+//
+// Nearest and anti-aliased stretching are drop-in replacements for Allegro's
+// stretch_blit and aastr's aa_stretch_blit: they produce exactly same pixels,
+// but precalculate the source pixel steps once per call instead of per row,
+// reuse the results between the neighbouring rows, and use SIMD (SSE2 or NEON)
+// where available. Bilinear stretching has no legacy counterpart, and is
+// implemented using the same approach.
+//
+// All functions work only with bitmaps of the same color depth, and return
+// false if the combination of formats is not supported, in which case the
+// caller should fallback to the generic Allegro or aastr implementation.
+//
+//=============================================================================
+#ifndef __AGS_CN_GFX__IMAGESCALE_H
+#define __AGS_CN_GFX__IMAGESCALE_H
+
+#include <vector>
+#include "gfx/bitmap.h"
+#include "util/geometry.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace ImageScale
+{
+    // Stretches src_rc of the source bitmap onto the dst_rc of the destination,
+    // using "nearest neighbour" method; optionally skips the source pixels
+    // of mask color. Supports 8, 15, 16 and 32-bit bitmaps.
+    bool StretchNearest(Bitmap *dst, const Bitmap *src, const Rect &src_rc, const Rect &dst_rc, bool masked);
+    // Stretches src_rc of the source bitmap onto the dst_rc of the destination
+    // with anti-aliasing: averages the covered source pixels when shrinking,
+    // and interpolates between the neighbouring pixels when enlarging.
+    // If masked, skips destination pixels which are mostly covered by the
+    // source pixels of mask color. Supports 15, 16 and 32-bit bitmaps.
+    bool StretchAA(Bitmap *dst, const Bitmap *src, const Rect &src_rc, const Rect &dst_rc, bool masked);
+    // Stretches src_rc of the source bitmap onto the dst_rc of the destination,
+    // interpolating between the 4 nearest source pixels. If masked, skips
+    // destination pixels which are mostly covered by the source pixels of
+    // mask color, and interpolates only between the rest of the pixels.
+    // Supports 15, 16 and 32-bit bitmaps; alpha channel is not kept, same as
+    // with StretchAA.
+    bool StretchBilinear(Bitmap *dst, const Bitmap *src, const Rect &src_rc, const Rect &dst_rc, bool masked);
+
+    // Calculates the source pixel index for each of the destination pixels
+    // in the [dbeg, dend) range, using exactly same Bresenham stepping as
+    // Allegro's stretcher; s, sw are source and d, dw are destination span.
+    void CalcNearestSteps(int s, int sw, int d, int dw, int dbeg, int dend, std::vector<int> &steps);
+} // namespace ImageScale
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_GFX__IMAGESCALE_H
@@ -45,7 +45,9 @@ int ccGetOption(int optbit)
 // Returns current running script callstack as a human-readable text
 extern String cc_get_callstack(int max_lines = INT_MAX);
 
-static ScriptError ccError;
+// The error state is per thread, so that the scripts may be loaded
+// by the background threads too (e.g. when preloading the rooms)
+static thread_local ScriptError ccError;
 
 void cc_clear_error()
 {
@@ -0,0 +1,233 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include <allegro.h>
+#include "gfx/bitmap.h"
+#include "util/compress.h"
+#include "util/lzw.h"
+#include "util/memory_compat.h"
+#include "util/memorystream.h"
+
+using namespace AGS::Common;
+
+// Fills the data with runs of repeating values mixed with noise,
+// to let compressors produce both literals and references
+static void FillPattern(uint8_t *data, size_t size)
+{
+    uint32_t seed = 12345u;
+    for (size_t i = 0; i < size; ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = ((i / 64) % 3 == 0) ? static_cast<uint8_t>(seed >> 16) : static_cast<uint8_t>(i / 16);
+    }
+}
+
+TEST(Compress, LZWExpandInParts) {
+    std::vector<uint8_t> data(20000);
+    FillPattern(data.data(), data.size());
+    std::vector<uint8_t> packed;
+    {
+        Stream in(std::make_unique<MemoryStream>(data.data(), data.size()));
+        Stream out(std::make_unique<VectorStream>(packed, kStream_Write));
+        ASSERT_TRUE(lzwcompress(&in, &out));
+    }
+
+    std::vector<uint8_t> whole(data.size());
+    ASSERT_TRUE(lzwexpand(packed.data(), packed.size(), whole.data(), whole.size()));
+    ASSERT_EQ(whole, data);
+
+    // expanding in small parts must give same result, including the
+    // references split between the parts
+    std::vector<uint8_t> parts(data.size());
+    LZWExpander lzw(packed.data(), packed.size());
+    size_t pos = 0;
+    for (size_t part = 1; pos < parts.size(); part = part % 13 + 1)
+    {
+        const size_t len = std::min(part, parts.size() - pos);
+        ASSERT_EQ(lzw.Expand(parts.data() + pos, len), len);
+        pos += len;
+    }
+    ASSERT_TRUE(lzw.IsEOS());
+    ASSERT_EQ(parts, data);
+}
+
+TEST(Compress, LZWBitmap) {
+    for (int bpp : { 1, 2, 4 })
+    {
+        Bitmap bmp(97, 61, bpp * 8);
+        FillPattern(bmp.GetDataForWriting(), bmp.GetDataSize());
+        RGB pal[256];
+        FillPattern(reinterpret_cast<uint8_t*>(pal), sizeof(pal));
+        std::vector<uint8_t> buf;
+        {
+            Stream out(std::make_unique<VectorStream>(buf, kStream_Write));
+            save_lzw(&out, &bmp, &pal);
+        }
+
+        Stream in(std::make_unique<VectorStream>(buf));
+        RGB pal2[256];
+        auto loaded = load_lzw(&in, bpp, &pal2);
+        ASSERT_TRUE(loaded != nullptr);
+        ASSERT_EQ(in.GetPosition(), static_cast<soff_t>(buf.size()));
+        ASSERT_EQ(loaded->GetWidth(), bmp.GetWidth());
+        ASSERT_EQ(loaded->GetHeight(), bmp.GetHeight());
+        ASSERT_EQ(loaded->GetColorDepth(), bmp.GetColorDepth());
+        ASSERT_EQ(memcmp(pal, pal2, sizeof(pal)), 0);
+        for (int y = 0; y < bmp.GetHeight(); ++y)
+            ASSERT_EQ(memcmp(loaded->GetScanLine(y), bmp.GetScanLine(y), bmp.GetLineLength()), 0);
+    }
+}
+
+TEST(Compress, RLEBitmap8Size) {
+    Bitmap bmp(50, 40, 8);
+    FillPattern(bmp.GetDataForWriting(), bmp.GetDataSize());
+    std::vector<uint8_t> buf;
+    size_t first_sz;
+    {
+        Stream out(std::make_unique<VectorStream>(buf, kStream_Write));
+        save_rle_bitmap8(&out, &bmp);
+        first_sz = static_cast<size_t>(out.GetPosition());
+        save_rle_bitmap8(&out, &bmp);
+    }
+    ASSERT_EQ(rle_bitmap8_size(buf.data(), buf.size()), first_sz);
+    ASSERT_EQ(rle_bitmap8_size(buf.data() + first_sz, buf.size() - first_sz), buf.size() - first_sz);
+    ASSERT_EQ(rle_bitmap8_size(buf.data(), first_sz - 1), 0u);
+}
+
+TEST(Compress, DeflateBitmap) {
+    for (int bpp : { 1, 2, 4 })
+    {
+        for (bool row_filters : { false, true })
+        {
+            // odd width, to test filtering with the partial pixels
+            Bitmap bmp(97, 61, bpp * 8);
+            FillPattern(bmp.GetDataForWriting(), bmp.GetDataSize());
+            std::vector<uint8_t> buf;
+            {
+                Stream out(std::make_unique<VectorStream>(buf, kStream_Write));
+                save_deflate_bitmap(&out, &bmp, row_filters);
+                save_deflate_bitmap(&out, &bmp, row_filters);
+            }
+
+            // the records are self-sized, so the second one is read after the first
+            Stream in(std::make_unique<VectorStream>(buf));
+            auto first = load_deflate_bitmap(&in);
+            std::vector<uint8_t> data;
+            read_deflate_bitmap(&in, data);
+            ASSERT_EQ(in.GetPosition(), static_cast<soff_t>(buf.size()));
+            auto loaded = unpack_deflate_bitmap(data.data(), data.size());
+            ASSERT_TRUE(first != nullptr);
+            ASSERT_TRUE(loaded != nullptr);
+            ASSERT_EQ(loaded->GetWidth(), bmp.GetWidth());
+            ASSERT_EQ(loaded->GetHeight(), bmp.GetHeight());
+            ASSERT_EQ(loaded->GetColorDepth(), bmp.GetColorDepth());
+            for (int y = 0; y < bmp.GetHeight(); ++y)
+            {
+                ASSERT_EQ(memcmp(first->GetScanLine(y), bmp.GetScanLine(y), bmp.GetLineLength()), 0);
+                ASSERT_EQ(memcmp(loaded->GetScanLine(y), bmp.GetScanLine(y), bmp.GetLineLength()), 0);
+            }
+            // truncated data must fail to unpack
+            ASSERT_TRUE(unpack_deflate_bitmap(data.data(), data.size() / 2) == nullptr);
+        }
+    }
+}
+
+TEST(Compress, DeflateBitmapBadRecord) {
+    Bitmap bmp(16, 16, 8);
+    std::vector<uint8_t> buf;
+    {
+        Stream out(std::make_unique<VectorStream>(buf, kStream_Write));
+        save_deflate_bitmap(&out, &bmp, true);
+    }
+    std::vector<uint8_t> data;
+    // the record must fit in the given limit
+    {
+        Stream in(std::make_unique<VectorStream>(buf));
+        ASSERT_FALSE(read_deflate_bitmap(&in, data, static_cast<soff_t>(buf.size()) - 1));
+        ASSERT_TRUE(data.empty());
+    }
+    // truncated record
+    {
+        std::vector<uint8_t> cut(buf.begin(), buf.end() - 1);
+        Stream in(std::make_unique<VectorStream>(cut));
+        ASSERT_FALSE(read_deflate_bitmap(&in, data));
+        ASSERT_TRUE(data.empty());
+    }
+    // corrupt size, much larger than the data
+    {
+        std::vector<uint8_t> bad(buf);
+        bad[3] = 0x7F;
+        Stream in(std::make_unique<VectorStream>(bad));
+        ASSERT_FALSE(read_deflate_bitmap(&in, data));
+        in.Seek(0, kSeekBegin);
+        ASSERT_TRUE(load_deflate_bitmap(&in) == nullptr);
+    }
+}
+
+// Measures the size and unpacking time of the room images, compressed
+// with the legacy methods (LZW background and RLE mask) and Deflate,
+// using a synthetic painted-like 32-bit background and a mask with few areas
+TEST(Compress, DISABLED_RoomImagesBenchmark) {
+    const int runs = 20;
+    Bitmap bg(1280, 720, 32);
+    Bitmap mask(1280, 720, 8);
+    uint32_t seed = 12345u;
+    for (int y = 0; y < bg.GetHeight(); ++y)
+    {
+        uint32_t *row = reinterpret_cast<uint32_t*>(bg.GetScanLineForWriting(y));
+        uint8_t *mrow = mask.GetScanLineForWriting(y);
+        for (int x = 0; x < bg.GetWidth(); ++x)
+        {
+            seed = seed * 1103515245u + 12345u;
+            const int noise = (seed >> 16) % 9 - 4;
+            const int r = std::min(255, std::max(0, 128 + static_cast<int>(100 * std::sin(x * 0.01)) + noise));
+            const int g = std::min(255, std::max(0, y * 255 / bg.GetHeight() + noise));
+            const int b = std::min(255, std::max(0, 128 + static_cast<int>(100 * std::cos((x + y) * 0.004)) + noise));
+            row[x] = 0xFF000000u | (r << 16) | (g << 8) | b;
+            mrow[x] = static_cast<uint8_t>((x / 200 + y / 150) % 5);
+        }
+    }
+
+    for (int method = 0; method < 3; ++method)
+    {
+        std::vector<uint8_t> buf;
+        {
+            Stream out(std::make_unique<VectorStream>(buf, kStream_Write));
+            switch (method)
+            {
+            case 0: save_lzw(&out, &bg); save_rle_bitmap8(&out, &mask); break;
+            default: save_deflate_bitmap(&out, &bg, method == 2); save_deflate_bitmap(&out, &mask, false); break;
+            }
+        }
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < runs; ++i)
+        {
+            Stream in(std::make_unique<VectorStream>(buf));
+            switch (method)
+            {
+            case 0: load_lzw(&in, 4); load_rle_bitmap8(&in); break;
+            default: load_deflate_bitmap(&in); load_deflate_bitmap(&in); break;
+            }
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        const double total_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        const char *names[] = { "LZW + RLE", "Deflate", "Deflate, filtered" };
+        printf("%-18s: %8zu bytes, %6.3f ms to unpack\n", names[method], buf.size(), total_ms / runs);
+    }
+}
@@ -0,0 +1,350 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdio.h>
+#include <string.h>
+#include "gtest/gtest.h"
+#include <allegro.h>
+#include <aastr.h>
+#include "gfx/allegrobitmap.h"
+#include "gfx/image_scale.h"
+
+using namespace AGS::Common;
+
+namespace
+{
+
+struct ScaleCase
+{
+    Rect SrcRc;
+    Rect DstRc;
+};
+
+// Source bitmap size is the size of the largest source rect + some margin
+const ScaleCase ScaleCases[] = {
+    { RectWH(0, 0, 16, 16), RectWH(0, 0, 16, 16) },
+    { RectWH(0, 0, 16, 16), RectWH(0, 0, 48, 32) },
+    { RectWH(3, 2, 37, 23), RectWH(1, 2, 100, 61) },
+    { RectWH(1, 4, 100, 61), RectWH(2, 0, 37, 23) },
+    { RectWH(0, 0, 64, 64), RectWH(5, 5, 1, 1) },
+    { RectWH(7, 7, 1, 1), RectWH(0, 0, 13, 7) },
+    { RectWH(0, 0, 50, 7), RectWH(4, 1, 3, 90) },
+    { RectWH(0, 0, 120, 100), RectWH(-17, -9, 150, 130) }, // clipped
+    { RectWH(2, 3, 110, 90), RectWH(0, 0, 110, 90) },
+};
+const int SrcWidth = 128, SrcHeight = 110;
+const int DstWidth = 128, DstHeight = 120;
+
+// Fills bitmap with pseudo-random pixels, with approx 1/4 of mask color
+void FillRandom(Bitmap *bmp, uint32_t seed)
+{
+    const int bpp = bmp->GetBPP();
+    for (int y = 0; y < bmp->GetHeight(); ++y)
+    {
+        uint8_t *line = bmp->GetScanLineForWriting(y);
+        for (int x = 0; x < bmp->GetWidth(); ++x)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            uint32_t c = seed >> 8;
+            if ((seed >> 28) < 4)
+                c = bmp->GetMaskColor();
+            switch (bpp)
+            {
+            case 1: line[x] = static_cast<uint8_t>(c); break;
+            case 2: reinterpret_cast<uint16_t*>(line)[x] = static_cast<uint16_t>(c); break;
+            case 4:
+                // make the alpha vary too, but keep the mask color exact
+                reinterpret_cast<uint32_t*>(line)[x] = (c == static_cast<uint32_t>(bmp->GetMaskColor())) ?
+                    c : (c | (seed << 24)); break;
+            }
+        }
+    }
+}
+
+::testing::AssertionResult BitmapsEqual(const Bitmap *a, const Bitmap *b)
+{
+    for (int y = 0; y < a->GetHeight(); ++y)
+    {
+        if (memcmp(a->GetScanLine(y), b->GetScanLine(y), a->GetLineLength()) != 0)
+            return ::testing::AssertionFailure() << "pixel rows differ at y = " << y;
+    }
+    return ::testing::AssertionSuccess();
+}
+
+// Sets the 32-bit pixel format for the duration of the test
+struct RGBShifts32
+{
+    int R, G, B;
+    RGBShifts32(int r, int g, int b)
+        : R(_rgb_r_shift_32), G(_rgb_g_shift_32), B(_rgb_b_shift_32)
+    {
+        _rgb_r_shift_32 = r; _rgb_g_shift_32 = g; _rgb_b_shift_32 = b;
+    }
+    ~RGBShifts32()
+    {
+        _rgb_r_shift_32 = R; _rgb_g_shift_32 = G; _rgb_b_shift_32 = B;
+    }
+};
+
+typedef void (*LegacyStretch)(Bitmap *dst, Bitmap *src, const Rect &src_rc, const Rect &dst_rc);
+typedef bool (*NewStretch)(Bitmap *dst, const Bitmap *src, const Rect &src_rc, const Rect &dst_rc, bool masked);
+
+void TestScaleCases(int depth, LegacyStretch legacy, NewStretch scale, bool masked, bool full_src)
+{
+    std::unique_ptr<Bitmap> src(new Bitmap(SrcWidth, SrcHeight, depth));
+    FillRandom(src.get(), 123u);
+    for (const auto &sc : ScaleCases)
+    {
+        std::unique_ptr<Bitmap> src_sub;
+        Rect src_rc = sc.SrcRc;
+        const Bitmap *use_src = src.get();
+        if (full_src)
+        { // test variant which always takes the whole source bitmap
+            src_sub.reset(new Bitmap(src.get(), sc.SrcRc));
+            src_rc = RectWH(0, 0, sc.SrcRc.GetWidth(), sc.SrcRc.GetHeight());
+            use_src = src_sub.get();
+        }
+        std::unique_ptr<Bitmap> dst1(new Bitmap(DstWidth, DstHeight, depth));
+        std::unique_ptr<Bitmap> dst2(new Bitmap(DstWidth, DstHeight, depth));
+        FillRandom(dst1.get(), 456u);
+        FillRandom(dst2.get(), 456u);
+        dst1->SetClip(RectWH(2, 1, DstWidth - 5, DstHeight - 3));
+        dst2->SetClip(RectWH(2, 1, DstWidth - 5, DstHeight - 3));
+        legacy(dst1.get(), const_cast<Bitmap*>(use_src), src_rc, sc.DstRc);
+        ASSERT_TRUE(scale(dst2.get(), use_src, src_rc, sc.DstRc, masked));
+        EXPECT_TRUE(BitmapsEqual(dst1.get(), dst2.get())) << "depth " << depth
+            << ", src " << src_rc.GetWidth() << "x" << src_rc.GetHeight()
+            << ", dst " << sc.DstRc.GetWidth() << "x" << sc.DstRc.GetHeight();
+    }
+}
+
+void AllegroStretch(Bitmap *dst, Bitmap *src, const Rect &src_rc, const Rect &dst_rc)
+{
+    stretch_blit(src->GetAllegroBitmap(), dst->GetAllegroBitmap(),
+        src_rc.Left, src_rc.Top, src_rc.GetWidth(), src_rc.GetHeight(),
+        dst_rc.Left, dst_rc.Top, dst_rc.GetWidth(), dst_rc.GetHeight());
+}
+
+void AllegroMaskedStretch(Bitmap *dst, Bitmap *src, const Rect &src_rc, const Rect &dst_rc)
+{
+    masked_stretch_blit(src->GetAllegroBitmap(), dst->GetAllegroBitmap(),
+        src_rc.Left, src_rc.Top, src_rc.GetWidth(), src_rc.GetHeight(),
+        dst_rc.Left, dst_rc.Top, dst_rc.GetWidth(), dst_rc.GetHeight());
+}
+
+void AAStretch(Bitmap *dst, Bitmap *src, const Rect &src_rc, const Rect &dst_rc)
+{
+    aa_stretch_blit(src->GetAllegroBitmap(), dst->GetAllegroBitmap(),
+        src_rc.Left, src_rc.Top, src_rc.GetWidth(), src_rc.GetHeight(),
+        dst_rc.Left, dst_rc.Top, dst_rc.GetWidth(), dst_rc.GetHeight());
+}
+
+void AAStretchSprite(Bitmap *dst, Bitmap *src, const Rect &/*src_rc*/, const Rect &dst_rc)
+{
+    aa_stretch_sprite(dst->GetAllegroBitmap(), src->GetAllegroBitmap(),
+        dst_rc.Left, dst_rc.Top, dst_rc.GetWidth(), dst_rc.GetHeight());
+}
+
+// Straightforward per-pixel bilinear interpolation, for comparison
+void BilinearReferenceImpl(Bitmap *dst, Bitmap *src, const Rect &src_rc, const Rect &dst_rc, bool masked)
+{
+    const int depth = src->GetColorDepth();
+    const int sw = src_rc.GetWidth(), sh = src_rc.GetHeight();
+    const int dw = dst_rc.GetWidth(), dh = dst_rc.GetHeight();
+    const Rect clip = IntersectRects(dst->GetClip(), dst_rc);
+    // source pixel and the 8-bit weight of the next one, for the pixel center
+    auto src_pos = [](int d, int s, int sw, int dw, int &i0, int &i1, int &f)
+    {
+        const double pos = std::max(0.0, (d + 0.5) * sw / dw - 0.5);
+        const int64_t fixed = static_cast<int64_t>(((2 * d + 1) * static_cast<int64_t>(sw) << 16) / (2 * dw)) - (1 << 15);
+        EXPECT_NEAR(pos, std::max<int64_t>(fixed, 0) / 65536.0, 1.0 / 65536.0);
+        const int64_t p = std::max<int64_t>(fixed, 0);
+        i0 = std::min(static_cast<int>(p >> 16), sw - 1);
+        f = (i0 == sw - 1) ? 0 : static_cast<int>((p & 0xFFFF) >> 8);
+        i1 = std::min(i0 + 1, sw - 1);
+        i0 += s; i1 += s;
+    };
+    for (int y = clip.Top; y <= clip.Bottom; ++y)
+    {
+        int y0, y1, fy;
+        src_pos(y - dst_rc.Top, src_rc.Top, sh, dh, y0, y1, fy);
+        for (int x = clip.Left; x <= clip.Right; ++x)
+        {
+            int x0, x1, fx;
+            src_pos(x - dst_rc.Left, src_rc.Left, sw, dw, x0, x1, fx);
+            const int px[4] = { src->GetPixel(x0, y0), src->GetPixel(x1, y0),
+                                src->GetPixel(x0, y1), src->GetPixel(x1, y1) };
+            const uint32_t w[4] = { static_cast<uint32_t>((256 - fx) * (256 - fy)), static_cast<uint32_t>(fx * (256 - fy)),
+                                    static_cast<uint32_t>((256 - fx) * fy), static_cast<uint32_t>(fx * fy) };
+            uint32_t r = 0, g = 0, b = 0, t = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                if (masked && (px[i] == src->GetMaskColor()))
+                {
+                    t += w[i];
+                    continue;
+                }
+                r += getr_depth(depth, px[i]) * w[i];
+                g += getg_depth(depth, px[i]) * w[i];
+                b += getb_depth(depth, px[i]) * w[i];
+            }
+            if (2 * t > 65536)
+                continue;
+            const uint32_t tw = 65536 - t;
+            dst->PutPixel(x, y, makecol_depth(depth, (r + tw / 2) / tw, (g + tw / 2) / tw, (b + tw / 2) / tw));
+        }
+    }
+}
+
+void BilinearReference(Bitmap *dst, Bitmap *src, const Rect &src_rc, const Rect &dst_rc)
+{
+    BilinearReferenceImpl(dst, src, src_rc, dst_rc, false);
+}
+
+void BilinearReferenceMasked(Bitmap *dst, Bitmap *src, const Rect &src_rc, const Rect &dst_rc)
+{
+    BilinearReferenceImpl(dst, src, src_rc, dst_rc, true);
+}
+
+} // namespace
+
+TEST(ImageScale, StretchNearest) {
+    RGBShifts32 shifts(16, 8, 0);
+    const int depths[] = { 8, 15, 16, 32 };
+    for (int depth : depths)
+    {
+        TestScaleCases(depth, AllegroStretch, ImageScale::StretchNearest, false, false);
+        TestScaleCases(depth, AllegroMaskedStretch, ImageScale::StretchNearest, true, false);
+    }
+}
+
+TEST(ImageScale, StretchAA) {
+    const int depths[] = { 15, 16, 32 };
+    {
+        RGBShifts32 shifts(16, 8, 0);
+        for (int depth : depths)
+        {
+            TestScaleCases(depth, AAStretch, ImageScale::StretchAA, false, false);
+            TestScaleCases(depth, AAStretchSprite, ImageScale::StretchAA, true, true);
+        }
+    }
+    {
+        // Non-standard 32-bit pixel layout
+        RGBShifts32 shifts(0, 8, 16);
+        TestScaleCases(32, AAStretch, ImageScale::StretchAA, false, false);
+        TestScaleCases(32, AAStretchSprite, ImageScale::StretchAA, true, true);
+    }
+}
+
+TEST(ImageScale, StretchBilinear) {
+    const int depths[] = { 15, 16, 32 };
+    {
+        RGBShifts32 shifts(16, 8, 0);
+        for (int depth : depths)
+        {
+            TestScaleCases(depth, BilinearReference, ImageScale::StretchBilinear, false, false);
+            TestScaleCases(depth, BilinearReferenceMasked, ImageScale::StretchBilinear, true, false);
+        }
+    }
+    {
+        // Non-standard 32-bit pixel layout
+        RGBShifts32 shifts(0, 8, 16);
+        TestScaleCases(32, BilinearReference, ImageScale::StretchBilinear, false, false);
+        TestScaleCases(32, BilinearReferenceMasked, ImageScale::StretchBilinear, true, false);
+    }
+    {
+        // Same size must give exactly same pixels (only alpha is lost)
+        RGBShifts32 shifts(16, 8, 0);
+        std::unique_ptr<Bitmap> src(new Bitmap(SrcWidth, SrcHeight, 32));
+        std::unique_ptr<Bitmap> dst(new Bitmap(SrcWidth, SrcHeight, 32));
+        FillRandom(src.get(), 789u);
+        ASSERT_TRUE(ImageScale::StretchBilinear(dst.get(), src.get(), RectWH(src->GetSize()), RectWH(dst->GetSize()), false));
+        for (int y = 0; y < SrcHeight; ++y)
+            for (int x = 0; x < SrcWidth; ++x)
+                ASSERT_EQ(dst->GetPixel(x, y) & 0xFFFFFF, src->GetPixel(x, y) & 0xFFFFFF);
+    }
+}
+
+TEST(ImageScale, Unsupported) {
+    std::unique_ptr<Bitmap> src8(new Bitmap(16, 16, 8));
+    std::unique_ptr<Bitmap> dst8(new Bitmap(32, 32, 8));
+    std::unique_ptr<Bitmap> dst32(new Bitmap(32, 32, 32));
+    const Rect src_rc = RectWH(0, 0, 16, 16), dst_rc = RectWH(0, 0, 32, 32);
+    ASSERT_FALSE(ImageScale::StretchNearest(dst32.get(), src8.get(), src_rc, dst_rc, false));
+    ASSERT_FALSE(ImageScale::StretchAA(dst8.get(), src8.get(), src_rc, dst_rc, false));
+    ASSERT_FALSE(ImageScale::StretchAA(dst32.get(), src8.get(), src_rc, dst_rc, false));
+    ASSERT_FALSE(ImageScale::StretchBilinear(dst8.get(), src8.get(), src_rc, dst_rc, false));
+}
+
+// Throughput benchmark, compares legacy Allegro/aastr functions and ImageScale
+// at several typical game and window resolutions. Run explicitly with
+// --gtest_also_run_disabled_tests --gtest_filter=ImageScale.*Benchmark
+TEST(ImageScale, DISABLED_StretchBenchmark) {
+    RGBShifts32 shifts(16, 8, 0);
+    const struct { Size Src, Dst; } resolutions[] = {
+        { Size(320, 200), Size(640, 400) },
+        { Size(320, 200), Size(1280, 800) },
+        { Size(640, 360), Size(1920, 1080) },
+        { Size(1280, 720), Size(1920, 1080) },
+        { Size(1920, 1080), Size(640, 360) },
+    };
+    const struct { const char *Name; LegacyStretch Legacy; NewStretch Scale; bool Masked; } methods[] = {
+        { "nearest", AllegroStretch, ImageScale::StretchNearest, false },
+        { "masked", AllegroMaskedStretch, ImageScale::StretchNearest, true },
+        { "aa", AAStretch, ImageScale::StretchAA, false },
+        { "bilinear", nullptr, ImageScale::StretchBilinear, false }, // no legacy counterpart
+    };
+    const int depth = 32;
+    const int iterations = 10;
+    const int runs = 3;
+    typedef std::chrono::high_resolution_clock Clock;
+    for (const auto &res : resolutions)
+    {
+        std::unique_ptr<Bitmap> src(new Bitmap(res.Src.Width, res.Src.Height, depth));
+        std::unique_ptr<Bitmap> dst(new Bitmap(res.Dst.Width, res.Dst.Height, depth));
+        FillRandom(src.get(), 1u);
+        const Rect src_rc = RectWH(res.Src), dst_rc = RectWH(res.Dst);
+        const double mpix = static_cast<double>(res.Dst.Width) * res.Dst.Height * iterations / 1000000.0;
+        for (const auto &m : methods)
+        {
+            // take the best of several runs, to reduce the noise
+            double legacy_s = 0.0, scale_s = 0.0;
+            for (int run = 0; run < runs; ++run)
+            {
+                auto t0 = Clock::now();
+                for (int i = 0; m.Legacy && (i < iterations); ++i)
+                    m.Legacy(dst.get(), src.get(), src_rc, dst_rc);
+                auto t1 = Clock::now();
+                for (int i = 0; i < iterations; ++i)
+                    m.Scale(dst.get(), src.get(), src_rc, dst_rc, m.Masked);
+                auto t2 = Clock::now();
+                const double run_legacy_s = std::chrono::duration<double>(t1 - t0).count();
+                const double run_scale_s = std::chrono::duration<double>(t2 - t1).count();
+                legacy_s = (run == 0) ? run_legacy_s : std::min(legacy_s, run_legacy_s);
+                scale_s = (run == 0) ? run_scale_s : std::min(scale_s, run_scale_s);
+            }
+            if (!m.Legacy)
+            {
+                printf("%4dx%-4d -> %4dx%-4d %-8s: new %8.1f Mpix/s\n",
+                    res.Src.Width, res.Src.Height, res.Dst.Width, res.Dst.Height, m.Name, mpix / scale_s);
+                continue;
+            }
+            printf("%4dx%-4d -> %4dx%-4d %-8s: legacy %8.1f Mpix/s, new %8.1f Mpix/s (x%.2f)\n",
+                res.Src.Width, res.Src.Height, res.Dst.Width, res.Dst.Height, m.Name,
+                mpix / legacy_s, mpix / scale_s, legacy_s / scale_s);
+        }
+    }
+}
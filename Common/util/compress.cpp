@@ -13,12 +13,15 @@
 //=============================================================================
 #include "util/compress.h"
 #include <stdlib.h>
+#include <cstdlib>
 #include <stdio.h>
+#include <algorithm>
 #include <vector>
 #include <miniz.h>
 #include "ac/common.h"	// quit, update_polled_stuff
 #include "gfx/bitmap.h"
 #include "util/lzw.h"
+#include "util/memory.h"
 #include "util/memory_compat.h"
 #include "util/memorystream.h"
 #if AGS_PLATFORM_ENDIAN_BIG
@@ -27,6 +30,25 @@
 
 using namespace AGS::Common;
 
+#if AGS_PLATFORM_ENDIAN_BIG
+// Converts the pixels between the little-endian and native byte order
+static void swap_pixel_bytes(uint8_t *data, size_t data_sz, int bpp)
+{
+  switch (bpp)
+  {
+  case 2:
+    for (int16_t *px = reinterpret_cast<int16_t*>(data), *end = px + data_sz / 2; px < end; ++px)
+      *px = BBOp::SwapBytesInt16(*px);
+    break;
+  case 4:
+    for (int32_t *px = reinterpret_cast<int32_t*>(data), *end = px + data_sz / 4; px < end; ++px)
+      *px = BBOp::SwapBytesInt32(*px);
+    break;
+  default: break;
+  }
+}
+#endif
+
 //-----------------------------------------------------------------------------
 // RLE
 //-----------------------------------------------------------------------------
@@ -403,44 +425,79 @@ void save_lzw(Stream *out, const Bitmap *bmpp, const RGB (*pal)[256])
   out->Seek(toret, kSeekBegin);
 }
 
-std::unique_ptr<Bitmap> load_lzw(Stream *in, int dst_bpp, RGB (*pal)[256])
+void read_lzw(Stream *in, std::vector<uint8_t> &data, size_t &uncomp_sz, RGB (*pal)[256])
 {
   // NOTE: old format saves full RGB struct here (4 bytes, including the filler)
   if (pal)
     in->Read(*pal, sizeof(RGB) * 256);
   else
     in->Seek(sizeof(RGB) * 256);
-  const size_t uncomp_sz = in->ReadInt32();
+  uncomp_sz = in->ReadInt32();
   const size_t comp_sz = in->ReadInt32();
-  const soff_t end_pos = in->GetPosition() + comp_sz;
-
-  // First decompress data into the memory buffer
-  std::vector<uint8_t> inbuf(comp_sz);
-  std::vector<uint8_t> membuf(uncomp_sz);
-  in->Read(inbuf.data(), comp_sz);
-  lzwexpand(inbuf.data(), comp_sz, membuf.data(), uncomp_sz);
+  data.resize(comp_sz);
+  data.resize(in->Read(data.data(), comp_sz));
+}
 
-  // Open same buffer for reading and get params and pixels
-  Stream mem_in(std::make_unique<VectorStream>(membuf));
-  int stride = mem_in.ReadInt32(); // width * bpp
-  int height = mem_in.ReadInt32();
+std::unique_ptr<Bitmap> unpack_lzw(const uint8_t *data, size_t data_sz, size_t uncomp_sz, int dst_bpp)
+{
+  // The unpacked data begins with the bitmap's params, followed by pixels
+  LZWExpander lzw(data, data_sz);
+  uint8_t header[sizeof(int32_t) * 2];
+  if ((uncomp_sz < sizeof(header)) || (lzw.Expand(header, sizeof(header)) < sizeof(header)))
+    return nullptr;
+  const int stride = Memory::ReadInt32LE(header); // width * bpp
+  const int height = Memory::ReadInt32LE(header + sizeof(int32_t));
+  if ((stride <= 0) || (height <= 0) || (dst_bpp <= 0))
+    return nullptr;
   std::unique_ptr<Bitmap> bmm(BitmapHelper::CreateBitmap((stride / dst_bpp), height, dst_bpp * 8));
   if (!bmm) return nullptr; // out of mem?
 
-  size_t num_pixels = stride * height / dst_bpp;
+  // Expand pixels right into the bitmap, rows are stored without padding
   uint8_t *bmp_data = bmm->GetDataForWriting();
-  switch (dst_bpp)
-  {
-  case 1: mem_in.Read(bmp_data, num_pixels); break;
-  case 2: mem_in.ReadArrayOfInt16(reinterpret_cast<int16_t*>(bmp_data), num_pixels); break;
-  case 4: mem_in.ReadArrayOfInt32(reinterpret_cast<int32_t*>(bmp_data), num_pixels); break;
-  default: assert(0); break;
-  }
+  const size_t pixels_sz = std::min<size_t>(bmm->GetLineLength() * height, uncomp_sz - sizeof(header));
+  lzw.Expand(bmp_data, pixels_sz);
+#if AGS_PLATFORM_ENDIAN_BIG
+  swap_pixel_bytes(bmp_data, pixels_sz, dst_bpp);
+#endif
+  return bmm;
+}
 
-  if (in->GetPosition() != end_pos)
-    in->Seek(end_pos, kSeekBegin);
+std::unique_ptr<Bitmap> load_lzw(Stream *in, int dst_bpp, RGB (*pal)[256])
+{
+  std::vector<uint8_t> data;
+  size_t uncomp_sz;
+  read_lzw(in, data, uncomp_sz, pal);
+  return unpack_lzw(data.data(), data.size(), uncomp_sz, dst_bpp);
+}
 
-  return bmm;
+size_t rle_bitmap8_size(const uint8_t *data, size_t data_sz)
+{
+  if (data_sz < sizeof(int16_t) * 2)
+    return 0;
+  const size_t w = static_cast<uint16_t>(Memory::ReadInt16LE(data));
+  const size_t h = static_cast<uint16_t>(Memory::ReadInt16LE(data + sizeof(int16_t)));
+  // Walk the packed runs without unpacking them
+  size_t pos = sizeof(int16_t) * 2;
+  for (size_t px = 0, num_px = w * h; px < num_px;)
+  {
+    if (pos >= data_sz)
+      return 0;
+    int8_t cx = static_cast<int8_t>(data[pos++]);
+    if (cx == -128)
+      cx = 0; // same as in cunpackbitl
+    if (cx < 0)
+    { // a run of the same byte
+      px += 1 - cx;
+      pos += 1;
+    }
+    else
+    { // a sequence of the different bytes
+      px += cx + 1;
+      pos += cx + 1;
+    }
+  }
+  pos += 3 * 256; // palette
+  return pos <= data_sz ? pos : 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -525,3 +582,245 @@ bool inflate_decompress(uint8_t* data, size_t data_sz, int /*image_bpp*/, Stream
     in->Read(in_buf.data(), in_sz);
     return z_inflate(in_buf.data(), in_sz, data, data_sz);
 }
+
+// Deflate bitmap record: the size of the rest of the record, bitmap's params,
+// and the deflated rows of pixels in the little-endian byte order;
+// if the row filters are enabled, then each row is prepended by a filter type.
+// NOTE: the filters are the same as defined by PNG specification.
+enum RowFilter
+{
+    kRowFilter_None = 0,
+    kRowFilter_Sub,     // difference with the pixel on the left
+    kRowFilter_Up,      // difference with the pixel above
+    kRowFilter_Average, // difference with the average of left and above
+    kRowFilter_Paeth,   // difference with the Paeth predictor
+    kNumRowFilters
+};
+
+const int DEFLATE_BMP_ROWFILTERS = 0x01; // bitmap flag: rows are filtered
+const size_t DEFLATE_BMP_HEADER_SIZE = sizeof(int32_t) * 2 + sizeof(int8_t) * 2 + sizeof(int16_t);
+
+static inline int paeth_predictor(int a, int b, int c)
+{
+    const int p = a + b - c;
+    const int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc)
+        return a;
+    return (pb <= pc) ? b : c;
+}
+
+// Applies the filter to the row of bytes; prev is the previous unfiltered row,
+// and bpp is the distance between the neighbouring pixels' bytes
+static void filter_row(int filter, const uint8_t *row, const uint8_t *prev, size_t len, size_t bpp, uint8_t *out)
+{
+    for (size_t i = 0; i < len; ++i)
+    {
+        const int a = (i >= bpp) ? row[i - bpp] : 0;
+        const int b = prev[i];
+        const int c = (i >= bpp) ? prev[i - bpp] : 0;
+        switch (filter)
+        {
+        case kRowFilter_Sub: out[i] = static_cast<uint8_t>(row[i] - a); break;
+        case kRowFilter_Up: out[i] = static_cast<uint8_t>(row[i] - b); break;
+        case kRowFilter_Average: out[i] = static_cast<uint8_t>(row[i] - ((a + b) >> 1)); break;
+        case kRowFilter_Paeth: out[i] = static_cast<uint8_t>(row[i] - paeth_predictor(a, b, c)); break;
+        default: out[i] = row[i]; break;
+        }
+    }
+}
+
+// Reverts the filter in place; returns false if the filter type is unknown
+static bool unfilter_row(int filter, uint8_t *row, const uint8_t *prev, size_t len, size_t bpp)
+{
+    switch (filter)
+    {
+    case kRowFilter_None:
+        break;
+    case kRowFilter_Sub:
+        for (size_t i = bpp; i < len; ++i)
+            row[i] += row[i - bpp];
+        break;
+    case kRowFilter_Up:
+        for (size_t i = 0; i < len; ++i)
+            row[i] += prev[i];
+        break;
+    case kRowFilter_Average:
+        for (size_t i = 0; i < bpp && i < len; ++i)
+            row[i] += prev[i] >> 1;
+        for (size_t i = bpp; i < len; ++i)
+            row[i] += (row[i - bpp] + prev[i]) >> 1;
+        break;
+    case kRowFilter_Paeth:
+        for (size_t i = 0; i < bpp && i < len; ++i)
+            row[i] += prev[i];
+        for (size_t i = bpp; i < len; ++i)
+            row[i] += paeth_predictor(row[i - bpp], prev[i], prev[i - bpp]);
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+// Deflates the next portion of data, and writes the output to the stream
+static void z_deflate_write(z_stream &stream, const uint8_t *data, size_t data_sz, int flush, Stream *out)
+{
+    uint8_t outbuf[4096];
+    stream.next_in = data;
+    stream.avail_in = static_cast<unsigned>(data_sz);
+    do {
+        stream.next_out = outbuf;
+        stream.avail_out = sizeof(outbuf);
+        int ret = deflate(&stream, flush);
+        assert(ret != Z_STREAM_ERROR);
+        (void)ret;
+        out->Write(outbuf, sizeof(outbuf) - stream.avail_out);
+    } while (stream.avail_out == 0);
+}
+
+// Inflates exactly the requested amount of data; returns false on error,
+// or if the stream has ended before
+static bool z_inflate_read(z_stream &stream, uint8_t *dst, size_t dst_sz)
+{
+    stream.next_out = dst;
+    stream.avail_out = static_cast<unsigned>(dst_sz);
+    while (stream.avail_out > 0)
+    {
+        int ret = inflate(&stream, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END)
+            break;
+        if (ret != Z_OK)
+            return false;
+    }
+    return stream.avail_out == 0;
+}
+
+void save_deflate_bitmap(Stream *out, const Bitmap *bmp, bool row_filters)
+{
+    const int w = bmp->GetWidth(), h = bmp->GetHeight(), bpp = bmp->GetBPP();
+    const size_t len = bmp->GetLineLength();
+    // reserve space for the record size
+    const soff_t size_at = out->GetPosition();
+    out->WriteInt32(0);
+    out->WriteInt32(w);
+    out->WriteInt32(h);
+    out->WriteInt8(static_cast<int8_t>(bpp));
+    out->WriteInt8(row_filters ? DEFLATE_BMP_ROWFILTERS : 0);
+    out->WriteInt16(0); // reserved
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit(&stream, Z_DEFAULT_COMPRESSION) != Z_OK)
+        return;
+    std::vector<uint8_t> prev(len, 0), cur(len), filtered(len + 1), best(len + 1);
+    for (int y = 0; y < h; ++y)
+    {
+        memcpy(cur.data(), bmp->GetScanLine(y), len);
+#if AGS_PLATFORM_ENDIAN_BIG
+        swap_pixel_bytes(cur.data(), len, bpp);
+#endif
+        if (!row_filters)
+        {
+            z_deflate_write(stream, cur.data(), len, Z_NO_FLUSH, out);
+            continue;
+        }
+
+        // Choose the filter which gives the least sum of absolute differences,
+        // the heuristic suggested by PNG specification
+        uint64_t best_sum = UINT64_MAX;
+        for (int f = kRowFilter_None; f < kNumRowFilters; ++f)
+        {
+            filtered[0] = static_cast<uint8_t>(f);
+            filter_row(f, cur.data(), prev.data(), len, bpp, &filtered[1]);
+            uint64_t sum = 0;
+            for (size_t i = 1; i <= len; ++i)
+                sum += std::abs(static_cast<int8_t>(filtered[i]));
+            if (sum < best_sum)
+            {
+                best_sum = sum;
+                best.swap(filtered);
+            }
+        }
+        z_deflate_write(stream, best.data(), len + 1, Z_NO_FLUSH, out);
+        prev.swap(cur);
+    }
+    z_deflate_write(stream, nullptr, 0, Z_FINISH, out);
+    (void)deflateEnd(&stream);
+
+    // write the record size, and seek back to the end of the output stream
+    const soff_t end_at = out->GetPosition();
+    out->Seek(size_at, kSeekBegin);
+    out->WriteInt32(static_cast<int32_t>(end_at - size_at - sizeof(int32_t)));
+    out->Seek(end_at, kSeekBegin);
+}
+
+bool read_deflate_bitmap(Stream *in, std::vector<uint8_t> &data, soff_t max_size)
+{
+    data.clear();
+    const soff_t data_sz = static_cast<uint32_t>(in->ReadInt32());
+    // the record size is not trusted, don't allocate more than is there
+    soff_t avail_sz = in->GetLength() - in->GetPosition();
+    if (max_size >= 0)
+        avail_sz = std::min(avail_sz, max_size - static_cast<soff_t>(sizeof(int32_t)));
+    if (data_sz > avail_sz)
+        return false;
+    data.resize(static_cast<size_t>(data_sz));
+    if (in->Read(data.data(), data.size()) != data.size())
+    {
+        data.clear();
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<Bitmap> unpack_deflate_bitmap(const uint8_t *data, size_t data_sz)
+{
+    if (data_sz < DEFLATE_BMP_HEADER_SIZE)
+        return nullptr;
+    const int w = Memory::ReadInt32LE(data);
+    const int h = Memory::ReadInt32LE(data + sizeof(int32_t));
+    const int bpp = data[sizeof(int32_t) * 2];
+    const int flags = data[sizeof(int32_t) * 2 + sizeof(int8_t)];
+    if ((w <= 0) || (h <= 0) || (bpp < 1) || (bpp > 4))
+        return nullptr;
+    std::unique_ptr<Bitmap> bmp(BitmapHelper::CreateBitmap(w, h, bpp * 8));
+    if (!bmp) return nullptr; // out of mem?
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit(&stream) != Z_OK)
+        return nullptr;
+    stream.next_in = data + DEFLATE_BMP_HEADER_SIZE;
+    stream.avail_in = static_cast<unsigned>(data_sz - DEFLATE_BMP_HEADER_SIZE);
+    // Inflate rows right into the bitmap, and unfilter them in place;
+    // the first row is filtered against the row of zeroes
+    const bool row_filters = (flags & DEFLATE_BMP_ROWFILTERS) != 0;
+    const size_t len = bmp->GetLineLength();
+    const std::vector<uint8_t> zero_row(row_filters ? len : 0u, 0);
+    bool ok = true;
+    for (int y = 0; (y < h) && ok; ++y)
+    {
+        uint8_t *row = bmp->GetScanLineForWriting(y);
+        uint8_t filter = kRowFilter_None;
+        if (row_filters)
+            ok = z_inflate_read(stream, &filter, 1);
+        ok = ok && z_inflate_read(stream, row, len);
+        if (ok && (filter != kRowFilter_None))
+            ok = unfilter_row(filter, row, (y > 0) ? bmp->GetScanLine(y - 1) : zero_row.data(), len, bpp);
+    }
+    (void)inflateEnd(&stream);
+    if (!ok)
+        return nullptr;
+#if AGS_PLATFORM_ENDIAN_BIG
+    swap_pixel_bytes(bmp->GetDataForWriting(), len * h, bpp);
+#endif
+    return bmp;
+}
+
+std::unique_ptr<Bitmap> load_deflate_bitmap(Stream *in)
+{
+    std::vector<uint8_t> data;
+    if (!read_deflate_bitmap(in, data))
+        return nullptr;
+    return unpack_deflate_bitmap(data.data(), data.size());
+}
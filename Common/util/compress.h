@@ -32,6 +32,9 @@ void save_rle_bitmap8(Common::Stream *out, const Common::Bitmap *bmp, const RGB
 std::unique_ptr<Common::Bitmap> load_rle_bitmap8(Common::Stream *in, RGB (*pal)[256] = nullptr);
 // Skips the 8-bit RLE bitmap
 void skip_rle_bitmap8(Common::Stream *in);
+// Gets the full size of the 8-bit RLE bitmap stored in memory, including
+// its header and palette; returns 0 if the data is incomplete
+size_t rle_bitmap8_size(const uint8_t *data, size_t data_sz);
 
 // LZW compression
 bool lzw_compress(const uint8_t *data, size_t data_sz, int image_bpp, Common::Stream *out);
@@ -40,9 +43,27 @@ bool lzw_decompress(uint8_t *data, size_t data_sz, int image_bpp, Common::Stream
 void save_lzw(Common::Stream *out, const Common::Bitmap *bmpp, const RGB (*pal)[256] = nullptr);
 // Loads bitmap decompressing
 std::unique_ptr<Common::Bitmap> load_lzw(Common::Stream *in, int dst_bpp, RGB (*pal)[256] = nullptr);
+// Reads the palette and the LZW-compressed bitmap data, without unpacking it;
+// this lets unpack the bitmap later, or on another thread
+void read_lzw(Common::Stream *in, std::vector<uint8_t> &data, size_t &uncomp_sz, RGB (*pal)[256] = nullptr);
+// Unpacks the bitmap from the data read by read_lzw()
+std::unique_ptr<Common::Bitmap> unpack_lzw(const uint8_t *data, size_t data_sz, size_t uncomp_sz, int dst_bpp);
 
 // Deflate compression
 bool deflate_compress(const uint8_t* data, size_t data_sz, int image_bpp, Common::Stream* out);
 bool inflate_decompress(uint8_t* data, size_t data_sz, int image_bpp, Common::Stream* in, size_t in_sz);
+// Saves bitmap compressed by Deflate, as a record which begins with its size;
+// optionally applies PNG-like filters to the pixel rows prior to compression,
+// which lets compress photo-like images better, at a cost of slower saving
+void save_deflate_bitmap(Common::Stream *out, const Common::Bitmap *bmp, bool row_filters);
+// Reads the Deflate bitmap record, without unpacking it; the record may not
+// exceed the remaining stream length, nor max_size bytes including its size
+// field (if max_size is not negative).
+// Returns false if the record is larger than that, or could not be read.
+bool read_deflate_bitmap(Common::Stream *in, std::vector<uint8_t> &data, soff_t max_size = -1);
+// Unpacks the bitmap from the data read by read_deflate_bitmap()
+std::unique_ptr<Common::Bitmap> unpack_deflate_bitmap(const uint8_t *data, size_t data_sz);
+// Loads the Deflate bitmap record and unpacks the bitmap
+std::unique_ptr<Common::Bitmap> load_deflate_bitmap(Common::Stream *in);
 
 #endif // __AC_COMPRESS_H
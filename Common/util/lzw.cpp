@@ -191,57 +191,59 @@ bool lzwcompress(Stream *lzw_in, Stream *out)
 
 bool lzwexpand(const uint8_t *src, size_t src_sz, uint8_t *dst, size_t dst_sz)
 {
-  int bits, ch, i, j, len, mask;
-  uint8_t *dst_ptr = dst;
-  const uint8_t *src_ptr = src;
-
   if (dst_sz == 0)
     return false; // nowhere to expand to
 
-  lzbuffer = (uint8_t *)malloc(N);
-  if (lzbuffer == nullptr) {
-    return false; // not enough memory
-  }
-  i = N - F;
-
-  // Read from the src and expand, until either src or dst runs out of space
-  while ((static_cast<size_t>(src_ptr - src) < src_sz) &&
-         (static_cast<size_t>(dst_ptr - dst) < dst_sz)) {
-    bits = *(src_ptr++);
-    for (mask = 0x01; mask & 0xFF; mask <<= 1) {
-      if (bits & mask) {
-        if (static_cast<size_t>(src_ptr - src) > (src_sz - sizeof(int16_t)))
-          break;
-
-        short jshort = 0;
-        jshort = Memory::ReadInt16LE(src_ptr);
-        src_ptr += sizeof(int16_t);
-        j = jshort;
-
-        len = ((j >> 12) & 15) + 3;
-        j = (i - j - 1) & (N - 1);
-
-        if (static_cast<size_t>(dst_ptr - dst) > (dst_sz - len))
-          break; // not enough dest buffer
-
-        while (len--) {
-          *(dst_ptr++) = (lzbuffer[i] = lzbuffer[j]);
-          j = (j + 1) & (N - 1);
-          i = (i + 1) & (N - 1);
-        }
-      } else {
-        ch = *(src_ptr++);
-        *(dst_ptr++) = (lzbuffer[i] = static_cast<uint8_t>(ch));
-        i = (i + 1) & (N - 1);
-      }
+  LZWExpander lzw(src, src_sz);
+  lzw.Expand(dst, dst_sz);
+  return lzw.IsEOS();
+}
+
+LZWExpander::LZWExpander(const uint8_t *src, size_t src_sz)
+  : _src(src)
+  , _srcEnd(src + src_sz)
+  , _winPos(N - F)
+{
+}
 
-      if ((static_cast<size_t>(dst_ptr - dst) >= dst_sz) ||
-          (static_cast<size_t>(src_ptr - src) >= src_sz)) {
-        break; // not enough dest buffer for the next pass
+size_t LZWExpander::Expand(uint8_t *dst, size_t dst_sz)
+{
+  uint8_t *dst_ptr = dst;
+  uint8_t *const dst_end = dst + dst_sz;
+
+  while (dst_ptr < dst_end) {
+    // Finish the copy, which could have been interrupted by the end of dst
+    if (_copyLen > 0) {
+      for (; (_copyLen > 0) && (dst_ptr < dst_end); --_copyLen) {
+        *(dst_ptr++) = (_window[_winPos] = _window[_copyPos]);
+        _copyPos = (_copyPos + 1) & (N - 1);
+        _winPos = (_winPos + 1) & (N - 1);
       }
-    } // end for mask
-  }
+      continue;
+    }
 
-  free(lzbuffer);
-  return (src_ptr - src) == src_sz;
+    // Each flags byte tells the kind of the next 8 items
+    if (_mask == 0) {
+      if (_src == _srcEnd)
+        break;
+      _flags = *(_src++);
+      _mask = 0x01;
+    }
+
+    if (_flags & _mask) {
+      if (_srcEnd - _src < static_cast<ptrdiff_t>(sizeof(int16_t)))
+        break; // incomplete data
+      const int j = Memory::ReadInt16LE(_src);
+      _src += sizeof(int16_t);
+      _copyLen = ((j >> 12) & 15) + 3;
+      _copyPos = (_winPos - j - 1) & (N - 1);
+    } else {
+      if (_src == _srcEnd)
+        break;
+      *(dst_ptr++) = (_window[_winPos] = *(_src++));
+      _winPos = (_winPos + 1) & (N - 1);
+    }
+    _mask = (_mask << 1) & 0xFF;
+  }
+  return dst_ptr - dst;
 }
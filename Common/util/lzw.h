@@ -26,4 +26,32 @@ bool lzwcompress(AGS::Common::Stream *lzw_in, AGS::Common::Stream *out);
 // the dst buffer should be large enough, or the uncompression will not be complete.
 bool lzwexpand(const uint8_t *src, size_t src_sz, uint8_t *dst, size_t dst_sz);
 
+// LZWExpander expands lzw-compressed data gradually, resuming where the
+// previous call stopped; this lets split the output among several buffers.
+// Does not use any shared state, so separate expanders may run in parallel.
+class LZWExpander
+{
+public:
+    LZWExpander(const uint8_t *src, size_t src_sz);
+
+    // Expands up to dst_sz bytes into dst, returns the number of bytes written
+    size_t Expand(uint8_t *dst, size_t dst_sz);
+    // Tells if all the compressed data was consumed
+    bool IsEOS() const { return (_src == _srcEnd) && (_copyLen == 0); }
+
+private:
+    static const int WindowSize = 4096;
+
+    const uint8_t *_src = nullptr;
+    const uint8_t *_srcEnd = nullptr;
+    uint8_t _window[WindowSize] = {};
+    int _winPos = 0;
+    // Current flags byte, and the mask of the next item's flag
+    int _flags = 0;
+    int _mask = 0;
+    // Pending copy of the previous output
+    int _copyPos = 0;
+    int _copyLen = 0;
+};
+
 #endif // __AGS_CN_UTIL__LZW_H
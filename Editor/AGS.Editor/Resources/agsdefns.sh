@@ -859,6 +859,10 @@ import void DisplayTopBar(int y, int textColor, int backColor, const string titl
 import void DisplayMessageBar(int y, int textColor, int backColor, const string title, int message);
 /// Resets the room state back to how it was initially set up in the editor.
 import void ResetRoom(int roomNumber);
+#ifdef SCRIPT_API_v363
+/// Starts loading the specified room in background, so that changing to that room later is faster.
+import void PreloadRoom(int roomNumber);
+#endif // SCRIPT_API_v363
 /// Checks whether the player has been in the specified room yet.
 import int  HasPlayerBeenInRoom(int roomNumber);
 #ifdef SCRIPT_COMPAT_v335
@@ -2498,6 +2502,43 @@ builtin managed struct AudioClip {
 #endif // SCRIPT_API_v361
 };
 
+#ifdef SCRIPT_API_v363
+builtin managed struct VideoPlayer {
+  /// Opens a video file for playing along with the game; its frames are displayed by the sprite returned by Graphic.
+  import static VideoPlayer* Open(const string filename, bool autoPlay = true, RepeatStyle = eOnce); // $AUTOCOMPLETESTATICONLY$
+  /// Starts or resumes the video playback.
+  import void Play();
+  /// Pauses the video playback.
+  import void Pause();
+  /// Stops the video playback; the Graphic keeps displaying the last shown frame.
+  import void Stop();
+  /// The sprite which displays the current video frame; may be assigned to objects, overlays, GUI and so forth.
+  readonly import attribute int Graphic;
+  /// The index of the currently displayed video frame, or -1 if no frame was displayed yet.
+  readonly import attribute int Frame;
+  /// The total number of frames in this video, or 0 if unknown.
+  readonly import attribute int FrameCount;
+  /// The video's native frame rate, in frames per second.
+  readonly import attribute float FrameRate;
+  /// The width of the video frame, in pixels.
+  readonly import attribute int Width;
+  /// The height of the video frame, in pixels.
+  readonly import attribute int Height;
+  /// The length of the video, in milliseconds.
+  readonly import attribute int LengthMs;
+  /// The current playback position, in milliseconds.
+  readonly import attribute int PositionMs;
+  /// Whether this video is currently playing.
+  readonly import attribute bool IsPlaying;
+  /// Gets/sets whether this video is restarted after reaching its end.
+  import attribute bool Looping;
+  /// Gets/sets the playback speed, as a multiplier of the normal speed (1.0 is default).
+  import attribute float Speed;
+  /// Gets/sets the volume of the video's own sound, from 0 to 100.
+  import attribute int Volume;
+};
+#endif // SCRIPT_API_v363
+
 
 #ifdef SCRIPT_API_v362
 // Engine value constant name pattern:
@@ -2748,6 +2789,10 @@ builtin managed struct Object {
   /// Gets the Y coordinate of the object's final moving destination; or current position if object is not moving.
   readonly import attribute int DestinationY;
 #endif
+#ifdef SCRIPT_API_v363
+  /// Checks whether the visible pixels of this object's image overlap those of another object.
+  import bool IsPixelCollidingWithObject(Object*);
+#endif // SCRIPT_API_v363
 
   int reserved[2];  // $AUTOCOMPLETEIGNORE$
 };
@@ -3021,6 +3066,12 @@ builtin managed struct Character {
   /// Gets the character this character is following
   readonly import attribute Character* Following;
 #endif // SCRIPT_API_v362
+#ifdef SCRIPT_API_v363
+  /// Checks whether the visible pixels of this character's image overlap those of another character.
+  import bool IsPixelCollidingWithChar(Character*);
+  /// Checks whether the visible pixels of this character's image overlap those of the object.
+  import bool IsPixelCollidingWithObject(Object*);
+#endif // SCRIPT_API_v363
 #ifdef STRICT
   /// The character's current X-position.
   import attribute int  x;
@@ -4177,7 +4177,8 @@ void convert_room_interactions_to_native(Room ^room, RoomStruct &rs)
 // Fixups and saves the native room struct into the file
 void save_room_file(RoomStruct &rs, const AGSString &path)
 {
-    rs.DataVersion = kRoomVersion_Current;
+    // save in the oldest format that fits, so that the older engines could load the room
+    rs.DataVersion = AGS::Common::GetMinRoomFileVersion(&rs);
     calculate_walkable_areas(rs);
 
     rs.BackgroundBPP = rs.BgFrames[0].Graphic->GetBPP();
@@ -4188,7 +4189,7 @@ void save_room_file(RoomStruct &rs, const AGSString &path)
     if (out == NULL)
         quit("save_room: unable to open room file for writing.");
 
-    AGS::Common::HRoomFileError err = AGS::Common::WriteRoomData(&rs, out.get(), kRoomVersion_Current);
+    AGS::Common::HRoomFileError err = AGS::Common::WriteRoomData(&rs, out.get(), rs.DataVersion);
     if (!err)
         quit(AGSString::FromFormat("save_room: unable to write room data, error was:\r\n%s", err->FullMessage()));
 }
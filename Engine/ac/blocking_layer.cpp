@@ -0,0 +1,123 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "ac/blocking_layer.h"
+#include <algorithm>
+#include <assert.h>
+#include <string.h>
+#include "gfx/bitmap.h"
+
+using namespace AGS::Common;
+
+namespace AGS
+{
+namespace Engine
+{
+
+static bool RectLess(const Rect &a, const Rect &b)
+{
+    if (a.Top != b.Top) return a.Top < b.Top;
+    if (a.Left != b.Left) return a.Left < b.Left;
+    if (a.Bottom != b.Bottom) return a.Bottom < b.Bottom;
+    return a.Right < b.Right;
+}
+
+void BlockingLayer::Update(const Bitmap *base, Bitmap *result, const std::vector<Rect> &blockers)
+{
+    const Size size = base->GetSize();
+    assert((result->GetSize() == size) && (result->GetColorDepth() == base->GetColorDepth()));
+
+    // Clip the new blockers to the mask, and sort them for comparison
+    const Rect bounds = RectWH(size);
+    _pending.clear();
+    for (const auto &r : blockers)
+    {
+        if (r.IsEmpty() || !AreRectsIntersecting(bounds, r))
+            continue;
+        _pending.push_back(ClampToRect(bounds, r));
+    }
+    std::sort(_pending.begin(), _pending.end(), RectLess);
+
+    const bool full_redraw = _invalid || (base != _base) || (result != _result) || (size != _size);
+    if (full_redraw)
+    {
+        _dirty.assign(size.Height, 1);
+        _rowStamps.assign(size.Height, 0u);
+    }
+    else
+    {
+        // Mark rows under the rects which are found only in one of the sets;
+        // rects found in both sets are already cut out of these rows
+        std::fill(_dirty.begin(), _dirty.end(), 0);
+        size_t i = 0, j = 0;
+        while ((i < _applied.size()) || (j < _pending.size()))
+        {
+            if ((j == _pending.size()) || ((i < _applied.size()) && RectLess(_applied[i], _pending[j])))
+                MarkRows(_applied[i++]);
+            else if ((i == _applied.size()) || RectLess(_pending[j], _applied[i]))
+                MarkRows(_pending[j++]);
+            else
+                i++, j++;
+        }
+    }
+
+    _applied.swap(_pending);
+    _base = base;
+    _result = result;
+    _size = size;
+    _invalid = false;
+    RedrawRows(base, result);
+}
+
+MaskRowStamps BlockingLayer::GetRowStamps() const
+{
+    MaskRowStamps stamps;
+    stamps.Version = _version;
+    stamps.Rows = _rowStamps.empty() ? nullptr : _rowStamps.data();
+    return stamps;
+}
+
+void BlockingLayer::MarkRows(const Rect &r)
+{
+    std::fill(_dirty.begin() + r.Top, _dirty.begin() + r.Bottom + 1, 1);
+}
+
+void BlockingLayer::RedrawRows(const Bitmap *base, Bitmap *result)
+{
+    _lastUpdatedRows = static_cast<int>(std::count(_dirty.begin(), _dirty.end(), 1));
+    if (_lastUpdatedRows == 0)
+        return;
+
+    _version++;
+    const size_t line_len = result->GetLineLength();
+    for (int y = 0; y < _size.Height; ++y)
+    {
+        if (!_dirty[y])
+            continue;
+        memcpy(result->GetScanLineForWriting(y), base->GetScanLine(y), line_len);
+        _rowStamps[y] = _version;
+    }
+
+    const int bpp = result->GetBPP();
+    for (const auto &r : _applied)
+    {
+        for (int y = r.Top; y <= r.Bottom; ++y)
+        {
+            if (_dirty[y])
+                memset(result->GetScanLineForWriting(y) + r.Left * bpp, 0, r.GetWidth() * bpp);
+        }
+    }
+}
+
+} // namespace Engine
+} // namespace AGS
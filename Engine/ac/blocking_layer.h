@@ -0,0 +1,81 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// BlockingLayer composes the walkable mask used for pathfinding: a copy of
+// the room's walkable areas with the blocking rectangles of characters and
+// objects cut out of it.
+//
+// The layer remembers which rectangles were applied last time, and when
+// given a new set, redraws only those rows which are touched by the
+// rectangles that were added or removed. Each redrawn row is stamped with
+// the new mask version, which lets pathfinders update their own data
+// only for the rows changed since they have synced last time.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__BLOCKINGLAYER_H
+#define __AGS_EE_AC__BLOCKINGLAYER_H
+
+#include <vector>
+#include "ac/route_finder.h"
+#include "util/geometry.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+class BlockingLayer
+{
+public:
+    BlockingLayer() = default;
+
+    // Tells that the base mask contents have changed, and the whole result
+    // must be redone on the next update
+    void Invalidate() { _invalid = true; }
+    // Composes the result mask from the base mask and the blocking rects
+    // (in mask coordinates); result must have same size and color depth
+    // as the base. Redraws the whole mask if either bitmap has changed
+    // since the last update, or if the layer was invalidated.
+    void Update(const Common::Bitmap *base, Common::Bitmap *result, const std::vector<Rect> &blockers);
+    // Gets the current mask version and per-row modification stamps
+    MaskRowStamps GetRowStamps() const;
+    // Gets the number of rows which were redrawn by the last update
+    int GetLastUpdatedRows() const { return _lastUpdatedRows; }
+
+private:
+    // Redraws the marked rows: copies them from the base and cuts the blockers
+    void RedrawRows(const Common::Bitmap *base, Common::Bitmap *result);
+    // Marks rows covered by the rect as dirty
+    void MarkRows(const Rect &r);
+
+    const Common::Bitmap *_base = nullptr;
+    const Common::Bitmap *_result = nullptr;
+    Size _size;
+    bool _invalid = true;
+    // Blocking rects applied to the result, sorted
+    std::vector<Rect> _applied;
+    // Temporary sorted copy of the new blocking rects
+    std::vector<Rect> _pending;
+    // Per-row dirty flags
+    std::vector<uint8_t> _dirty;
+    // Per-row stamps of the last modification
+    std::vector<uint32_t> _rowStamps;
+    uint32_t _version = 0u;
+    int _lastUpdatedRows = 0;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_AC__BLOCKINGLAYER_H
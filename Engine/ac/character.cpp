@@ -31,6 +31,7 @@
 #include "ac/global_room.h"
 #include "ac/global_translation.h"
 #include "ac/gui.h"
+#include "ac/hit_test_grid.h"
 #include "ac/lipsync.h"
 #include "ac/mouse.h"
 #include "ac/movelist.h"
@@ -558,6 +559,18 @@ int Character_IsCollidingWithChar(CharacterInfo *char1, CharacterInfo *char2) {
     return 0;
 }
 
+bool Character_IsPixelCollidingWithChar(CharacterInfo *char1, CharacterInfo *char2) {
+    if (char2 == nullptr)
+        quit("!Character.IsPixelCollidingWithChar: invalid char2");
+    return AreThingsPixelOverlapping(char1->index_id, char2->index_id);
+}
+
+bool Character_IsPixelCollidingWithObject(CharacterInfo *chin, ScriptObject *objid) {
+    if (objid == nullptr)
+        quit("!Character.IsPixelCollidingWithObject: invalid object number");
+    return AreThingsPixelOverlapping(chin->index_id, objid->id + OVERLAPPING_OBJECT);
+}
+
 int Character_IsCollidingWithObject(CharacterInfo *chin, ScriptObject *objid) {
     if (objid == nullptr)
         quit("!AreCharObjColliding: invalid object number");
@@ -1776,9 +1789,10 @@ int Character_GetSpeakingFrame(CharacterInfo *chaa) {
 const int turnlooporder[8] = {0, 6, 1, 7, 3, 5, 2, 4};
 
 // Core character move implementation:
-// uses a provided path or searches for a path to a given destination;
+// uses a provided path or route, or searches for a path to a given destination;
 // starts a move or walk (with automatic animation).
-void move_character_impl(CharacterInfo *chin, const std::vector<Point> *path, int tox, int toy, bool ignwal, bool walk_anim)
+void move_character_impl(CharacterInfo *chin, const std::vector<Point> *path, int tox, int toy, bool ignwal, bool walk_anim,
+    const MoveList *route = nullptr)
 {
     const int chac = chin->index_id;
     if (!ValidateCharForMove(chin, "MoveCharacter"))
@@ -1850,10 +1864,19 @@ void move_character_impl(CharacterInfo *chin, const std::vector<Point> *path, in
     {
         path_result = Pathfinding::CalculateMoveList(mls[mslot], *path, move_speed_x, move_speed_y, ignwal ? kMoveStage_Direct : 0);
     }
+    else if (route)
+    {
+        // route was found by the batched search
+        path_result = !route->IsEmpty();
+        if (path_result)
+            mls[mslot] = *route;
+    }
     else
     {
         MaskRouteFinder *pathfind = get_room_pathfinder();
-        pathfind->SetWalkableArea(prepare_walkable_areas(chac), thisroom.MaskResolution);
+        Bitmap *walk_mask = prepare_walkable_areas(chac);
+        const MaskRowStamps walk_stamps = get_walkable_areas_stamps();
+        pathfind->SetWalkableArea(walk_mask, thisroom.MaskResolution, &walk_stamps);
         path_result = Pathfinding::FindRoute(mls[mslot], pathfind, src_x, src_y, dst_x, dst_y, move_speed_x, move_speed_y, false, ignwal);
     }
 
@@ -2123,7 +2146,7 @@ bool FindNearestWalkableAreaForCharacter(const Point &src, Point &dst, bool forc
         limits.Top = std::max(limits.Top, 14);
     }
 
-    if (!Pathfinding::FindNearestWalkablePoint(thisroom.WalkAreaMask.get(), at_pt, dst, limits, 0, 1))
+    if (!find_nearest_walkable_point(at_pt, dst, limits))
         return false;
     dst = Point(mask_to_room_coord(dst.X), mask_to_room_coord(dst.Y));
     return true;
@@ -2164,7 +2187,9 @@ void move_character_straight(CharacterInfo *chaa, int x, int y, bool walk_anim)
     const int dst_y = data_to_game_coord(y);
 
     MaskRouteFinder *pathfind = get_room_pathfinder();
-    pathfind->SetWalkableArea(prepare_walkable_areas(chaa->index_id), thisroom.MaskResolution);
+    Bitmap *walk_mask = prepare_walkable_areas(chaa->index_id);
+    const MaskRowStamps walk_stamps = get_walkable_areas_stamps();
+    pathfind->SetWalkableArea(walk_mask, thisroom.MaskResolution, &walk_stamps);
     if (!pathfind->IsWalkableAt(chaa->x, chaa->y))
     {
         StopMoving(chaa->index_id);
@@ -2195,6 +2220,54 @@ void walk_character_straight(CharacterInfo *chaa, int x, int y)
     move_character_straight(chaa, x, y, true /* animate */);
 }
 
+// Character walks which were queued to be started together
+struct QueuedWalk
+{
+    int CharId;
+    int X, Y;
+};
+static std::vector<QueuedWalk> queued_walks;
+
+void queue_walk_character(CharacterInfo *chaa, int tox, int toy)
+{
+    queued_walks.push_back({ chaa->index_id, tox, toy });
+}
+
+void walk_queued_characters()
+{
+    if (queued_walks.empty())
+        return;
+
+    // Find all routes over the common mask, where each walker
+    // is not blocked by the same areas that it would be alone
+    MaskRouteFinder *pathfind = get_room_pathfinder();
+    RouteBatch batch;
+    Bitmap *walk_mask = prepare_walkable_areas_batch(batch);
+    const MaskRowStamps walk_stamps = get_walkable_areas_stamps();
+    pathfind->SetWalkableArea(walk_mask, thisroom.MaskResolution, &walk_stamps);
+    for (const auto &walk : queued_walks)
+    {
+        const CharacterInfo *chi = &game.chars[walk.CharId];
+        RouteRequest req;
+        // NOTE: for old games we assume the input coordinates are in the "data" coordinate system
+        req.Src = Point(data_to_game_coord(chi->x), data_to_game_coord(chi->y));
+        req.Dst = Point(data_to_game_coord(walk.X), data_to_game_coord(walk.Y));
+        chi->get_effective_walkspeeds(req.MoveSpeedX, req.MoveSpeedY);
+        get_walkable_areas_exclusions(walk.CharId, req.Excluded);
+        batch.Requests.push_back(std::move(req));
+    }
+    std::vector<MoveList> routes;
+    pathfind->FindRoutes(batch, routes);
+
+    for (size_t i = 0; i < queued_walks.size(); ++i)
+    {
+        const QueuedWalk &walk = queued_walks[i];
+        move_character_impl(&game.chars[walk.CharId], nullptr, walk.X, walk.Y, false /* walk areas */,
+            true /* animate */, &routes[i]);
+    }
+    queued_walks.clear();
+}
+
 int wantMoveNow (CharacterInfo *chi, CharacterExtras *chex) {
     // check most likely case first
     if ((chex->zoom == 100) || ((chi->flags & CHF_SCALEMOVESPEED) == 0))
@@ -2391,39 +2464,102 @@ void update_character_scale(int charid)
     chex.zoom_offs = zoom_offs;
 }
 
+// Hit test parameters of a character
+struct CharacterHitBox
+{
+    int X = 0, Y = 0; // top-left
+    int Width = 0, Height = 0; // in data coordinates
+    int Mirrored = 0;
+};
+
+// Spatial index of the room characters' bounding boxes
+static HitTestGrid char_hit_grid;
+// Room which the index was filled for
+static int char_hit_grid_room = -1;
+static std::vector<int> char_hit_candidates;
+
+// Tells whether the character may be clicked, and gets its bounding box
+static bool get_character_hit_box(int cc, CharacterHitBox &hit)
+{
+    CharacterInfo *chin = &game.chars[cc];
+    if (chin->room != displayed_room) return false;
+    if (chin->on == 0) return false;
+    if (chin->flags & CHF_NOINTERACT) return false;
+    if ((chin->view < 0) ||
+        (chin->loop >= views[chin->view].numLoops) ||
+        (chin->frame >= views[chin->view].loops[chin->loop].numFrames))
+    {
+        return false;
+    }
+
+    int sppic = views[chin->view].loops[chin->loop].frames[chin->frame].pic;
+    int usewid = charextra[cc].width;
+    int usehit = charextra[cc].height;
+    if (usewid==0) usewid=game.SpriteInfos[sppic].Width;
+    if (usehit==0) usehit= game.SpriteInfos[sppic].Height;
+    hit.X = chin->x - game_to_data_coord(usewid) / 2;
+    hit.Y = charextra[cc].GetEffectiveY(chin) - game_to_data_coord(usehit);
+    hit.Width = game_to_data_coord(usewid);
+    hit.Height = game_to_data_coord(usehit);
+    hit.Mirrored = views[chin->view].loops[chin->loop].frames[chin->frame].flags & VFLG_FLIPSPRITE;
+    return true;
+}
+
+// Clears the index if it was filled for another room;
+// returns true if it has to be filled again
+static bool reset_character_hit_index_on_room_change()
+{
+    const Size room_size(thisroom.Width, thisroom.Height);
+    if ((char_hit_grid_room == displayed_room) && (char_hit_grid.GetArea() == room_size))
+        return false;
+    char_hit_grid.Reset(room_size);
+    char_hit_grid_room = displayed_room;
+    return true;
+}
+
+void update_character_hit_index(int charid)
+{
+    reset_character_hit_index_on_room_change();
+    // only the characters which moved to other grid cells
+    // have to update the cells' lists
+    CharacterHitBox hit;
+    if (!get_character_hit_box(charid, hit))
+        char_hit_grid.Remove(charid);
+    // zero size means that the sprite's size will be used in is_pos_in_sprite
+    else if ((hit.Width == 0) || (hit.Height == 0))
+        char_hit_grid.Update(charid, Rect());
+    else
+        char_hit_grid.Update(charid, Rect(hit.X, hit.Y, hit.X + hit.Width, hit.Y + hit.Height));
+}
+
 int is_pos_on_character(int xx,int yy) {
-    int cc,sppic,lowestyp=0,lowestwas=-1;
-    for (cc=0;cc<game.numcharacters;cc++) {
-        if (game.chars[cc].room!=displayed_room) continue;
-        if (game.chars[cc].on==0) continue;
-        if (game.chars[cc].flags & CHF_NOINTERACT) continue;
-        if (game.chars[cc].view < 0) continue;
-        CharacterInfo*chin=&game.chars[cc];
+    // The index is updated once per frame, along with the characters'
+    // scaling; only fill it here if the room has been changed since
+    if (reset_character_hit_index_on_room_change())
+    {
+        for (int cc = 0; cc < game.numcharacters; ++cc)
+            update_character_hit_index(cc);
+    }
 
-        if ((chin->view < 0) || 
-            (chin->loop >= views[chin->view].numLoops) ||
-            (chin->frame >= views[chin->view].loops[chin->loop].numFrames))
-        {
+    // Only test the characters whose boxes contain the point,
+    // in the order of their ids, same as with the full iteration
+    int lowestyp=0,lowestwas=-1;
+    char_hit_grid.Query(xx, yy, char_hit_candidates);
+    for (int cc : char_hit_candidates) {
+        CharacterInfo*chin=&game.chars[cc];
+        // script could have disabled the character since the last update
+        CharacterHitBox hit;
+        if (!get_character_hit_box(cc, hit))
             continue;
-        }
-
-        sppic=views[chin->view].loops[chin->loop].frames[chin->frame].pic;
-        int usewid = charextra[cc].width;
-        int usehit = charextra[cc].height;
-        if (usewid==0) usewid=game.SpriteInfos[sppic].Width;
-        if (usehit==0) usehit= game.SpriteInfos[sppic].Height;
-        int xxx = chin->x - game_to_data_coord(usewid) / 2;
-        int yyy = charextra[cc].GetEffectiveY(chin) - game_to_data_coord(usehit);
-        int mirrored = views[chin->view].loops[chin->loop].frames[chin->frame].flags & VFLG_FLIPSPRITE;
 
         bool is_original;
         Bitmap *theImage = GetCharacterImage(cc, &is_original);
         if (!is_original)
-            mirrored = 0; // transformed image is already flipped
+            hit.Mirrored = 0; // transformed image is already flipped
 
-        if (is_pos_in_sprite(xx,yy,xxx,yyy, theImage,
-            game_to_data_coord(usewid),
-            game_to_data_coord(usehit), mirrored, is_original) == FALSE)
+        const int sppic = views[chin->view].loops[chin->loop].frames[chin->frame].pic;
+        if (is_pos_in_sprite(xx,yy,hit.X,hit.Y, theImage,
+            hit.Width, hit.Height, hit.Mirrored, is_original, sppic) == FALSE)
             continue;
 
         int use_base = chin->get_baseline();
@@ -3301,6 +3437,16 @@ RuntimeScriptValue Sc_Character_IsCollidingWithObject(void *self, const RuntimeS
     API_OBJCALL_INT_POBJ(CharacterInfo, Character_IsCollidingWithObject, ScriptObject);
 }
 
+RuntimeScriptValue Sc_Character_IsPixelCollidingWithChar(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_BOOL_POBJ(CharacterInfo, Character_IsPixelCollidingWithChar, CharacterInfo);
+}
+
+RuntimeScriptValue Sc_Character_IsPixelCollidingWithObject(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_BOOL_POBJ(CharacterInfo, Character_IsPixelCollidingWithObject, ScriptObject);
+}
+
 RuntimeScriptValue Sc_Character_IsInteractionAvailable(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
     API_OBJCALL_BOOL_PINT(CharacterInfo, Character_IsInteractionAvailable);
@@ -4110,6 +4256,8 @@ void RegisterCharacterAPI(ScriptAPIVersion base_api, ScriptAPIVersion /*compat_a
         { "Character::HasInventory^1",            API_FN_PAIR(Character_HasInventory) },
         { "Character::IsCollidingWithChar^1",     API_FN_PAIR(Character_IsCollidingWithChar) },
         { "Character::IsCollidingWithObject^1",   API_FN_PAIR(Character_IsCollidingWithObject) },
+        { "Character::IsPixelCollidingWithChar^1", API_FN_PAIR(Character_IsPixelCollidingWithChar) },
+        { "Character::IsPixelCollidingWithObject^1", API_FN_PAIR(Character_IsPixelCollidingWithObject) },
         { "Character::IsInteractionAvailable^1",  API_FN_PAIR(Character_IsInteractionAvailable) },
         { "Character::LockView^1",                API_FN_PAIR(Character_LockView) },
         { "Character::LockView^2",                API_FN_PAIR(Character_LockViewEx) },
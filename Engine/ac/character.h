@@ -46,6 +46,8 @@ void    Character_FaceObject(CharacterInfo *char1, ScriptObject *obj, int blocki
 void    Character_FollowCharacter(CharacterInfo *chaa, CharacterInfo *tofollow, int distaway, int eagerness);
 int     Character_IsCollidingWithChar(CharacterInfo *char1, CharacterInfo *char2);
 int     Character_IsCollidingWithObject(CharacterInfo *chin, ScriptObject *objid);
+bool    Character_IsPixelCollidingWithChar(CharacterInfo *char1, CharacterInfo *char2);
+bool    Character_IsPixelCollidingWithObject(CharacterInfo *chin, ScriptObject *objid);
 bool    Character_IsInteractionAvailable(CharacterInfo *cchar, int mood);
 void    Character_LockView(CharacterInfo *chap, int vii);
 void    Character_LockViewEx(CharacterInfo *chap, int vii, int stopMoving);
@@ -193,6 +195,10 @@ void move_character_straight(CharacterInfo *chaa, int x, int y, bool walk_anim);
 void walk_character(CharacterInfo *chaa, int tox, int toy, bool ignwal);
 // Start character walk the straight line until any non-passable area is met
 void walk_character_straight(CharacterInfo *chaa, int tox, int toy);
+// Queue character walk over walkable areas, to be started by walk_queued_characters
+void queue_walk_character(CharacterInfo *chaa, int tox, int toy);
+// Start all the queued walks, searching for their routes together
+void walk_queued_characters();
 int  wantMoveNow (CharacterInfo *chi, CharacterExtras *chex);
 void setup_player_character(int charid);
 Common::Bitmap *GetCharacterImage(int charid, bool *is_original = nullptr);
@@ -200,6 +206,9 @@ CharacterInfo *GetCharacterAtScreen(int xx, int yy);
 // Deduces room object's scale, accounting for both manual scaling and the room region effects;
 // calculates resulting sprite size.
 void update_character_scale(int charid);
+// Updates the character's entry in the hit test index, using its current
+// position and scaled size; should be called after update_character_scale
+void update_character_hit_index(int charid);
 // Get character ID at the given room coordinates
 int is_pos_on_character(int xx,int yy);
 void get_char_blocking_rect(int charid, int *x1, int *y1, int *width, int *y2);
@@ -0,0 +1,202 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "ac/character_update.h"
+#include "ac/characterextras.h"
+#include "ac/characterinfo.h"
+#include "ac/view.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+const int CharacterUpdateState::BlockSize;
+
+void CharacterUpdateState::Reset()
+{
+    *this = CharacterUpdateState();
+}
+
+void CharacterUpdateState::SyncFrom(const CharacterInfo *chars, const CharacterExtras *chex, int first, int count)
+{
+    if (static_cast<size_t>(count) != _flags.size())
+    {
+        _flags.resize(count);
+        _room.resize(count);
+        _walking.resize(count);
+        _view.resize(count);
+        _loop.resize(count);
+        _frame.resize(count);
+        _wait.resize(count);
+        _walkWait.resize(count);
+        _animWait.resize(count);
+        _idleTime.resize(count);
+        _idleLeft.resize(count);
+        _changed.resize(count);
+    }
+    if (_validView.size() < static_cast<size_t>(first + count))
+    {
+        // views are never valid below zero, so new characters get validated
+        _validView.resize(first + count, -1);
+        _validLoop.resize(first + count);
+        _validNumFrames.resize(first + count);
+    }
+
+    _first = first;
+    chars += first;
+    chex += first;
+    for (int i = 0; i < count; ++i)
+    {
+        const CharacterInfo &chi = chars[i];
+        const CharacterExtras &ex = chex[i];
+        _flags[i] =
+            kUpdate_On * (chi.on == 1) |
+            kUpdate_Following * (ex.following >= 0) |
+            kUpdate_Animating * (chi.is_animating() || chi.is_idling()) |
+            kUpdate_MoveNoAnim * chi.is_moving_no_anim() |
+            kUpdate_FixedView * ((chi.flags & CHF_FIXVIEW) != 0) |
+            kUpdate_HasIdle * (chi.idleview >= 1) |
+            kUpdate_IdleNow * (ex.process_idle_this_time == 1) |
+            kUpdate_IdlePending * (ex.process_idle_this_time != 0);
+        _room[i] = chi.room;
+        _walking[i] = chi.walking;
+        _view[i] = chi.view;
+        _loop[i] = chi.loop;
+        _frame[i] = chi.frame;
+        _wait[i] = chi.wait;
+        _walkWait[i] = chi.walkwait;
+        _animWait[i] = ex.animwait;
+        _idleTime[i] = chi.idletime;
+        _idleLeft[i] = chi.idleleft;
+    }
+}
+
+// NOTE: this must match the logic of UpdateCharacterMoveAndAnim, for the
+// characters which only count down their delays
+void CharacterUpdateState::Update(int displayed_room, bool idle_tick, const std::vector<ViewStruct> &views)
+{
+    _fullUpdate.clear();
+    // Work with the plain arrays, which lets compiler keep them in registers
+    const int count = static_cast<int>(_flags.size());
+    const uint8_t *flags = _flags.data();
+    const int *room = _room.data();
+    const int16_t *walking = _walking.data();
+    const int *view = _view.data();
+    const uint16_t *loop = _loop.data();
+    const uint16_t *frame = _frame.data();
+    const int first = _first;
+    const int *valid_view = _validView.data() + first;
+    const uint16_t *valid_loop = _validLoop.data() + first;
+    const uint16_t *valid_num_frames = _validNumFrames.data() + first;
+    const int16_t *idle_time = _idleTime.data();
+    int *wait = _wait.data();
+    int *walk_wait = _walkWait.data();
+    int16_t *anim_wait = _animWait.data();
+    int16_t *idle_left = _idleLeft.data();
+    uint8_t *changed = _changed.data();
+    for (int i = 0; i < count; ++i)
+    {
+        const uint8_t fl = flags[i];
+        changed[i] = 0;
+        if ((fl & kUpdate_On) == 0)
+            continue;
+
+        // Turning around and following are updated regardless of the room,
+        // and so is fixing the loop and frame, in case script changed them
+        const bool was_valid = (view[i] == valid_view[i]) && (loop[i] == valid_loop[i]) &&
+            (frame[i] < valid_num_frames[i]);
+        if ((walking[i] >= TURNING_AROUND) || (fl & kUpdate_Following) ||
+            (!was_valid && !ValidateLoopAndFrame(i, views)))
+        {
+            _fullUpdate.push_back(first + i);
+            continue;
+        }
+
+        if (room[i] != displayed_room)
+        {
+            // Outside of the room only the pending idle update is cancelled
+            changed[i] = (fl & kUpdate_IdlePending) ? kChanged_IdleUpdate : 0;
+            continue;
+        }
+
+        const bool is_moving = walking[i] > 0;
+        const bool is_idling = idle_left[i] < 0;
+        const bool anim_update = (fl & kUpdate_Animating) &&
+            (!is_moving || (fl & kUpdate_MoveNoAnim));
+        // Idle animation doesn't count as doing something
+        const bool doing_nothing = anim_update ? is_idling : !is_moving;
+        const bool count_idle = (fl & kUpdate_HasIdle) && !is_idling;
+        const bool reset_idle = count_idle &&
+            (!doing_nothing || (fl & kUpdate_FixedView));
+        const bool tick_idle = count_idle && !reset_idle &&
+            (idle_tick || (fl & kUpdate_IdleNow));
+
+        // Making a move step or the next walking frame, the next animation
+        // frame, or starting the idle animation requires the full update
+        if ((is_moving && ((walk_wait[i] <= 0) || (anim_wait[i] <= 0))) ||
+            (anim_update && (wait[i] <= 0)) ||
+            (tick_idle && (idle_left[i] == 0)))
+        {
+            _fullUpdate.push_back(first + i);
+            continue;
+        }
+
+        walk_wait[i] -= is_moving;
+        anim_wait[i] -= is_moving;
+        wait[i] -= anim_update;
+        idle_left[i] = reset_idle ? idle_time[i] : idle_left[i] - tick_idle;
+        changed[i] = kChanged_Timers;
+    }
+}
+
+void CharacterUpdateState::SyncTo(CharacterInfo *chars, CharacterExtras *chex) const
+{
+    chars += _first;
+    chex += _first;
+    const int count = static_cast<int>(_changed.size());
+    for (int i = 0; i < count; ++i)
+    {
+        const uint8_t changed = _changed[i];
+        if (changed == 0)
+            continue;
+        // same as the full update, reset the idle update flag of any enabled character
+        chex[i].process_idle_this_time = 0;
+        if (changed == kChanged_Timers)
+        {
+            chars[i].wait = _wait[i];
+            chars[i].walkwait = _walkWait[i];
+            chex[i].animwait = _animWait[i];
+            chars[i].idleleft = _idleLeft[i];
+        }
+    }
+}
+
+bool CharacterUpdateState::ValidateLoopAndFrame(int index, const std::vector<ViewStruct> &views)
+{
+    const int view = _view[index];
+    if ((view < 0) || (static_cast<size_t>(view) >= views.size()) ||
+        (_loop[index] >= views[view].numLoops))
+        return false;
+    const int num_frames = views[view].loops[_loop[index]].numFrames;
+    if ((num_frames == 0) || (_frame[index] >= num_frames))
+        return false;
+
+    _validView[_first + index] = view;
+    _validLoop[_first + index] = _loop[index];
+    _validNumFrames[_first + index] = static_cast<uint16_t>(num_frames);
+    return true;
+}
+
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,121 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// CharacterUpdateState keeps the per-frame movement and animation state of
+// the characters in compact separate arrays (structure of arrays). Most of
+// the characters on a frame only count down their walk, animation or idle
+// delays, or are outside of the displayed room and have nothing to update;
+// these are handled over the arrays in a single pass, and only the rest
+// are passed to the full character update.
+//
+// CharacterInfo and CharacterExtras remain the authoritative state, because
+// they are exposed to script and plugin API by memory, and may be changed
+// by them at any time between the updates. SyncFrom() and SyncTo() are the
+// explicit sync points: the state is gathered at the start of the update
+// pass, and the changed delays are written back before any character gets
+// the full update.
+//
+// The characters are processed in blocks of BlockSize, so that the gathered
+// characters are still in cache when the block's full updates are run.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__CHARACTERUPDATE_H
+#define __AGS_EE_AC__CHARACTERUPDATE_H
+
+#include <vector>
+#include "core/types.h"
+
+struct CharacterInfo;
+struct CharacterExtras;
+struct ViewStruct;
+
+namespace AGS
+{
+namespace Engine
+{
+
+class CharacterUpdateState
+{
+public:
+    // Recommended number of characters to gather at once
+    static const int BlockSize = 256;
+
+    // Forgets all the characters, e.g. when the game data is unloaded
+    void Reset();
+    // Sync point: gathers the movement and animation state of the block of
+    // characters, starting with the first; chars and chex are full arrays
+    void SyncFrom(const CharacterInfo *chars, const CharacterExtras *chex, int first, int count);
+    // Advances the delays of the gathered characters which do nothing else this
+    // frame, and makes the list of characters which require the full update;
+    // idle_tick tells if the idle timers are counted down on this frame
+    void Update(int displayed_room, bool idle_tick, const std::vector<ViewStruct> &views);
+    // Sync point: writes the state changed by Update() back to the characters
+    void SyncTo(CharacterInfo *chars, CharacterExtras *chex) const;
+    // Gets the ids of the characters which require the full update, in ascending order
+    const std::vector<int> &GetFullUpdate() const { return _fullUpdate; }
+
+private:
+    // Character's flags, gathered from several CharacterInfo and CharacterExtras fields
+    enum UpdateFlags
+    {
+        kUpdate_On          = 0x01, // is enabled
+        kUpdate_Following   = 0x02, // follows another character
+        kUpdate_Animating   = 0x04, // plays a view animation or an idle animation
+        kUpdate_MoveNoAnim  = 0x08, // moves without a walking animation
+        kUpdate_FixedView   = 0x10, // has view locked
+        kUpdate_HasIdle     = 0x20, // has an idle view
+        kUpdate_IdleNow     = 0x40, // has to count idle time on this frame
+        kUpdate_IdlePending = 0x80  // has any pending idle update
+    };
+    // What has to be written back after Update
+    enum ChangedFields
+    {
+        kChanged_IdleUpdate = 0x01, // idle update flag is reset
+        kChanged_Timers     = 0x02  // delays are counted down, and idle update reset
+    };
+
+    // Tests if the character's loop and frame are in the valid range, which
+    // means that the full update would not have to fix them, and remembers
+    // the view and loop, so that only the frame is tested on the next frames
+    bool ValidateLoopAndFrame(int index, const std::vector<ViewStruct> &views);
+
+    // Index of the first gathered character
+    int _first = 0;
+    // Hot state of the block, gathered from CharacterInfo and CharacterExtras
+    std::vector<uint8_t>  _flags; // UpdateFlags
+    std::vector<int>      _room;
+    std::vector<int16_t>  _walking;
+    std::vector<int>      _view;
+    std::vector<uint16_t> _loop;
+    std::vector<uint16_t> _frame;
+    std::vector<int>      _wait;
+    std::vector<int>      _walkWait;
+    std::vector<int16_t>  _animWait;
+    std::vector<int16_t>  _idleTime;
+    std::vector<int16_t>  _idleLeft;
+    // What was changed by Update (ChangedFields), zero if nothing
+    std::vector<uint8_t>  _changed;
+    // Last view and loop which were found valid, and the number of frames
+    // in that loop, for all characters; kept between frames
+    std::vector<int>      _validView;
+    std::vector<uint16_t> _validLoop;
+    std::vector<uint16_t> _validNumFrames;
+    // Characters which require the full update
+    std::vector<int> _fullUpdate;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_AC__CHARACTERUPDATE_H
@@ -448,8 +448,10 @@ void UpdateCharacterFollower(CharacterInfo *chi, std::vector<int> &followingAsSh
         // make sure he's not standing on top of the other man
         if (goxoffs < 0) goxoffs-=distaway;
         else goxoffs+=distaway;
-        walk_character(chi, game.chars[following].x + goxoffs,
-          game.chars[following].y + (Random(50) - 25), false /* walk areas */);
+        // the walk is started after all characters are updated, and routes
+        // of all followers are searched for together
+        queue_walk_character(chi, game.chars[following].x + goxoffs,
+          game.chars[following].y + (Random(50) - 25));
 
         doing_nothing = 0;
       }
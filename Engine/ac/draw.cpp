@@ -58,6 +58,7 @@
 #include "gfx/gfx_util.h"
 #include "gfx/graphicsdriver.h"
 #include "gfx/ali3dexception.h"
+#include "gfx/bitmap_pool.h"
 #include "gfx/blender.h"
 #include "main/game_run.h"
 #include "media/audio/audio_system.h"
@@ -121,6 +122,14 @@ struct DrawState
 };
 
 DrawState drawstate;
+// Pools of spare bitmaps and render targets, reused by the drawables;
+// NOTE: these must be declared before any drawable object storage,
+// so that they are destroyed after them.
+BitmapPool bitmappool;
+RenderTargetPool rendertargetpool;
+// Allocation stats of the last frame, for displaying in debug overlay
+BitmapPoolStats bitmappool_stats;
+BitmapPoolStats rendertarget_stats;
 RGB palette[256];
 COLOR_MAP maincoltable;
 
@@ -141,7 +150,8 @@ struct ObjTexture
     uint32_t DrawIndex = 0u;
     // Raw bitmap; used for software render mode,
     // or when particular object types require generated image.
-    std::unique_ptr<Bitmap> Bmp;
+    // Normally borrowed from the bitmap pool.
+    PooledBitmap Bmp;
     // Corresponding texture, created by renderer
     IDriverDependantBitmap *Ddb = nullptr;
     // Sprite notification block: becomes invalid to notify an updated
@@ -195,7 +205,7 @@ struct ObjTexture
 // if active sprite / texture should be reconstructed
 struct ObjectCache
 {
-    std::unique_ptr<Bitmap> image;
+    PooledBitmap image;
     bool  in_use = false; // CHECKME: possibly may be removed
     int   sppic = 0;
     // TODO: pickout tint settings, maybe even share with Char/Obj structs,
@@ -700,6 +710,7 @@ void init_draw_method()
 {
     drawstate.SoftwareRender = !gfxDriver->HasAcceleratedTransform();
     drawstate.FullFrameRedraw = gfxDriver->RequiresFullRedrawEachFrame();
+    rendertargetpool.SetDriver(gfxDriver);
 
     // Must init this as early as possible, as this affects bitmap->texture conv
     gfxDriver->UseSmoothScaling(play.ShouldAASprites());
@@ -733,6 +744,8 @@ void dispose_draw_method()
     dispose_room_drawdata();
     dispose_invalid_regions(false);
     destroy_blank_image();
+    bitmappool.ClearSpare();
+    rendertargetpool.ClearSpare();
 }
 
 static void alloc_fixed_drawindexes()
@@ -831,6 +844,9 @@ void clear_drawobj_cache()
     overtxs.clear();
     // Mouse cursor texture
     cursor_tx = ObjTexture();
+    // Spare bitmaps and textures
+    bitmappool.ClearSpare();
+    rendertargetpool.ClearSpare();
 
     // Clear sprite update notification blocks
     drawstate.SpriteNotifyMap.clear();
@@ -851,6 +867,7 @@ void release_drawobj_rendertargets()
             gfxDriver->DestroyDDB(tex);
         tex = nullptr;
     }
+    rendertargetpool.ClearSpare();
 }
 
 void on_mainviewport_changed()
@@ -1352,11 +1369,7 @@ IDriverDependantBitmap* recycle_ddb_sprite(IDriverDependantBitmap *ddb, uint32_t
 
 IDriverDependantBitmap* recycle_render_target(IDriverDependantBitmap *ddb, int width, int height, int col_depth, bool opaque)
 {
-    if (ddb && (ddb->GetWidth() == width) && (ddb->GetHeight() == height))
-        return ddb;
-    if (ddb)
-        gfxDriver->DestroyDDB(ddb);
-    return gfxDriver->CreateRenderTargetDDB(width, height, col_depth, opaque ? kTxFlags_Opaque : kTxFlags_None);
+    return rendertargetpool.Recycle(ddb, width, height, col_depth, opaque);
 }
 
 // FIXME: make has_alpha and opaque properties of ObjTexture?!
@@ -1528,6 +1541,15 @@ void recycle_bitmap(std::unique_ptr<Common::Bitmap> &bimp, int coldep, int wid,
     bimp.reset(recycle_bitmap(bimp.release(), coldep, wid, hit, make_transparent));
 }
 
+// Same as above, but borrows a bitmap from the pool, which lets reuse
+// the same memory for the images of varied sizes
+static void recycle_bitmap(PooledBitmap &bimp, int coldep, int wid, int hit, bool make_transparent = false)
+{
+    bitmappool.Recycle(bimp, wid, hit, coldep);
+    if (make_transparent)
+        bimp->ClearTransparent();
+}
+
 // Get the local tint at the specified X & Y co-ordinates, based on
 // room regions and SetAmbientTint
 // tint_amnt will be set to 0 if there is no tint enabled
@@ -1634,7 +1656,7 @@ static void apply_tint_or_light(ObjTexture &actsp, int light_level,
 
  // we can only do tint/light if the colour depths match
  if (game.GetColorDepth() == actsp.Bmp->GetColorDepth()) {
-     std::unique_ptr<Bitmap> oldwas;
+     PooledBitmap oldwas;
      // if the caller supplied a source bitmap, ->Blit from it
      // (used as a speed optimisation where possible)
      if (blitFrom) 
@@ -1642,7 +1664,7 @@ static void apply_tint_or_light(ObjTexture &actsp, int light_level,
      // otherwise, make a new target bmp
      else {
          oldwas = std::move(actsp.Bmp);
-         actsp.Bmp.reset(BitmapHelper::CreateBitmap(oldwas->GetWidth(), oldwas->GetHeight(), coldept));
+         actsp.Bmp = bitmappool.Acquire(oldwas->GetWidth(), oldwas->GetHeight(), coldept);
      }
      Bitmap *active_spr = actsp.Bmp.get();
 
@@ -1691,7 +1713,7 @@ static void apply_tint_or_light(ObjTexture &actsp, int light_level,
 // * if transformation is necessary - writes into dst and returns dst;
 // * if no transformation is necessary - simply returns src;
 // Used for software render mode only.
-static Bitmap *transform_sprite(std::unique_ptr<Bitmap> &dst, Bitmap *src, bool src_has_alpha,
+static Bitmap *transform_sprite(PooledBitmap &dst, Bitmap *src, bool src_has_alpha,
     const Size &dst_sz, GraphicFlip flip = Common::kFlip_None)
 {
     if ((src->GetSize() == dst_sz) && (flip == kFlip_None))
@@ -2360,7 +2382,9 @@ void draw_fps(const Rect &viewport)
         snprintf(fps_buffer, sizeof(fps_buffer), "FPS: --.- / %s", base_buffer);
     }
     char loop_buffer[128];
-    snprintf(loop_buffer, sizeof(loop_buffer), "Loop %u Time %.2f", loopcounter, time);
+    // Also display number of bitmap and render target allocations in the last frame
+    snprintf(loop_buffer, sizeof(loop_buffer), "Loop %u Time %.2f Alloc B:%u T:%u",
+        loopcounter, time, bitmappool_stats.Allocs, rendertarget_stats.Allocs);
 
     int text_off = get_font_surface_extent(font).first; // TODO: a generic function that accounts for this?
     wouttext_outline(fpsDisplay.get(), 1, 1 - text_off, font, text_color, fps_buffer);
@@ -2758,6 +2782,10 @@ void construct_game_scene(bool full_redraw)
 {
     set_our_eip(3);
 
+    // Record the pools' allocation stats for the previous frame
+    bitmappool_stats = bitmappool.ResetStats();
+    rendertarget_stats = rendertargetpool.ResetStats();
+
     // React to changes to viewports and cameras (possibly from script) just before the render
     play.UpdateViewports();
 
@@ -22,6 +22,7 @@
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
 #include "ac/string.h"
+#include "ac/walkablearea.h"
 #include "ac/walkbehind.h"
 #include "ac/dynobj/dynobj_manager.h"
 #include "debug/debug_log.h"
@@ -64,6 +65,10 @@ void DrawingSurface_Release(ScriptDrawingSurface* sds)
         {
             walkbehinds_recalc();
         }
+        else if (sds->roomMaskType == kRoomAreaWalkable)
+        {
+            invalidate_walkable_areas();
+        }
         sds->roomMaskType = kRoomAreaNone;
     }
     if (sds->dynamicSpriteNumber >= 0)
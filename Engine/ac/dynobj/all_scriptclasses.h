@@ -33,5 +33,6 @@
 #include "ac/dynobj/scriptstring.h"
 #include "ac/dynobj/scriptsystem.h"
 #include "ac/dynobj/scriptviewframe.h"
+#include "ac/dynobj/scriptvideoplayer.h"
 
 #endif // __AGS_EE_DYNOBJ__ALLSCRIPTOBJECTS_H
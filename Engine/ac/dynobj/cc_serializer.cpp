@@ -123,6 +123,10 @@ void AGSDeSerializer::Unserialize(int index, const char *objectType, const char
         ScriptDynamicSprite *scf = new ScriptDynamicSprite();
         scf->Unserialize(index, &mems, data_sz);
     }
+    else if (strcmp(objectType, "VideoPlayer") == 0) {
+        ScriptVideoPlayer *scf = new ScriptVideoPlayer();
+        scf->Unserialize(index, &mems, data_sz);
+    }
     else if (strcmp(objectType, "DrawingSurface") == 0) {
         ScriptDrawingSurface *sds = new ScriptDrawingSurface();
         sds->Unserialize(index, &mems, data_sz);
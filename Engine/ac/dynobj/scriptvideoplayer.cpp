@@ -0,0 +1,71 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "ac/dynobj/scriptvideoplayer.h"
+#include "ac/dynamicsprite.h"
+#include "ac/gamesetupstruct.h"
+#include "ac/dynobj/dynobj_manager.h"
+#include "media/video/video.h"
+#include "util/stream.h"
+
+using namespace AGS::Common;
+
+extern GameSetupStruct game;
+
+int ScriptVideoPlayer::Dispose(void* /*address*/, bool force)
+{
+    // if this is being removed voluntarily (ie. pointer out of scope)
+    // then stop the video and delete its sprite;
+    // otherwise, it's a Restore Game or something so don't
+    if (!force)
+    {
+        if (get_video_control(_videoID))
+        {
+            video_stop(_videoID);
+        }
+        else if ((_spriteID > 0) && (static_cast<size_t>(_spriteID) < game.SpriteInfos.size()) &&
+            (game.SpriteInfos[_spriteID].Flags & SPF_DYNAMICALLOC))
+        {
+            // the video was not restored after loading a save,
+            // but its last frame was, as a dynamic sprite
+            free_dynamic_sprite(_spriteID);
+        }
+    }
+
+    delete this;
+    return 1;
+}
+
+const char *ScriptVideoPlayer::GetType()
+{
+    return "VideoPlayer";
+}
+
+size_t ScriptVideoPlayer::CalcSerializeSize(const void* /*address*/)
+{
+    return sizeof(int32_t) * 2;
+}
+
+void ScriptVideoPlayer::Serialize(const void* /*address*/, Stream *out)
+{
+    out->WriteInt32(_videoID);
+    out->WriteInt32(_spriteID);
+}
+
+void ScriptVideoPlayer::Unserialize(int index, Stream *in, size_t /*data_sz*/)
+{
+    in->ReadInt32(); // video playback is not restored from saves
+    _videoID = -1;
+    _spriteID = in->ReadInt32();
+    ccRegisterUnserializedObject(index, this, this);
+}
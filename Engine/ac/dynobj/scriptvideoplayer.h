@@ -0,0 +1,49 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// ScriptVideoPlayer is a script object that controls a non-blocking video.
+//
+//=============================================================================
+#ifndef __AGS_EE_DYNOBJ__SCRIPTVIDEOPLAYER_H
+#define __AGS_EE_DYNOBJ__SCRIPTVIDEOPLAYER_H
+
+#include "ac/dynobj/cc_agsdynamicobject.h"
+
+struct ScriptVideoPlayer final : AGSCCDynamicObject
+{
+public:
+    ScriptVideoPlayer() = default;
+    ScriptVideoPlayer(int video_id, int sprite_id)
+        : _videoID(video_id), _spriteID(sprite_id) {}
+
+    int Dispose(void *address, bool force) override;
+    const char *GetType() override;
+    void Unserialize(int index, AGS::Common::Stream *in, size_t data_sz) override;
+
+    // Gets the ID of the video, or -1 if the video is not available anymore
+    int GetVideoID() const { return _videoID; }
+    // Gets the sprite that displays the video frames
+    int GetSpriteID() const { return _spriteID; }
+
+private:
+    // Calculate and return required space for serialization, in bytes
+    size_t CalcSerializeSize(const void *address) override;
+    // Write object data into the provided stream
+    void Serialize(const void *address, AGS::Common::Stream *out) override;
+
+    int _videoID = -1;
+    int _spriteID = 0;
+};
+
+#endif // __AGS_EE_DYNOBJ__SCRIPTVIDEOPLAYER_H
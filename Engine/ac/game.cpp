@@ -36,10 +36,12 @@
 #include "ac/keycode.h"
 #include "ac/lipsync.h"
 #include "ac/mouse.h"
+#include "ac/object.h"
 #include "ac/overlay.h"
 #include "ac/path_helper.h"
 #include "ac/sys_events.h"
 #include "ac/room.h"
+#include "ac/roompreload.h"
 #include "ac/roomstatus.h"
 #include "ac/sprite.h"
 #include "ac/spritecache.h"
@@ -67,7 +69,9 @@
 #include "gui/guidialog.h"
 #include "main/engine.h"
 #include "main/game_run.h"
+#include "main/update.h"
 #include "media/audio/audio_system.h"
+#include "media/audio/soundprefetch.h"
 #include "media/video/video.h"
 #include "platform/base/agsplatformdriver.h"
 #include "platform/base/sys_main.h"
@@ -524,6 +528,7 @@ void unload_game()
     charextra.clear();
     mls.clear();
     views.clear();
+    reset_character_update();
     splipsync.clear();
     numLipLines = 0;
     curLipLine = -1;
@@ -548,6 +553,9 @@ void unload_game()
     // IMPORTANT: this is hard reset, including locked items
     spriteset.Reset();
     soundcache_clear();
+    soundprefetch_clear();
+    reset_voice_prefetch();
+    preload_room_clear();
 }
 
 
@@ -1454,7 +1462,7 @@ void display_switch_out_suspend()
 
     // TODO: find out if anything has to be done here for SDL backend
 
-    video_single_pause();
+    video_pause_all();
     // Pause all the sounds
     for (int i = 0; i < TOTAL_AUDIO_CHANNELS; i++) {
         auto* ch = AudioChans::GetChannelIfPlaying(i);
@@ -1490,7 +1498,7 @@ void display_switch_in_resume()
             ch->resume();
         }
     }
-    video_single_resume();
+    video_resume_all();
 
     // release render targets if switching back to the full screen mode;
     // unfortunately, otherwise Direct3D fails to reset device when restoring fullscreen.
@@ -1588,6 +1596,8 @@ void game_sprite_updated(int sprnum, bool deleted)
 {
     // Notify draw system about dynamic sprite change
     notify_sprite_changed(sprnum, deleted);
+    // Sprite's hit mask has to be recreated
+    invalidate_sprite_hitmask(sprnum);
 
     // GUI still have a special draw route, so cannot rely on object caches;
     // will have to do a per-GUI and per-control check.
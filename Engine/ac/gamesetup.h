@@ -19,6 +19,7 @@
 #include "ac/speech.h"
 #include "ac/sys_events.h"
 #include "main/graphics_mode.h"
+#include "media/audio/audiodefines.h"
 #include "util/string.h"
 
 
@@ -86,6 +87,9 @@ struct GameConfig
     static const size_t DefTexCacheSize     = (128 * 1024); // 128 MB
     static const size_t DefSoundLoadAtOnce  = 1024; // 1 MB
     static const size_t DefSoundCache       = 1024u * 32; // 32 MB
+    static const size_t DefSoundPCMCache    = 1024u * 16; // 16 MB
+    static const int    DefSoundPCMMaxLength = 3000; // 3 seconds
+    static const int    DefSoundDecodeAhead = 250; // in ms
 
     // Display configuration
     DisplayModeSetup Display;
@@ -101,6 +105,11 @@ struct GameConfig
     // Audio options
     bool    AudioEnabled         = false;
     String  AudioDriverID;
+    int     AudioDecodeAheadMs   = DefSoundDecodeAhead; // length of sound decoded ahead of playback
+    int     AudioDecodeThreads   = 0; // number of decoding threads, 0 is automatic
+    AudioOutputType AudioOutput  = kAudioOutput_Device; // where to send the mixed sound
+    AudioOutputPace AudioPace    = kAudioPace_Realtime; // pace of rendering, if not on a device
+    String  AudioOutputFile;     // file to write the mixed sound into
     bool    UseVoicePack         = false;
 
     // Control options
@@ -115,6 +124,8 @@ struct GameConfig
     size_t  TextureCacheSize     = DefTexCacheSize; // in KB
     size_t  SoundCacheSize       = DefSoundCache; // sound cache limit, in KB
     size_t  SoundLoadAtOnceSize  = DefSoundLoadAtOnce; // threshold for loading sounds immediately, in KB
+    size_t  SoundPCMCacheSize    = DefSoundPCMCache; // decoded sound cache limit, in KB
+    int     SoundPCMMaxLength    = DefSoundPCMMaxLength; // max length of a decoded cached sound, in ms
 
     // Misc options
     String  Translation;
@@ -131,6 +142,7 @@ struct GameConfig
     bool    ClearCacheOnRoomChange = false; // for low-end devices: clear resource caches on room change
     bool    RunInBackground      = false; // whether run on background, when game is switched out
     bool    ShowFps              = false;
+    bool    PathfinderHierarchical = false; // use hierarchical pathfinding in large rooms
 
     // Accessibility options
     AccessibilityGameConfig Access;
@@ -1258,6 +1258,12 @@ RuntimeScriptValue Sc_PlayVideo(const RuntimeScriptValue *params, int32_t param_
     API_SCALL_VOID_POBJ_PINT2(PlayVideo, const char);
 }
 
+// void (int nrnum)
+RuntimeScriptValue Sc_PreloadRoom(const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_SCALL_VOID_PINT(PreloadRoom);
+}
+
 // void (int dialog)
 RuntimeScriptValue Sc_QuitGame(const RuntimeScriptValue *params, int32_t param_count)
 {
@@ -2561,6 +2567,7 @@ void RegisterGlobalAPI(ScriptAPIVersion base_api, ScriptAPIVersion /*compat_api*
         { "PlaySound",                API_FN_PAIR(play_sound) },
         { "PlaySoundEx",              API_FN_PAIR(PlaySoundEx) },
         { "PlayVideo",                API_FN_PAIR(PlayVideo) },
+        { "PreloadRoom",              API_FN_PAIR(PreloadRoom) },
         { "QuitGame",                 API_FN_PAIR(QuitGame) },
         { "Random",                   Sc_Rand, __Rand },
         { "RawClearScreen",           API_FN_PAIR(RawClear) },
@@ -12,6 +12,7 @@
 //
 //=============================================================================
 #include <stdio.h>
+#include <deque>
 #include "ac/common.h"
 #include "ac/game.h"
 #include "ac/gamesetup.h"
@@ -26,6 +27,7 @@
 #include "main/engine.h"
 #include "media/audio/audio_core.h"
 #include "media/audio/audio_system.h"
+#include "media/audio/soundprefetch.h"
 #include "util/string_compat.h"
 #include "util/time_util.h"
 
@@ -477,26 +479,114 @@ static String get_cue_filename(int charid, int sndid, bool old_style)
     return Path::ConcatPaths(get_voice_assetpath(), asset_filename);
 }
 
-// Play voice-over clip on the common channel;
+// Finds the voice-over clip asset;
 // voice_name should be bare clip name without extension
-static bool play_voice_clip_on_channel(const String &voice_name)
+static bool find_voice_clip_asset(const String &voice_name, AssetPath &apath)
 {
-    stop_and_destroy_channel(SCHAN_SPEECH);
-
     // TODO: perhaps a better algorithm, allow any extension / sound format?
     // e.g. make a hashmap matching a voice name to a asset name
     std::array<const char*, 3> exts = {{ "mp3", "ogg", "wav" }};
-    AssetPath apath = get_voice_over_assetpath(voice_name);
-    bool found = false;
+    apath = get_voice_over_assetpath(voice_name);
     for (auto *ext : exts)
     {
         apath.Name.Format("%s.%s", voice_name.GetCStr(), ext);
-        found = AssetMgr->DoesAssetExist(apath);
-        if (found)
+        if (AssetMgr->DoesAssetExist(apath))
+            return true;
+    }
+    return false;
+}
+
+// Voice-over prefetching: voice cues of each character are numbered in the
+// order of their lines in the game script, so in a conversation the next
+// line of every participant is most likely the one following their last
+// played cue. After each voice line the next cues of the recent speakers
+// are prefetched, so that they start without waiting for the storage.
+// Looking up the voice assets is done on the main thread, so only a few
+// of the cues are checked after each line, and every cue is checked once.
+struct VoiceCue
+{
+    int CharID = 0;
+    int SndID = 0;
+};
+// Number of the most recent speakers, whose next lines are prefetched
+static const size_t VoicePrefetchSpeakers = 3u;
+// Number of lines prefetched ahead for each speaker
+static const int VoicePrefetchLines = 2;
+// Max number of cues looked up in the storage after each line
+static const int VoicePrefetchChecks = 2;
+// Max number of remembered cues which were looked up already
+static const size_t VoicePrefetchCheckedMax = 32u;
+// Most recent speakers with their last played cue, latest first
+static std::deque<VoiceCue> RecentVoiceCues;
+// Cues which were looked up already, latest last
+static std::deque<VoiceCue> CheckedVoiceCues;
+
+static bool voice_cue_checked(int charid, int sndid)
+{
+    for (const auto &cue : CheckedVoiceCues)
+    {
+        if (cue.CharID == charid && cue.SndID == sndid)
+            return true;
+    }
+    VoiceCue cue;
+    cue.CharID = charid;
+    cue.SndID = sndid;
+    CheckedVoiceCues.push_back(cue);
+    if (CheckedVoiceCues.size() > VoicePrefetchCheckedMax)
+        CheckedVoiceCues.pop_front();
+    return false;
+}
+
+static void prefetch_next_voice_cues(int charid, int sndid)
+{
+    for (auto it = RecentVoiceCues.begin(); it != RecentVoiceCues.end(); ++it)
+    {
+        if (it->CharID == charid)
+        {
+            RecentVoiceCues.erase(it);
             break;
+        }
     }
+    VoiceCue last_cue;
+    last_cue.CharID = charid;
+    last_cue.SndID = sndid;
+    RecentVoiceCues.push_front(last_cue);
+    if (RecentVoiceCues.size() > VoicePrefetchSpeakers)
+        RecentVoiceCues.pop_back();
+
+    // Request the nearest lines first, and the other speakers before
+    // the current one, as they are usually the ones to reply
+    const bool old_style = !game.options[OPT_VOICECLIPNAMERULE];
+    int checks = 0;
+    for (int line = 1; line <= VoicePrefetchLines && checks < VoicePrefetchChecks; ++line)
+    {
+        for (size_t i = 1; i <= RecentVoiceCues.size() && checks < VoicePrefetchChecks; ++i)
+        {
+            const VoiceCue &cue = RecentVoiceCues[i % RecentVoiceCues.size()];
+            if (voice_cue_checked(cue.CharID, cue.SndID + line))
+                continue;
+            checks++;
+            AssetPath apath;
+            if (find_voice_clip_asset(get_cue_filename(cue.CharID, cue.SndID + line, old_style), apath))
+                soundprefetch_request(apath);
+        }
+    }
+}
 
-    if (!found) {
+void reset_voice_prefetch()
+{
+    RecentVoiceCues.clear();
+    CheckedVoiceCues.clear();
+}
+
+// Play voice-over clip on the common channel;
+// voice_name should be bare clip name without extension
+static bool play_voice_clip_on_channel(const String &voice_name)
+{
+    stop_and_destroy_channel(SCHAN_SPEECH);
+
+    AssetPath apath;
+    if (!find_voice_clip_asset(voice_name, apath)) {
         debug_script_warn("Speech file not found: '%s'", voice_name.GetCStr());
         return false;
     }
@@ -561,6 +651,7 @@ bool play_voice_speech(int charid, int sndid)
     String voice_file = get_cue_filename(charid, sndid, !game.options[OPT_VOICECLIPNAMERULE]);
     if (!play_voice_clip_impl(voice_file, true, true))
         return false;
+    prefetch_next_voice_cues(charid, sndid);
 
     int ii;  // Compare the base file name to the .pam file name
     curLipLine = -1;  // See if we have voice lip sync for this line
@@ -595,7 +686,10 @@ bool play_voice_nonblocking(int charid, int sndid, bool as_speech)
         return false;
 
     String voice_file = get_cue_filename(charid, sndid, !game.options[OPT_VOICECLIPNAMERULE]);
-    return play_voice_clip_impl(voice_file, as_speech, false);
+    if (!play_voice_clip_impl(voice_file, as_speech, false))
+        return false;
+    prefetch_next_voice_cues(charid, sndid);
+    return true;
 }
 
 void stop_voice_speech()
@@ -65,5 +65,7 @@ bool    play_voice_nonblocking(int charid, int sndid, bool as_speech);
 void    stop_voice_speech();
 // Stop non-blocking voice-over and revert audio volumes if necessary
 void    stop_voice_nonblocking();
+// Forget the recent voice cues, e.g. when the voice pack changes
+void    reset_voice_prefetch();
 
 #endif // __AGS_EE_AC__GLOBALAUDIO_H
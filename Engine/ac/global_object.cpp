@@ -25,10 +25,12 @@
 #include "ac/gamestate.h"
 #include "ac/global_character.h"
 #include "ac/global_translation.h"
+#include "ac/hit_test_grid.h"
 #include "ac/object.h"
 #include "ac/properties.h"
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
+#include "ac/sprite_hitmask.h"
 #include "ac/string.h"
 #include "ac/viewframe.h"
 #include "ac/dynobj/cc_object.h"
@@ -43,8 +45,6 @@
 using namespace AGS::Common;
 using namespace AGS::Engine;
 
-#define OVERLAPPING_OBJECT 1000
-
 extern RoomStatus*croom;
 extern RoomObject*objs;
 extern std::vector<ViewStruct> views;
@@ -69,13 +69,66 @@ int GetObjectIDAtScreen(int scrx, int scry)
     return GetObjectIDAtRoom(vpt.first.X, vpt.first.Y);
 }
 
+// Spatial index of the room objects' bounding boxes
+static HitTestGrid obj_hit_grid;
+// Room which the index was filled for
+static int obj_hit_grid_room = -1;
+static std::vector<int> obj_hit_candidates;
+
+// Tells whether the object may be clicked
+static bool is_object_hit_testable(uint32_t objid)
+{
+    return (objid < croom->numobj) && (objs[objid].on == 1) && ((objs[objid].flags & OBJF_NOINTERACT) == 0);
+}
+
+// Clears the index if it was filled for another room;
+// returns true if it has to be filled again
+static bool reset_object_hit_index_on_room_change()
+{
+    const Size room_size(thisroom.Width, thisroom.Height);
+    if ((obj_hit_grid_room == displayed_room) && (obj_hit_grid.GetArea() == room_size))
+        return false;
+    obj_hit_grid.Reset(room_size);
+    obj_hit_grid_room = displayed_room;
+    return true;
+}
+
+void update_object_hit_index(int objid)
+{
+    reset_object_hit_index_on_room_change();
+    // only the objects which moved to other grid cells
+    // have to update the cells' lists
+    if (!is_object_hit_testable(objid))
+    {
+        obj_hit_grid.Remove(objid);
+        return;
+    }
+    const RoomObject &obj = objs[objid];
+    int spWidth = game_to_data_coord(obj.get_width());
+    int spHeight = game_to_data_coord(obj.get_height());
+    // zero size means that the sprite's size will be used in is_pos_in_sprite
+    if ((spWidth == 0) || (spHeight == 0))
+        obj_hit_grid.Update(objid, Rect());
+    else
+        obj_hit_grid.Update(objid, Rect(obj.x, obj.y - spHeight, obj.x + spWidth, obj.y));
+}
+
 int GetObjectIDAtRoom(int roomx, int roomy)
 {
+    // The index is updated once per frame, along with the objects'
+    // scaling; only fill it here if the room has been changed since
+    if (reset_object_hit_index_on_room_change())
+    {
+        for (uint32_t aa = 0; aa < croom->numobj; ++aa)
+            update_object_hit_index(aa);
+    }
+
     int bestshotyp=-1,bestshotwas=-1;
-    // Iterate through all objects in the room
-    for (uint32_t aa=0;aa<croom->numobj;aa++) {
-        if (objs[aa].on != 1) continue;
-        if (objs[aa].flags & OBJF_NOINTERACT)
+    // Iterate through the objects whose boxes contain the point, in the order of their ids
+    obj_hit_grid.Query(roomx, roomy, obj_hit_candidates);
+    for (int aa : obj_hit_candidates) {
+        // script could have disabled the object since the last update
+        if (!is_object_hit_testable(aa))
             continue;
         int xxx=objs[aa].x,yyy=objs[aa].y;
         int isflipped = 0;
@@ -90,7 +143,7 @@ int GetObjectIDAtRoom(int roomx, int roomy)
             isflipped = 0; // transformed image is already flipped
 
         if (is_pos_in_sprite(roomx, roomy, xxx, yyy - spHeight, theImage,
-            spWidth, spHeight, isflipped, is_original) == FALSE)
+            spWidth, spHeight, isflipped, is_original, objs[aa].num) == FALSE)
             continue;
 
         int usebasel = objs[aa].get_baseline();   
@@ -543,6 +596,92 @@ int AreThingsOverlapping(int thing1, int thing2)
     return 0;
 }
 
+// Gets the hit mask of the thing's image as it's drawn in the room,
+// and the image's top-left position in game coordinates;
+// returns false if the thing is not currently shown
+static bool GetThingHitMask(int thing, Point &pos, SpriteHitMask &tmp_mask, const SpriteHitMask *&mask)
+{
+    int sprnum, width, height, flipped;
+    bool is_original;
+    Bitmap *image;
+    if (is_valid_character(thing))
+    {
+        CharacterInfo *chin = &game.chars[thing];
+        if ((chin->room != displayed_room) || (chin->on == 0))
+            return false;
+        if ((chin->view < 0) ||
+            (chin->loop >= views[chin->view].numLoops) ||
+            (chin->frame >= views[chin->view].loops[chin->loop].numFrames))
+            return false;
+
+        const ViewFrame &vf = views[chin->view].loops[chin->loop].frames[chin->frame];
+        sprnum = vf.pic;
+        flipped = vf.flags & VFLG_FLIPSPRITE;
+        width = GetCharacterWidth(thing);
+        height = GetCharacterHeight(thing);
+        image = GetCharacterImage(thing, &is_original);
+        pos = Point(data_to_game_coord(chin->x - game_to_data_coord(width) / 2),
+            data_to_game_coord(charextra[thing].GetEffectiveY(chin) - game_to_data_coord(height)));
+    }
+    else if (is_valid_object(thing - OVERLAPPING_OBJECT))
+    {
+        const RoomObject &obj = objs[thing - OVERLAPPING_OBJECT];
+        if (obj.on != 1)
+            return false;
+
+        sprnum = obj.num;
+        flipped = (obj.view != RoomObject::NoView) ?
+            views[obj.view].loops[obj.loop].frames[obj.frame].flags & VFLG_FLIPSPRITE : 0;
+        width = obj.get_width();
+        height = obj.get_height();
+        image = GetObjectImage(thing - OVERLAPPING_OBJECT, &is_original);
+        pos = Point(data_to_game_coord(obj.x), data_to_game_coord(obj.y - game_to_data_coord(height)));
+    }
+    else
+    {
+        quit("!AreThingsPixelOverlapping: invalid parameter");
+        return false;
+    }
+
+    if (!is_original)
+    {
+        // cached image is already scaled and flipped
+        tmp_mask.Create(image);
+        mask = &tmp_mask;
+        return true;
+    }
+    const SpriteHitMask &sprite_mask = get_sprite_hitmask(sprnum, image);
+    if ((sprite_mask.GetWidth() == width) && (sprite_mask.GetHeight() == height) && !flipped)
+    {
+        mask = &sprite_mask;
+        return true;
+    }
+    tmp_mask.CreateTransformed(sprite_mask, width, height, flipped != 0);
+    mask = &tmp_mask;
+    return true;
+}
+
+bool AreThingsPixelOverlapping(int thing1, int thing2)
+{
+    if (game.options[OPT_PIXPERFECT] == 0)
+        return AreThingsOverlapping(thing1, thing2) != 0;
+
+    Point pos1, pos2;
+    SpriteHitMask tmp1, tmp2;
+    const SpriteHitMask *mask1, *mask2;
+    if (!GetThingHitMask(thing1, pos1, tmp1, mask1))
+        return false;
+    // the cached mask may be freed by the next cache lookup, so keep a copy
+    if (mask1 != &tmp1)
+    {
+        tmp1 = *mask1;
+        mask1 = &tmp1;
+    }
+    if (!GetThingHitMask(thing2, pos2, tmp2, mask2))
+        return false;
+    return SpriteHitMask::Overlaps(*mask1, pos1.X, pos1.Y, *mask2, pos2.X, pos2.Y);
+}
+
 int GetObjectProperty (int hss, const char *property)
 {
     if (!is_valid_object(hss))
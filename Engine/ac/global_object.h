@@ -20,10 +20,16 @@
 
 #include "gfx/bitmap.h"
 
+// Offset of the object ids among the "thing" ids, where characters go first
+#define OVERLAPPING_OBJECT 1000
+
 // Get object at the given screen coordinates
 int  GetObjectIDAtScreen(int xx,int yy);
 // Get object at the given room coordinates
 int  GetObjectIDAtRoom(int roomx, int roomy);
+// Updates the object's entry in the hit test index, using its current
+// position and scaled size; should be called after update_object_scale
+void update_object_hit_index(int objid);
 void SetObjectTint(int obj, int red, int green, int blue, int opacity, int luminance);
 void RemoveObjectTint(int obj);
 void SetObjectView(int obn,int vii);
@@ -58,6 +64,9 @@ void SetObjectIgnoreWalkbehinds (int cha, int clik);
 void RunObjectInteraction (int aa, int mood);
 int  AreObjectsColliding(int obj1,int obj2);
 int  AreThingsOverlapping(int thing1, int thing2);
+// Tells if the opaque pixels of two things' images overlap; uses bounding
+// boxes, same as AreThingsOverlapping, if the pixel-perfect option is off
+bool AreThingsPixelOverlapping(int thing1, int thing2);
 
 int  GetObjectProperty (int hss, const char *property);
 void GetObjectPropertyText (int item, const char *property, char *bufer);
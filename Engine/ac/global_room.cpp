@@ -24,6 +24,7 @@
 #include "ac/movelist.h"
 #include "ac/properties.h"
 #include "ac/room.h"
+#include "ac/roompreload.h"
 #include "ac/roomstatus.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
@@ -157,6 +158,15 @@ void ResetRoom(int nrnum) {
     debug_script_log("Room %d reset to original state", nrnum);
 }
 
+void PreloadRoom(int nrnum) {
+    if ((nrnum<0) | (nrnum>=MAX_ROOMS))
+        quit("!PreloadRoom: invalid room number");
+    if (nrnum == displayed_room)
+        return; // already loaded
+
+    preload_room(nrnum);
+}
+
 int HasPlayerBeenInRoom(int roomnum) {
     if ((roomnum < 0) || (roomnum >= MAX_ROOMS))
         return 0;
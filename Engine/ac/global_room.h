@@ -24,6 +24,8 @@ void NewRoom(int nrnum);
 void NewRoomEx(int nrnum,int newx,int newy);
 void NewRoomNPC(int charid, int nrnum, int newx, int newy);
 void ResetRoom(int nrnum);
+// Starts loading the room in background, for the faster room change later
+void PreloadRoom(int nrnum);
 int  HasPlayerBeenInRoom(int roomnum);
 void CallRoomScript (int value);
 int  HasBeenToRoom (int roomnum);
@@ -0,0 +1,135 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "ac/hit_test_grid.h"
+#include <algorithm>
+
+namespace AGS
+{
+namespace Engine
+{
+
+static bool SameRect(const Rect &r1, const Rect &r2)
+{
+    return (r1.Left == r2.Left) && (r1.Top == r2.Top) &&
+        (r1.Right == r2.Right) && (r1.Bottom == r2.Bottom);
+}
+
+void HitTestGrid::Reset(const Size &area, int cell_size)
+{
+    _area = area;
+    _cellSize = std::max(1, cell_size);
+    _cellsX = std::max(1, (area.Width + _cellSize - 1) / _cellSize);
+    _cellsY = std::max(1, (area.Height + _cellSize - 1) / _cellSize);
+    _cells.clear();
+    _cells.resize(_cellsX * _cellsY);
+    _unbounded.clear();
+    _entries.clear();
+}
+
+void HitTestGrid::Clear()
+{
+    for (auto &cell : _cells)
+        cell.clear();
+    _unbounded.clear();
+    _entries.clear();
+}
+
+void HitTestGrid::Update(int id, const Rect &box)
+{
+    if (id < 0)
+        return;
+    if (static_cast<size_t>(id) >= _entries.size())
+        _entries.resize(id + 1);
+    Entry &entry = _entries[id];
+    if (entry.Active && SameRect(entry.Box, box))
+        return;
+
+    const Rect cells = GetCellRange(box);
+    if (!entry.Active || !SameRect(entry.Cells, cells))
+    {
+        if (entry.Active)
+            RemoveFromCells(id, entry.Cells);
+        AddToCells(id, cells);
+    }
+    entry.Active = true;
+    entry.Box = box;
+    entry.Cells = cells;
+}
+
+void HitTestGrid::Remove(int id)
+{
+    if (!Has(id))
+        return;
+    Entry &entry = _entries[id];
+    RemoveFromCells(id, entry.Cells);
+    entry.Active = false;
+}
+
+void HitTestGrid::Query(int x, int y, std::vector<int> &ids) const
+{
+    ids.clear();
+    if (_cells.empty())
+        return;
+    for (int id : _cells[CellY(y) * _cellsX + CellX(x)])
+    {
+        if (_entries[id].Box.IsInside(x, y))
+            ids.push_back(id);
+    }
+    ids.insert(ids.end(), _unbounded.begin(), _unbounded.end());
+    std::sort(ids.begin(), ids.end());
+}
+
+Rect HitTestGrid::GetCellRange(const Rect &box) const
+{
+    if (box.IsEmpty())
+        return Rect();
+    return Rect(CellX(box.Left), CellY(box.Top), CellX(box.Right), CellY(box.Bottom));
+}
+
+void HitTestGrid::AddToCells(int id, const Rect &cells)
+{
+    if (cells.IsEmpty())
+    {
+        _unbounded.push_back(id);
+        return;
+    }
+    for (int cy = cells.Top; cy <= cells.Bottom; ++cy)
+        for (int cx = cells.Left; cx <= cells.Right; ++cx)
+            _cells[cy * _cellsX + cx].push_back(id);
+}
+
+void HitTestGrid::RemoveFromCells(int id, const Rect &cells)
+{
+    auto remove_id = [id](std::vector<int> &list)
+    {
+        auto it = std::find(list.begin(), list.end(), id);
+        if (it != list.end())
+        {
+            *it = list.back();
+            list.pop_back();
+        }
+    };
+
+    if (cells.IsEmpty())
+    {
+        remove_id(_unbounded);
+        return;
+    }
+    for (int cy = cells.Top; cy <= cells.Bottom; ++cy)
+        for (int cx = cells.Left; cx <= cells.Right; ++cx)
+            remove_id(_cells[cy * _cellsX + cx]);
+}
+
+} // namespace Engine
+} // namespace AGS
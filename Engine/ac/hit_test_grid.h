@@ -0,0 +1,92 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// HitTestGrid is a uniform grid of the room's cells, which keeps the list
+// of interactive entities (characters or objects) whose bounding boxes
+// intersect each cell. It lets to find hit test candidates at a point
+// without testing every entity in the room. The entries are updated
+// individually, and only touch the grid cells if their box has moved
+// to other cells.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__HITTESTGRID_H
+#define __AGS_EE_AC__HITTESTGRID_H
+
+#include <vector>
+#include "util/geometry.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+class HitTestGrid
+{
+public:
+    // Default cell size, in room coordinates
+    static const int DefaultCellSize = 64;
+
+    HitTestGrid() { Reset(Size()); }
+
+    // Removes all entries, and sets up the grid over the given area;
+    // entries may still be outside of the area, and they will be
+    // registered in the nearest edge cells
+    void Reset(const Size &area, int cell_size = DefaultCellSize);
+    // Removes all entries, keeping the grid
+    void Clear();
+    const Size &GetArea() const { return _area; }
+    int GetCellSize() const { return _cellSize; }
+
+    // Adds or updates the entry's bounding box; the box is inclusive;
+    // an empty box means that the entry's bounds are unknown, and it
+    // should be returned by any query
+    void Update(int id, const Rect &box);
+    // Removes the entry from the grid
+    void Remove(int id);
+    // Tells if the entry is currently in the grid
+    bool Has(int id) const { return (id >= 0) && (static_cast<size_t>(id) < _entries.size()) && _entries[id].Active; }
+
+    // Gets the ids of entries whose boxes contain the point, sorted by id
+    void Query(int x, int y, std::vector<int> &ids) const;
+
+private:
+    struct Entry
+    {
+        bool Active = false;
+        Rect Box;
+        // Range of the cells the entry is registered in,
+        // empty if it's in the unbounded list
+        Rect Cells;
+    };
+
+    Rect GetCellRange(const Rect &box) const;
+    inline int CellX(int x) const { return AGSMath::Clamp(x / _cellSize, 0, _cellsX - 1); }
+    inline int CellY(int y) const { return AGSMath::Clamp(y / _cellSize, 0, _cellsY - 1); }
+    void AddToCells(int id, const Rect &cells);
+    void RemoveFromCells(int id, const Rect &cells);
+
+    Size _area;
+    int _cellSize = DefaultCellSize;
+    int _cellsX = 1;
+    int _cellsY = 1;
+    std::vector<std::vector<int>> _cells;
+    // Entries with unknown bounds
+    std::vector<int> _unbounded;
+    std::vector<Entry> _entries;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_AC__HITTESTGRID_H
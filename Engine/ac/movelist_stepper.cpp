@@ -0,0 +1,351 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "ac/movelist_stepper.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace AGS
+{
+namespace Engine
+{
+
+// Optionally fixes target position, when one axis is left to move along.
+// This is done only for backwards compatibility now.
+// Uses generic parameters.
+static void movelist_handle_targetfix(const fixed xpermove, const fixed ypermove, int &targety)
+{
+    // Old comment about ancient behavior:
+    // if the X-movement has finished, and the Y-per-move is < 1, finish
+    // This can cause jump at the end, but without it the character will
+    // walk on the spot for a while if the Y-per-move is for example 0.2
+    //    if ((ypermove & 0xfffff000) == 0) cmls.doneflag|=2;
+    //    int ypmm=(ypermove >> 16) & 0x0000ffff;
+
+    // NEW 2.15 SR-1 plan: if X-movement has finished, and Y-per-move is < 1,
+    // allow it to finish more easily by moving target zone
+    // NOTE: interesting fact: this fix was also done for the strictly vertical
+    // move, probably because of the logical mistake in condition.
+
+    int tfix = 3;
+    // 2.70: if the X permove is also <=1, don't skip as far
+    if (((xpermove & 0xffff0000) == 0xffff0000) ||
+        ((xpermove & 0xffff0000) == 0x00000000))
+        tfix = 2;
+
+    // 2.61 RC1: correct this to work with > -1 as well as < 1
+    if (ypermove == 0) {}
+    // Y per move is < 1, so finish the move
+    else if ((ypermove & 0xffff0000) == 0)
+        targety -= tfix;
+    // Y per move is -1 exactly, don't snap to finish
+    else if ((ypermove & 0xffffffff) == 0xffff0000) {}
+    // Y per move is > -1, so finish the move
+    else if ((ypermove & 0xffff0000) == 0xffff0000)
+        targety += tfix;
+}
+
+// Handle remaining move along a single axis; uses generic parameters.
+static void movelist_handle_remainer(const fixed xpermove, const fixed ypermove,
+    const int xdistance, const float step_length, fixed &fin_ymove, float &fin_from_part)
+{
+    // Walk along the remaining axis with the full walking speed
+    assert(xpermove != 0 && ypermove != 0 && step_length >= 0.f);
+    fin_ymove = ypermove > 0 ? ftofix(step_length) : -ftofix(step_length);
+    fin_from_part = (float)xdistance / fixtof(xpermove);
+    assert(fin_from_part >= 0);
+}
+
+// Test if move completed, returns if just completed
+static bool movelist_handle_donemove(const uint8_t testflag, const fixed xpermove, const int targetx, uint8_t &doneflag, int &xps)
+{
+    if ((doneflag & testflag) != 0)
+        return false; // already done before
+
+    if (((xpermove > 0) && (xps >= targetx)) || ((xpermove < 0) && (xps <= targetx)))
+    {
+        doneflag |= testflag;
+        xps = targetx; // snap to the target (in case run over)
+        // Comment about old engine behavior:
+        // if the Y is almost there too, finish it
+        // this is new in v2.40
+        // removed in 2.70
+        /*if (abs(yps - targety) <= 2)
+            yps = targety;*/
+    }
+    else if (xpermove == 0)
+    {
+        doneflag |= testflag;
+    }
+    return (doneflag & testflag) != 0;
+}
+
+void UpdateMoveListRemainer(MoveList &m)
+{
+    assert(m.GetNumStages() > 0);
+    const fixed xpermove = m.permove[m.onstage].X;
+    const fixed ypermove = m.permove[m.onstage].Y;
+    const Point target = m.pos[m.onstage + 1];
+    // Apply remainer to movelists where LONGER axis was completed, and SHORTER remains
+    if ((xpermove != 0) && (ypermove != 0))
+    {
+        if ((m.doneflag & kMoveListDone_XY) == kMoveListDone_X && (abs(ypermove) < abs(xpermove)))
+            movelist_handle_remainer(xpermove, ypermove, (target.X - m.from.X),
+                m.GetStepLength(), m.fin_move, m.fin_from_part);
+        else if ((m.doneflag & kMoveListDone_XY) == kMoveListDone_Y && (abs(xpermove) < abs(ypermove)))
+            movelist_handle_remainer(ypermove, xpermove, (target.Y - m.from.Y),
+                m.GetStepLength(), m.fin_move, m.fin_from_part);
+    }
+}
+
+// Gets the current stage's target, optionally applying old-style fixup
+static Point GetStepTarget(const MoveList &m, const MoveStepOptions &opts)
+{
+    Point target = m.pos[m.onstage + 1];
+    if (opts.LegacyTargetFix)
+    {
+        const fixed xpermove = m.permove[m.onstage].X;
+        const fixed ypermove = m.permove[m.onstage].Y;
+        if ((ypermove != 0) && (m.doneflag & kMoveListDone_X) != 0)
+        { // X-move has finished, handle the Y-move remainer
+            movelist_handle_targetfix(xpermove, ypermove, target.Y);
+        }
+        else if ((xpermove != 0) && (m.doneflag & kMoveListDone_Y) != 0)
+        { // Y-move has finished, handle the X-move remainer
+            movelist_handle_targetfix(xpermove, ypermove, target.Y);
+        }
+    }
+    return target;
+}
+
+// Gets the number of steps made past the end of the current stage,
+// measured along the longer axis
+static float GetStageOvershoot(const MoveList &m)
+{
+    if (m.fin_from_part > 0.f)
+        return 0.f; // finished along the remaining axis, too complicated
+    const fixed xpermove = m.permove[m.onstage].X;
+    const fixed ypermove = m.permove[m.onstage].Y;
+    const Point &target = m.pos[m.onstage + 1];
+    const float steps = (abs(xpermove) >= abs(ypermove)) ?
+        ((xpermove != 0) ? (target.X - m.from.X) / static_cast<float>(fixtof(xpermove)) : m.onpart) :
+        (target.Y - m.from.Y) / static_cast<float>(fixtof(ypermove));
+    const float overshoot = m.onpart - steps;
+    return ((overshoot > 0.f) && (overshoot < 1.f)) ? overshoot : 0.f;
+}
+
+// Handles completion of the step, after the new position was calculated
+static MoveStepResult FinishStep(MoveList &m, const Point &target, int &xps, int &yps,
+    const MoveStepOptions &opts)
+{
+    const fixed xpermove = m.permove[m.onstage].X;
+    const fixed ypermove = m.permove[m.onstage].Y;
+    MoveStepResult result = kMoveStep_Moving;
+
+    // Check if finished either horizontal or vertical movement;
+    // if any was finished just now, then also handle remainer fixup
+    bool done_now = movelist_handle_donemove(kMoveListDone_X, xpermove, target.X, m.doneflag, xps);
+    done_now     |= movelist_handle_donemove(kMoveListDone_Y, ypermove, target.Y, m.doneflag, yps);
+    if (done_now)
+        UpdateMoveListRemainer(m);
+
+    // Handle end of move stage
+    if ((m.doneflag & kMoveListDone_XY) == kMoveListDone_XY)
+    {
+        // the distance went past the waypoint, in pixels
+        const float overshoot = opts.InterpolateStages ? GetStageOvershoot(m) * m.GetStepLength() : 0.f;
+        // this stage is done, go on to the next stage
+        m.from = m.pos[m.onstage + 1];
+        m.onstage++;
+        m.onpart = -1.f;
+        m.fin_from_part = 0.f;
+        m.fin_move = 0;
+        m.doneflag = 0;
+        if (m.onstage < m.GetNumStages())
+        {
+            xps = m.from.X;
+            yps = m.from.Y;
+        }
+
+        if (m.onstage >= m.GetNumStages() - 1)
+        {  // last stage is just dest pos
+            m = {};
+            result = kMoveStep_Finished;
+        }
+        else
+        {
+            // continue walking the next stage without a pause
+            if (opts.InterpolateStages)
+            {
+                const float step_length = m.GetStepLength();
+                m.onpart = (step_length > 0.f) ? overshoot / step_length : 0.f;
+            }
+            result = kMoveStep_NextStage;
+        }
+    }
+
+    // Make a step along the current vector
+    m.onpart += 1.f;
+    return result;
+}
+
+MoveStepResult StepMoveList(MoveList &m, int &pos_x, int &pos_y, const MoveStepOptions &opts)
+{
+    const fixed xpermove = m.permove[m.onstage].X;
+    const fixed ypermove = m.permove[m.onstage].Y;
+    const fixed fin_move = m.fin_move;
+    const float main_onpart = (m.fin_from_part > 0.f) ? m.fin_from_part : m.onpart;
+    const float fin_onpart = m.onpart - main_onpart;
+    const Point target = GetStepTarget(m, opts);
+    int xps = pos_x, yps = pos_y;
+
+    // Calculate next positions, as required
+    if ((m.doneflag & kMoveListDone_X) == 0)
+    {
+        xps = m.from.X + (int)(fixtof(xpermove) * main_onpart) +
+          (int)(fixtof(fin_move) * fin_onpart);
+    }
+    if ((m.doneflag & kMoveListDone_Y) == 0)
+    {
+        yps = m.from.Y + (int)(fixtof(ypermove) * main_onpart) +
+          (int)(fixtof(fin_move) * fin_onpart);
+    }
+
+    const MoveStepResult result = FinishStep(m, target, xps, yps, opts);
+    pos_x = xps;
+    pos_y = yps;
+    return result;
+}
+
+
+// Progress which no movelist has, tells that the mover's stage must be read
+static const uint32_t NoStage = UINT32_MAX;
+// Step progress of a mover which has made the full step
+static const float NoStepPart = -1.f;
+
+void MoveListStepper::Clear()
+{
+    *this = MoveListStepper();
+}
+
+void MoveListStepper::SetCount(int count)
+{
+    _movers.resize(count);
+}
+
+void MoveListStepper::Sync(int index, MoveList *m, int *pos_x, int *pos_y)
+{
+    Mover &mv = _movers[index];
+    if (m != mv.List)
+    {
+        mv.List = m;
+        mv.OnStage = NoStage;
+    }
+    mv.PosX = pos_x;
+    mv.PosY = pos_y;
+}
+
+void MoveListStepper::ReadStage(Mover &mv, const MoveList &m, const MoveStepOptions &opts)
+{
+    const fixed xpermove = m.permove[m.onstage].X;
+    const fixed ypermove = m.permove[m.onstage].Y;
+    const Point target = GetStepTarget(m, opts);
+    mv.OnStage = m.onstage;
+    mv.OnPart = m.onpart;
+    mv.DoneFlag = m.doneflag;
+    mv.DirX = (xpermove > 0) - (xpermove < 0);
+    mv.DirY = (ypermove > 0) - (ypermove < 0);
+    mv.FromX = m.from.X;
+    mv.FromY = m.from.Y;
+    mv.TargetX = target.X;
+    mv.TargetY = target.Y;
+    mv.PermoveX = fixtof(xpermove);
+    mv.PermoveY = fixtof(ypermove);
+    mv.FinMove = fixtof(m.fin_move);
+    mv.FinFromPart = m.fin_from_part;
+}
+
+fixed MoveListStepper::GetSubPos(const Mover &mv, bool y_axis)
+{
+    const int pos = y_axis ? *mv.PosY : *mv.PosX;
+    const uint8_t done_flag = y_axis ? kMoveListDone_Y : kMoveListDone_X;
+    if ((mv.StepPart == NoStepPart) || (mv.DoneFlag & done_flag))
+        return itofix(pos);
+    // same as the integer position, but without rounding each part of the move
+    const float main_onpart = (mv.FinFromPart > 0.f) ? mv.FinFromPart : mv.StepPart;
+    const float fin_onpart = mv.StepPart - main_onpart;
+    const int from = y_axis ? mv.FromY : mv.FromX;
+    const double permove = y_axis ? mv.PermoveY : mv.PermoveX;
+    return static_cast<fixed>((from + permove * main_onpart + mv.FinMove * fin_onpart) * 65536.0);
+}
+
+void MoveListStepper::Step(const MoveStepOptions &opts)
+{
+    // the legacy target fixup is applied when the stage is read
+    const bool read_all = opts.LegacyTargetFix != _legacyTargetFix;
+    _legacyTargetFix = opts.LegacyTargetFix;
+    _finished.clear();
+
+    const int count = static_cast<int>(_movers.size());
+    for (int i = 0; i < count; ++i)
+    {
+        Mover &mv = _movers[i];
+        MoveList *m = mv.List;
+        if (!m)
+            continue;
+        if (read_all || (m->onstage != mv.OnStage) || (m->onpart != mv.OnPart) ||
+            (m->doneflag != mv.DoneFlag))
+            ReadStage(mv, *m, opts);
+
+        // NOTE: the expressions must match StepMoveList exactly
+        const float onpart = mv.OnPart;
+        const float main_onpart = (mv.FinFromPart > 0.f) ? mv.FinFromPart : onpart;
+        const float fin_onpart = onpart - main_onpart;
+        const double fin_dist = mv.FinMove * fin_onpart;
+        const bool move_x = (mv.DoneFlag & kMoveListDone_X) == 0;
+        const bool move_y = (mv.DoneFlag & kMoveListDone_Y) == 0;
+        const int xps = move_x ? mv.FromX + (int)(mv.PermoveX * main_onpart) + (int)fin_dist : *mv.PosX;
+        const int yps = move_y ? mv.FromY + (int)(mv.PermoveY * main_onpart) + (int)fin_dist : *mv.PosY;
+
+        // Completing an axis or a stage is done by the full step; an axis is
+        // complete when the position reaches the target from the direction
+        // of move, or if there's no move along it
+        const bool end_x = move_x & (mv.DirX * (xps - mv.TargetX) >= 0);
+        const bool end_y = move_y & (mv.DirY * (yps - mv.TargetY) >= 0);
+        if (end_x | end_y | (!move_x & !move_y))
+        {
+            mv.StepPart = NoStepPart;
+            if (StepMoveList(*m, *mv.PosX, *mv.PosY, opts) == kMoveStep_Finished)
+            {
+                mv.List = nullptr;
+                _finished.push_back(i);
+            }
+            else
+            {
+                // read the next stage while the movelist is in cache
+                ReadStage(mv, *m, opts);
+            }
+            continue;
+        }
+
+        *mv.PosX = xps;
+        *mv.PosY = yps;
+        mv.StepPart = onpart;
+        mv.OnPart = onpart + 1.f;
+        m->onpart = mv.OnPart;
+    }
+}
+
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,128 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// MoveList stepping: advancing a mover along its MoveList by a single step.
+//
+// MoveListStepper advances a number of movers at once. It keeps the current
+// stage of each mover in a packed array between the steps, so that a regular
+// step only has to compute the new position, and does not look into the
+// MoveList's waypoints. The steps which complete an axis or a stage are
+// passed to StepMoveList, so the results are exactly the same. MoveList
+// remains the authoritative state, as it is saved and may be changed by
+// game logic; the mover's stage is read again whenever its MoveList has
+// a progress different from what the stepper has left there.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__MOVELISTSTEPPER_H
+#define __AGS_EE_AC__MOVELISTSTEPPER_H
+
+#include <vector>
+#include "ac/movelist.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+// Result of a single movement step
+enum MoveStepResult
+{
+    kMoveStep_Moving    = 0, // continues moving along the current stage
+    kMoveStep_Finished  = 1, // has finished the last stage, the movelist is reset
+    kMoveStep_NextStage = 2  // has finished a stage, and begins the next one
+};
+
+struct MoveStepOptions
+{
+    // Moves target when only one axis is left to move along,
+    // this is for backwards compatibility with games before 3.6.1
+    bool LegacyTargetFix = false;
+    // Carries the part of the step which went past the stage's end into
+    // the next stage, so that the mover keeps its speed at the waypoints;
+    // otherwise the first step of a stage is made from its start
+    bool InterpolateStages = false;
+};
+
+// Does the next move along the movelist, updating the given position
+MoveStepResult StepMoveList(MoveList &m, int &pos_x, int &pos_y, const MoveStepOptions &opts);
+// Recalculates remaining move fixup for the movelist where only one axis is
+// left to move along; required after the movelist is restored from a save
+void UpdateMoveListRemainer(MoveList &m);
+
+class MoveListStepper
+{
+public:
+    // Forgets all the movers, e.g. when the movelists are restored from a save
+    void Clear();
+    // Sets the number of movers, indexed from 0
+    void SetCount(int count);
+    // Assigns the movelist and the position to the mover with given index,
+    // or disables the mover if the movelist is null; the position is
+    // updated by each step, and must stay valid until the next Sync
+    void Sync(int index, MoveList *m, int *pos_x, int *pos_y);
+    // Advances all the enabled movers by a single step
+    void Step(const MoveStepOptions &opts);
+
+    // Gets the indexes of the movers which have finished moving on the last step
+    const std::vector<int> &GetFinished() const { return _finished; }
+    // Gets the exact position of the mover after the last step, in fixed point
+    fixed GetSubX(int index) const { return GetSubPos(_movers[index], false); }
+    fixed GetSubY(int index) const { return GetSubPos(_movers[index], true); }
+
+private:
+    // Mover's state, packed for the stepping
+    struct Mover
+    {
+        // Movelist, null if the mover is disabled
+        MoveList *List = nullptr;
+        // Position which is updated
+        int     *PosX = nullptr;
+        int     *PosY = nullptr;
+        // The movelist progress left by the last step, which tells
+        // if the stage below is still valid
+        uint32_t OnStage = 0u;
+        float    OnPart = 0.f;
+        uint8_t  DoneFlag = 0u;
+        // Direction of move along the axes, -1, 0 or 1
+        int8_t   DirX = 0;
+        int8_t   DirY = 0;
+        // Current stage: start, target, and per-step moves
+        int      FromX = 0;
+        int      FromY = 0;
+        int      TargetX = 0;
+        int      TargetY = 0;
+        double   PermoveX = 0.0;
+        double   PermoveY = 0.0;
+        // Move along the remaining axis, see MoveList::fin_move
+        double   FinMove = 0.0;
+        float    FinFromPart = 0.f;
+        // Progress which the last step was made with, for the exact position
+        float    StepPart = 0.f;
+    };
+
+    // Reads the mover's current stage from its movelist
+    static void ReadStage(Mover &mv, const MoveList &m, const MoveStepOptions &opts);
+    // Calculates the exact position of the mover along the axis
+    static fixed GetSubPos(const Mover &mv, bool y_axis);
+
+    std::vector<Mover> _movers;
+    std::vector<int> _finished;
+    // Options which the targets were calculated with
+    bool _legacyTargetFix = false;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_AC__MOVELISTSTEPPER_H
@@ -26,6 +26,7 @@
 #include "ac/room.h"
 #include "ac/roomstatus.h"
 #include "ac/runtime_defines.h"
+#include "ac/sprite_hitmask.h"
 #include "ac/string.h"
 #include "ac/system.h"
 #include "ac/view.h"
@@ -54,6 +55,9 @@ extern Bitmap *walkable_areas_temp;
 extern IGraphicsDriver *gfxDriver;
 extern CCObject ccDynamicObject;
 
+// 1-bit masks of the original sprites, used for the pixel-perfect hit tests
+static SpriteHitMaskCache sprite_hitmasks;
+
 
 bool is_valid_object(int obj_id)
 {
@@ -72,6 +76,12 @@ int Object_IsCollidingWithObject(ScriptObject *objj, ScriptObject *obj2) {
     return AreObjectsColliding(objj->id, obj2->id);
 }
 
+bool Object_IsPixelCollidingWithObject(ScriptObject *objj, ScriptObject *obj2) {
+    if (obj2 == nullptr)
+        quit("!Object.IsPixelCollidingWithObject: invalid object specified");
+    return AreThingsPixelOverlapping(objj->id + OVERLAPPING_OBJECT, obj2->id + OVERLAPPING_OBJECT);
+}
+
 ScriptObject *GetObjectAtScreen(int xx, int yy) {
     int hsnum = GetObjectIDAtScreen(xx, yy);
     if (hsnum < 0)
@@ -471,7 +481,9 @@ void move_object(int objj, int tox, int toy, int speed, int ignwal) {
 
     const int mslot = objj + 1;
     MaskRouteFinder *pathfind = get_room_pathfinder();
-    pathfind->SetWalkableArea(prepare_walkable_areas(-1), thisroom.MaskResolution);
+    Bitmap *walk_mask = prepare_walkable_areas(-1);
+    const MaskRowStamps walk_stamps = get_walkable_areas_stamps();
+    pathfind->SetWalkableArea(walk_mask, thisroom.MaskResolution, &walk_stamps);
     if (Pathfinding::FindRoute(mls[mslot], pathfind, src_x, src_y, dst_x, dst_y,
         speed, speed, false, ignwal != 0))
     {
@@ -607,7 +619,7 @@ int isposinbox(int mmx,int mmy,int lf,int tp,int rt,int bt) {
 // arx,ary,spww,sphh are the sprite's bounding box
 // bitmap_original tells whether bitmap is an original sprite, or transformed version
 int is_pos_in_sprite(int xx, int yy, int arx, int ary, Bitmap *sprit,
-                     int spww, int sphh, int flipped, bool bitmap_original) {
+                     int spww, int sphh, int flipped, bool bitmap_original, int sprnum) {
     if (spww==0) spww = game_to_data_coord(sprit->GetWidth()) - 1;
     if (sphh==0) sphh = game_to_data_coord(sprit->GetHeight()) - 1;
 
@@ -635,14 +647,33 @@ int is_pos_in_sprite(int xx, int yy, int arx, int ary, Bitmap *sprit,
         if (flipped)
             xpos = (sprit->GetWidth() - 1) - xpos;
 
-        int gpcol = my_getpixel(sprit, xpos, ypos);
+        if (bitmap_original && (sprnum >= 0))
+        {
+            // original sprites have their opaque pixels cached in a 1-bit mask
+            if (!sprite_hitmasks.Get(sprnum, sprit).IsOpaque(xpos, ypos))
+                return FALSE;
+        }
+        else
+        {
+            int gpcol = my_getpixel(sprit, xpos, ypos);
 
-        if ((gpcol == sprit->GetMaskColor()) || (gpcol == -1))
-            return FALSE;
+            if ((gpcol == sprit->GetMaskColor()) || (gpcol == -1))
+                return FALSE;
+        }
     }
     return TRUE;
 }
 
+const SpriteHitMask &get_sprite_hitmask(int sprnum, Bitmap *image)
+{
+    return sprite_hitmasks.Get(sprnum, image);
+}
+
+void invalidate_sprite_hitmask(int sprnum)
+{
+    sprite_hitmasks.Invalidate(sprnum);
+}
+
 // X and Y co-ordinates must be in native format (TODO: find out if this comment is still true)
 int check_click_on_object(int roomx, int roomy, int mood)
 {
@@ -865,6 +896,11 @@ RuntimeScriptValue Sc_Object_IsCollidingWithObject(void *self, const RuntimeScri
     API_OBJCALL_INT_POBJ(ScriptObject, Object_IsCollidingWithObject, ScriptObject);
 }
 
+RuntimeScriptValue Sc_Object_IsPixelCollidingWithObject(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_BOOL_POBJ(ScriptObject, Object_IsPixelCollidingWithObject, ScriptObject);
+}
+
 // void (ScriptObject *objj, char *buffer)
 RuntimeScriptValue Sc_Object_GetName(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
@@ -1259,6 +1295,7 @@ void RegisterObjectAPI()
         { "Object::Animate^6",                API_FN_PAIR(Object_Animate6) },
         { "Object::Animate^7",                API_FN_PAIR(Object_Animate) },
         { "Object::IsCollidingWithObject^1",  API_FN_PAIR(Object_IsCollidingWithObject) },
+        { "Object::IsPixelCollidingWithObject^1", API_FN_PAIR(Object_IsPixelCollidingWithObject) },
         { "Object::GetName^1",                API_FN_PAIR(Object_GetName) },
         { "Object::GetProperty^1",            API_FN_PAIR(Object_GetProperty) },
         { "Object::GetPropertyText^2",        API_FN_PAIR(Object_GetPropertyText) },
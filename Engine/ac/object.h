@@ -24,6 +24,7 @@
 #include "ac/dynobj/scriptobject.h"
 
 namespace AGS { namespace Common { class Bitmap; } }
+namespace AGS { namespace Engine { class SpriteHitMask; } }
 using namespace AGS; // FIXME later
 
 bool    is_valid_object(int obj_id);
@@ -31,6 +32,7 @@ bool    is_valid_object(int obj_id);
 // if not then prints a warning to the log; returns assertion result
 bool    AssertObject(const char *apiname, int obj_id);
 int     Object_IsCollidingWithObject(ScriptObject *objj, ScriptObject *obj2);
+bool    Object_IsPixelCollidingWithObject(ScriptObject *objj, ScriptObject *obj2);
 ScriptObject *GetObjectAtScreen(int xx, int yy);
 void    Object_Tint(ScriptObject *objj, int red, int green, int blue, int saturation, int luminance);
 void    Object_RemoveTint(ScriptObject *objj);
@@ -92,10 +94,16 @@ void    get_object_blocking_rect(int objid, int *x1, int *y1, int *width, int *y
 int     isposinbox(int mmx,int mmy,int lf,int tp,int rt,int bt);
 // xx,yy is the position in room co-ordinates that we are checking
 // arx,ary,spww,sphh are the sprite's bounding box (including sprite scaling);
-// bitmap_original tells whether bitmap is an original sprite, or transformed version
+// bitmap_original tells whether bitmap is an original sprite, or transformed version;
+// sprnum is the original sprite's number, if known, which lets to use its cached hit mask
 int     is_pos_in_sprite(int xx, int yy, int arx, int ary,
                          Common::Bitmap *sprit, int spww, int sphh, int flipped,
-                         bool bitmap_original);
+                         bool bitmap_original, int sprnum = -1);
+// Gets the cached hit mask of the original sprite, creating one if necessary;
+// the returned reference is only valid until the next call to this function
+const Engine::SpriteHitMask &get_sprite_hitmask(int sprnum, Common::Bitmap *image);
+// Drops the sprite's cached hit mask, must be called whenever the sprite changes
+void    invalidate_sprite_hitmask(int sprnum);
 // X and Y co-ordinates must be in native format
 // X and Y are ROOM coordinates
 int     check_click_on_object(int roomx, int roomy, int mood);
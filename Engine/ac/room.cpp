@@ -40,6 +40,7 @@
 #include "ac/room.h"
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
+#include "ac/roompreload.h"
 #include "ac/screen.h"
 #include "ac/string.h"
 #include "ac/system.h"
@@ -215,8 +216,8 @@ ScriptUserObject *Room_NearestWalkableArea(int x, int y)
     if (displayed_room < 0)
         quit("!Room.NearestWalkableArea: no room is currently loaded");
     Point found_pt;
-    if (Pathfinding::FindNearestWalkablePoint(thisroom.WalkAreaMask.get(),
-        Point(room_to_mask_coord(x), room_to_mask_coord(y)), found_pt))
+    if (find_nearest_walkable_point(Point(room_to_mask_coord(x), room_to_mask_coord(y)), found_pt,
+        RectWH(thisroom.WalkAreaMask->GetSize())))
     {
         return ScriptStructHelpers::CreatePoint(mask_to_room_coord(found_pt.X), mask_to_room_coord(found_pt.Y));
     }
@@ -475,6 +476,21 @@ HError LoadRoomScript(RoomStruct *room, int newnum)
     return HError::None();
 }
 
+String get_room_filename(int room_num)
+{
+    String filename = String::FromFormat("room%d.crm", room_num);
+    if (room_num == 0) {
+        // support both room0.crm and intro.crm
+        // 2.70: Renamed intro.crm to room0.crm, to stop it causing confusion
+        if ((loaded_game_file_version < kGameVersion_270 && AssetMgr->DoesAssetExist("intro.crm")) ||
+            (loaded_game_file_version >= kGameVersion_270 && !AssetMgr->DoesAssetExist(filename)))
+        {
+            filename = "intro.crm";
+        }
+    }
+    return filename;
+}
+
 static void reset_temp_room()
 {
     troom = RoomStatus();
@@ -495,24 +511,26 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
     set_color_depth(8);
     displayed_room=newnum;
 
-    room_filename.Format("room%d.crm", newnum);
-    if (newnum == 0) {
-        // support both room0.crm and intro.crm
-        // 2.70: Renamed intro.crm to room0.crm, to stop it causing confusion
-        if ((loaded_game_file_version < kGameVersion_270 && AssetMgr->DoesAssetExist("intro.crm")) ||
-            (loaded_game_file_version >= kGameVersion_270 && !AssetMgr->DoesAssetExist(room_filename)))
-        {
-            room_filename = "intro.crm";
-        }
-    }
+    room_filename = get_room_filename(newnum);
 
-    // load the room from disk
+    // load the room from disk, unless it was preloaded
     set_our_eip(200);
-    thisroom.GameID = NO_GAME_ID_IN_ROOM_FILE;
-    HError err = LoadRoom(room_filename, &thisroom, AssetMgr.get(), game.IsLegacyHiRes(), game.SpriteInfos);
-    if (!err)
+    if (!preload_room_take(newnum, thisroom))
     {
-        quitprintf("Unable to load the room file '%s'. Error: %s", room_filename.GetCStr(), err->FullMessage().GetCStr());
+        thisroom.GameID = NO_GAME_ID_IN_ROOM_FILE;
+        HError err = LoadRoom(room_filename, &thisroom, AssetMgr.get(), game.IsLegacyHiRes(), game.SpriteInfos,
+            room_decode_parallel);
+        if (!err)
+        {
+            quitprintf("Unable to load the room file '%s'. Error: %s", room_filename.GetCStr(), err->FullMessage().GetCStr());
+        }
+
+        err = LoadRoomScript(&thisroom, newnum);
+        if (!err)
+        {
+            quitprintf("!Unable to load script from '%s'. Error: %s", room_filename.GetCStr(),
+                err->FullMessage().GetCStr());
+        }
     }
 
     if ((thisroom.GameID != NO_GAME_ID_IN_ROOM_FILE) &&
@@ -521,13 +539,6 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
         quitprintf("!Unable to load '%s'. This room file is assigned to a different game.", room_filename.GetCStr());
     }
 
-    err = LoadRoomScript(&thisroom, newnum);
-    if (!err)
-    {
-        quitprintf("!Unable to load script from '%s'. Error: %s", room_filename.GetCStr(),
-            err->FullMessage().GetCStr());
-    }
-
     convert_room_coordinates_to_data_res(&thisroom);
 
     set_our_eip(201);
@@ -1107,7 +1118,12 @@ void croom_ptr_clear()
 void init_room_pathfinder()
 {
     if (!room_pathfinder)
-        room_pathfinder = Pathfinding::CreateDefaultMaskPathfinder(loaded_game_file_version);
+        room_pathfinder = Pathfinding::CreateDefaultMaskPathfinder(loaded_game_file_version, usetup.PathfinderHierarchical);
+    // Assign the new room's walkable areas, letting pathfinder to prepare any
+    // additional data in advance
+    Bitmap *walk_mask = prepare_walkable_areas(-1);
+    const MaskRowStamps walk_stamps = get_walkable_areas_stamps();
+    room_pathfinder->SetWalkableArea(walk_mask, thisroom.MaskResolution, &walk_stamps);
 }
 
 void dispose_room_pathfinder()
@@ -44,6 +44,8 @@ ScriptDrawingSurface *Region_GetDrawingSurface();
 
 void  save_room_data_segment ();
 void  unload_old_room();
+// Gets the name of the room file for the given room number
+AGS::Common::String get_room_filename(int room_num);
 void  load_new_room(int newnum,CharacterInfo*forchar);
 void  new_room(int newnum,CharacterInfo*forchar);
 // Sets up a placeholder room object; this is used to avoid occasional crashes
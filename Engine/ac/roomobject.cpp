@@ -21,7 +21,6 @@
 #include "ac/runtime_defines.h"
 #include "ac/viewframe.h"
 #include "debug/debug_log.h"
-#include "main/update.h"
 #include "util/stream.h"
 #include "util/string_utils.h"
 
@@ -71,9 +70,6 @@ int RoomObject::get_baseline() const {
 void RoomObject::UpdateCyclingView(int ref_id)
 {
 	if (on != 1) return;
-    if (moving>0) {
-      do_movelist_move(moving, x, y);
-      }
     if (cycling==0) return;
     if (view == RoomObject::NoView) return;
     if (wait>0) { wait--; return; }
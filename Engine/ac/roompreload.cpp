@@ -0,0 +1,187 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "ac/roompreload.h"
+#include <atomic>
+#include <future>
+#include <mutex>
+#include "ac/game.h"
+#include "ac/gamesetupstruct.h"
+#include "ac/room.h"
+#include "core/assetmanager.h"
+#include "debug/out.h"
+#include "game/room_file.h"
+#include "script/cc_common.h"
+#include "util/thread_pool.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+extern GameSetupStruct game;
+
+// Everything the worker needs for loading a room; the streams are opened
+// by the main thread, and the rest is copied from the game data
+struct RoomPreloadRequest
+{
+    UStream RoomIn;
+    RoomFileVersion DataVersion = kRoomVersion_Undefined;
+    UStream ScriptIn;
+    bool GameIsHires = false;
+    std::vector<SpriteInfo> SpriteInfos;
+};
+
+struct PreloadedRoom
+{
+    std::unique_ptr<RoomStruct> Room;
+    String Error;
+};
+
+static ThreadPool PreloadThread;
+static bool PreloadThreadStarted = false;
+// Unpacks room images; may be used by both the main and the preload threads
+static ThreadPool DecodeThreads;
+static bool DecodeThreadsStarted = false;
+static std::mutex DecodeThreadsMutex;
+// The staged room's number, and its loading result
+static int StagedRoomNum = -1;
+static std::future<PreloadedRoom> StagedRoom;
+// Incremented on clear, tells the pending requests to skip their work
+static std::shared_ptr<std::atomic<uint32_t>> PreloadGeneration =
+    std::make_shared<std::atomic<uint32_t>>(0u);
+
+static PreloadedRoom preload_room_load(RoomPreloadRequest &req,
+    std::shared_ptr<std::atomic<uint32_t>> generation, uint32_t request_gen)
+{
+    PreloadedRoom result;
+    if (*generation != request_gen)
+        return result; // cancelled
+    std::unique_ptr<RoomStruct> room(new RoomStruct());
+    HRoomFileError err = ReadRoomData(room.get(), std::move(req.RoomIn), req.DataVersion, room_decode_parallel);
+    if (err)
+        err = UpdateRoomData(room.get(), req.DataVersion, req.GameIsHires, req.SpriteInfos);
+    if (!err)
+    {
+        result.Error = err->FullMessage();
+        return result;
+    }
+    // Separate room script replaces one from the room file, see LoadRoomScript()
+    if (req.ScriptIn)
+    {
+        PScript script(ccScript::CreateFromStream(req.ScriptIn.get()));
+        if (!script)
+        {
+            result.Error = String::FromFormat("Failed to load a script module: %s",
+                cc_get_error().ErrorString.GetCStr());
+            return result;
+        }
+        room->CompiledScript = script;
+    }
+    result.Room = std::move(room);
+    return result;
+}
+
+void preload_room(int room_num)
+{
+    if (StagedRoom.valid() && (StagedRoomNum == room_num))
+        return; // already staged
+    preload_room_clear();
+
+    const String filename = get_room_filename(room_num);
+    RoomDataSource src;
+    HRoomFileError err = OpenRoomFileFromAsset(filename, src, AssetMgr.get());
+    if (!err)
+    {
+        Debug::Printf(kDbgMsg_Warn, "Unable to preload room %d from '%s': %s",
+            room_num, filename.GetCStr(), err->FullMessage().GetCStr());
+        return;
+    }
+
+    auto req = std::make_shared<RoomPreloadRequest>();
+    req->RoomIn = std::move(src.InputStream);
+    req->DataVersion = src.DataVersion;
+    req->ScriptIn = AssetMgr->OpenAsset(String::FromFormat("room%d.o", room_num));
+    req->GameIsHires = game.IsLegacyHiRes();
+    req->SpriteInfos = game.SpriteInfos;
+
+    if (!PreloadThreadStarted)
+    {
+        PreloadThread.Start(1);
+        PreloadThreadStarted = true;
+    }
+    auto generation = PreloadGeneration;
+    const uint32_t request_gen = generation->load();
+    // std::function requires a copyable callable, so share the task
+    auto task = std::make_shared<std::packaged_task<PreloadedRoom()>>(
+        [req, generation, request_gen]() { return preload_room_load(*req, generation, request_gen); });
+    StagedRoomNum = room_num;
+    StagedRoom = task->get_future();
+    Debug::Printf(kDbgMsg_Info, "Preloading room %d", room_num);
+    PreloadThread.Enqueue([task]() { (*task)(); });
+}
+
+bool preload_room_take(int room_num, RoomStruct &room)
+{
+    if (!StagedRoom.valid())
+        return false;
+    if (StagedRoomNum != room_num)
+    {
+        preload_room_clear(); // entering another room, drop the staged one
+        return false;
+    }
+
+    PreloadedRoom result = StagedRoom.get();
+    StagedRoomNum = -1;
+    if (!result.Room)
+    {
+        Debug::Printf(kDbgMsg_Warn, "Failed to preload room %d, loading it again. Error: %s",
+            room_num, result.Error.GetCStr());
+        return false;
+    }
+    room = std::move(*result.Room);
+    return true;
+}
+
+void preload_room_clear()
+{
+    // Let the pending request finish quickly, the result is discarded
+    (*PreloadGeneration)++;
+    StagedRoom = std::future<PreloadedRoom>();
+    StagedRoomNum = -1;
+}
+
+void preload_room_shutdown()
+{
+    preload_room_clear();
+    PreloadThread.Stop();
+    PreloadThreadStarted = false;
+    std::lock_guard<std::mutex> lk(DecodeThreadsMutex);
+    DecodeThreads.Stop();
+    DecodeThreadsStarted = false;
+}
+
+void room_decode_parallel(size_t count, const std::function<void(size_t)> &job)
+{
+    {
+        std::lock_guard<std::mutex> lk(DecodeThreadsMutex);
+        if (!DecodeThreadsStarted)
+        {
+            DecodeThreads.Start(ThreadPool::GetDefaultThreadCount(MAX_ROOM_DECODE_THREADS));
+            DecodeThreadsStarted = true;
+        }
+    }
+    DecodeThreads.ParallelFor(count, 1u, [&job](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+            job(i);
+    });
+}
@@ -0,0 +1,56 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Room preloading: reads the room file and the room's script on a background
+// thread, so that the next room change does not have to wait for the disk
+// and the decompression of the room backgrounds and masks.
+//
+// The assets are opened on the calling thread, while the reading, decoding
+// and the room data fixups are done by the worker. Only one room may be
+// staged at a time: a new request replaces the previous one. The staged
+// room is taken by the next room change, and discarded if a different room
+// gets loaded.
+//
+// Room backgrounds and masks are unpacked in parallel, on a separate pool
+// of worker threads; this is used both by the preloading and by the regular
+// room loading.
+//
+// When the threads are disabled for the platform, the room is loaded right
+// away on the calling thread.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__ROOMPRELOAD_H
+#define __AGS_EE_AC__ROOMPRELOAD_H
+
+#include <functional>
+#include "game/roomstruct.h"
+
+// Max number of threads used for unpacking the room images
+const size_t MAX_ROOM_DECODE_THREADS = 4u;
+
+// Schedules loading of the given room, unless it's already staged
+void preload_room(int room_num);
+// Moves the staged room into the given room object, and clears the stage;
+// waits if the room is still being loaded. Returns false if this room was
+// not staged, or failed to load; in which case the room object is untouched.
+bool preload_room_take(int room_num, AGS::Common::RoomStruct &room);
+// Discards the staged room, and cancels the pending loading if possible
+void preload_room_clear();
+// Discards the staged room and stops the loading threads
+void preload_room_shutdown();
+// Runs the room image unpacking jobs in parallel, returns after all are done;
+// meant to be passed into ReadRoomData() and LoadRoom()
+void room_decode_parallel(size_t count, const std::function<void(size_t)> &job);
+
+#endif // __AGS_EE_AC__ROOMPRELOAD_H
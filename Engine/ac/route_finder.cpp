@@ -12,11 +12,17 @@
 //
 //=============================================================================
 #include "ac/route_finder.h"
+#include <algorithm>
+#include <map>
 #include <memory>
+#include <string.h>
 #include <allegro.h>
 #include "ac/movelist.h"
+#include "ac/route_finder_cache.h"
+#include "ac/route_finder_flowfield.h"
 #include "ac/route_finder_impl.h"
 #include "ac/route_finder_impl_legacy.h"
+#include "ac/walkable_distance_map.h"
 #include "debug/out.h"
 #include "gfx/bitmap.h"
 #include "util/memory_compat.h"
@@ -28,6 +34,19 @@ namespace AGS
 namespace Engine
 {
 
+// Point ordering, for use in the sorted containers
+struct PointLess
+{
+    bool operator()(const Point &a, const Point &b) const
+    {
+        return (a.Y < b.Y) || ((a.Y == b.Y) && (a.X < b.X));
+    }
+};
+
+MaskRouteFinder::MaskRouteFinder() = default;
+
+MaskRouteFinder::~MaskRouteFinder() = default;
+
 bool MaskRouteFinder::CanSeeFrom(int srcx, int srcy, int dstx, int dsty, int *lastcx, int *lastcy)
 {
     if (!_walkablearea)
@@ -62,9 +81,31 @@ bool MaskRouteFinder::FindRoute(std::vector<Point> &path, int srcx, int srcy, in
     dstx /= _coordScale;
     dsty /= _coordScale;
 
-    if (!FindRouteImpl(path, srcx, srcy, dstx, dsty, exact_dest, ignore_walls))
-        return false;
-    
+    // Only the routes over the mask which version is known may be cached
+    const bool use_cache = !ignore_walls && _routeCacheMask && (_walkablearea == _routeCacheMask);
+    const RouteCacheKey cache_key(Point(srcx, srcy), Point(dstx, dsty), _rowStamps.Version, exact_dest);
+    const CachedRoute *cached = use_cache ? FindCachedRoute(cache_key) : nullptr;
+    if (cached)
+    {
+        if (!cached->Found)
+            return false;
+        path = cached->Path;
+    }
+    else
+    {
+        const bool found = FindRouteImpl(path, srcx, srcy, dstx, dsty, exact_dest, ignore_walls);
+        if (use_cache)
+        {
+            CachedRoute route;
+            route.Found = found;
+            if (found)
+                route.Path = path;
+            _routeCache->Put(cache_key, std::move(route));
+        }
+        if (!found)
+            return false;
+    }
+
     // convert output from the mask coords
     for (auto &pt : path)
         pt *= _coordScale;
@@ -79,24 +120,248 @@ bool MaskRouteFinder::IsWalkableAt(int x, int y)
     return _walkablearea->GetPixel(x / _coordScale, y / _coordScale) > 0;
 }
 
-void MaskRouteFinder::SetWalkableArea(const Bitmap *walkablearea, int coord_scale)
+void MaskRouteFinder::FindRoutes(const RouteBatch &batch, std::vector<MoveList> &results)
+{
+    results.clear();
+    results.resize(batch.Requests.size());
+    if (!_walkablearea || batch.Requests.empty())
+        return;
+
+    assert(!batch.BaseMask || (batch.BaseMask->GetSize() == _walkablearea->GetSize()));
+
+    // Flow fields built for the previous batches may be reused only if the mask
+    // has not changed since; without row stamps the mask changes are unknown
+    if (!_rowStamps.Rows || (_flowFieldVersion != _rowStamps.Version))
+    {
+        for (auto &field : _flowFields)
+            field->Reset();
+        _flowFieldVersion = _rowStamps.Version;
+    }
+
+    // Requests over the common mask may use cached routes, and are grouped
+    // by their destination; the rest are left for the regular search
+    const bool use_cache = _routeCacheMask && (_walkablearea == _routeCacheMask);
+    std::vector<std::vector<Point>> paths(batch.Requests.size());
+    std::map<Point, std::vector<size_t>, PointLess> dest_groups;
+    std::vector<size_t> search;
+    for (size_t i = 0; i < batch.Requests.size(); ++i)
+    {
+        const RouteRequest &req = batch.Requests[i];
+        if (!req.Excluded.empty() || req.IgnoreWalls)
+        {
+            search.push_back(i);
+            continue;
+        }
+        const Point src(req.Src.X / _coordScale, req.Src.Y / _coordScale);
+        const Point dst(req.Dst.X / _coordScale, req.Dst.Y / _coordScale);
+        const CachedRoute *cached = use_cache ?
+            FindCachedRoute(RouteCacheKey(src, dst, _rowStamps.Version, req.ExactDest)) : nullptr;
+        if (cached)
+        {
+            if (cached->Found)
+                paths[i] = cached->Path;
+            continue;
+        }
+        dest_groups[dst].push_back(i);
+    }
+
+    // Solve the large groups using flow fields, one field per destination
+    for (const auto &group : dest_groups)
+    {
+        const FlowField *field = (group.second.size() >= MinFlowFieldRequests) ?
+            GetFlowField(group.first) : nullptr;
+        for (size_t i : group.second)
+        {
+            const RouteRequest &req = batch.Requests[i];
+            if (!field || !FindRouteFlowField(*field, paths[i], req.Src.X / _coordScale, req.Src.Y / _coordScale))
+                search.push_back(i);
+        }
+    }
+
+    if (!search.empty())
+    {
+        std::sort(search.begin(), search.end());
+        std::vector<std::vector<Point>> found_paths(search.size());
+        FindRoutesImpl(batch, search, found_paths);
+        for (size_t k = 0; k < search.size(); ++k)
+        {
+            const size_t i = search[k];
+            const RouteRequest &req = batch.Requests[i];
+            if (use_cache && req.Excluded.empty() && !req.IgnoreWalls)
+            {
+                CachedRoute route;
+                route.Found = !found_paths[k].empty();
+                route.Path = found_paths[k];
+                _routeCache->Put(RouteCacheKey(Point(req.Src.X / _coordScale, req.Src.Y / _coordScale),
+                    Point(req.Dst.X / _coordScale, req.Dst.Y / _coordScale), _rowStamps.Version, req.ExactDest),
+                    std::move(route));
+            }
+            paths[i] = std::move(found_paths[k]);
+        }
+    }
+
+    for (size_t i = 0; i < batch.Requests.size(); ++i)
+    {
+        if (paths[i].empty())
+            continue;
+        const RouteRequest &req = batch.Requests[i];
+        for (auto &pt : paths[i])
+            pt *= _coordScale;
+        Pathfinding::CalculateMoveList(results[i], paths[i], req.MoveSpeedX, req.MoveSpeedY,
+            req.IgnoreWalls ? kMoveStage_Direct : 0);
+    }
+}
+
+const FlowField *MaskRouteFinder::GetFlowField(const Point &dst)
+{
+    for (size_t i = 0; i < _flowFields.size(); ++i)
+    {
+        const FlowField &field = *_flowFields[i];
+        if (field.IsBuilt() && (field.GetMask() == _walkablearea) && (field.GetTarget() == dst))
+        {
+            std::rotate(_flowFields.begin(), _flowFields.begin() + i, _flowFields.begin() + i + 1);
+            return _flowFields.front().get();
+        }
+    }
+
+    // Build a new field in place of the least recently used one
+    if (_flowFields.size() < MaxFlowFields)
+        _flowFields.emplace_back(new FlowField());
+    std::rotate(_flowFields.begin(), _flowFields.end() - 1, _flowFields.end());
+    FlowField &field = *_flowFields.front();
+    _flowFieldBuilds++;
+    if (!field.Build(_walkablearea, dst))
+    {
+        field.Reset();
+        return nullptr;
+    }
+    return &field;
+}
+
+bool MaskRouteFinder::FindRouteFlowField(const FlowField &field, std::vector<Point> &path, int srcx, int srcy)
+{
+    // Same as FindRouteImpl, a straight line is used whenever possible
+    const Point &dst = field.GetTarget();
+    if (CanSeeFromImpl(srcx, srcy, dst.X, dst.Y))
+    {
+        path.clear();
+        path.emplace_back(srcx, srcy);
+        path.emplace_back(dst.X, dst.Y);
+        return true;
+    }
+    return field.TracePath(Point(srcx, srcy), path);
+}
+
+void MaskRouteFinder::FindRoutesImpl(const RouteBatch &batch, const std::vector<size_t> &requests,
+    std::vector<std::vector<Point>> &paths)
+{
+    // Requests with exclusions are solved over a copy of the mask,
+    // which rows are composed for each such request separately
+    const Bitmap *mask = _walkablearea;
+    std::unique_ptr<Bitmap> req_mask;
+    for (size_t k = 0; k < requests.size(); ++k)
+    {
+        const RouteRequest &req = batch.Requests[requests[k]];
+        if (!req.Excluded.empty() && batch.BaseMask)
+        {
+            if (!req_mask)
+                req_mask.reset(new Bitmap(mask->GetWidth(), mask->GetHeight(), 8));
+            for (int y = 0; y < mask->GetHeight(); ++y)
+            {
+                uint8_t *row = req_mask->GetScanLineForWriting(y);
+                if (!ComposeRequestRow(batch, req, y, row))
+                    memcpy(row, mask->GetScanLine(y), mask->GetWidth());
+            }
+            _walkablearea = req_mask.get();
+        }
+
+        if (!FindRouteImpl(paths[k], req.Src.X / _coordScale, req.Src.Y / _coordScale,
+                req.Dst.X / _coordScale, req.Dst.Y / _coordScale, req.ExactDest, req.IgnoreWalls))
+            paths[k].clear();
+        _walkablearea = mask;
+    }
+}
+
+bool MaskRouteFinder::ComposeRequestRow(const RouteBatch &batch, const RouteRequest &req,
+    int y, uint8_t *row)
+{
+    bool affected = false;
+    for (int ex : req.Excluded)
+    {
+        const Rect &r = batch.Blockers[ex];
+        if ((y >= r.Top) && (y <= r.Bottom))
+        {
+            affected = true;
+            break;
+        }
+    }
+    if (!affected)
+        return false;
+
+    const int width = batch.BaseMask->GetWidth();
+    memcpy(row, batch.BaseMask->GetScanLine(y), width);
+    for (size_t i = 0; i < batch.Blockers.size(); ++i)
+    {
+        const Rect &r = batch.Blockers[i];
+        if ((y < r.Top) || (y > r.Bottom) ||
+            (std::find(req.Excluded.begin(), req.Excluded.end(), static_cast<int>(i)) != req.Excluded.end()))
+            continue;
+        const int left = std::max(0, r.Left);
+        const int right = std::min(width - 1, r.Right);
+        if (left <= right)
+            memset(row + left, 0, right - left + 1);
+    }
+    return true;
+}
+
+void MaskRouteFinder::SetWalkableArea(const Bitmap *walkablearea, int coord_scale,
+    const MaskRowStamps *row_stamps)
 {
     _walkablearea = walkablearea;
+    _rowStamps = row_stamps ? *row_stamps : MaskRowStamps();
     assert(coord_scale > 0);
     _coordScale = std::max(1, coord_scale);
     OnSetWalkableArea();
+
+    // Cached routes remain valid only for the same mask, and only if its
+    // changes are tracked; otherwise the mask version does not tell anything
+    const Bitmap *cache_mask = (walkablearea && _rowStamps.Rows) ? walkablearea : nullptr;
+    if (_routeCache && (cache_mask != _routeCacheMask))
+        _routeCache->Clear();
+    _routeCacheMask = cache_mask;
+}
+
+void MaskRouteFinder::GetRouteCacheStats(uint32_t &hits, uint32_t &misses) const
+{
+    hits = _routeCache ? _routeCache->GetHits() : 0u;
+    misses = _routeCache ? _routeCache->GetMisses() : 0u;
+}
+
+const CachedRoute *MaskRouteFinder::FindCachedRoute(const RouteCacheKey &key)
+{
+    if (!_routeCache)
+        _routeCache.reset(new RouteCache());
+    const CachedRoute *route = _routeCache->Find(key);
+    const uint32_t lookups = _routeCache->GetLookups();
+    if (lookups % RouteCacheLogInterval == 0)
+    {
+        Debug::Printf("Route cache: %u hits of %u lookups (%.1f%%), %u bytes used",
+            _routeCache->GetHits(), lookups, 100.0 * _routeCache->GetHits() / lookups,
+            static_cast<uint32_t>(_routeCache->GetCacheSize()));
+    }
+    return route;
 }
 
 
 namespace Pathfinding
 {
 
-std::unique_ptr<MaskRouteFinder> CreateDefaultMaskPathfinder(GameDataVersion game_ver)
+std::unique_ptr<MaskRouteFinder> CreateDefaultMaskPathfinder(GameDataVersion game_ver, bool hierarchical)
 {
     if (game_ver >= kGameVersion_350) 
     {
-        Debug::Printf(MessageType::kDbgMsg_Info, "Initialize path finder");
-        return std::make_unique<JPSRouteFinder>();
+        Debug::Printf(MessageType::kDbgMsg_Info, "Initialize path finder%s", hierarchical ? " (hierarchical)" : "");
+        return std::make_unique<JPSRouteFinder>(hierarchical);
     } 
     else 
     {
@@ -301,19 +566,28 @@ void RecalculateMoveSpeeds(MoveList &mls, int old_speed_x, int old_speed_y, int
     }
 }
 
-bool FindNearestWalkablePoint(Bitmap *mask, const Point &from_pt, Point &dst_pt,
+bool FindNearestWalkablePoint(const Bitmap *mask, const Point &from_pt, Point &dst_pt,
     const int range, const int step)
 {
     return FindNearestWalkablePoint(mask, from_pt, dst_pt, RectWH(mask->GetSize()), range, step);
 }
 
-bool FindNearestWalkablePoint(Bitmap *mask, const Point &from_pt, Point &dst_pt,
-    const Rect &limits, const int range, const int step)
+// Calculates the area scanned by FindNearestWalkablePoint
+static Rect GetNearestPointScanLimits(const Bitmap *mask, const Point &from_pt, const Rect &limits, const int range)
 {
-    assert(mask->GetColorDepth() == 8);
     const Rect mask_limits = IntersectRects(limits, RectWH(mask->GetSize()));
-    const Rect use_limits = (range <= 0) ? mask_limits :
+    return (range <= 0) ? mask_limits :
         IntersectRects(mask_limits, RectWH(from_pt.X - range / 2, from_pt.Y - range / 2, range * 2, range * 2));
+}
+
+static bool ScanNearestWalkablePoint(const Bitmap *mask, const Point &from_pt, Point &dst_pt,
+    const Rect &use_limits, const int step, const int first_range);
+
+bool FindNearestWalkablePoint(const Bitmap *mask, const Point &from_pt, Point &dst_pt,
+    const Rect &limits, const int range, const int step)
+{
+    assert(mask->GetColorDepth() == 8);
+    const Rect use_limits = GetNearestPointScanLimits(mask, from_pt, limits, range);
 
     if (use_limits.IsEmpty())
         return false;
@@ -325,6 +599,14 @@ bool FindNearestWalkablePoint(Bitmap *mask, const Point &from_pt, Point &dst_pt,
         return true;
     }
 
+    return ScanNearestWalkablePoint(mask, from_pt, dst_pt, use_limits, step, 1);
+}
+
+// Scans for the nearest walkable point around the given location,
+// beginning with the given range
+static bool ScanNearestWalkablePoint(const Bitmap *mask, const Point &from_pt, Point &dst_pt,
+    const Rect &use_limits, const int step, const int first_range)
+{
     // Scan outwards from the starting point, rectangle by rectangle,
     // and measure distance between start and found point. The one with the smallest
     // distance will be accepted as a result.
@@ -339,7 +621,7 @@ bool FindNearestWalkablePoint(Bitmap *mask, const Point &from_pt, Point &dst_pt,
     int max_range = std::max(
         std::max(from_pt.X - use_limits.Left, use_limits.Right - from_pt.X),
         std::max(from_pt.Y - use_limits.Top, use_limits.Bottom - from_pt.Y));
-    for (int cur_range = 1; cur_range <= max_range; cur_range += step)
+    for (int cur_range = first_range; cur_range <= max_range; cur_range += step)
     {
         const int scan_fromx = std::max(use_limits.Left,   from_pt.X - cur_range);
         const int scan_tox   = std::min(use_limits.Right,  from_pt.X + cur_range);
@@ -374,6 +656,90 @@ bool FindNearestWalkablePoint(Bitmap *mask, const Point &from_pt, Point &dst_pt,
     return false;
 }
 
+// Tells whether the ring scan in FindNearestWalkablePoint skips the point: this
+// happens to the points on the bottom side of a ring, which top side is clipped
+// by the limits, unless they are on its (clipped) left or right side.
+static bool IsPointSkippedByRingScan(const Point &from_pt, const Point &pt, const Rect &limits)
+{
+    const int dx = std::abs(pt.X - from_pt.X);
+    const int ring = pt.Y - from_pt.Y;
+    return (ring > dx) && (from_pt.Y - ring < limits.Top) &&
+        !((pt.X == limits.Left) && (from_pt.X - ring < limits.Left)) &&
+        !((pt.X == limits.Right) && (from_pt.X + ring > limits.Right));
+}
+
+// Finds a walkable point at the given squared distance from the start, which
+// would be found first by the ring scan in FindNearestWalkablePoint: that is
+// one on the smallest ring, with the smallest x, and then smallest y.
+// Fails if there are no such points which the scan would check.
+static bool FindRingPointAtSqDistance(const Bitmap *mask, const Point &from_pt, const uint32_t sqdist,
+    const Rect &limits, Point &dst_pt)
+{
+    if (sqdist == 0u)
+    {
+        dst_pt = from_pt;
+        return true;
+    }
+
+    for (int ring = 1; static_cast<uint32_t>(ring * ring) <= sqdist; ++ring)
+    {
+        // the point is either on a vertical or horizontal side of the ring
+        const uint32_t rest = sqdist - ring * ring;
+        int other = static_cast<int>(std::sqrt(static_cast<double>(rest)));
+        while (static_cast<uint32_t>(other * other) > rest)
+            other--;
+        while (static_cast<uint32_t>((other + 1) * (other + 1)) <= rest)
+            other++;
+        if ((static_cast<uint32_t>(other * other) != rest) || (other > ring))
+            continue;
+
+        const Point offsets[] = { Point(-ring, -other), Point(-ring, other), Point(ring, -other), Point(ring, other),
+                                  Point(-other, -ring), Point(-other, ring), Point(other, -ring), Point(other, ring) };
+        bool found = false;
+        for (const auto &off : offsets)
+        {
+            const Point pt(from_pt.X + off.X, from_pt.Y + off.Y);
+            if (!limits.IsInside(pt) || (mask->GetScanLine(pt.Y)[pt.X] == 0) ||
+                IsPointSkippedByRingScan(from_pt, pt, limits))
+                continue;
+            if (!found || (pt.X < dst_pt.X) || ((pt.X == dst_pt.X) && (pt.Y < dst_pt.Y)))
+            {
+                dst_pt = pt;
+                found = true;
+            }
+        }
+        if (found)
+            return true;
+    }
+    return false;
+}
+
+bool FindNearestWalkablePoint(WalkableDistanceMap &dist_map, const Point &from_pt, Point &dst_pt,
+    const Rect &limits, const int range, const int step)
+{
+    const Bitmap *mask = dist_map.GetMask();
+    const Rect use_limits = GetNearestPointScanLimits(mask, from_pt, limits, range);
+    if (use_limits.IsEmpty())
+        return false;
+
+    if ((step != 1) || !use_limits.IsInside(from_pt))
+        return FindNearestWalkablePoint(mask, from_pt, dst_pt, limits, range, step);
+
+    // The map tells the distance to the nearest point on the whole mask;
+    // if such point is found within limits, then it's the one we need
+    const uint32_t sqdist = dist_map.GetSqDistance(from_pt.X, from_pt.Y);
+    if (sqdist == WalkableDistanceMap::NoWalkable)
+        return false;
+    if (FindRingPointAtSqDistance(mask, from_pt, sqdist, use_limits, dst_pt))
+        return true;
+    // Otherwise scan, skipping the rings which are too close to have any
+    // walkable points, i.e. where even the corners are nearer than that
+    int first_range = 1;
+    while (static_cast<uint64_t>(2 * first_range) * first_range < sqdist)
+        first_range++;
+    return ScanNearestWalkablePoint(mask, from_pt, dst_pt, use_limits, step, first_range);
+}
+
 } // namespace Pathfinding
 
 } // namespace Engine
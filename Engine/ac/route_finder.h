@@ -29,6 +29,48 @@ namespace Common { class Bitmap; }
 namespace Engine
 {
 
+class FlowField;
+class RouteCache;
+struct CachedRoute;
+struct RouteCacheKey;
+class WalkableDistanceMap;
+
+// MaskRowStamps: tells when each row of a walkable mask was modified last time,
+// letting pathfinders update their internal data only for the changed rows.
+struct MaskRowStamps
+{
+    // Mask version: the latest stamp among all rows
+    uint32_t Version = 0u;
+    // Per-row stamps, each telling the mask version when this row was modified
+    const uint32_t *Rows = nullptr;
+};
+
+// RouteRequest: a single route query for the batched search.
+struct RouteRequest
+{
+    Point Src;
+    Point Dst;
+    int MoveSpeedX = 1;
+    int MoveSpeedY = 1;
+    bool ExactDest = false;
+    bool IgnoreWalls = false;
+    // Indexes of the batch blockers which do not apply to this request,
+    // e.g. the walker's own blocking area, or ones it is already standing in
+    std::vector<int> Excluded;
+};
+
+// RouteBatch: a set of route requests, which share a walkable mask.
+struct RouteBatch
+{
+    // Walkable mask without any blockers; used to restore excluded areas.
+    // The routefinder's own mask is expected to be this mask with all
+    // of the Blockers cut out.
+    const Common::Bitmap *BaseMask = nullptr;
+    // Blocking rectangles, in mask coordinates
+    std::vector<Rect> Blockers;
+    std::vector<RouteRequest> Requests;
+};
+
 // IRouteFinder: a basic pathfinding interface.
 class IRouteFinder 
 {
@@ -56,6 +98,17 @@ public:
 class MaskRouteFinder : public IRouteFinder
 {
 public:
+    // Min number of batch requests to the same destination,
+    // which are solved using a shared flow field
+    static const size_t MinFlowFieldRequests = 3;
+    // Max number of flow fields kept for the recent common destinations
+    static const size_t MaxFlowFields = 8;
+    // Number of the route cache lookups between printing its stats to the log
+    static const uint32_t RouteCacheLogInterval = 1000u;
+
+    MaskRouteFinder();
+    ~MaskRouteFinder() override;
+
     // Traces a straight line between two points, returns if it's fully passable;
     // optionally assigns last found passable position.
     bool CanSeeFrom(int srcx, int srcy, int dstx, int dsty, int *lastcx = nullptr, int *lastcy = nullptr) override;
@@ -63,15 +116,30 @@ public:
     // exact_dest - tells to fail if the destination is inside the wall and cannot be reached;
     //              otherwise pathfinder will try to find the closest possible end point.
     // ignore_walls - tells to ignore impassable areas (builds a straight line path).
+    // Found routes are cached, so long as the walkable mask's version is known.
     bool FindRoute(std::vector<Point> &path, int srcx, int srcy, int dstx, int dsty,
         bool exact_dest = false, bool ignore_walls = false) override;
     // Tells whether the current position is walkable
     bool IsWalkableAt(int x, int y) override;
+    // Searches for routes for all the batch requests, and calculates MoveLists;
+    // results are stored in the same order as requests, a failed search leaves
+    // an empty MoveList. Implementations may solve requests in parallel.
+    // Requests heading to the same destination are solved by following
+    // a flow field, one per destination, which is kept until the walkable
+    // mask changes. Requests over the common mask use the route cache.
+    void FindRoutes(const RouteBatch &batch, std::vector<MoveList> &results);
 
     // Assign a walkable mask, and an optional coordinate scale factor which will be used
     // to convert (divide) input coordinates, and resulting path back (multiply).
     // Note that this may make routefinder to generate additional data, taking more time.
-    void SetWalkableArea(const AGS::Common::Bitmap *walkablearea, int coord_scale = 1);
+    // Optional row stamps tell which parts of the mask have changed since the previous
+    // call, otherwise the routefinder will have to assume that the whole mask did.
+    void SetWalkableArea(const AGS::Common::Bitmap *walkablearea, int coord_scale = 1,
+        const MaskRowStamps *row_stamps = nullptr);
+    // Gets the route cache's hit and miss counters
+    void GetRouteCacheStats(uint32_t &hits, uint32_t &misses) const;
+    // Gets the number of flow fields built by the batched searches
+    uint32_t GetFlowFieldBuilds() const { return _flowFieldBuilds; }
 
 protected:
     // Update the implementation after a new walkable area is set
@@ -81,9 +149,38 @@ protected:
     // FindRoute implementation
     virtual bool FindRouteImpl(std::vector<Point> &path, int srcx, int srcy, int dstx, int dsty,
         bool exact_dest, bool ignore_walls) = 0;
+    // FindRoutes implementation: finds paths for the listed batch requests,
+    // converting their coordinates to the mask coords; resulting paths are in
+    // mask coords too, and failed searches leave them empty.
+    // The default implementation solves requests one by one.
+    virtual void FindRoutesImpl(const RouteBatch &batch, const std::vector<size_t> &requests,
+        std::vector<std::vector<Point>> &paths);
+
+    // Composes the walkable mask row for the request, where only the blockers
+    // not excluded by it are cut out; returns false if the row is not affected
+    // by the request's exclusions, and may be used as is.
+    static bool ComposeRequestRow(const RouteBatch &batch, const RouteRequest &req,
+        int y, uint8_t *row);
+    // Gets the flow field leading to the destination, building one if there's
+    // no valid field yet; returns null if the destination may not be reached
+    const FlowField *GetFlowField(const Point &dst);
+    // Finds a route over the flow field towards its target (all in mask coords)
+    bool FindRouteFlowField(const FlowField &field, std::vector<Point> &path, int srcx, int srcy);
+    // Looks up the route cache, creating one if necessary, and periodically logs its stats
+    const CachedRoute *FindCachedRoute(const RouteCacheKey &key);
 
     const Common::Bitmap *_walkablearea = nullptr;
     int _coordScale = 1;
+    MaskRowStamps _rowStamps;
+    // Flow fields for the recent common destinations, most recently used first,
+    // and the mask version they were built for
+    std::vector<std::unique_ptr<FlowField>> _flowFields;
+    uint32_t _flowFieldVersion = 0u;
+    uint32_t _flowFieldBuilds = 0u;
+    // Cache of the recently found routes, and the mask it's valid for;
+    // null mask means that the mask version is not known, and cache is not used
+    std::unique_ptr<RouteCache> _routeCache;
+    const Common::Bitmap *_routeCacheMask = nullptr;
 };
 
 //
@@ -91,8 +188,10 @@ protected:
 // Manages converting navigation paths into MoveLists.
 namespace Pathfinding
 {
-    // Creates a default engine's MaskRouteFinder implementation
-    std::unique_ptr<MaskRouteFinder> CreateDefaultMaskPathfinder(GameDataVersion game_ver);
+    // Creates a default engine's MaskRouteFinder implementation;
+    // hierarchical option lets it search large masks faster, at the cost of
+    // slightly less optimal routes (not supported by the legacy pathfinder).
+    std::unique_ptr<MaskRouteFinder> CreateDefaultMaskPathfinder(GameDataVersion game_ver, bool hierarchical = false);
 
     // Find route using a provided IRouteFinder, and calculate the MoveList using move speeds
     bool FindRoute(MoveList &mls, IRouteFinder *finder, int srcx, int srcy, int dstx, int dsty,
@@ -105,10 +204,14 @@ namespace Pathfinding
     void RecalculateMoveSpeeds(MoveList &mls, int old_speed_x, int old_speed_y, int new_speed_x, int new_speed_y);
     // Searchs for the nearest walkable point on a mask, starting from the given location,
     // and scanning around in the given square range. Optionally limit the scan to the certain rectangle.
-    bool FindNearestWalkablePoint(AGS::Common::Bitmap *mask, const Point &from_pt, Point &dst_pt,
+    bool FindNearestWalkablePoint(const AGS::Common::Bitmap *mask, const Point &from_pt, Point &dst_pt,
         const int range = 0, const int step = 1);
-    bool FindNearestWalkablePoint(AGS::Common::Bitmap *mask, const Point &from_pt, Point &dst_pt,
+    bool FindNearestWalkablePoint(const AGS::Common::Bitmap *mask, const Point &from_pt, Point &dst_pt,
         const Rect &limits, const int range = 0, const int step = 0);
+    // Searchs for the nearest walkable point on the distance map's mask; gives same result
+    // as the scan above, but looks the point up in the map whenever that is possible.
+    bool FindNearestWalkablePoint(WalkableDistanceMap &dist_map, const Point &from_pt, Point &dst_pt,
+        const Rect &limits, const int range = 0, const int step = 1);
 }
 
 } // namespace Engine
@@ -0,0 +1,118 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// RouteCache: remembers the results of the recent route searches, so that
+// walkers repeating the same routes (patrols, walking between hotspots)
+// do not have to search for them again.
+//
+// Routes are keyed by the start and end points in the mask coordinates
+// (that is room coordinates quantised by the mask resolution), and the
+// version of the walkable mask, which includes the blocking areas.
+// Entries made for older mask versions are never matched again, and are
+// eventually disposed by the MRU rule.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__ROUTEFINDERCACHE_H
+#define __AGS_EE_AC__ROUTEFINDERCACHE_H
+
+#include <vector>
+#include "core/types.h"
+#include "util/geometry.h"
+#include "util/resourcecache.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+struct RouteCacheKey
+{
+    Point Src;
+    Point Dst;
+    uint32_t MaskVersion = 0u;
+    bool ExactDest = false;
+
+    RouteCacheKey() = default;
+    RouteCacheKey(const Point &src, const Point &dst, uint32_t mask_version, bool exact_dest)
+        : Src(src), Dst(dst), MaskVersion(mask_version), ExactDest(exact_dest) {}
+
+    bool operator ==(const RouteCacheKey &other) const
+    {
+        return (Src == other.Src) && (Dst == other.Dst) &&
+            (MaskVersion == other.MaskVersion) && (ExactDest == other.ExactDest);
+    }
+};
+
+struct RouteCacheKeyHash
+{
+    size_t operator()(const RouteCacheKey &key) const
+    {
+        uint32_t h = key.MaskVersion * 2654435761u;
+        h = (h ^ static_cast<uint32_t>(key.Src.X)) * 16777619u;
+        h = (h ^ static_cast<uint32_t>(key.Src.Y)) * 16777619u;
+        h = (h ^ static_cast<uint32_t>(key.Dst.X)) * 16777619u;
+        h = (h ^ static_cast<uint32_t>(key.Dst.Y)) * 16777619u;
+        return h ^ static_cast<uint32_t>(key.ExactDest);
+    }
+};
+
+// The result of a route search; failed searches are remembered too
+struct CachedRoute
+{
+    bool Found = false;
+    std::vector<Point> Path;
+};
+
+class RouteCache :
+    public Common::ResourceCache<RouteCacheKey, CachedRoute, size_t, RouteCacheKeyHash>
+{
+public:
+    // Default cache size limit, in bytes
+    static const size_t DefaultMaxSize = 256 * 1024;
+
+    RouteCache(size_t max_size = DefaultMaxSize)
+        : ResourceCache(max_size) {}
+
+    // Looks up the route, and counts the cache hits and misses;
+    // returns nullptr if there's no such route in cache
+    const CachedRoute *Find(const RouteCacheKey &key)
+    {
+        if (!Exists(key))
+        {
+            _misses++;
+            return nullptr;
+        }
+        _hits++;
+        return &Get(key);
+    }
+
+    uint32_t GetHits() const { return _hits; }
+    uint32_t GetMisses() const { return _misses; }
+    uint32_t GetLookups() const { return _hits + _misses; }
+    void ResetStats() { _hits = _misses = 0u; }
+
+private:
+    size_t CalcSize(const CachedRoute &item) override
+    {
+        return sizeof(RouteCacheKey) + sizeof(CachedRoute) + item.Path.size() * sizeof(Point);
+    }
+
+    uint32_t _hits = 0u;
+    uint32_t _misses = 0u;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_AC__ROUTEFINDERCACHE_H
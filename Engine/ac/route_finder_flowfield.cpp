@@ -0,0 +1,183 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "ac/route_finder_flowfield.h"
+#include <stdlib.h>
+#include "gfx/bitmap.h"
+
+using namespace AGS::Common;
+
+namespace AGS
+{
+namespace Engine
+{
+
+const uint32_t FlowField::Unreachable;
+const uint32_t FlowField::StraightCost;
+const uint32_t FlowField::DiagonalCost;
+
+// Neighbour offsets: 4 orthogonal, followed by 4 diagonal ones
+static const int NeighbourX[8] = { 1, -1, 0, 0, 1, -1, 1, -1 };
+static const int NeighbourY[8] = { 0, 0, 1, -1, 1, 1, -1, -1 };
+
+bool FlowField::Build(const Bitmap *mask, const Point &target)
+{
+    Reset();
+    if (!mask || !RectWH(mask->GetSize()).IsInside(target) ||
+        (mask->GetScanLine(target.Y)[target.X] == 0))
+        return false;
+
+    _mask = mask;
+    _target = target;
+    _width = mask->GetWidth();
+    _height = mask->GetHeight();
+    _cost.assign(_width * _height, Unreachable);
+
+    // Dijkstra search from the target, using a circular bucket queue:
+    // since step costs are small integers, the entries pending at any time
+    // fit in the (max step cost + 1) buckets by their cost
+    const uint32_t num_buckets = DiagonalCost + 1;
+    _buckets.resize(num_buckets);
+    for (auto &b : _buckets)
+        b.clear();
+    _cost[target.Y * _width + target.X] = 0u;
+    _buckets[0].push_back(target.Y * _width + target.X);
+    size_t pending = 1u;
+    for (uint32_t cost = 0u; pending > 0; ++cost)
+    {
+        std::vector<int> &bucket = _buckets[cost % num_buckets];
+        // NOTE: new entries are never added to the current bucket,
+        // because all steps cost less than the number of buckets
+        for (size_t i = 0; i < bucket.size(); ++i)
+        {
+            const int index = bucket[i];
+            if (_cost[index] != cost)
+                continue; // stale entry, already reached cheaper
+            const int x = index % _width, y = index / _width;
+            for (int n = 0; n < 8; ++n)
+            {
+                const int nx = x + NeighbourX[n], ny = y + NeighbourY[n];
+                if ((nx < 0) || (ny < 0) || (nx >= _width) || (ny >= _height) ||
+                    (mask->GetScanLine(ny)[nx] == 0))
+                    continue;
+                // diagonal steps may not cut the wall corners
+                if ((n >= 4) && ((mask->GetScanLine(y)[nx] == 0) || (mask->GetScanLine(ny)[x] == 0)))
+                    continue;
+                const uint32_t new_cost = cost + ((n < 4) ? StraightCost : DiagonalCost);
+                const int nindex = ny * _width + nx;
+                if (new_cost < _cost[nindex])
+                {
+                    _cost[nindex] = new_cost;
+                    _buckets[new_cost % num_buckets].push_back(nindex);
+                    pending++;
+                }
+            }
+        }
+        pending -= bucket.size();
+        bucket.clear();
+    }
+    return true;
+}
+
+void FlowField::Reset()
+{
+    _mask = nullptr;
+    _width = _height = 0;
+    std::vector<uint32_t>().swap(_cost);
+}
+
+uint32_t FlowField::GetCost(int x, int y) const
+{
+    if (!_mask || (x < 0) || (y < 0) || (x >= _width) || (y >= _height))
+        return Unreachable;
+    return _cost[y * _width + x];
+}
+
+bool FlowField::TracePath(const Point &from, std::vector<Point> &path) const
+{
+    path.clear();
+    uint32_t cost = GetCost(from.X, from.Y);
+    if (cost == Unreachable)
+        return false;
+
+    // Walk down the field, each time to the neighbour closest to the target
+    _steps.clear();
+    _steps.push_back(from);
+    Point pt = from;
+    while (cost > 0u)
+    {
+        int best = -1;
+        uint32_t best_cost = cost;
+        for (int n = 0; n < 8; ++n)
+        {
+            const uint32_t ncost = GetCost(pt.X + NeighbourX[n], pt.Y + NeighbourY[n]);
+            if ((ncost < best_cost) && ((n < 4) ||
+                ((GetCost(pt.X + NeighbourX[n], pt.Y) != Unreachable) &&
+                 (GetCost(pt.X, pt.Y + NeighbourY[n]) != Unreachable))))
+            {
+                best = n;
+                best_cost = ncost;
+            }
+        }
+        // there's always a cheaper neighbour, the one the search came from
+        if (best < 0)
+            return false;
+        pt = Point(pt.X + NeighbourX[best], pt.Y + NeighbourY[best]);
+        cost = best_cost;
+        _steps.push_back(pt);
+    }
+
+    // Skip the steps which may be passed by walking straight
+    path.push_back(_steps[0]);
+    for (size_t i = 0; i + 1 < _steps.size();)
+    {
+        size_t next = i + 1;
+        while ((next + 1 < _steps.size()) && IsLineWalkable(_steps[i], _steps[next + 1]))
+            next++;
+        path.push_back(_steps[next]);
+        i = next;
+    }
+    if (path.size() == 1)
+        path.push_back(path[0]);
+    return true;
+}
+
+bool FlowField::IsLineWalkable(const Point &from, const Point &to) const
+{
+    // Bresenham's line
+    int x = from.X, y = from.Y;
+    const int dx = abs(to.X - from.X), dy = -abs(to.Y - from.Y);
+    const int sx = (from.X < to.X) ? 1 : -1, sy = (from.Y < to.Y) ? 1 : -1;
+    int err = dx + dy;
+    for (;;)
+    {
+        if (_cost[y * _width + x] == Unreachable)
+            return false;
+        if ((x == to.X) && (y == to.Y))
+            return true;
+        const int e2 = 2 * err;
+        if (e2 >= dy)
+        {
+            err += dy;
+            x += sx;
+        }
+        if (e2 <= dx)
+        {
+            err += dx;
+            y += sy;
+        }
+    }
+}
+
+} // namespace Engine
+} // namespace AGS
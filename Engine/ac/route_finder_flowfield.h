@@ -0,0 +1,78 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// FlowField: a map of the walking distances from every walkable pixel of
+// a mask to a single target (also known as "Dijkstra map"). It's built by
+// one search starting from the target, after which a route from any point
+// is found by simply following the decreasing distances. This is useful
+// when many walkers head to the same destination.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__ROUTEFINDERFLOWFIELD_H
+#define __AGS_EE_AC__ROUTEFINDERFLOWFIELD_H
+
+#include <vector>
+#include "core/types.h"
+#include "util/geometry.h"
+
+namespace AGS
+{
+
+namespace Common { class Bitmap; }
+
+namespace Engine
+{
+
+class FlowField
+{
+public:
+    // Distance value for the pixels from which the target cannot be reached
+    static const uint32_t Unreachable = UINT32_MAX;
+    // Distance costs of the orthogonal and diagonal steps
+    static const uint32_t StraightCost = 10u;
+    static const uint32_t DiagonalCost = 14u;
+
+    // Builds the field of distances to the target over the 8-bit walkable mask;
+    // returns false if the target is outside of the mask or not walkable
+    bool Build(const Common::Bitmap *mask, const Point &target);
+    // Releases the field data
+    void Reset();
+    bool IsBuilt() const { return _mask != nullptr; }
+    const Common::Bitmap *GetMask() const { return _mask; }
+    const Point &GetTarget() const { return _target; }
+    // Gets the distance cost from the pixel to the target
+    uint32_t GetCost(int x, int y) const;
+    // Follows the field from the start point down to the target, and gives
+    // the route's waypoints, where each next one may be reached walking
+    // straight from the previous; returns false if the target is unreachable
+    bool TracePath(const Point &from, std::vector<Point> &path) const;
+
+private:
+    // Tells if the straight line between two points goes over walkable pixels only
+    bool IsLineWalkable(const Point &from, const Point &to) const;
+
+    const Common::Bitmap *_mask = nullptr;
+    Point _target;
+    int _width = 0;
+    int _height = 0;
+    std::vector<uint32_t> _cost;
+    // Search buffers
+    std::vector<std::vector<int>> _buckets;
+    mutable std::vector<Point> _steps;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_AC__ROUTEFINDERFLOWFIELD_H
@@ -0,0 +1,513 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "ac/route_finder_hpa.h"
+#include <algorithm>
+#include <assert.h>
+#include <functional>
+#include <stdlib.h>
+#include <math.h>
+#include "gfx/bitmap.h"
+#include "util/math.h"
+
+using namespace AGS::Common;
+
+namespace AGS
+{
+namespace Engine
+{
+
+// Border passages of this length or longer get a portal at each end,
+// shorter ones have a single portal in the middle
+static const int MinDoublePortalLength = 6;
+static const float DiagonalCost = 1.41421356f;
+
+static inline float Distance(const Point &a, const Point &b)
+{
+    const float dx = static_cast<float>(a.X - b.X), dy = static_cast<float>(a.Y - b.Y);
+    return sqrtf(dx * dx + dy * dy);
+}
+
+// Cost of the shortest path in 8 directions with no obstacles
+static inline float OctileDistance(const Point &a, const Point &b)
+{
+    const int dx = std::abs(a.X - b.X), dy = std::abs(a.Y - b.Y);
+    return std::max(dx, dy) + (DiagonalCost - 1.f) * std::min(dx, dy);
+}
+
+ClusterGraph::ClusterGraph(int cluster_size)
+    : _clusterSize(std::max(4, cluster_size))
+    // a single portal takes at least 2 cells (with a wall between them),
+    // and a pair of portals at least 7 cells
+    , _sideSlots(_clusterSize / 2 + 1)
+{
+}
+
+void ClusterGraph::Update(const Bitmap *mask, const MaskRowStamps &stamps)
+{
+    if ((mask != _mask) || (mask->GetWidth() != _width) || (mask->GetHeight() != _height))
+    {
+        _mask = mask;
+        _width = mask->GetWidth();
+        _height = mask->GetHeight();
+        _walk.resize(_width * _height);
+        for (int y = 0; y < _height; ++y)
+        {
+            const uint8_t *row = mask->GetScanLine(y);
+            uint8_t *walk_row = &_walk[y * _width];
+            for (int x = 0; x < _width; ++x)
+                walk_row[x] = row[x] != 0;
+        }
+        InitClusters();
+        _graphDirty = true;
+    }
+    else
+    {
+        // Check only rows which were modified since the last update,
+        // or all of them if there's no way to tell
+        for (int y = 0; y < _height; ++y)
+        {
+            if (!stamps.Rows || (stamps.Rows[y] > _version))
+                SyncRow(mask, y);
+        }
+    }
+
+    _version = stamps.Version;
+    _lastRebuilt = 0;
+    if (_graphDirty)
+        RebuildGraph();
+}
+
+void ClusterGraph::Reset()
+{
+    _mask = nullptr;
+    _width = _height = 0;
+    _clustersX = _clustersY = 0;
+    _version = 0u;
+    _graphDirty = true;
+    _walk.clear();
+    _clusters.clear();
+}
+
+Rect ClusterGraph::GetClusterBounds(const Point &pt) const
+{
+    if (_clusters.empty())
+        return Rect();
+    const Point cpt(Math::Clamp(pt.X, 0, _width - 1), Math::Clamp(pt.Y, 0, _height - 1));
+    return _clusters[GetClusterIndex(cpt)].Bounds;
+}
+
+size_t ClusterGraph::GetNodeCount() const
+{
+    size_t count = 0u;
+    for (const auto &c : _clusters)
+        for (const auto &portals : c.Portals)
+            count += portals.size();
+    return count;
+}
+
+Point ClusterGraph::GetNodePos(int cluster, int side, int portal) const
+{
+    const Cluster &c = _clusters[cluster];
+    const int off = c.Portals[side][portal];
+    switch (side)
+    {
+    case kSide_Left: return Point(c.Bounds.Left, c.Bounds.Top + off);
+    case kSide_Right: return Point(c.Bounds.Right, c.Bounds.Top + off);
+    case kSide_Top: return Point(c.Bounds.Left + off, c.Bounds.Top);
+    default: return Point(c.Bounds.Left + off, c.Bounds.Bottom);
+    }
+}
+
+void ClusterGraph::InitClusters()
+{
+    const int csize = _clusterSize;
+    _clustersX = (_width + csize - 1) / csize;
+    _clustersY = (_height + csize - 1) / csize;
+    _clusters.clear();
+    _clusters.resize(_clustersX * _clustersY);
+    for (int cy = 0; cy < _clustersY; ++cy)
+    {
+        for (int cx = 0; cx < _clustersX; ++cx)
+        {
+            const int x = cx * csize, y = cy * csize;
+            _clusters[cy * _clustersX + cx].Bounds =
+                RectWH(x, y, std::min(csize, _width - x), std::min(csize, _height - y));
+        }
+    }
+}
+
+void ClusterGraph::SyncRow(const Bitmap *mask, int y)
+{
+    const uint8_t *row = mask->GetScanLine(y);
+    uint8_t *walk_row = &_walk[y * _width];
+    Cluster *cluster_row = &_clusters[(y / _clusterSize) * _clustersX];
+    for (int x = 0; x < _width; ++x)
+    {
+        const uint8_t walk = row[x] != 0;
+        if (walk_row[x] != walk)
+        {
+            walk_row[x] = walk;
+            cluster_row[x / _clusterSize].Dirty = true;
+            _graphDirty = true;
+        }
+    }
+}
+
+void ClusterGraph::RebuildGraph()
+{
+    // Find portals on the borders of the changed clusters; this may also
+    // change portals of their neighbours
+    for (int cy = 0; cy < _clustersY; ++cy)
+    {
+        for (int cx = 0; cx < _clustersX; ++cx)
+        {
+            const int index = cy * _clustersX + cx;
+            Cluster &c = _clusters[index];
+            if (!c.Dirty)
+                continue;
+            if (cx > 0)
+                FindPortals(index - 1, index, false);
+            if (cx < _clustersX - 1)
+                FindPortals(index, index + 1, false);
+            if (cy > 0)
+                FindPortals(index - _clustersX, index, true);
+            if (cy < _clustersY - 1)
+                FindPortals(index, index + _clustersX, true);
+            c.CostsDirty = true;
+        }
+    }
+
+    for (auto &c : _clusters)
+    {
+        if (c.CostsDirty)
+        {
+            CalcClusterCosts(c);
+            _lastRebuilt++;
+        }
+        c.Dirty = false;
+    }
+    _graphDirty = false;
+}
+
+void ClusterGraph::FindPortals(int cluster1, int cluster2, bool vertical)
+{
+    // vertical - second cluster is below the first one, otherwise to the right
+    Cluster &c1 = _clusters[cluster1];
+    Cluster &c2 = _clusters[cluster2];
+    const Rect &b1 = c1.Bounds;
+    const Rect &b2 = c2.Bounds;
+    const int border_len = vertical ? b1.GetWidth() : b1.GetHeight();
+
+    std::vector<int> portals;
+    int run_start = -1;
+    for (int i = 0; i <= border_len; ++i)
+    {
+        // passage must be walkable on both sides
+        const bool open = (i < border_len) &&
+            (vertical ? (IsWalkable(b1.Left + i, b1.Bottom) && IsWalkable(b1.Left + i, b2.Top)) :
+                        (IsWalkable(b1.Right, b1.Top + i) && IsWalkable(b2.Left, b1.Top + i)));
+        if (open && (run_start < 0))
+            run_start = i;
+        if (open || (run_start < 0))
+            continue;
+
+        const int run_end = i - 1;
+        if (run_end - run_start + 1 >= MinDoublePortalLength)
+        {
+            portals.push_back(run_start);
+            portals.push_back(run_end);
+        }
+        else
+        {
+            portals.push_back((run_start + run_end) / 2);
+        }
+        run_start = -1;
+    }
+    assert(portals.size() <= static_cast<size_t>(_sideSlots));
+
+    std::vector<int> &portals1 = c1.Portals[vertical ? kSide_Bottom : kSide_Right];
+    std::vector<int> &portals2 = c2.Portals[vertical ? kSide_Top : kSide_Left];
+    if (portals1 != portals)
+    {
+        portals1 = portals;
+        c1.CostsDirty = true;
+    }
+    if (portals2 != portals)
+    {
+        portals2 = std::move(portals);
+        c2.CostsDirty = true;
+    }
+}
+
+void ClusterGraph::CalcClusterCosts(Cluster &c)
+{
+    const int cluster = static_cast<int>(&c - &_clusters.front());
+    _nodePos.clear();
+    for (int side = 0; side < kNumSides; ++side)
+    {
+        c.SideStart[side] = static_cast<int>(_nodePos.size());
+        for (size_t i = 0; i < c.Portals[side].size(); ++i)
+            _nodePos.push_back(GetNodePos(cluster, side, static_cast<int>(i)));
+    }
+    c.SideStart[kNumSides] = static_cast<int>(_nodePos.size());
+
+    const size_t node_count = _nodePos.size();
+    c.Costs.assign(node_count * node_count, INFINITY);
+    // in a cluster without walls the costs are simply the octile distances
+    const bool is_open = IsOpen(c.Bounds);
+    for (size_t i = 0; i < node_count; ++i)
+    {
+        if (is_open)
+        {
+            for (size_t j = 0; j < node_count; ++j)
+                c.Costs[i * node_count + j] = OctileDistance(_nodePos[i], _nodePos[j]);
+            continue;
+        }
+
+        c.Costs[i * node_count + i] = 0.f;
+        if (i + 1 == node_count)
+            break;
+        SearchLocal(_search, c.Bounds, _nodePos[i], &_nodePos[i + 1], node_count - i - 1);
+        for (size_t j = i + 1; j < node_count; ++j)
+        {
+            const float cost = GetLocalCost(_search, c.Bounds, _nodePos[j]);
+            c.Costs[i * node_count + j] = cost;
+            c.Costs[j * node_count + i] = cost;
+        }
+    }
+    c.CostsDirty = false;
+}
+
+bool ClusterGraph::IsOpen(const Rect &bounds) const
+{
+    for (int y = bounds.Top; y <= bounds.Bottom; ++y)
+    {
+        const uint8_t *walk_row = &_walk[y * _width];
+        for (int x = bounds.Left; x <= bounds.Right; ++x)
+        {
+            if (!walk_row[x])
+                return false;
+        }
+    }
+    return true;
+}
+
+void ClusterGraph::SearchLocal(SearchContext &ctx, const Rect &bounds, const Point &from,
+    const Point *targets, size_t target_count) const
+{
+    // Dijkstra search, moving in 8 directions, but not cutting the wall corners
+    const int w = bounds.GetWidth(), h = bounds.GetHeight();
+    std::vector<float> &local_dist = ctx.LocalDist;
+    std::vector<OpenEntry> &local_open = ctx.LocalOpen;
+    std::vector<uint16_t> &local_targets = ctx.LocalTargets;
+    local_dist.assign(w * h, INFINITY);
+    if (!IsWalkable(from.X, from.Y))
+        return;
+
+    // if targets are given, then stop as soon as all of them are reached
+    if (targets)
+    {
+        local_targets.assign(w * h, 0);
+        for (size_t i = 0; i < target_count; ++i)
+            local_targets[(targets[i].Y - bounds.Top) * w + (targets[i].X - bounds.Left)]++;
+    }
+
+    local_open.clear();
+    const int from_index = (from.Y - bounds.Top) * w + (from.X - bounds.Left);
+    local_dist[from_index] = 0.f;
+    local_open.push_back(OpenEntry(0.f, from_index));
+    while (!local_open.empty())
+    {
+        std::pop_heap(local_open.begin(), local_open.end(), std::greater<OpenEntry>());
+        const OpenEntry e = local_open.back();
+        local_open.pop_back();
+        if (e.first > local_dist[e.second])
+            continue; // outdated entry
+        if (targets && local_targets[e.second])
+        {
+            target_count -= local_targets[e.second];
+            local_targets[e.second] = 0;
+            if (target_count == 0)
+                break;
+        }
+
+        const int lx = e.second % w, ly = e.second / w;
+        const int x = lx + bounds.Left, y = ly + bounds.Top;
+        for (int dy = -1; dy <= 1; ++dy)
+        {
+            if ((unsigned)(ly + dy) >= (unsigned)h)
+                continue;
+            for (int dx = -1; dx <= 1; ++dx)
+            {
+                if ((dx == 0 && dy == 0) || ((unsigned)(lx + dx) >= (unsigned)w))
+                    continue;
+                if (!IsWalkable(x + dx, y + dy))
+                    continue;
+                const bool diagonal = (dx != 0) && (dy != 0);
+                if (diagonal && !IsWalkable(x + dx, y) && !IsWalkable(x, y + dy))
+                    continue;
+                const float dist = e.first + (diagonal ? DiagonalCost : 1.f);
+                const int index = e.second + dy * w + dx;
+                if (dist < local_dist[index])
+                {
+                    local_dist[index] = dist;
+                    local_open.push_back(OpenEntry(dist, index));
+                    std::push_heap(local_open.begin(), local_open.end(), std::greater<OpenEntry>());
+                }
+            }
+        }
+    }
+}
+
+void ClusterGraph::OpenNode(SearchContext &ctx, int node, float cost, int prev, const Point &pos, const Point &dst)
+{
+    if ((ctx.SearchId[node] == ctx.CurSearchId) && (ctx.Cost[node] <= cost))
+        return;
+    ctx.SearchId[node] = ctx.CurSearchId;
+    ctx.Cost[node] = cost;
+    ctx.Prev[node] = prev;
+    ctx.Open.push_back(OpenEntry(cost + Distance(pos, dst), node));
+    std::push_heap(ctx.Open.begin(), ctx.Open.end(), std::greater<OpenEntry>());
+}
+
+bool ClusterGraph::FindPath(const Point &src, const Point &dst, std::vector<Point> &path)
+{
+    return FindPath(src, dst, path, _search);
+}
+
+bool ClusterGraph::FindPath(const Point &src, const Point &dst, std::vector<Point> &path, SearchContext &ctx) const
+{
+    path.clear();
+    const Rect map_rc = RectWH(0, 0, _width, _height);
+    if (!map_rc.IsInside(src) || !map_rc.IsInside(dst) ||
+        !IsWalkable(src.X, src.Y) || !IsWalkable(dst.X, dst.Y))
+        return false;
+
+    const int src_index = GetClusterIndex(src);
+    const int dst_index = GetClusterIndex(dst);
+    const Cluster &src_cluster = _clusters[src_index];
+    const Cluster &dst_cluster = _clusters[dst_index];
+    SearchLocal(ctx, src_cluster.Bounds, src);
+    if ((src_index == dst_index) && (GetLocalCost(ctx, src_cluster.Bounds, dst) < INFINITY))
+    {
+        path.push_back(src);
+        path.push_back(dst);
+        return true;
+    }
+
+    // A* search over the abstract graph; start is connected to the nodes
+    // of its own cluster, and the nodes of the destination's cluster
+    // are connected to the goal, with the costs found by local searches
+    // the node buffers are (re)allocated whenever the clusters change
+    const size_t max_nodes = _clusters.size() * kNumSides * _sideSlots;
+    if (ctx.SearchId.size() != max_nodes)
+    {
+        ctx.Cost.resize(max_nodes);
+        ctx.Prev.resize(max_nodes);
+        ctx.SearchId.assign(max_nodes, 0u);
+        ctx.CurSearchId = 0u;
+    }
+    if (++ctx.CurSearchId == 0u)
+    {
+        std::fill(ctx.SearchId.begin(), ctx.SearchId.end(), 0u);
+        ctx.CurSearchId = 1u;
+    }
+    ctx.Open.clear();
+    for (int side = 0; side < kNumSides; ++side)
+    {
+        for (size_t i = 0; i < src_cluster.Portals[side].size(); ++i)
+        {
+            const Point pos = GetNodePos(src_index, side, static_cast<int>(i));
+            const float cost = GetLocalCost(ctx, src_cluster.Bounds, pos);
+            if (cost < INFINITY)
+                OpenNode(ctx, MakeNodeId(src_index, side, static_cast<int>(i)), cost, -1, pos, dst);
+        }
+    }
+
+    SearchLocal(ctx, dst_cluster.Bounds, dst);
+    ctx.GoalCost.clear();
+    for (int side = 0; side < kNumSides; ++side)
+    {
+        for (size_t i = 0; i < dst_cluster.Portals[side].size(); ++i)
+            ctx.GoalCost.push_back(GetLocalCost(ctx, dst_cluster.Bounds, GetNodePos(dst_index, side, static_cast<int>(i))));
+    }
+
+    static const int NeighbourSide[kNumSides] = { kSide_Right, kSide_Left, kSide_Bottom, kSide_Top };
+    const int neighbour_offset[kNumSides] = { -1, 1, -_clustersX, _clustersX };
+    float best_cost = INFINITY;
+    int best_node = -1;
+    while (!ctx.Open.empty())
+    {
+        std::pop_heap(ctx.Open.begin(), ctx.Open.end(), std::greater<OpenEntry>());
+        const OpenEntry e = ctx.Open.back();
+        ctx.Open.pop_back();
+        if (e.first >= best_cost)
+            break; // cannot find anything better
+        const int node = e.second;
+        const int cluster = node / (kNumSides * _sideSlots);
+        const int side = (node / _sideSlots) % kNumSides;
+        const int portal = node % _sideSlots;
+        const Point pos = GetNodePos(cluster, side, portal);
+        const float cost = ctx.Cost[node];
+        if (e.first > cost + Distance(pos, dst))
+            continue; // outdated entry
+
+        const Cluster &c = _clusters[cluster];
+        const int node_count = c.SideStart[kNumSides];
+        const int i = c.SideStart[side] + portal;
+        if ((cluster == dst_index) && (cost + ctx.GoalCost[i] < best_cost))
+        {
+            best_cost = cost + ctx.GoalCost[i];
+            best_node = node;
+        }
+
+        // cross the border to the paired node of the neighbour cluster
+        const int next_cluster = cluster + neighbour_offset[side];
+        const int next_side = NeighbourSide[side];
+        OpenNode(ctx, MakeNodeId(next_cluster, next_side, portal), cost + 1.f, node,
+            GetNodePos(next_cluster, next_side, portal), dst);
+        // move to the other nodes of the same cluster
+        for (int next = 0; next < kNumSides; ++next)
+        {
+            for (int j = c.SideStart[next]; j < c.SideStart[next + 1]; ++j)
+            {
+                const float edge_cost = c.Costs[i * node_count + j];
+                if ((j == i) || (edge_cost == INFINITY))
+                    continue;
+                const int next_portal = j - c.SideStart[next];
+                OpenNode(ctx, MakeNodeId(cluster, next, next_portal), cost + edge_cost, node,
+                    GetNodePos(cluster, next, next_portal), dst);
+            }
+        }
+    }
+
+    if (best_node < 0)
+        return false;
+
+    path.push_back(dst);
+    for (int node = best_node; node >= 0; node = ctx.Prev[node])
+    {
+        const Point pos = GetNodePos(node / (kNumSides * _sideSlots),
+            (node / _sideSlots) % kNumSides, node % _sideSlots);
+        if (pos != path.back())
+            path.push_back(pos);
+    }
+    if (path.back() != src)
+        path.push_back(src);
+    std::reverse(path.begin(), path.end());
+    return true;
+}
+
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,174 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// ClusterGraph: an abstract graph for the hierarchical pathfinding (HPA*).
+//
+// The walkable mask is divided into square clusters. Along each border
+// between the neighbouring clusters the walkable passages are found, and
+// "portal" nodes are placed at them. Within each cluster the path costs
+// between every pair of its nodes are precalculated. The route search may
+// then run over this small graph first, and the precise path has to be
+// found only between consecutive nodes of the abstract path, which lie
+// within same cluster, or a pair of adjacent ones.
+//
+// The graph keeps a copy of the mask, and when updated, recalculates only
+// those clusters which contents or portals have changed.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__ROUTEFINDERHPA_H
+#define __AGS_EE_AC__ROUTEFINDERHPA_H
+
+#include <vector>
+#include "ac/route_finder.h"
+#include "util/geometry.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+class ClusterGraph
+{
+public:
+    // Default cluster size, in mask pixels
+    static const int DefaultClusterSize = 32;
+
+    // Open list entry: estimated cost and index
+    typedef std::pair<float, int> OpenEntry;
+
+    // Scratch data of the path search; searches which use separate
+    // contexts may run in parallel, so long as the graph is not updated
+    struct SearchContext
+    {
+        // Local search buffers
+        std::vector<float> LocalDist;
+        std::vector<OpenEntry> LocalOpen;
+        std::vector<uint16_t> LocalTargets;
+        // Abstract search buffers, indexed by node id; the search id tells
+        // which of the entries are valid for the current search
+        std::vector<float> Cost;
+        std::vector<int> Prev;
+        std::vector<uint32_t> SearchId;
+        uint32_t CurSearchId = 0u;
+        std::vector<OpenEntry> Open;
+        std::vector<float> GoalCost;
+    };
+
+    ClusterGraph(int cluster_size = DefaultClusterSize);
+
+    // Builds the graph for the given walkable mask, or updates existing one
+    // if it's the same mask as before. If row stamps are provided, then only
+    // rows changed since the last update are checked.
+    void Update(const Common::Bitmap *mask, const MaskRowStamps &stamps);
+    // Clears the graph
+    void Reset();
+    // Finds an abstract path between two walkable points on the mask; fills
+    // a list of waypoints, beginning with src and ending with dst, where each
+    // pair of consecutive points lie within one or two adjacent clusters.
+    bool FindPath(const Point &src, const Point &dst, std::vector<Point> &path);
+    // Finds an abstract path, using the given search context
+    bool FindPath(const Point &src, const Point &dst, std::vector<Point> &path, SearchContext &ctx) const;
+    // Gets the bounds of the cluster which contains the given point
+    Rect GetClusterBounds(const Point &pt) const;
+
+    int GetClusterSize() const { return _clusterSize; }
+    // Gets the total number of portal nodes
+    size_t GetNodeCount() const;
+    // Gets the number of clusters which had their paths recalculated by the last update
+    int GetLastRebuiltClusters() const { return _lastRebuilt; }
+
+private:
+    // Cluster sides, portal nodes are grouped by these
+    enum ClusterSide
+    {
+        kSide_Left,
+        kSide_Right,
+        kSide_Top,
+        kSide_Bottom,
+        kNumSides
+    };
+
+    struct Cluster
+    {
+        Rect Bounds;
+        // Portal offsets along each side, relative to the cluster's top-left
+        std::vector<int> Portals[kNumSides];
+        // Index of the first node of each side in the list of cluster nodes
+        int SideStart[kNumSides + 1] = {};
+        // Path costs between each pair of cluster nodes
+        std::vector<float> Costs;
+        // Cluster contents have changed
+        bool Dirty = true;
+        // Portals have changed, and the costs must be recalculated
+        bool CostsDirty = true;
+    };
+
+    inline bool IsWalkable(int x, int y) const { return _walk[y * _width + x] != 0; }
+    inline int GetClusterIndex(const Point &pt) const
+        { return (pt.Y / _clusterSize) * _clustersX + (pt.X / _clusterSize); }
+    // Node id is made of the cluster index, side and portal index on that side;
+    // this keeps ids of the unchanged portals when the neighbours are updated
+    inline int MakeNodeId(int cluster, int side, int portal) const
+        { return (cluster * kNumSides + side) * _sideSlots + portal; }
+    // Gets node's position on the mask
+    Point GetNodePos(int cluster, int side, int portal) const;
+
+    // Creates the clusters for the new mask size
+    void InitClusters();
+    // Compares the mask row with the saved copy, marks the changed clusters
+    void SyncRow(const Common::Bitmap *mask, int y);
+    // Finds portals on the sides of changed clusters,
+    // and recalculates paths in the clusters which portals have changed
+    void RebuildGraph();
+    // Finds portals on the border between two neighbouring clusters
+    void FindPortals(int cluster1, int cluster2, bool horizontal);
+    // Recalculates path costs between the cluster nodes
+    void CalcClusterCosts(Cluster &c);
+    // Tells whether the area has no walls
+    bool IsOpen(const Rect &bounds) const;
+    // Finds path costs from the given point to the cells of a cluster;
+    // if the targets are given, then stops when all of these are reached
+    void SearchLocal(SearchContext &ctx, const Rect &bounds, const Point &from,
+        const Point *targets = nullptr, size_t target_count = 0) const;
+    // Gets the path cost to the point, found by the last local search
+    static inline float GetLocalCost(const SearchContext &ctx, const Rect &bounds, const Point &pt)
+        { return ctx.LocalDist[(pt.Y - bounds.Top) * bounds.GetWidth() + (pt.X - bounds.Left)]; }
+    // Updates the node's cost in the abstract search, and adds it to the open list
+    static void OpenNode(SearchContext &ctx, int node, float cost, int prev, const Point &pos, const Point &dst);
+
+    int _clusterSize = DefaultClusterSize;
+    // Max number of portals per cluster side
+    int _sideSlots = 0;
+    const Common::Bitmap *_mask = nullptr;
+    int _width = 0;
+    int _height = 0;
+    int _clustersX = 0;
+    int _clustersY = 0;
+    uint32_t _version = 0u;
+    bool _graphDirty = true;
+    int _lastRebuilt = 0;
+    // Copy of the mask: 1 for walkable cells, 0 for walls
+    std::vector<uint8_t> _walk;
+    std::vector<Cluster> _clusters;
+
+    // Node positions of the cluster which costs are calculated
+    std::vector<Point> _nodePos;
+    // Search context used by the graph updates, and by default path searches
+    SearchContext _search;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_AC__ROUTEFINDERHPA_H
@@ -16,9 +16,12 @@
 //
 //=============================================================================
 #include <algorithm>
+#include <atomic>
 #include "ac/route_finder_impl.h"
+#include "ac/route_finder_hpa.h"
 #include "ac/route_finder_jps.inl"
 #include "gfx/bitmap.h"
+#include "util/thread_pool.h"
 
 using namespace AGS::Common;
 
@@ -29,41 +32,124 @@ namespace AGS
 namespace Engine
 {
 
-JPSRouteFinder::JPSRouteFinder()
-    : nav(*new Navigation())
+struct JPSRouteFinder::SearchContext
 {
-}
+    // Navigation grid, which rows point to the walkable mask,
+    // except those composed for the current batch request
+    Navigation Nav;
+    std::vector<int> Path, CPath;
+    std::vector<Point> AbstractPath;
+    std::vector<Point> RefinedPath;
+    ClusterGraph::SearchContext Clusters;
+    // Walkable mask which the navigation grid was synced with last time
+    const Bitmap *NavMask = nullptr;
+    Size NavSize;
+    uint32_t NavVersion = 0u;
+    // Indexes of the rows composed for the current request, and their contents
+    std::vector<int> ReqRows;
+    std::vector<uint8_t> ReqRowData;
+};
 
-JPSRouteFinder::~JPSRouteFinder()
+JPSRouteFinder::JPSRouteFinder(bool hierarchical)
+    : _search(new SearchContext())
 {
-    delete &nav;
+    if (hierarchical)
+        _clusters.reset(new ClusterGraph());
 }
 
+JPSRouteFinder::~JPSRouteFinder() = default;
+
 void JPSRouteFinder::Configure(GameDataVersion /*game_ver*/)
 {
 }
 
 void JPSRouteFinder::OnSetWalkableArea()
 {
+    // the cluster graph is updated right away, as it may take time
+    if (_walkablearea && UseClusters())
+        _clusters->Update(_walkablearea, _rowStamps);
+}
+
+void JPSRouteFinder::SyncNavWalkablearea(SearchContext &ctx) const
+{
+    Navigation &nav = ctx.Nav;
+    const Size mask_size = _walkablearea->GetSize();
+    const uint32_t *row_stamps = _rowStamps.Rows;
+    if ((ctx.NavMask != _walkablearea) || (ctx.NavSize != mask_size) || !row_stamps)
+    {
+        // New mask, or unknown changes: resync all rows
+        nav.Resize(mask_size.Width, mask_size.Height);
+        for (int y = 0; y < mask_size.Height; y++)
+            nav.SetMapRow(y, _walkablearea->GetScanLine(y));
+    }
+    else if (ctx.NavVersion != _rowStamps.Version)
+    {
+        // Same mask, update only the rows modified since the last sync
+        for (int y = 0; y < mask_size.Height; y++)
+        {
+            if (row_stamps[y] > ctx.NavVersion)
+                nav.SetMapRow(y, _walkablearea->GetScanLine(y));
+        }
+    }
+    ctx.NavMask = _walkablearea;
+    ctx.NavSize = mask_size;
+    ctx.NavVersion = _rowStamps.Version;
 }
 
-void JPSRouteFinder::SyncNavWalkablearea()
+void JPSRouteFinder::SetRequestRows(SearchContext &ctx, const RouteBatch &batch, const RouteRequest &req) const
 {
-    // FIXME: this is dumb, but...
-    nav.Resize(_walkablearea->GetWidth(), _walkablearea->GetHeight());
+    ctx.ReqRows.clear();
+    if (!batch.BaseMask)
+        return;
 
-    for (int y = 0; y < _walkablearea->GetHeight(); y++)
-        nav.SetMapRow(y, _walkablearea->GetScanLine(y));
+    const int width = _walkablearea->GetWidth();
+    const int height = _walkablearea->GetHeight();
+    for (int ex : req.Excluded)
+    {
+        const Rect &r = batch.Blockers[ex];
+        for (int y = std::max(0, r.Top); y <= std::min(height - 1, r.Bottom); ++y)
+            ctx.ReqRows.push_back(y);
+    }
+    std::sort(ctx.ReqRows.begin(), ctx.ReqRows.end());
+    ctx.ReqRows.erase(std::unique(ctx.ReqRows.begin(), ctx.ReqRows.end()), ctx.ReqRows.end());
+    ctx.ReqRowData.resize(ctx.ReqRows.size() * width);
+    for (size_t i = 0; i < ctx.ReqRows.size(); ++i)
+    {
+        uint8_t *row = &ctx.ReqRowData[i * width];
+        ComposeRequestRow(batch, req, ctx.ReqRows[i], row);
+        ctx.Nav.SetMapRow(ctx.ReqRows[i], row);
+    }
+}
+
+void JPSRouteFinder::ResetRequestRows(SearchContext &ctx) const
+{
+    for (int y : ctx.ReqRows)
+        ctx.Nav.SetMapRow(y, _walkablearea->GetScanLine(y));
+    ctx.ReqRows.clear();
+}
+
+const uint8_t *JPSRouteFinder::GetMaskRow(const SearchContext &ctx, int y) const
+{
+    const auto it = std::lower_bound(ctx.ReqRows.begin(), ctx.ReqRows.end(), y);
+    if ((it != ctx.ReqRows.end()) && (*it == y))
+        return &ctx.ReqRowData[(it - ctx.ReqRows.begin()) * _walkablearea->GetWidth()];
+    return _walkablearea->GetScanLine(y);
 }
 
 bool JPSRouteFinder::CanSeeFromImpl(int srcx, int srcy, int dstx, int dsty, int *lastcx, int *lastcy)
+{
+    SyncNavWalkablearea(*_search);
+    return CanSeeFromImpl(*_search, srcx, srcy, dstx, dsty, lastcx, lastcy);
+}
+
+bool JPSRouteFinder::CanSeeFromImpl(SearchContext &ctx, int srcx, int srcy, int dstx, int dsty,
+    int *lastcx, int *lastcy) const
 {
     bool result = false;
     int last_valid_x = srcx, last_valid_y = srcy;
     if ((srcx != dstx) || (srcy != dsty))
     {
-        SyncNavWalkablearea();
-        result = !nav.TraceLine(srcx, srcy, dstx, dsty, last_valid_x, last_valid_y);
+        result = !ctx.Nav.TraceLine(srcx, srcy, dstx, dsty, last_valid_x, last_valid_y);
     }
     if (lastcx)
         *lastcx = last_valid_x;
@@ -72,47 +158,121 @@ bool JPSRouteFinder::CanSeeFromImpl(int srcx, int srcy, int dstx, int dsty, int
     return result;
 }
 
-bool JPSRouteFinder::FindRouteJPS(std::vector<Point> &nav_path, int fromx, int fromy, int destx, int desty)
+bool JPSRouteFinder::FindRouteJPS(SearchContext &ctx, std::vector<Point> &nav_path,
+    int fromx, int fromy, int destx, int desty) const
 {
-    if (!_walkablearea)
-        return false;
-
-    SyncNavWalkablearea();
+    // NOTE: the cluster graph is built for the common mask, and does not
+    // account for the rows composed for a batch request
+    if (ctx.ReqRows.empty() && UseClusters() && FindRouteHierarchical(ctx, nav_path, fromx, fromy, destx, desty))
+        return true;
 
-    path.clear();
-    cpath.clear();
+    Navigation &nav = ctx.Nav;
+    ctx.Path.clear();
+    ctx.CPath.clear();
 
-    if (nav.NavigateRefined(fromx, fromy, destx, desty, path, cpath) == Navigation::NAV_UNREACHABLE)
+    if (nav.NavigateRefined(fromx, fromy, destx, desty, ctx.Path, ctx.CPath) == Navigation::NAV_UNREACHABLE)
         return false;
 
     nav_path.clear();
 
-    for (size_t i = 0; i < cpath.size(); i++)
+    for (size_t i = 0; i < ctx.CPath.size(); i++)
     {
         int x, y;
-        nav.UnpackSquare(cpath[i], x, y);
+        nav.UnpackSquare(ctx.CPath[i], x, y);
         nav_path.emplace_back( x, y );
     }
 
     return true;
 }
 
+bool JPSRouteFinder::UseClusters() const
+{
+    // small masks are faster to search directly
+    if (!_clusters)
+        return false;
+    const int min_size = _clusters->GetClusterSize() * 2;
+    return (_walkablearea->GetWidth() > min_size) || (_walkablearea->GetHeight() > min_size);
+}
+
+bool JPSRouteFinder::FindRouteHierarchical(SearchContext &ctx, std::vector<Point> &nav_path,
+    int fromx, int fromy, int destx, int desty) const
+{
+    // NOTE: unreachable destinations are left for the plain search,
+    // which finds the closest reachable point
+    std::vector<Point> &abstract_path = ctx.AbstractPath;
+    std::vector<Point> &refined_path = ctx.RefinedPath;
+    if (!_clusters->FindPath(Point(fromx, fromy), Point(destx, desty), abstract_path, ctx.Clusters))
+        return false;
+
+    // Refine each abstract step, restricting the search to the clusters it crosses
+    Navigation &nav = ctx.Nav;
+    refined_path.clear();
+    refined_path.push_back(abstract_path[0]);
+    bool refined = true;
+    for (size_t i = 1; i < abstract_path.size() && refined; ++i)
+    {
+        const Point &from = abstract_path[i - 1];
+        const Point &to = abstract_path[i];
+        const Rect from_rc = _clusters->GetClusterBounds(from);
+        const Rect to_rc = _clusters->GetClusterBounds(to);
+        nav.SetBounds(std::min(from_rc.Left, to_rc.Left), std::min(from_rc.Top, to_rc.Top),
+            std::max(from_rc.Right, to_rc.Right), std::max(from_rc.Bottom, to_rc.Bottom));
+
+        ctx.Path.clear();
+        ctx.CPath.clear();
+        refined = (nav.NavigateRefined(from.X, from.Y, to.X, to.Y, ctx.Path, ctx.CPath) != Navigation::NAV_UNREACHABLE) &&
+            !ctx.CPath.empty() && (ctx.CPath.back() == Navigation::PackSquare(to.X, to.Y));
+        for (size_t j = 1; j < ctx.CPath.size() && refined; ++j)
+        {
+            int x, y;
+            nav.UnpackSquare(ctx.CPath[j], x, y);
+            refined_path.emplace_back(x, y);
+        }
+    }
+    nav.ResetBounds();
+    if (!refined)
+        return false;
+
+    // Skip the waypoints which may be passed by walking straight
+    nav_path.clear();
+    nav_path.push_back(refined_path[0]);
+    for (size_t i = 0; i + 1 < refined_path.size();)
+    {
+        const Point &from = refined_path[i];
+        size_t next = i + 1;
+        while ((next + 1 < refined_path.size()) &&
+               !nav.TraceLine(from.X, from.Y, refined_path[next + 1].X, refined_path[next + 1].Y))
+            next++;
+        nav_path.push_back(refined_path[next]);
+        i = next;
+    }
+    return true;
+}
+
 bool JPSRouteFinder::FindRouteImpl(std::vector<Point> &nav_path, int srcx, int srcy, int dstx, int dsty,
     bool exact_dest, bool ignore_walls)
+{
+    SyncNavWalkablearea(*_search);
+    return FindRouteImpl(*_search, nav_path, srcx, srcy, dstx, dsty, exact_dest, ignore_walls);
+}
+
+bool JPSRouteFinder::FindRouteImpl(SearchContext &ctx, std::vector<Point> &nav_path, int srcx, int srcy,
+    int dstx, int dsty, bool exact_dest, bool ignore_walls) const
 {
     nav_path.clear();
 
-    if (ignore_walls || CanSeeFromImpl(srcx, srcy, dstx, dsty))
+    if (ignore_walls || CanSeeFromImpl(ctx, srcx, srcy, dstx, dsty))
     {
         nav_path.emplace_back( srcx, srcy );
         nav_path.emplace_back( dstx, dsty );
     }
     else
     {
-        if ((exact_dest) && (_walkablearea->GetPixel(dstx, dsty) == 0))
+        if ((exact_dest) && (dstx >= 0) && (dstx < _walkablearea->GetWidth()) &&
+                (dsty >= 0) && (dsty < _walkablearea->GetHeight()) && (GetMaskRow(ctx, dsty)[dstx] == 0))
             return false; // clicked on a wall
 
-        FindRouteJPS(nav_path, srcx, srcy, dstx, dsty);
+        FindRouteJPS(ctx, nav_path, srcx, srcy, dstx, dsty);
     }
 
     if (nav_path.empty())
@@ -128,5 +288,42 @@ bool JPSRouteFinder::FindRouteImpl(std::vector<Point> &nav_path, int srcx, int s
     return true;
 }
 
+void JPSRouteFinder::FindRoutesImpl(const RouteBatch &batch, const std::vector<size_t> &requests,
+    std::vector<std::vector<Point>> &paths)
+{
+    if (!_batchThreads)
+    {
+        _batchThreads.reset(new ThreadPool());
+        _batchThreads->Start(ThreadPool::GetDefaultThreadCount(MaxBatchThreads));
+    }
+
+    const size_t count = requests.size();
+    const size_t num_workers = std::min(count, _batchThreads->GetThreadCount() + 1);
+    while (_batchSearch.size() < num_workers)
+        _batchSearch.emplace_back(new SearchContext());
+    for (size_t w = 0; w < num_workers; ++w)
+        SyncNavWalkablearea(*_batchSearch[w]);
+
+    // Each worker takes next unsolved request until there are none left;
+    // the results are written by the request index, so their order
+    // does not depend on which worker solved which request
+    std::atomic<size_t> next_request(0u);
+    _batchThreads->ParallelFor(num_workers, 1u, [&](size_t begin, size_t end)
+    {
+        for (size_t w = begin; w < end; ++w)
+        {
+            SearchContext &ctx = *_batchSearch[w];
+            for (size_t k = next_request++; k < count; k = next_request++)
+            {
+                const RouteRequest &req = batch.Requests[requests[k]];
+                SetRequestRows(ctx, batch, req);
+                FindRouteImpl(ctx, paths[k], req.Src.X / _coordScale, req.Src.Y / _coordScale,
+                    req.Dst.X / _coordScale, req.Dst.Y / _coordScale, req.ExactDest, req.IgnoreWalls);
+                ResetRequestRows(ctx);
+            }
+        }
+    });
+}
+
 } // namespace Engine
 } // namespace AGS
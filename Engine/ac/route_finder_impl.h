@@ -23,18 +23,28 @@ namespace AGS
 namespace Engine
 {
 
-class Navigation;
+class ClusterGraph;
+class ThreadPool;
 
 // JPSRouteFinder: a jump point search (JPS) A* pathfinder by Martin Sedlak.
+// Optionally uses hierarchical search on large masks: finds a route over
+// the abstract graph of mask clusters first, and then refines it with JPS.
 class JPSRouteFinder : public MaskRouteFinder
 {
 public:
-    JPSRouteFinder();
+    // Max number of worker threads for the batched search
+    static const size_t MaxBatchThreads = 8;
+
+    JPSRouteFinder(bool hierarchical = false);
     ~JPSRouteFinder();
 
     void Configure(GameDataVersion game_ver) override;
 
 private:
+    // Navigation grid and scratch data of a route search; the main context
+    // is used for the regular searches, and each batch worker has its own
+    struct SearchContext;
+
     // Update the implementation after a new walkable area is set
     void OnSetWalkableArea() override;
     // CanSeeFrom implementation
@@ -42,12 +52,37 @@ private:
     // FindRoute implementation
     bool FindRouteImpl(std::vector<Point> &path, int srcx, int srcy, int dstx, int dsty,
         bool exact_dest, bool ignore_walls)  override;
+    // FindRoutes implementation; solves requests on the worker threads
+    void FindRoutesImpl(const RouteBatch &batch, const std::vector<size_t> &requests,
+        std::vector<std::vector<Point>> &paths) override;
 
-    void SyncNavWalkablearea();
-    bool FindRouteJPS(std::vector<Point> &nav_path, int fromx, int fromy, int destx, int desty);
+    // Points context's navigation grid to the walkable mask rows; updates only rows
+    // that have changed since the last sync, if the mask stamps allow that
+    void SyncNavWalkablearea(SearchContext &ctx) const;
+    // Overrides context's grid rows with the ones composed for the batch request
+    void SetRequestRows(SearchContext &ctx, const RouteBatch &batch, const RouteRequest &req) const;
+    // Restores the rows overridden for the batch request
+    void ResetRequestRows(SearchContext &ctx) const;
+    // Gets the mask row as seen by the context's search
+    const uint8_t *GetMaskRow(const SearchContext &ctx, int y) const;
+    // CanSeeFrom and FindRoute implementations, over the context's grid;
+    // the grid must be synced with the walkable mask beforehand
+    bool CanSeeFromImpl(SearchContext &ctx, int srcx, int srcy, int dstx, int dsty,
+        int *lastcx = nullptr, int *lastcy = nullptr) const;
+    bool FindRouteImpl(SearchContext &ctx, std::vector<Point> &path, int srcx, int srcy, int dstx, int dsty,
+        bool exact_dest, bool ignore_walls) const;
+    bool FindRouteJPS(SearchContext &ctx, std::vector<Point> &nav_path, int fromx, int fromy, int destx, int desty) const;
+    // Tells whether the hierarchical search should be used for the current mask
+    bool UseClusters() const;
+    // Finds route using the cluster graph, refining each abstract step with JPS
+    bool FindRouteHierarchical(SearchContext &ctx, std::vector<Point> &nav_path,
+        int fromx, int fromy, int destx, int desty) const;
 
-    Navigation &nav; // declare as reference, because we must hide real Navigation decl here
-    std::vector<int> path, cpath;
+    std::unique_ptr<ClusterGraph> _clusters;
+    std::unique_ptr<SearchContext> _search;
+    // Batched search contexts and threads; created on demand
+    std::vector<std::unique_ptr<SearchContext>> _batchSearch;
+    std::unique_ptr<ThreadPool> _batchThreads;
 };
 
 } // namespace Engine
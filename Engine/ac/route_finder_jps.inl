@@ -42,6 +42,10 @@ public:
 	Navigation();
 
 	void Resize(int width, int height);
+	// restricts search and line tracing to the given rectangle (inclusive)
+	void SetBounds(int x1, int y1, int x2, int y2);
+	// lifts the search restriction, letting to use the whole map
+	void ResetBounds();
 
 	enum NavResult
 	{
@@ -97,6 +101,9 @@ private:
 	int mapWidth;
 	int mapHeight;
 	std::vector<const unsigned char *> map;
+	// search bounds
+	int boundX, boundY;
+	int boundWidth, boundHeight;
 
 	typedef unsigned short tFrameId;
 	typedef int tPrev;
@@ -190,6 +197,10 @@ const float Navigation::DIST_SCALE_UNPACK = 1.0f / Navigation::DIST_SCALE_PACK;
 Navigation::Navigation()
 	: mapWidth(0)
 	, mapHeight(0)
+	, boundX(0)
+	, boundY(0)
+	, boundWidth(0)
+	, boundHeight(0)
 	, frameId(1)
 	, cnode(0)
 	, closest(0)
@@ -208,6 +219,27 @@ void Navigation::Resize(int width, int height)
 
 	map.resize(mapHeight);
 	mapNodes.resize(size);
+	ResetBounds();
+}
+
+void Navigation::SetBounds(int x1, int y1, int x2, int y2)
+{
+	x1 = iclamp(x1, 0, mapWidth);
+	y1 = iclamp(y1, 0, mapHeight);
+	x2 = iclamp(x2, x1 - 1, mapWidth - 1);
+	y2 = iclamp(y2, y1 - 1, mapHeight - 1);
+	boundX = x1;
+	boundY = y1;
+	boundWidth = x2 - x1 + 1;
+	boundHeight = y2 - y1 + 1;
+}
+
+void Navigation::ResetBounds()
+{
+	boundX = 0;
+	boundY = 0;
+	boundWidth = mapWidth;
+	boundHeight = mapHeight;
 }
 
 void Navigation::IncFrameId()
@@ -235,8 +267,8 @@ inline void Navigation::UnpackSquare(int sq, int &x, int &y)
 inline bool Navigation::Outside(int x, int y) const
 {
 	return
-		(unsigned)x >= (unsigned)mapWidth ||
-		(unsigned)y >= (unsigned)mapHeight;
+		(unsigned)(x - boundX) >= (unsigned)boundWidth ||
+		(unsigned)(y - boundY) >= (unsigned)boundHeight;
 }
 
 inline bool Navigation::Walkable(int x, int y) const
@@ -425,7 +457,7 @@ Navigation::NavResult Navigation::Navigate(int sx, int sy, int ex, int ey, std::
 		{
 			for (int ny = y-1; ny <= y+1; ny++)
 			{
-				if ((unsigned)ny >= (unsigned)mapHeight)
+				if ((unsigned)(ny - boundY) >= (unsigned)boundHeight)
 					continue;
 
 				for (int nx = x-1; nx <= x+1; nx++)
@@ -433,7 +465,7 @@ Navigation::NavResult Navigation::Navigate(int sx, int sy, int ex, int ey, std::
 					if (nx == x && ny == y)
 						continue;
 
-					if ((unsigned)nx >= (unsigned)mapWidth)
+					if ((unsigned)(nx - boundX) >= (unsigned)boundWidth)
 						continue;
 
 					if (!Walkable(nx, ny))
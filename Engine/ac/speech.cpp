@@ -17,11 +17,13 @@
 #include "ac/game.h"
 #include "ac/gamesetup.h"
 #include "ac/gamestate.h"
+#include "ac/global_audio.h"
 #include "ac/runtime_defines.h"
 #include "ac/dynobj/scriptoverlay.h"
 #include "core/assetmanager.h"
 #include "debug/debug_log.h"
 #include "main/engine.h"
+#include "media/audio/soundprefetch.h"
 #include "util/directory.h"
 #include "util/file.h"
 #include "util/path.h"
@@ -105,7 +107,9 @@ bool init_voicepak(const String &name)
     if (ResPaths.SpeechPak.Name.CompareNoCase(speech_file) == 0)
         return true; // same pak already assigned
 
-    // First remove existing voice packs
+    // First remove existing voice packs, and any voice clips prefetched from them
+    soundprefetch_clear();
+    reset_voice_prefetch();
     ResPaths.VoiceAvail = false;
     AssetMgr->RemoveLibrary(ResPaths.SpeechPak.Path);
     AssetMgr->RemoveLibrary(ResPaths.VoiceDirSub);
@@ -0,0 +1,174 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "ac/sprite_hitmask.h"
+#include <algorithm>
+#include <allegro.h>
+#include "gfx/bitmap.h"
+
+using namespace AGS::Common;
+
+namespace AGS
+{
+namespace Engine
+{
+
+// Sets the mask bits for the pixels of a bitmap row, which differ from the mask color
+template <typename TPixel>
+static void MakeMaskRow(const uint8_t *src, int width, uint32_t mask_color, uint32_t *dst)
+{
+    const TPixel *px = reinterpret_cast<const TPixel*>(src);
+    for (int x = 0; x < width; ++x)
+    {
+        // alpha channel is not counted, same as when reading pixels for the hit test
+        if ((px[x] & 0x00ffffff) != mask_color)
+            dst[x >> 5] |= (1u << (x & 31));
+    }
+}
+
+SpriteHitMask::SpriteHitMask(const Bitmap *bmp)
+{
+    Create(bmp);
+}
+
+void SpriteHitMask::Create(const Bitmap *bmp)
+{
+    _width = bmp->GetWidth();
+    _height = bmp->GetHeight();
+    _stride = (_width + 31) / 32;
+    _bits.assign(_stride * _height, 0u);
+
+    const uint32_t mask_color = bmp->GetMaskColor();
+    for (int y = 0; y < _height; ++y)
+    {
+        const uint8_t *src = bmp->GetScanLine(y);
+        uint32_t *dst = &_bits[y * _stride];
+        switch (bmp->GetBPP())
+        {
+        case 1: MakeMaskRow<uint8_t>(src, _width, mask_color, dst); break;
+        case 2: MakeMaskRow<uint16_t>(src, _width, mask_color, dst); break;
+        case 4: MakeMaskRow<uint32_t>(src, _width, mask_color, dst); break;
+        default:
+            {
+                BITMAP *al_bmp = const_cast<BITMAP*>(bmp->GetAllegroBitmap());
+                for (int x = 0; x < _width; ++x)
+                {
+                    if ((static_cast<uint32_t>(al_bmp->vtable->getpixel(al_bmp, x, y)) & 0x00ffffff) != mask_color)
+                        dst[x >> 5] |= (1u << (x & 31));
+                }
+            }
+            break;
+        }
+    }
+}
+
+void SpriteHitMask::CreateTransformed(const SpriteHitMask &src, int width, int height, bool flip)
+{
+    _width = std::max(0, width);
+    _height = std::max(0, height);
+    _stride = (_width + 31) / 32;
+    _bits.assign(_stride * _height, 0u);
+    if ((src._width == 0) || (src._height == 0))
+        return;
+
+    // Precalculate source column for each destination pixel
+    std::vector<int> src_x(_width);
+    for (int x = 0; x < _width; ++x)
+    {
+        const int sx = (x * src._width) / _width;
+        src_x[x] = flip ? (src._width - 1 - sx) : sx;
+    }
+    for (int y = 0; y < _height; ++y)
+    {
+        const int sy = (y * src._height) / _height;
+        uint32_t *dst = &_bits[y * _stride];
+        for (int x = 0; x < _width; ++x)
+        {
+            if (src.IsOpaque(src_x[x], sy))
+                dst[x >> 5] |= (1u << (x & 31));
+        }
+    }
+}
+
+bool SpriteHitMask::Overlaps(const SpriteHitMask &m1, int x1, int y1,
+                             const SpriteHitMask &m2, int x2, int y2)
+{
+    const int left = std::max(x1, x2);
+    const int right = std::min(x1 + m1._width, x2 + m2._width);
+    const int top = std::max(y1, y2);
+    const int bottom = std::min(y1 + m1._height, y2 + m2._height);
+    if ((left >= right) || (top >= bottom))
+        return false;
+
+    for (int y = top; y < bottom; ++y)
+    {
+        const uint32_t *row1 = m1.GetRow(y - y1);
+        const uint32_t *row2 = m2.GetRow(y - y2);
+        for (int x = left; x < right; x += 32)
+        {
+            // bits past the mask's width are always zero, but the last
+            // chunk may still include pixels to the right of the overlap
+            const int count = right - x;
+            const uint32_t range = (count >= 32) ? 0xFFFFFFFFu : ((1u << count) - 1);
+            if (m1.ReadBits(row1, x - x1) & m2.ReadBits(row2, x - x2) & range)
+                return true;
+        }
+    }
+    return false;
+}
+
+SpriteHitMaskCache::SpriteHitMaskCache(size_t max_size)
+    : _maxSize(max_size)
+{
+}
+
+const SpriteHitMask &SpriteHitMaskCache::Get(int sprnum, const Bitmap *image)
+{
+    auto it = _masks.find(sprnum);
+    if ((it != _masks.end()) && (it->second.Source == image))
+        return it->second.Mask;
+
+    if (it != _masks.end())
+    {
+        _size -= it->second.Mask.GetMemorySize();
+    }
+    else
+    {
+        // Masks are small and cheap to recreate, so simply drop all when full
+        if (_size >= _maxSize)
+            Clear();
+        it = _masks.emplace(sprnum, Entry()).first;
+    }
+    it->second.Source = image;
+    it->second.Mask.Create(image);
+    _size += it->second.Mask.GetMemorySize();
+    return it->second.Mask;
+}
+
+void SpriteHitMaskCache::Invalidate(int sprnum)
+{
+    auto it = _masks.find(sprnum);
+    if (it == _masks.end())
+        return;
+    _size -= it->second.Mask.GetMemorySize();
+    _masks.erase(it);
+}
+
+void SpriteHitMaskCache::Clear()
+{
+    _masks.clear();
+    _size = 0u;
+}
+
+} // namespace Engine
+} // namespace AGS
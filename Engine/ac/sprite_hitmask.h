@@ -0,0 +1,119 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// SpriteHitMask is a 1-bit per pixel mask of the sprite's opaque pixels,
+// used for the pixel-perfect hit tests, instead of reading sprite pixels,
+// and for testing whether two sprites' opaque pixels overlap.
+// SpriteHitMaskCache keeps masks of the game sprites, created on demand.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__SPRITEHITMASK_H
+#define __AGS_EE_AC__SPRITEHITMASK_H
+
+#include <unordered_map>
+#include <vector>
+#include "core/types.h"
+
+namespace AGS
+{
+
+namespace Common { class Bitmap; }
+
+namespace Engine
+{
+
+class SpriteHitMask
+{
+public:
+    SpriteHitMask() = default;
+    // Creates a mask from the bitmap, where pixels of the bitmap's
+    // mask color are transparent, and all the others are opaque
+    explicit SpriteHitMask(const Common::Bitmap *bmp);
+
+    void Create(const Common::Bitmap *bmp);
+    // Creates a mask from another mask, scaled to the given size and optionally
+    // flipped horizontally; pixels are sampled same way as the hit test does
+    void CreateTransformed(const SpriteHitMask &src, int width, int height, bool flip);
+
+    int GetWidth() const { return _width; }
+    int GetHeight() const { return _height; }
+    // Gets the number of 32-bit words per mask row
+    int GetStride() const { return _stride; }
+    // Gets mask row; bit N of the word W represents pixel at (W * 32 + N)
+    const uint32_t *GetRow(int y) const { return &_bits[y * _stride]; }
+    size_t GetMemorySize() const { return _bits.size() * sizeof(uint32_t); }
+
+    // Tells if the pixel is opaque; pixels outside of the mask are not
+    inline bool IsOpaque(int x, int y) const
+    {
+        if ((x < 0) || (y < 0) || (x >= _width) || (y >= _height))
+            return false;
+        return (_bits[y * _stride + (x >> 5)] & (1u << (x & 31))) != 0;
+    }
+
+    // Tells if any opaque pixels of the two masks overlap, when the masks
+    // are placed at the given positions; compares 32 pixels at a time
+    static bool Overlaps(const SpriteHitMask &m1, int x1, int y1,
+                         const SpriteHitMask &m2, int x2, int y2);
+
+private:
+    // Reads 32 mask bits of the row, starting at the given pixel
+    inline uint32_t ReadBits(const uint32_t *row, int x) const
+    {
+        const int word = x >> 5, shift = x & 31;
+        uint32_t bits = row[word] >> shift;
+        if ((shift > 0) && (word + 1 < _stride))
+            bits |= row[word + 1] << (32 - shift);
+        return bits;
+    }
+
+    int _width = 0;
+    int _height = 0;
+    int _stride = 0;
+    std::vector<uint32_t> _bits;
+};
+
+class SpriteHitMaskCache
+{
+public:
+    // Default limit of the total masks size, in bytes
+    static const size_t DefaultMaxSize = 16 * 1024 * 1024;
+
+    SpriteHitMaskCache(size_t max_size = DefaultMaxSize);
+
+    // Gets the mask for the sprite, (re)creating it from the given sprite image
+    // if it's not cached yet, or was made from another bitmap;
+    // the returned reference is only valid until the next call to Get()
+    const SpriteHitMask &Get(int sprnum, const Common::Bitmap *image);
+    // Removes the sprite's mask, e.g. when the sprite was modified
+    void Invalidate(int sprnum);
+    void Clear();
+    size_t GetMemorySize() const { return _size; }
+
+private:
+    struct Entry
+    {
+        const Common::Bitmap *Source = nullptr;
+        SpriteHitMask Mask;
+    };
+
+    size_t _maxSize = DefaultMaxSize;
+    size_t _size = 0u;
+    std::unordered_map<int, Entry> _masks;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_AC__SPRITEHITMASK_H
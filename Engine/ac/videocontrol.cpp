@@ -0,0 +1,306 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "ac/videocontrol.h"
+#include "ac/gamesetup.h"
+#include "ac/dynobj/dynobj_manager.h"
+#include "debug/debugger.h"
+#include "debug/debug_log.h"
+#include "media/video/video.h"
+#include "util/math.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+ScriptVideoPlayer *VideoPlayer_Open(const char *filename, bool auto_play, int repeat)
+{
+    if (debug_flags & DBG_NOVIDEO)
+        return nullptr;
+
+    // Non-blocking video is run along with the game, so always allow to drop
+    // frames, and keep its own audio without stopping any game sounds
+    int video_flags = kVideo_EnableVideo | kVideo_DropFrames | kVideo_DropFramesUndecoded | kVideo_SyncAudioVideo;
+    if (usetup.AudioEnabled)
+        video_flags |= kVideo_EnableAudio;
+    if (repeat != 0)
+        video_flags |= kVideo_Loop;
+
+    int video_id;
+    HError err = open_video(filename, video_flags, video_id);
+    if (!err)
+    {
+        debug_script_warn("VideoPlayer.Open: failed to open video '%s': %s", filename, err->FullMessage().GetCStr());
+        return nullptr;
+    }
+
+    VideoControl *video = get_video_control(video_id);
+    if (auto_play)
+        video->Play();
+    ScriptVideoPlayer *svp = new ScriptVideoPlayer(video_id, video->GetSpriteID());
+    ccRegisterManagedObject(svp, svp);
+    return svp;
+}
+
+// Gets the video control, optionally warns if the video is not available anymore
+static VideoControl *get_video_control(ScriptVideoPlayer *svp, const char *apiname)
+{
+    VideoControl *video = get_video_control(svp->GetVideoID());
+    if (!video && apiname)
+        debug_script_warn("%s: video is not available, could have been restored from a saved game", apiname);
+    return video;
+}
+
+void VideoPlayer_Play(ScriptVideoPlayer *svp)
+{
+    if (VideoControl *video = get_video_control(svp, "VideoPlayer.Play"))
+        video->Play();
+}
+
+void VideoPlayer_Pause(ScriptVideoPlayer *svp)
+{
+    if (VideoControl *video = get_video_control(svp, "VideoPlayer.Pause"))
+        video->Pause();
+}
+
+void VideoPlayer_Stop(ScriptVideoPlayer *svp)
+{
+    if (VideoControl *video = get_video_control(svp, nullptr))
+        video->Stop();
+}
+
+int VideoPlayer_GetGraphic(ScriptVideoPlayer *svp)
+{
+    return svp->GetSpriteID();
+}
+
+int VideoPlayer_GetFrame(ScriptVideoPlayer *svp)
+{
+    VideoControl *video = get_video_control(svp, nullptr);
+    if (!video || video->GetFrameIndex() == UINT32_MAX)
+        return -1;
+    return static_cast<int>(video->GetFrameIndex());
+}
+
+int VideoPlayer_GetFrameCount(ScriptVideoPlayer *svp)
+{
+    VideoControl *video = get_video_control(svp, nullptr);
+    return video ? static_cast<int>(video->GetFrameCount()) : 0;
+}
+
+float VideoPlayer_GetFrameRate(ScriptVideoPlayer *svp)
+{
+    VideoControl *video = get_video_control(svp, nullptr);
+    return video ? video->GetFramerate() : 0.f;
+}
+
+int VideoPlayer_GetWidth(ScriptVideoPlayer *svp)
+{
+    VideoControl *video = get_video_control(svp, nullptr);
+    return video ? video->GetFrameSize().Width : 0;
+}
+
+int VideoPlayer_GetHeight(ScriptVideoPlayer *svp)
+{
+    VideoControl *video = get_video_control(svp, nullptr);
+    return video ? video->GetFrameSize().Height : 0;
+}
+
+int VideoPlayer_GetLengthMs(ScriptVideoPlayer *svp)
+{
+    VideoControl *video = get_video_control(svp, nullptr);
+    return video ? static_cast<int>(video->GetDurationMs()) : 0;
+}
+
+int VideoPlayer_GetPositionMs(ScriptVideoPlayer *svp)
+{
+    VideoControl *video = get_video_control(svp, nullptr);
+    return video ? static_cast<int>(video->GetPositionMs()) : 0;
+}
+
+bool VideoPlayer_GetIsPlaying(ScriptVideoPlayer *svp)
+{
+    VideoControl *video = get_video_control(svp, nullptr);
+    return video && (video->GetPlayState() == PlayStatePlaying);
+}
+
+bool VideoPlayer_GetLooping(ScriptVideoPlayer *svp)
+{
+    VideoControl *video = get_video_control(svp, nullptr);
+    return video && video->IsLooping();
+}
+
+void VideoPlayer_SetLooping(ScriptVideoPlayer *svp, bool loop)
+{
+    if (VideoControl *video = get_video_control(svp, "VideoPlayer.Looping"))
+        video->SetLooping(loop);
+}
+
+float VideoPlayer_GetSpeed(ScriptVideoPlayer *svp)
+{
+    VideoControl *video = get_video_control(svp, nullptr);
+    return video ? video->GetSpeed() : 0.f;
+}
+
+void VideoPlayer_SetSpeed(ScriptVideoPlayer *svp, float speed)
+{
+    if (speed <= 0.f)
+    {
+        debug_script_warn("VideoPlayer.Speed: invalid speed %f, must be positive", speed);
+        return;
+    }
+    if (VideoControl *video = get_video_control(svp, "VideoPlayer.Speed"))
+        video->SetSpeed(speed);
+}
+
+int VideoPlayer_GetVolume(ScriptVideoPlayer *svp)
+{
+    VideoControl *video = get_video_control(svp, nullptr);
+    return video ? static_cast<int>(video->GetVolume() * 100.f + 0.5f) : 0;
+}
+
+void VideoPlayer_SetVolume(ScriptVideoPlayer *svp, int volume)
+{
+    if (VideoControl *video = get_video_control(svp, "VideoPlayer.Volume"))
+        video->SetVolume(Math::Clamp(volume, 0, 100) / 100.f);
+}
+
+//=============================================================================
+//
+// Script API Functions
+//
+//=============================================================================
+
+#include "script/script_api.h"
+#include "script/script_runtime.h"
+
+RuntimeScriptValue Sc_VideoPlayer_Open(const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_SCALL_OBJAUTO_POBJ_PBOOL_PINT(ScriptVideoPlayer, VideoPlayer_Open, const char);
+}
+
+RuntimeScriptValue Sc_VideoPlayer_Play(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_VOID(ScriptVideoPlayer, VideoPlayer_Play);
+}
+
+RuntimeScriptValue Sc_VideoPlayer_Pause(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_VOID(ScriptVideoPlayer, VideoPlayer_Pause);
+}
+
+RuntimeScriptValue Sc_VideoPlayer_Stop(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_VOID(ScriptVideoPlayer, VideoPlayer_Stop);
+}
+
+RuntimeScriptValue Sc_VideoPlayer_GetGraphic(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_INT(ScriptVideoPlayer, VideoPlayer_GetGraphic);
+}
+
+RuntimeScriptValue Sc_VideoPlayer_GetFrame(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_INT(ScriptVideoPlayer, VideoPlayer_GetFrame);
+}
+
+RuntimeScriptValue Sc_VideoPlayer_GetFrameCount(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_INT(ScriptVideoPlayer, VideoPlayer_GetFrameCount);
+}
+
+RuntimeScriptValue Sc_VideoPlayer_GetFrameRate(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_FLOAT(ScriptVideoPlayer, VideoPlayer_GetFrameRate);
+}
+
+RuntimeScriptValue Sc_VideoPlayer_GetWidth(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_INT(ScriptVideoPlayer, VideoPlayer_GetWidth);
+}
+
+RuntimeScriptValue Sc_VideoPlayer_GetHeight(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_INT(ScriptVideoPlayer, VideoPlayer_GetHeight);
+}
+
+RuntimeScriptValue Sc_VideoPlayer_GetLengthMs(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_INT(ScriptVideoPlayer, VideoPlayer_GetLengthMs);
+}
+
+RuntimeScriptValue Sc_VideoPlayer_GetPositionMs(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_INT(ScriptVideoPlayer, VideoPlayer_GetPositionMs);
+}
+
+RuntimeScriptValue Sc_VideoPlayer_GetIsPlaying(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_BOOL(ScriptVideoPlayer, VideoPlayer_GetIsPlaying);
+}
+
+RuntimeScriptValue Sc_VideoPlayer_GetLooping(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_BOOL(ScriptVideoPlayer, VideoPlayer_GetLooping);
+}
+
+RuntimeScriptValue Sc_VideoPlayer_SetLooping(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_VOID_PBOOL(ScriptVideoPlayer, VideoPlayer_SetLooping);
+}
+
+RuntimeScriptValue Sc_VideoPlayer_GetSpeed(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_FLOAT(ScriptVideoPlayer, VideoPlayer_GetSpeed);
+}
+
+RuntimeScriptValue Sc_VideoPlayer_SetSpeed(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_VOID_PFLOAT(ScriptVideoPlayer, VideoPlayer_SetSpeed);
+}
+
+RuntimeScriptValue Sc_VideoPlayer_GetVolume(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_INT(ScriptVideoPlayer, VideoPlayer_GetVolume);
+}
+
+RuntimeScriptValue Sc_VideoPlayer_SetVolume(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_VOID_PINT(ScriptVideoPlayer, VideoPlayer_SetVolume);
+}
+
+void RegisterVideoAPI()
+{
+    ScFnRegister video_api[] = {
+        { "VideoPlayer::Open^3",          API_FN_PAIR(VideoPlayer_Open) },
+        { "VideoPlayer::Play^0",          API_FN_PAIR(VideoPlayer_Play) },
+        { "VideoPlayer::Pause^0",         API_FN_PAIR(VideoPlayer_Pause) },
+        { "VideoPlayer::Stop^0",          API_FN_PAIR(VideoPlayer_Stop) },
+        { "VideoPlayer::get_Graphic",     API_FN_PAIR(VideoPlayer_GetGraphic) },
+        { "VideoPlayer::get_Frame",       API_FN_PAIR(VideoPlayer_GetFrame) },
+        { "VideoPlayer::get_FrameCount",  API_FN_PAIR(VideoPlayer_GetFrameCount) },
+        { "VideoPlayer::get_FrameRate",   API_FN_PAIR(VideoPlayer_GetFrameRate) },
+        { "VideoPlayer::get_Width",       API_FN_PAIR(VideoPlayer_GetWidth) },
+        { "VideoPlayer::get_Height",      API_FN_PAIR(VideoPlayer_GetHeight) },
+        { "VideoPlayer::get_LengthMs",    API_FN_PAIR(VideoPlayer_GetLengthMs) },
+        { "VideoPlayer::get_PositionMs",  API_FN_PAIR(VideoPlayer_GetPositionMs) },
+        { "VideoPlayer::get_IsPlaying",   API_FN_PAIR(VideoPlayer_GetIsPlaying) },
+        { "VideoPlayer::get_Looping",     API_FN_PAIR(VideoPlayer_GetLooping) },
+        { "VideoPlayer::set_Looping",     API_FN_PAIR(VideoPlayer_SetLooping) },
+        { "VideoPlayer::get_Speed",       API_FN_PAIR(VideoPlayer_GetSpeed) },
+        { "VideoPlayer::set_Speed",       API_FN_PAIR(VideoPlayer_SetSpeed) },
+        { "VideoPlayer::get_Volume",      API_FN_PAIR(VideoPlayer_GetVolume) },
+        { "VideoPlayer::set_Volume",      API_FN_PAIR(VideoPlayer_SetVolume) },
+    };
+
+    ccAddExternalFunctions(video_api);
+}
@@ -0,0 +1,43 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Script API for the non-blocking video playback.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__VIDEOCONTROL_H
+#define __AGS_EE_AC__VIDEOCONTROL_H
+
+#include "ac/dynobj/scriptvideoplayer.h"
+
+ScriptVideoPlayer *VideoPlayer_Open(const char *filename, bool auto_play, int repeat);
+void    VideoPlayer_Play(ScriptVideoPlayer *svp);
+void    VideoPlayer_Pause(ScriptVideoPlayer *svp);
+void    VideoPlayer_Stop(ScriptVideoPlayer *svp);
+int     VideoPlayer_GetGraphic(ScriptVideoPlayer *svp);
+int     VideoPlayer_GetFrame(ScriptVideoPlayer *svp);
+int     VideoPlayer_GetFrameCount(ScriptVideoPlayer *svp);
+float   VideoPlayer_GetFrameRate(ScriptVideoPlayer *svp);
+int     VideoPlayer_GetWidth(ScriptVideoPlayer *svp);
+int     VideoPlayer_GetHeight(ScriptVideoPlayer *svp);
+int     VideoPlayer_GetLengthMs(ScriptVideoPlayer *svp);
+int     VideoPlayer_GetPositionMs(ScriptVideoPlayer *svp);
+bool    VideoPlayer_GetIsPlaying(ScriptVideoPlayer *svp);
+bool    VideoPlayer_GetLooping(ScriptVideoPlayer *svp);
+void    VideoPlayer_SetLooping(ScriptVideoPlayer *svp, bool loop);
+float   VideoPlayer_GetSpeed(ScriptVideoPlayer *svp);
+void    VideoPlayer_SetSpeed(ScriptVideoPlayer *svp, float speed);
+int     VideoPlayer_GetVolume(ScriptVideoPlayer *svp);
+void    VideoPlayer_SetVolume(ScriptVideoPlayer *svp, int volume);
+
+#endif // __AGS_EE_AC__VIDEOCONTROL_H
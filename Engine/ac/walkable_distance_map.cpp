@@ -0,0 +1,257 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "ac/walkable_distance_map.h"
+#include <algorithm>
+#include <assert.h>
+#include "gfx/bitmap.h"
+
+using namespace AGS::Common;
+
+namespace AGS
+{
+namespace Engine
+{
+
+// Integer division, rounding towards negative infinity
+inline int64_t FloorDiv(int64_t a, int64_t b)
+{
+    const int64_t d = a / b;
+    return ((a % b != 0) && ((a < 0) != (b < 0))) ? d - 1 : d;
+}
+
+void WalkableDistanceMap::SetMask(const Bitmap *mask, int tile_size)
+{
+    assert(!mask || mask->GetColorDepth() == 8);
+    _mask = mask;
+    _tileSize = std::max(0, tile_size);
+    _tiles.clear();
+    _hasWalkable = -1;
+    if (!mask)
+    {
+        _tilesX = _tilesY = 0;
+        return;
+    }
+
+    if (_tileSize == 0)
+    {
+        _tilesX = _tilesY = 1;
+        _tiles.resize(1);
+        _tiles[0].Bounds = RectWH(mask->GetSize());
+        return;
+    }
+
+    _tilesX = (mask->GetWidth() + _tileSize - 1) / _tileSize;
+    _tilesY = (mask->GetHeight() + _tileSize - 1) / _tileSize;
+    _tiles.resize(_tilesX * _tilesY);
+    const Rect mask_rc = RectWH(mask->GetSize());
+    for (int ty = 0; ty < _tilesY; ++ty)
+    {
+        for (int tx = 0; tx < _tilesX; ++tx)
+        {
+            _tiles[ty * _tilesX + tx].Bounds =
+                ClampToRect(mask_rc, RectWH(tx * _tileSize, ty * _tileSize, _tileSize, _tileSize));
+        }
+    }
+}
+
+void WalkableDistanceMap::Invalidate()
+{
+    // the old mask may be gone, or replaced by another one of different
+    // size at the same address, so its layout cannot be kept either
+    SetMask(nullptr);
+    std::vector<Tile>().swap(_tiles);
+}
+
+uint32_t WalkableDistanceMap::GetSqDistance(int x, int y)
+{
+    assert(_mask && RectWH(_mask->GetSize()).IsInside(x, y));
+    if (!HasWalkable())
+        return NoWalkable;
+
+    const int index = (_tileSize > 0) ? ((y / _tileSize) * _tilesX + (x / _tileSize)) : 0;
+    Tile &tile = _tiles[index];
+    if (tile.Dist.empty())
+        CalcTile(index);
+    return tile.Dist[(y - tile.Bounds.Top) * tile.Bounds.GetWidth() + (x - tile.Bounds.Left)];
+}
+
+size_t WalkableDistanceMap::GetMemoryUsed() const
+{
+    size_t mem = 0u;
+    for (const auto &tile : _tiles)
+        mem += tile.Dist.capacity() * sizeof(uint32_t);
+    return mem;
+}
+
+bool WalkableDistanceMap::HasWalkable()
+{
+    if (_hasWalkable < 0)
+    {
+        // Find out which tiles have walkable pixels, or just if the mask has any
+        const int width = _mask->GetWidth();
+        _tileHasWalkable.assign(_tiles.size(), 0);
+        for (int y = 0; y < _mask->GetHeight(); ++y)
+        {
+            const uint8_t *row = _mask->GetScanLine(y);
+            if (_tileSize == 0)
+            {
+                if (std::any_of(row, row + width, [](uint8_t px) { return px != 0; }))
+                {
+                    _tileHasWalkable[0] = 1;
+                    break;
+                }
+                continue;
+            }
+            uint8_t *tile_flags = &_tileHasWalkable[(y / _tileSize) * _tilesX];
+            for (int x = 0; x < width; ++x)
+                tile_flags[x / _tileSize] |= (row[x] != 0);
+        }
+        _hasWalkable = std::any_of(_tileHasWalkable.begin(), _tileHasWalkable.end(),
+            [](uint8_t f) { return f != 0; }) ? 1 : 0;
+    }
+    return _hasWalkable != 0;
+}
+
+void WalkableDistanceMap::CalcTile(int index)
+{
+    Tile &tile = _tiles[index];
+    const Rect mask_rc = RectWH(_mask->GetSize());
+    const Rect &tb = tile.Bounds;
+    tile.Dist.resize(tb.GetWidth() * tb.GetHeight());
+    if (_tileSize == 0)
+    {
+        CalcTileInWindow(tile, mask_rc);
+        // the whole map does not need calculation buffers afterwards
+        std::vector<uint32_t>().swap(_colDist);
+        return;
+    }
+
+    // Find the nearest tile which has walkable pixels, K tiles away;
+    // every pixel of this tile has a walkable pixel closer than
+    // (K + 1) * tile size * sqrt(2), so there's no need to look farther
+    const int tile_x = index % _tilesX;
+    const int tile_y = index / _tilesX;
+    int k = 0;
+    for (bool found = false; !found; )
+    {
+        for (int ty = std::max(0, tile_y - k); (ty <= std::min(_tilesY - 1, tile_y + k)) && !found; ++ty)
+        {
+            const int tx_step = ((ty == tile_y - k) || (ty == tile_y + k)) ? 1 : std::max(1, 2 * k);
+            for (int tx = tile_x - k; (tx <= tile_x + k) && !found; tx += tx_step)
+                found = (tx >= 0) && (tx < _tilesX) && _tileHasWalkable[ty * _tilesX + tx];
+        }
+        if (!found)
+            k++;
+    }
+    const int margin = ((k + 1) * _tileSize * 1415 + 999) / 1000;
+    CalcTileInWindow(tile, ClampToRect(mask_rc,
+        Rect(tb.Left - margin, tb.Top - margin, tb.Right + margin, tb.Bottom + margin)));
+}
+
+void WalkableDistanceMap::CalcTileInWindow(Tile &tile, const Rect &window)
+{
+    const Rect &tb = tile.Bounds;
+    const int win_width = window.GetWidth();
+    const int tile_width = tb.GetWidth();
+    const int tile_height = tb.GetHeight();
+    // "Infinite" distance, larger than any distance within the window
+    const int inf = win_width + window.GetHeight();
+    const int64_t inf_sq = static_cast<int64_t>(inf) * inf;
+
+    // Phase 1: distances to the nearest walkable pixel in the same column,
+    // calculated for the tile rows, first looking up, and then down
+    _colDist.resize(tile_height * win_width);
+    _above.assign(win_width, window.Top - inf);
+    _below.assign(win_width, window.Bottom + inf);
+    for (int y = window.Top; y <= tb.Bottom; ++y)
+    {
+        const uint8_t *row = _mask->GetScanLine(y) + window.Left;
+        for (int x = 0; x < win_width; ++x)
+        {
+            if (row[x] != 0)
+                _above[x] = y;
+        }
+        if (y < tb.Top)
+            continue;
+        uint32_t *col_dist = &_colDist[(y - tb.Top) * win_width];
+        for (int x = 0; x < win_width; ++x)
+            col_dist[x] = std::min(y - _above[x], inf);
+    }
+    for (int y = window.Bottom; y >= tb.Top; --y)
+    {
+        const uint8_t *row = _mask->GetScanLine(y) + window.Left;
+        for (int x = 0; x < win_width; ++x)
+        {
+            if (row[x] != 0)
+                _below[x] = y;
+        }
+        if (y > tb.Bottom)
+            continue;
+        uint32_t *col_dist = &_colDist[(y - tb.Top) * win_width];
+        for (int x = 0; x < win_width; ++x)
+            col_dist[x] = std::min<uint32_t>(col_dist[x], std::min(_below[x] - y, inf));
+    }
+
+    // Phase 2: for each row, find the lower envelope of parabolas
+    // f(x) = (x - i)^2 + g(i)^2, where g(i) is a column distance
+    _envCols.resize(win_width);
+    _envStart.resize(win_width);
+    int *s = _envCols.data();
+    int *t = _envStart.data();
+    const int tile_left = tb.Left - window.Left;
+    const int tile_right = tb.Right - window.Left;
+    for (int r = 0; r < tile_height; ++r)
+    {
+        const uint32_t *g = &_colDist[r * win_width];
+        auto f = [g](int x, int i) { return static_cast<int64_t>(x - i) * (x - i) + static_cast<int64_t>(g[i]) * g[i]; };
+        auto sep = [g](int i, int u) { return FloorDiv(static_cast<int64_t>(u) * u - static_cast<int64_t>(i) * i +
+            static_cast<int64_t>(g[u]) * g[u] - static_cast<int64_t>(g[i]) * g[i], 2 * (u - i)); };
+
+        int q = 0;
+        s[0] = 0;
+        t[0] = 0;
+        for (int u = 1; u < win_width; ++u)
+        {
+            while ((q >= 0) && (f(t[q], s[q]) > f(t[q], u)))
+                q--;
+            if (q < 0)
+            {
+                q = 0;
+                s[0] = u;
+            }
+            else
+            {
+                const int64_t w = 1 + sep(s[q], u);
+                if (w < win_width)
+                {
+                    q++;
+                    s[q] = u;
+                    t[q] = static_cast<int>(w);
+                }
+            }
+        }
+
+        uint32_t *dist = &tile.Dist[r * tile_width];
+        for (int u = tile_right; u >= tile_left; --u)
+        {
+            while (t[q] > u)
+                q--;
+            const int64_t d = f(u, s[q]);
+            dist[u - tile_left] = (d >= inf_sq) ? NoWalkable : static_cast<uint32_t>(d);
+        }
+    }
+}
+
+} // namespace Engine
+} // namespace AGS
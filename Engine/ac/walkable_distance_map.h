@@ -0,0 +1,103 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// WalkableDistanceMap: keeps the squared euclidean distance from each pixel
+// of a walkable mask to its nearest walkable pixel, which lets to find
+// the nearest walkable point without scanning the mask around.
+//
+// The distances are calculated using an exact distance transform
+// (A. Meijster, J. Roerdink, W. Hesselink, 2000). The map may either be
+// calculated for the whole mask at once, or split into tiles, calculated
+// only when a point inside them is requested, which saves memory when
+// only few parts of a large mask are ever queried.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__WALKABLEDISTANCEMAP_H
+#define __AGS_EE_AC__WALKABLEDISTANCEMAP_H
+
+#include <vector>
+#include "core/types.h"
+#include "util/geometry.h"
+
+namespace AGS
+{
+
+namespace Common { class Bitmap; }
+
+namespace Engine
+{
+
+class WalkableDistanceMap
+{
+public:
+    // Distance value meaning that there's no walkable pixels on the mask
+    static const uint32_t NoWalkable = UINT32_MAX;
+    // Default tile size, in pixels, for the tiled map
+    static const int DefaultTileSize = 64;
+
+    // Assigns the 8-bit walkable mask, and resets the map; if tile size is 0,
+    // then the map is calculated for the whole mask at once, otherwise it's
+    // calculated tile by tile on demand
+    void SetMask(const Common::Bitmap *mask, int tile_size = 0);
+    // Resets the map and forgets the mask, which may be changed or deleted
+    // afterwards; the mask must be assigned again with SetMask before use
+    void Invalidate();
+    const Common::Bitmap *GetMask() const { return _mask; }
+    int GetTileSize() const { return _tileSize; }
+    // Gets the squared distance from the point to the nearest walkable pixel,
+    // calculating the map or its tile if necessary; the point must be inside the mask
+    uint32_t GetSqDistance(int x, int y);
+    // Gets the number of bytes used by the calculated tiles
+    size_t GetMemoryUsed() const;
+
+private:
+    struct Tile
+    {
+        Rect Bounds;
+        // Squared distances, empty if not calculated yet
+        std::vector<uint32_t> Dist;
+    };
+
+    // Tells if there are any walkable pixels on the mask;
+    // also finds out which tiles have any
+    bool HasWalkable();
+    // Calculates the tile's distances
+    void CalcTile(int index);
+    // Calculates distances for the tile pixels, only counting walkable
+    // pixels within the given window
+    void CalcTileInWindow(Tile &tile, const Rect &window);
+
+    const Common::Bitmap *_mask = nullptr;
+    // Tile size, or 0 if the map is not split
+    int _tileSize = 0;
+    int _tilesX = 0;
+    int _tilesY = 0;
+    std::vector<Tile> _tiles;
+    // Whether the mask has any walkable pixel: -1 unknown, 0 no, 1 yes
+    int _hasWalkable = -1;
+    // Whether each tile has any walkable pixel
+    std::vector<uint8_t> _tileHasWalkable;
+
+    // Calculation buffers
+    std::vector<uint32_t> _colDist;
+    std::vector<int> _above;
+    std::vector<int> _below;
+    std::vector<int> _envCols;
+    std::vector<int> _envStart;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_AC__WALKABLEDISTANCEMAP_H
@@ -22,10 +22,14 @@
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
 #include "ac/walkablearea.h"
+#include "ac/blocking_layer.h"
+#include "ac/route_finder.h"
+#include "ac/walkable_distance_map.h"
 #include "game/roomstruct.h"
 #include "gfx/bitmap.h"
 
 using namespace AGS::Common;
+using namespace AGS::Engine;
 
 extern RoomStruct thisroom;
 extern GameSetupStruct game;
@@ -34,9 +38,26 @@ extern RoomStatus*croom;
 extern RoomObject*objs;
 
 Bitmap *walkareabackup=nullptr, *walkable_areas_temp = nullptr;
+// Composes walkable_areas_temp from the walkable areas and blocking rects
+static BlockingLayer blocking_layer;
+static std::vector<Rect> blocking_rects;
+// Owners of the blocking rects: character index, or (-1 - object index)
+static std::vector<int> blocking_owners;
+// Distances to the nearest walkable pixels of the room's walkable mask
+static WalkableDistanceMap walkable_distance_map;
+// Masks larger than this (in pixels) have their distance map split into tiles,
+// calculated only when needed
+static const int max_full_walkable_distance_map = 1024 * 1024;
+
+void invalidate_walkable_areas()
+{
+    blocking_layer.Invalidate();
+    walkable_distance_map.Invalidate();
+}
 
 void redo_walkable_areas()
 {
+    invalidate_walkable_areas();
     thisroom.WalkAreaMask->Blit(walkareabackup, 0, 0);
     for (int h = 0; h < walkareabackup->GetHeight(); ++h)
     {
@@ -105,25 +126,17 @@ void scale_sprite_size(int sppic, int zoom_level, int *newwidth, int *newheight)
         newheight[0] = 1;
 }
 
-void remove_walkable_areas_from_temp(int fromx, int cwidth, int starty, int endy) {
-
+// Adds a blocking rect, given in room coordinates, to the list
+static void add_blocking_rect(int owner, int fromx, int cwidth, int starty, int endy) {
     fromx = room_to_mask_coord(fromx);
     cwidth = room_to_mask_coord(cwidth);
     starty = room_to_mask_coord(starty);
     endy = room_to_mask_coord(endy);
-
-    int yyy;
-    if (endy >= walkable_areas_temp->GetHeight())
-        endy = walkable_areas_temp->GetHeight() - 1;
-    if (starty < 0)
-        starty = 0;
-
-    for (; cwidth > 0; cwidth --) {
-        for (yyy = starty; yyy <= endy; yyy++)
-            walkable_areas_temp->PutPixel (fromx, yyy, 0);
-        fromx ++;
+    if ((cwidth > 0) && (starty <= endy))
+    {
+        blocking_rects.push_back(Rect(fromx, starty, fromx + cwidth - 1, endy));
+        blocking_owners.push_back(owner);
     }
-
 }
 
 int is_point_in_rect(int x, int y, int left, int top, int right, int bottom) {
@@ -132,13 +145,11 @@ int is_point_in_rect(int x, int y, int left, int top, int right, int bottom) {
     return 0;
 }
 
-Bitmap *prepare_walkable_areas (int sourceChar) {
-    // copy the walkable areas to the temp bitmap
-    walkable_areas_temp->Blit(thisroom.WalkAreaMask.get(), 0,0,0,0,thisroom.WalkAreaMask->GetWidth(),thisroom.WalkAreaMask->GetHeight());
+static void collect_blocking_rects(int sourceChar) {
     // if the character who's moving doesn't block, don't bother checking
     if (sourceChar < 0) ;
     else if (game.chars[sourceChar].flags & CHF_NOBLOCKING)
-        return walkable_areas_temp;
+        return;
 
     // for each character in the current room, make the area under them unwalkable
     for (int ww = 0; ww < game.numcharacters; ww++) {
@@ -158,7 +169,7 @@ Bitmap *prepare_walkable_areas (int sourceChar) {
         if (is_char_in_blocking_rect(sourceChar, ww, &fromx, &cwidth))
             continue;
 
-        remove_walkable_areas_from_temp(fromx, cwidth, char1->get_blocking_top(), char1->get_blocking_bottom());
+        add_blocking_rect(ww, fromx, cwidth, char1->get_blocking_top(), char1->get_blocking_bottom());
     }
 
     // check for any blocking objects in the room, and deal with them as well
@@ -180,12 +191,66 @@ Bitmap *prepare_walkable_areas (int sourceChar) {
             x1, y1, x1 + width, y2)))
             continue;
 
-        remove_walkable_areas_from_temp(x1, width, y1, y2);
+        add_blocking_rect(-1 - static_cast<int>(ww), x1, width, y1, y2);
     }
+}
 
+Bitmap *prepare_walkable_areas (int sourceChar) {
+    // gather the blocking rects, and let the blocking layer update only
+    // those parts of the temp bitmap which are affected by the changes
+    blocking_rects.clear();
+    blocking_owners.clear();
+    collect_blocking_rects(sourceChar);
+    blocking_layer.Update(thisroom.WalkAreaMask.get(), walkable_areas_temp, blocking_rects);
     return walkable_areas_temp;
 }
 
+Bitmap *prepare_walkable_areas_batch(RouteBatch &batch) {
+    // cut out the blocking rects of everyone, as if no character was walking
+    Bitmap *mask = prepare_walkable_areas(-1);
+    batch.BaseMask = thisroom.WalkAreaMask.get();
+    batch.Blockers = blocking_rects;
+    return mask;
+}
+
+void get_walkable_areas_exclusions(int sourceChar, std::vector<int> &excluded) {
+    // same rects as skipped by collect_blocking_rects for this character
+    excluded.clear();
+    const CharacterInfo &chi = game.chars[sourceChar];
+    for (size_t i = 0; i < blocking_owners.size(); ++i) {
+        const int owner = blocking_owners[i];
+        bool exclude;
+        if (chi.flags & CHF_NOBLOCKING) {
+            exclude = true;
+        }
+        else if (owner >= 0) {
+            exclude = (owner == sourceChar) || is_char_in_blocking_rect(sourceChar, owner, nullptr, nullptr);
+        }
+        else {
+            int x1, y1, width, y2;
+            get_object_blocking_rect(-1 - owner, &x1, &y1, &width, &y2);
+            exclude = is_point_in_rect(chi.x, chi.y, x1, y1, x1 + width, y2) != 0;
+        }
+        if (exclude)
+            excluded.push_back(static_cast<int>(i));
+    }
+}
+
+MaskRowStamps get_walkable_areas_stamps() {
+    return blocking_layer.GetRowStamps();
+}
+
+bool find_nearest_walkable_point(const Point &from_pt, Point &dst_pt, const Rect &limits) {
+    const Bitmap *mask = thisroom.WalkAreaMask.get();
+    if (walkable_distance_map.GetMask() != mask)
+    {
+        const int tile_size = (mask->GetWidth() * mask->GetHeight() > max_full_walkable_distance_map) ?
+            WalkableDistanceMap::DefaultTileSize : 0;
+        walkable_distance_map.SetMask(mask, tile_size);
+    }
+    return Pathfinding::FindNearestWalkablePoint(walkable_distance_map, from_pt, dst_pt, limits, 0, 1);
+}
+
 // return the walkable area at the character's feet, taking into account
 // that he might just be off the edge of one
 int get_walkable_area_at_location(int xx, int yy) {
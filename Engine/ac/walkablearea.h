@@ -18,14 +18,32 @@
 #ifndef __AGS_EE_AC__WALKABLEAREA_H
 #define __AGS_EE_AC__WALKABLEAREA_H
 
+#include <vector>
+#include "util/geometry.h"
+
+namespace AGS { namespace Engine { struct MaskRowStamps; struct RouteBatch; } }
+
 void  redo_walkable_areas();
+// Tells that the room's walkable mask was modified, and the temp mask must be fully redone
+void  invalidate_walkable_areas();
 int   get_walkable_area_pixel(int x, int y);
 int   get_area_scaling (int onarea, int xx, int yy);
 void  scale_sprite_size(int sppic, int zoom_level, int *newwidth, int *newheight);
-void  remove_walkable_areas_from_temp(int fromx, int cwidth, int starty, int endy);
 int   is_point_in_rect(int x, int y, int left, int top, int right, int bottom);
 // IMPORTANT: this function returns *global pointer*, do not delete the returned bitmap! -- subject to future refactor
 Common::Bitmap *prepare_walkable_areas (int sourceChar);
+// Prepares the walkable mask for the batched route search, with the blocking rects
+// of all characters and objects cut out; assigns the batch's base mask and blockers.
+// IMPORTANT: returns same global pointer as prepare_walkable_areas
+Common::Bitmap *prepare_walkable_areas_batch(AGS::Engine::RouteBatch &batch);
+// Gets the indexes of the blocking rects, found by the last prepare_walkable_areas_batch,
+// which do not apply to the given character's walk
+void  get_walkable_areas_exclusions(int sourceChar, std::vector<int> &excluded);
+// Gets the modification stamps of the rows of the last prepared walkable mask
+AGS::Engine::MaskRowStamps get_walkable_areas_stamps();
+// Finds the nearest walkable pixel on the room's walkable mask, within the limits;
+// coordinates are in the mask resolution
+bool  find_nearest_walkable_point(const Point &from_pt, Point &dst_pt, const Rect &limits);
 int   get_walkable_area_at_location(int xx, int yy);
 int   get_walkable_area_at_character (int charnum);
 
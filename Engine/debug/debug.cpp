@@ -215,6 +215,7 @@ std::vector<String> parse_log_multigroup(const String &group_str)
         case 'o': grplist.emplace_back("manobj"); break;
         case 'l': grplist.emplace_back("sdl"); break;
         case 'p': grplist.emplace_back("plugin"); break;
+        case 'i': grplist.emplace_back("init"); break;
         }
     }
     return grplist;
@@ -53,6 +53,7 @@
 #include "main/main.h"
 #include "main/update.h"
 #include "media/audio/audio_system.h"
+#include "media/video/video.h"
 #include "platform/base/agsplatformdriver.h"
 #include "platform/base/sys_main.h"
 #include "plugin/plugin_engine.h"
@@ -467,6 +468,7 @@ void DoBeforeRestore(PreservedParams &pp, SaveCmpSelection select_cmp)
     unload_old_room();
     raw_saved_screen = nullptr;
     remove_all_overlays();
+    video_stop_all();
     play.complete_overlay_on = 0;
     play.text_overlay_on = 0;
 
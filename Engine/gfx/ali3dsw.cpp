@@ -17,6 +17,7 @@
 #include <stack>
 #include "ac/sys_events.h"
 #include "gfx/ali3dexception.h"
+#include "gfx/gfxfilter_scalenx.h"
 #include "gfx/gfxfilter_sdl_renderer.h"
 #include "gfx/gfx_util.h"
 #include "platform/base/agsplatformdriver.h"
@@ -108,6 +109,10 @@ void SDLRendererGraphicsDriver::SetGraphicsFilter(PSDLRenderFilter filter)
   // e.g like D3D and OGL filters act
   SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
   // SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");  // make the scaled rendering look smoother.
+
+  // Software filter may need the screen texture of a different size
+  if (_renderer && virtualScreen)
+    CreateScreenTexture();
 }
 
 bool SDLRendererGraphicsDriver::SetDisplayMode(const DisplayMode &mode)
@@ -220,17 +225,33 @@ void SDLRendererGraphicsDriver::CreateVirtualScreen()
   _origVirtualScreen.reset(new Bitmap(vscreen_w, vscreen_h, _srcColorDepth));
   virtualScreen = _origVirtualScreen.get();
   _stageVirtualScreen = virtualScreen;
+  CreateScreenTexture();
+}
+
+void SDLRendererGraphicsDriver::DestroyVirtualScreen()
+{
+  DestroyScreenTexture();
+  _origVirtualScreen.reset();
+  virtualScreen = nullptr;
+  _stageVirtualScreen = nullptr;
+}
 
-  _screenTex = SDL_CreateTexture(_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, vscreen_w, vscreen_h);
+void SDLRendererGraphicsDriver::CreateScreenTexture()
+{
+  DestroyScreenTexture();
+  _screenTexScale = _filter ? std::max(1, _filter->GetPreScale()) : 1;
+  const int tex_w = _srcRect.GetWidth() * _screenTexScale;
+  const int tex_h = _srcRect.GetHeight() * _screenTexScale;
+  _screenTex = SDL_CreateTexture(_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, tex_w, tex_h);
 
   // Fake bitmap that will wrap over texture pixels for simplier conversion
-  _fakeTexBitmap = create_bitmap_placeholder(32, vscreen_w, vscreen_h, nullptr);
+  _fakeTexBitmap = create_bitmap_placeholder(32, tex_w, tex_h, nullptr);
 
   _lastTexPixels = nullptr;
   _lastTexPitch = -1;
 }
 
-void SDLRendererGraphicsDriver::DestroyVirtualScreen()
+void SDLRendererGraphicsDriver::DestroyScreenTexture()
 {
   destroy_bitmap(_fakeTexBitmap);
   _fakeTexBitmap = nullptr;
@@ -238,10 +259,7 @@ void SDLRendererGraphicsDriver::DestroyVirtualScreen()
       SDL_DestroyTexture(_screenTex);
   }
   _screenTex = nullptr;
-
-  _origVirtualScreen.reset();
-  virtualScreen = nullptr;
-  _stageVirtualScreen = nullptr;
+  _filterSrcBitmap.reset();
 }
 
 void SDLRendererGraphicsDriver::ReleaseDisplayMode()
@@ -635,13 +653,29 @@ void SDLRendererGraphicsDriver::BlitToTexture()
     // standard blit operation, for simplicity sake.
     const int vwidth = virtualScreen->GetWidth();
     const int vheight = virtualScreen->GetHeight();
+    const int tex_w = _fakeTexBitmap->w;
+    const int tex_h = _fakeTexBitmap->h;
     if ((_lastTexPixels != pixels) || (_lastTexPitch != pitch)) {
-        attach_bitmap_data(_fakeTexBitmap, pixels, pitch * vheight, pitch, nullptr);
+        attach_bitmap_data(_fakeTexBitmap, pixels, pitch * tex_h, pitch, nullptr);
         _lastTexPixels = (unsigned char *)pixels;
         _lastTexPitch = pitch;
     }
 
-    blit(virtualScreen->GetAllegroBitmap(), _fakeTexBitmap, 0, 0, 0, 0, vwidth, vheight);
+    if ((_screenTexScale > 1) &&
+        (vwidth * _screenTexScale == tex_w) && (vheight * _screenTexScale == tex_h)) {
+        // Software filter: enlarge the 32-bit screen image directly into the texture
+        const Bitmap *filter_src = virtualScreen;
+        if (virtualScreen->GetColorDepth() != 32) {
+            if (!_filterSrcBitmap || (_filterSrcBitmap->GetSize() != virtualScreen->GetSize()))
+                _filterSrcBitmap.reset(new Bitmap(vwidth, vheight, 32));
+            _filterSrcBitmap->Blit(virtualScreen);
+            filter_src = _filterSrcBitmap.get();
+        }
+        BitmapData tex_data(static_cast<uint8_t*>(pixels), pitch * tex_h, pitch, tex_w, tex_h, kPxFmt_A8R8G8B8);
+        _filter->PreScale(filter_src->GetBitmapData(), tex_data);
+    } else {
+        blit(virtualScreen->GetAllegroBitmap(), _fakeTexBitmap, 0, 0, 0, 0, vwidth, vheight);
+    }
 
     SDL_UnlockTexture(_screenTex);
 }
@@ -822,7 +856,7 @@ SDLRendererGraphicsFactory::~SDLRendererGraphicsFactory()
 
 size_t SDLRendererGraphicsFactory::GetFilterCount() const
 {
-    return 1;
+    return 4;
 }
 
 const GfxFilterInfo *SDLRendererGraphicsFactory::GetFilterInfo(size_t index) const
@@ -831,6 +865,12 @@ const GfxFilterInfo *SDLRendererGraphicsFactory::GetFilterInfo(size_t index) con
     {
     case 0:
         return &SDLRendererGfxFilter::FilterInfo;
+    case 1:
+        return &ScaleNxGfxFilter::Scale2xInfo;
+    case 2:
+        return &ScaleNxGfxFilter::Scale3xInfo;
+    case 3:
+        return &ScaleNxGfxFilter::Scale4xInfo;
     default:
         return nullptr;
     }
@@ -859,6 +899,12 @@ SDLRendererGfxFilter *SDLRendererGraphicsFactory::CreateFilter(const String &id)
 {
     if (SDLRendererGfxFilter::FilterInfo.Id.CompareNoCase(id) == 0)
         return new SDLRendererGfxFilter();
+    else if (ScaleNxGfxFilter::Scale2xInfo.Id.CompareNoCase(id) == 0)
+        return new ScaleNxGfxFilter(2);
+    else if (ScaleNxGfxFilter::Scale3xInfo.Id.CompareNoCase(id) == 0)
+        return new ScaleNxGfxFilter(3);
+    else if (ScaleNxGfxFilter::Scale4xInfo.Id.CompareNoCase(id) == 0)
+        return new ScaleNxGfxFilter(4);
     return nullptr;
 }
 
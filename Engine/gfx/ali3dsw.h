@@ -17,8 +17,8 @@
 //
 // TODO: replace nearest-neighbour software filter with SDL's own accelerated
 // scaling, maybe add more filter types if SDL renderer supports them.
-// Only keep Hqx filter as a software option (might need to change how the 
-// filter code works).
+// Pixel-art filters (ScaleNx) enlarge the screen in software before it's
+// copied to the texture.
 //
 //=============================================================================
 #ifndef __AGS_EE_GFX__ALI3DSW_H
@@ -302,6 +302,10 @@ private:
     // Use gfx filter to create a new virtual screen
     void CreateVirtualScreen();
     void DestroyVirtualScreen();
+    // Creates the screen texture, sized to fit the virtual screen
+    // enlarged by the software filter
+    void CreateScreenTexture();
+    void DestroyScreenTexture();
     // Unset parameters and release resources related to the display mode
     void ReleaseDisplayMode();
 
@@ -338,6 +342,12 @@ private:
     BITMAP *_fakeTexBitmap = nullptr;
     unsigned char *_lastTexPixels = nullptr;
     int _lastTexPitch = -1;
+    // Scale of the screen texture relative to the virtual screen,
+    // when the filter enlarges the image in software
+    int _screenTexScale = 1;
+    // 32-bit copy of the virtual screen for the software filter,
+    // used when the virtual screen is of a different color depth
+    std::unique_ptr<Bitmap> _filterSrcBitmap;
 
     // Original virtual screen created and managed by the renderer.
     std::unique_ptr<Bitmap> _origVirtualScreen;
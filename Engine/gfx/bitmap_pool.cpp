@@ -0,0 +1,229 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gfx/bitmap_pool.h"
+#include <algorithm>
+#include "gfx/graphicsdriver.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+using namespace Common;
+
+void BitmapPoolReturn::operator()(Bitmap *bmp) const
+{
+    if (Pool)
+        Pool->Release(bmp);
+    else
+        delete bmp;
+}
+
+BitmapPool::~BitmapPool()
+{
+    // NOTE: any bitmaps that are still lent will have their backing deleted;
+    // the pool must be destroyed after all the users are gone.
+    _lent.clear();
+    ClearSpare();
+}
+
+void BitmapPool::SetMaxSpareSize(size_t max_size)
+{
+    _maxSpareSize = max_size;
+    if (_spareSize > _maxSpareSize)
+        ClearSpare();
+}
+
+// Rounds the dimension up to the nearest bucket step:
+// small dimensions are aligned to 16 pixels, larger ones are aligned to
+// a quarter of the previous power-of-two; this limits wasted space to 25%.
+static int BucketStep(int v)
+{
+    if (v <= 64)
+        return (v + 15) & ~15;
+    int pow2 = 64;
+    while ((pow2 << 1) <= v)
+        pow2 <<= 1;
+    const int step = pow2 / 4;
+    return ((v + step - 1) / step) * step;
+}
+
+Size BitmapPool::GetBucketSize(int width, int height)
+{
+    return Size(BucketStep(std::max(1, width)), BucketStep(std::max(1, height)));
+}
+
+PooledBitmap BitmapPool::Acquire(int width, int height, int color_depth)
+{
+    const Size bucket = GetBucketSize(width, height);
+    std::unique_ptr<Bitmap> backing;
+    auto it = _spare.find(MakeKey(bucket.Width, bucket.Height, color_depth));
+    if (it != _spare.end() && !it->second.empty())
+    {
+        backing = std::move(it->second.back());
+        it->second.pop_back();
+        _spareSize -= backing->GetDataSize();
+        _stats.Reuses++;
+    }
+    else
+    {
+        backing.reset(new Bitmap(bucket.Width, bucket.Height, color_depth));
+        if (backing->IsNull())
+            return PooledBitmap();
+        _stats.Allocs++;
+    }
+
+    // NOTE: the sub-bitmap is created over the full backing, and only then
+    // resized, because allegro allocates its line table by the initial height.
+    Bitmap *view = new Bitmap(backing.get(), RectWH(bucket));
+    ResizeView(view, width, height);
+    _lent[view] = std::move(backing);
+    return PooledBitmap(view, BitmapPoolReturn(this));
+}
+
+bool BitmapPool::Recycle(PooledBitmap &bmp, int width, int height, int color_depth)
+{
+    if (bmp && (bmp->GetColorDepth() == color_depth))
+    {
+        if ((bmp->GetWidth() == width) && (bmp->GetHeight() == height))
+        {
+            bmp->ResetClip();
+            return false;
+        }
+
+        // If this is our bitmap, and the new size belongs to the same bucket,
+        // then simply resize the sub-bitmap within its backing
+        auto it = (bmp.get_deleter().Pool == this) ? _lent.find(bmp.get()) : _lent.end();
+        if (it != _lent.end() && it->second->GetSize() == GetBucketSize(width, height))
+        {
+            ResizeView(bmp.get(), width, height);
+            _stats.Reuses++;
+            return false;
+        }
+    }
+
+    bmp = Acquire(width, height, color_depth);
+    return true;
+}
+
+void BitmapPool::ClearSpare()
+{
+    _spare.clear();
+    _spareSize = 0u;
+}
+
+BitmapPoolStats BitmapPool::ResetStats()
+{
+    BitmapPoolStats stats = _stats;
+    _stats = BitmapPoolStats();
+    return stats;
+}
+
+void BitmapPool::Release(Bitmap *bmp)
+{
+    auto it = _lent.find(bmp);
+    if (it == _lent.end())
+    { // not ours, simply delete
+        delete bmp;
+        return;
+    }
+
+    std::unique_ptr<Bitmap> backing = std::move(it->second);
+    _lent.erase(it);
+    delete bmp; // delete the sub-bitmap first, as it references backing
+    PutSpare(std::move(backing));
+}
+
+void BitmapPool::PutSpare(std::unique_ptr<Bitmap> &&backing)
+{
+    const size_t data_sz = backing->GetDataSize();
+    if (_spareSize + data_sz > _maxSpareSize)
+        return; // over the limit, let the backing be deleted
+    _spareSize += data_sz;
+    _spare[MakeKey(backing->GetWidth(), backing->GetHeight(), backing->GetColorDepth())]
+        .push_back(std::move(backing));
+}
+
+void BitmapPool::ResizeView(Bitmap *view, int width, int height)
+{
+    view->ResizeSubBitmap(width, height);
+    view->ResetClip();
+}
+
+
+void RenderTargetPool::SetDriver(IGraphicsDriver *driver)
+{
+    if (_driver != driver)
+        ClearSpare();
+    _driver = driver;
+}
+
+IDriverDependantBitmap *RenderTargetPool::Recycle(IDriverDependantBitmap *ddb,
+    int width, int height, int color_depth, bool opaque)
+{
+    if (ddb && (ddb->GetWidth() == width) && (ddb->GetHeight() == height))
+        return ddb;
+    if (ddb)
+        Release(ddb);
+
+    for (auto it = _spare.begin(); it != _spare.end(); ++it)
+    {
+        IDriverDependantBitmap *spare = *it;
+        if ((spare->GetWidth() == width) && (spare->GetHeight() == height) &&
+            (spare->GetColorDepth() == color_depth) && (spare->IsOpaque() == opaque))
+        {
+            _spare.erase(it);
+            // Reset drawing parameters to the defaults of a new texture
+            spare->SetStretch(width, height, false);
+            spare->SetFlip(kFlip_None);
+            spare->SetAlpha(255);
+            spare->SetLightLevel(0);
+            spare->SetTint(0, 0, 0, 0);
+            _stats.Reuses++;
+            return spare;
+        }
+    }
+
+    _stats.Allocs++;
+    return _driver->CreateRenderTargetDDB(width, height, color_depth, opaque ? kTxFlags_Opaque : kTxFlags_None);
+}
+
+void RenderTargetPool::Release(IDriverDependantBitmap *ddb)
+{
+    if (!ddb)
+        return;
+    if (_spare.size() >= MaxSpareCount)
+    { // drop the oldest spare texture
+        _driver->DestroyDDB(_spare.front());
+        _spare.erase(_spare.begin());
+    }
+    _spare.push_back(ddb);
+}
+
+void RenderTargetPool::ClearSpare()
+{
+    for (auto *ddb : _spare)
+        _driver->DestroyDDB(ddb);
+    _spare.clear();
+}
+
+BitmapPoolStats RenderTargetPool::ResetStats()
+{
+    BitmapPoolStats stats = _stats;
+    _stats = BitmapPoolStats();
+    return stats;
+}
+
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,156 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// BitmapPool keeps spare bitmaps for reuse, grouped in "buckets" by color
+// depth and size, where the size is rounded up to the nearest bucket step.
+// Bitmaps lent by the pool are sub-bitmaps of the exact requested size,
+// which reference a bucket-sized "backing" bitmap. This lets to reuse same
+// backing for images of varying sizes (e.g. animation frames), resizing the
+// lent sub-bitmap in place, so long as the new size fits into the backing.
+//
+// RenderTargetPool keeps spare render target textures, which cannot be
+// shared by sub-regions, and so are matched by their exact size.
+//
+// Both pools count allocations and reuses, the counters may be reset each
+// frame to get "per frame" statistics.
+//
+// NOTE: lent bitmaps are sub-bitmaps, and so their pixel data is not
+// contiguous; use GetScanLine() to access their rows.
+//
+//=============================================================================
+#ifndef __AGS_EE_GFX__BITMAPPOOL_H
+#define __AGS_EE_GFX__BITMAPPOOL_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "gfx/bitmap.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+using Common::Bitmap;
+class IDriverDependantBitmap;
+class IGraphicsDriver;
+
+// Allocation counters, for the statistics
+struct BitmapPoolStats
+{
+    uint32_t Allocs = 0u; // new objects allocated
+    uint32_t Reuses = 0u; // requests served from the spare objects
+};
+
+class BitmapPool;
+
+// Deleter which returns the pooled bitmaps back to their pool,
+// and deletes any other bitmaps
+struct BitmapPoolReturn
+{
+    BitmapPool *Pool = nullptr;
+
+    BitmapPoolReturn() = default;
+    BitmapPoolReturn(BitmapPool *pool) : Pool(pool) {}
+    void operator()(Bitmap *bmp) const;
+};
+
+typedef std::unique_ptr<Bitmap, BitmapPoolReturn> PooledBitmap;
+
+class BitmapPool
+{
+public:
+    BitmapPool() = default;
+    ~BitmapPool();
+
+    // Sets the limit of memory (in bytes) which may be held by the spare bitmaps
+    void SetMaxSpareSize(size_t max_size);
+    // Gets a bitmap of exactly the given size and color depth;
+    // reuses a spare backing bitmap of a matching bucket, if there's one.
+    PooledBitmap Acquire(int width, int height, int color_depth);
+    // Ensures that the bitmap is of exactly the given size and color depth;
+    // resizes existing pooled bitmap in place if possible, otherwise returns
+    // it to the pool and acquires a new one.
+    // Returns whether the bitmap object was replaced.
+    bool Recycle(PooledBitmap &bmp, int width, int height, int color_depth);
+    // Deletes all the spare bitmaps
+    void ClearSpare();
+    // Gets the amount of memory held by the spare bitmaps
+    size_t GetSpareSize() const { return _spareSize; }
+    // Gets and resets the allocation statistics
+    BitmapPoolStats ResetStats();
+
+    // Calculates the size of a bucket for the given bitmap size
+    static Size GetBucketSize(int width, int height);
+
+private:
+    friend struct BitmapPoolReturn;
+
+    // Takes back the lent bitmap; puts its backing into the spare list
+    void Release(Bitmap *bmp);
+    // Puts the backing bitmap into spare list, or deletes one if the limit is reached
+    void PutSpare(std::unique_ptr<Bitmap> &&backing);
+    // Resizes a lent sub-bitmap within its backing
+    static void ResizeView(Bitmap *view, int width, int height);
+
+    static uint64_t MakeKey(int width, int height, int color_depth)
+    {
+        return (static_cast<uint64_t>(color_depth) << 48)
+            | (static_cast<uint64_t>(width) << 24) | static_cast<uint64_t>(height);
+    }
+
+    // Default max memory held by spare bitmaps
+    static const size_t DefaultMaxSpareSize = 16 * 1024 * 1024;
+
+    // Lent bitmaps: sub-bitmap -> backing bitmap
+    std::unordered_map<Bitmap*, std::unique_ptr<Bitmap>> _lent;
+    // Spare backing bitmaps, grouped by the bucket key
+    std::unordered_map<uint64_t, std::vector<std::unique_ptr<Bitmap>>> _spare;
+    size_t _spareSize = 0u;
+    size_t _maxSpareSize = DefaultMaxSpareSize;
+    BitmapPoolStats _stats;
+};
+
+class RenderTargetPool
+{
+public:
+    // NOTE: spare textures must be cleared explicitly, before the driver is destroyed
+    RenderTargetPool() = default;
+
+    // Assigns a graphics driver, which creates and destroys textures;
+    // disposes any spare textures made by the previous driver.
+    void SetDriver(IGraphicsDriver *driver);
+    // Ensures that the render target matches the given parameters,
+    // swaps it for a spare one, or creates a new one if necessary.
+    IDriverDependantBitmap *Recycle(IDriverDependantBitmap *ddb, int width, int height, int color_depth, bool opaque);
+    // Returns a render target to the spare list
+    void Release(IDriverDependantBitmap *ddb);
+    // Destroys all the spare render targets
+    void ClearSpare();
+    // Gets and resets the allocation statistics
+    BitmapPoolStats ResetStats();
+
+private:
+    // Max number of spare render targets
+    static const size_t MaxSpareCount = 8;
+
+    IGraphicsDriver *_driver = nullptr;
+    std::vector<IDriverDependantBitmap*> _spare;
+    BitmapPoolStats _stats;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GFX__BITMAPPOOL_H
@@ -0,0 +1,192 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gfx/gfxfilter_scalenx.h"
+#include <algorithm>
+
+namespace AGS
+{
+namespace Engine
+{
+namespace ALSW
+{
+
+using namespace Common;
+
+const GfxFilterInfo ScaleNxGfxFilter::Scale2xInfo = GfxFilterInfo("Scale2x", "Scale2x (pixel art)", 2);
+const GfxFilterInfo ScaleNxGfxFilter::Scale3xInfo = GfxFilterInfo("Scale3x", "Scale3x (pixel art)", 3);
+const GfxFilterInfo ScaleNxGfxFilter::Scale4xInfo = GfxFilterInfo("Scale4x", "Scale4x (pixel art)", 4);
+
+// Source pixel neighbourhood, named as in the Scale2x/3x description:
+//   A B C
+//   D E F
+//   G H I
+// Pixels outside of the image are clamped to the nearest edge.
+struct Neighbours
+{
+    uint32_t A, B, C, D, E, F, G, H, I;
+};
+
+inline void GetNeighbours(const uint32_t *row_up, const uint32_t *row, const uint32_t *row_down,
+    int x, int width, Neighbours &n)
+{
+    const int xl = std::max(x - 1, 0);
+    const int xr = std::min(x + 1, width - 1);
+    n.A = row_up[xl];   n.B = row_up[x];   n.C = row_up[xr];
+    n.D = row[xl];      n.E = row[x];      n.F = row[xr];
+    n.G = row_down[xl]; n.H = row_down[x]; n.I = row_down[xr];
+}
+
+// Scales source rows [y_begin, y_end) using Scale2x method: each pixel E
+// is replaced by a 2x2 block, where each corner takes the color of the two
+// adjacent neighbours if they are equal, unless it's a straight edge.
+static void Scale2xRows(const BitmapData &src, BitmapData &dst, int y_begin, int y_end)
+{
+    const int width = src.GetWidth();
+    const int height = src.GetHeight();
+    Neighbours n;
+    for (int y = y_begin; y < y_end; ++y)
+    {
+        const uint32_t *row_up = reinterpret_cast<const uint32_t*>(src.GetLine(std::max(y - 1, 0)));
+        const uint32_t *row = reinterpret_cast<const uint32_t*>(src.GetLine(y));
+        const uint32_t *row_down = reinterpret_cast<const uint32_t*>(src.GetLine(std::min(y + 1, height - 1)));
+        uint32_t *out0 = reinterpret_cast<uint32_t*>(dst.GetLine(y * 2));
+        uint32_t *out1 = reinterpret_cast<uint32_t*>(dst.GetLine(y * 2 + 1));
+        for (int x = 0; x < width; ++x, out0 += 2, out1 += 2)
+        {
+            GetNeighbours(row_up, row, row_down, x, width, n);
+            if ((n.B != n.H) && (n.D != n.F))
+            {
+                out0[0] = (n.D == n.B) ? n.D : n.E;
+                out0[1] = (n.B == n.F) ? n.F : n.E;
+                out1[0] = (n.D == n.H) ? n.D : n.E;
+                out1[1] = (n.H == n.F) ? n.F : n.E;
+            }
+            else
+            {
+                out0[0] = out0[1] = out1[0] = out1[1] = n.E;
+            }
+        }
+    }
+}
+
+// Scales source rows [y_begin, y_end) using Scale3x method,
+// which is similar to Scale2x, but produces 3x3 blocks.
+static void Scale3xRows(const BitmapData &src, BitmapData &dst, int y_begin, int y_end)
+{
+    const int width = src.GetWidth();
+    const int height = src.GetHeight();
+    Neighbours n;
+    for (int y = y_begin; y < y_end; ++y)
+    {
+        const uint32_t *row_up = reinterpret_cast<const uint32_t*>(src.GetLine(std::max(y - 1, 0)));
+        const uint32_t *row = reinterpret_cast<const uint32_t*>(src.GetLine(y));
+        const uint32_t *row_down = reinterpret_cast<const uint32_t*>(src.GetLine(std::min(y + 1, height - 1)));
+        uint32_t *out0 = reinterpret_cast<uint32_t*>(dst.GetLine(y * 3));
+        uint32_t *out1 = reinterpret_cast<uint32_t*>(dst.GetLine(y * 3 + 1));
+        uint32_t *out2 = reinterpret_cast<uint32_t*>(dst.GetLine(y * 3 + 2));
+        for (int x = 0; x < width; ++x, out0 += 3, out1 += 3, out2 += 3)
+        {
+            GetNeighbours(row_up, row, row_down, x, width, n);
+            if ((n.B != n.H) && (n.D != n.F))
+            {
+                out0[0] = (n.D == n.B) ? n.D : n.E;
+                out0[1] = ((n.D == n.B) && (n.E != n.C)) || ((n.B == n.F) && (n.E != n.A)) ? n.B : n.E;
+                out0[2] = (n.B == n.F) ? n.F : n.E;
+                out1[0] = ((n.D == n.B) && (n.E != n.G)) || ((n.D == n.H) && (n.E != n.A)) ? n.D : n.E;
+                out1[1] = n.E;
+                out1[2] = ((n.B == n.F) && (n.E != n.I)) || ((n.H == n.F) && (n.E != n.C)) ? n.F : n.E;
+                out2[0] = (n.D == n.H) ? n.D : n.E;
+                out2[1] = ((n.D == n.H) && (n.E != n.I)) || ((n.H == n.F) && (n.E != n.G)) ? n.H : n.E;
+                out2[2] = (n.H == n.F) ? n.F : n.E;
+            }
+            else
+            {
+                out0[0] = out0[1] = out0[2] = n.E;
+                out1[0] = out1[1] = out1[2] = n.E;
+                out2[0] = out2[1] = out2[2] = n.E;
+            }
+        }
+    }
+}
+
+ScaleNxGfxFilter::ScaleNxGfxFilter(int factor)
+    : _factor(std::max(2, std::min(factor, 4)))
+{
+}
+
+const GfxFilterInfo &ScaleNxGfxFilter::GetInfo() const
+{
+    switch (_factor)
+    {
+    case 2: return Scale2xInfo;
+    case 3: return Scale3xInfo;
+    default: return Scale4xInfo;
+    }
+}
+
+bool ScaleNxGfxFilter::Initialize(const int color_depth, String &err_str)
+{
+    _threads.Start(ThreadPool::GetDefaultThreadCount(MaxThreads));
+    return SDLRendererGfxFilter::Initialize(color_depth, err_str);
+}
+
+void ScaleNxGfxFilter::UnInitialize()
+{
+    _threads.Stop();
+    _midBuffer.clear();
+    _midBuffer.shrink_to_fit();
+    SDLRendererGfxFilter::UnInitialize();
+}
+
+void ScaleNxGfxFilter::PreScale(const BitmapData &src, BitmapData &dst)
+{
+    if ((src.GetColorDepth() != 32) || (dst.GetColorDepth() != 32) ||
+        (dst.GetWidth() != src.GetWidth() * _factor) || (dst.GetHeight() != src.GetHeight() * _factor))
+        return; // unsupported
+
+    const size_t height = src.GetHeight();
+    switch (_factor)
+    {
+    case 2:
+        _threads.ParallelFor(height, MinBandRows, [&src, &dst](size_t begin, size_t end)
+            { Scale2xRows(src, dst, static_cast<int>(begin), static_cast<int>(end)); });
+        break;
+    case 3:
+        _threads.ParallelFor(height, MinBandRows, [&src, &dst](size_t begin, size_t end)
+            { Scale3xRows(src, dst, static_cast<int>(begin), static_cast<int>(end)); });
+        break;
+    case 4:
+    {
+        // Scale2x twice, through an intermediate image;
+        // the second pass needs to wait for all of the first one to complete,
+        // because the bands read neighbouring rows.
+        const int mid_w = src.GetWidth() * 2, mid_h = src.GetHeight() * 2;
+        const size_t mid_stride = mid_w * sizeof(uint32_t);
+        _midBuffer.resize(mid_stride * mid_h);
+        BitmapData mid(_midBuffer.data(), _midBuffer.size(), mid_stride, mid_w, mid_h, kPxFmt_A8R8G8B8);
+        _threads.ParallelFor(height, MinBandRows, [&src, &mid](size_t begin, size_t end)
+            { Scale2xRows(src, mid, static_cast<int>(begin), static_cast<int>(end)); });
+        const BitmapData &mid_src = mid;
+        _threads.ParallelFor(mid_h, MinBandRows, [&mid_src, &dst](size_t begin, size_t end)
+            { Scale2xRows(mid_src, dst, static_cast<int>(begin), static_cast<int>(end)); });
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+} // namespace ALSW
+} // namespace Engine
+} // namespace AGS
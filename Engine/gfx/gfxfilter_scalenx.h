@@ -0,0 +1,71 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Pixel-art scaling filters for the software renderer: Scale2x, Scale3x
+// (also known as AdvMAME2x/3x) and Scale4x (Scale2x applied twice).
+// These enlarge the game frame on CPU, smoothing diagonal edges without
+// introducing new colors; the result is then stretched to the final
+// window size by the renderer.
+// The frame is processed in bands of rows, split among worker threads.
+//
+//=============================================================================
+#ifndef __AGS_EE_GFX__SCALENXGFXFILTER_H
+#define __AGS_EE_GFX__SCALENXGFXFILTER_H
+
+#include <vector>
+#include "gfx/gfxfilter_sdl_renderer.h"
+#include "util/thread_pool.h"
+
+namespace AGS
+{
+namespace Engine
+{
+namespace ALSW
+{
+
+class ScaleNxGfxFilter : public SDLRendererGfxFilter
+{
+public:
+    // Creates a filter for the scale factor 2, 3 or 4
+    ScaleNxGfxFilter(int factor);
+
+    const GfxFilterInfo &GetInfo() const override;
+
+    bool Initialize(const int color_depth, String &err_str) override;
+    void UnInitialize() override;
+
+    int GetPreScale() const override { return _factor; }
+    void PreScale(const Common::BitmapData &src, Common::BitmapData &dst) override;
+
+    static const GfxFilterInfo Scale2xInfo;
+    static const GfxFilterInfo Scale3xInfo;
+    static const GfxFilterInfo Scale4xInfo;
+
+private:
+    // Max number of worker threads used for scaling
+    static const size_t MaxThreads = 8;
+    // Min number of source rows per band
+    static const size_t MinBandRows = 16;
+
+    const int _factor;
+    ThreadPool _threads;
+    // Intermediate 2x image, for the Scale4x
+    std::vector<uint8_t> _midBuffer;
+};
+
+} // namespace ALSW
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GFX__SCALENXGFXFILTER_H
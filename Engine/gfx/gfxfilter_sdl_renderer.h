@@ -18,6 +18,7 @@
 //=============================================================================
 #ifndef __AGS_EE_GFX__SDLRENDERERFILTER_H
 #define __AGS_EE_GFX__SDLRENDERERFILTER_H
+#include "gfx/bitmapdata.h"
 #include "gfx/gfxfilter_scaling.h"
 
 namespace AGS
@@ -32,6 +33,13 @@ class SDLRendererGfxFilter : public ScalingGfxFilter
 public:
     const GfxFilterInfo &GetInfo() const override;
 
+    // Gets the factor by which this filter enlarges the image in software,
+    // before passing it to the renderer; 1 means no software scaling.
+    virtual int GetPreScale() const { return 1; }
+    // Enlarges the 32-bit source image into the destination,
+    // which size must be exactly GetPreScale() times larger.
+    virtual void PreScale(const Common::BitmapData &/*src*/, Common::BitmapData &/*dst*/) {}
+
     static const GfxFilterInfo FilterInfo;
 };
 
@@ -131,7 +131,7 @@ bool parse_legacy_frame_config(const String &scaling_option, String &filter_id,
         String CurrentName;
         int    Scaling;
     } legacy_filters[6] = { {"none", "none", -1}, {"max", "StdScale", 0}, {"StdScale", "StdScale", -1},
-                           {"AAx", "Linear", -1}, {"Hq2x", "Hqx", 2}, {"Hq3x", "Hqx", 3} };
+                           {"AAx", "Linear", -1}, {"Hq2x", "Scale2x", 2}, {"Hq3x", "Scale3x", 3} };
 
     for (int i = 0; i < 6; i++)
     {
@@ -418,6 +418,17 @@ void load_common_config(const ConfigTree &cfg, GameConfig &setup)
     setup.TextureCacheSize = CfgReadInt(cfg, "graphics", "texture_cache_size", setup.TextureCacheSize);
     setup.SoundCacheSize = CfgReadInt(cfg, "sound", "cache_size", setup.SoundCacheSize);
     setup.SoundLoadAtOnceSize = CfgReadInt(cfg, "sound", "stream_threshold", setup.SoundLoadAtOnceSize);
+    setup.SoundPCMCacheSize = CfgReadInt(cfg, "sound", "decoded_cache_size", setup.SoundPCMCacheSize);
+    setup.SoundPCMMaxLength = CfgReadInt(cfg, "sound", "decoded_cache_max_length", setup.SoundPCMMaxLength);
+    setup.AudioDecodeAheadMs = CfgReadInt(cfg, "sound", "decode_ahead", 0, 10000, setup.AudioDecodeAheadMs);
+    setup.AudioDecodeThreads = CfgReadInt(cfg, "sound", "decode_threads", 0, 16, setup.AudioDecodeThreads);
+    setup.AudioOutput = StrUtil::ParseEnum<AudioOutputType>(
+        CfgReadString(cfg, "sound", "output", "device"),
+        CstrArr<kNumAudioOutputTypes>{ "device", "null", "wav" }, setup.AudioOutput);
+    setup.AudioPace = StrUtil::ParseEnum<AudioOutputPace>(
+        CfgReadString(cfg, "sound", "output_pace", "realtime"),
+        CstrArr<kNumAudioOutputPaces>{ "realtime", "fast" }, setup.AudioPace);
+    setup.AudioOutputFile = CfgReadString(cfg, "sound", "output_file", "audio_output.wav");
 
     // Various system options
     setup.LoadLatestSave = CfgReadBoolInt(cfg, "misc", "load_latest_save", setup.LoadLatestSave);
@@ -425,6 +436,7 @@ void load_common_config(const ConfigTree &cfg, GameConfig &setup)
     setup.RunInBackground = CfgReadInt(cfg, "misc", "background", 0) != 0;
     setup.ShowFps = CfgReadBoolInt(cfg, "misc", "show_fps");
     setup.ClearCacheOnRoomChange = CfgReadBoolInt(cfg, "misc", "clear_cache_on_room_change", setup.ClearCacheOnRoomChange);
+    setup.PathfinderHierarchical = CfgReadBoolInt(cfg, "misc", "pathfinder_hierarchical", setup.PathfinderHierarchical);
 
     // Accessibility settings
     setup.Access.SpeechSkipStyle = parse_speechskip_style(CfgReadString(cfg, "access", "speechskip"));
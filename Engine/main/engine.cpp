@@ -77,6 +77,9 @@
 #include "util/error.h"
 #include "util/path.h"
 #include "util/string_utils.h"
+#include "util/task_graph.h"
+#include "util/thread_pool.h"
+#include "util/time_util.h"
 
 using namespace AGS::Common;
 using namespace AGS::Engine;
@@ -383,21 +386,34 @@ void engine_init_keyboard()
     /* do nothing */
 }
 
+// Initializes the backend's audio subsystem; must be called on the main thread
+void engine_init_audio_driver()
+{
+    if (!usetup.AudioEnabled)
+        return;
+    Debug::Printf("Initializing audio");
+    // Headless output renders the mix by itself, and needs no audio driver
+    if (usetup.AudioOutput == kAudioOutput_Device)
+        usetup.AudioEnabled = sys_audio_init(usetup.AudioDriverID);
+}
+
+// Initializes the audio core; may be called on any thread, after the driver
 void engine_init_audio()
 {
     if (usetup.AudioEnabled)
     {
-        Debug::Printf("Initializing audio");
-        bool res = sys_audio_init(usetup.AudioDriverID);
-        if (res)
-        {
-            try {
-                audio_core_init(); // audio core system
-            }
-            catch (std::runtime_error& ex) {
-                Debug::Printf(kDbgMsg_Error, "Failed to initialize audio system: %s", ex.what());
-                res = false;
-            }
+        bool res = true;
+        AudioOutputSetup output;
+        output.Type = usetup.AudioOutput;
+        output.Pace = usetup.AudioPace;
+        output.WavFile = usetup.AudioOutputFile;
+        try {
+            audio_core_init(static_cast<float>(usetup.AudioDecodeAheadMs),
+                static_cast<size_t>(usetup.AudioDecodeThreads), output); // audio core system
+        }
+        catch (std::runtime_error& ex) {
+            Debug::Printf(kDbgMsg_Error, "Failed to initialize audio system: %s", ex.what());
+            res = false;
         }
         usetup.AudioEnabled = res;
     }
@@ -405,6 +421,7 @@ void engine_init_audio()
     if (usetup.AudioEnabled)
     {
         soundcache_set_rules(usetup.SoundLoadAtOnceSize * 1024, usetup.SoundCacheSize * 1024);
+        soundcache_set_pcm_rules(usetup.SoundPCMCacheSize * 1024, static_cast<float>(usetup.SoundPCMMaxLength));
     }
     else
     {
@@ -572,17 +589,28 @@ void show_preload()
     }
 }
 
-HError engine_init_sprites()
+// Opens the sprite files; this must be done on the main thread,
+// because the AssetManager is not thread-safe
+static HError engine_open_sprite_files(std::unique_ptr<Stream> &sprite_file,
+    std::unique_ptr<Stream> &index_file)
 {
     spriteset.Reset();
     Debug::Printf(kDbgMsg_Info, "Initialize sprites");
-    auto sprite_file = AssetMgr->OpenAsset(SpriteFile::DefaultSpriteFileName);
+    sprite_file = AssetMgr->OpenAsset(SpriteFile::DefaultSpriteFileName);
     if (!sprite_file)
     {
         return new Error(String::FromFormat("Failed to open spriteset file '%s'.",
             SpriteFile::DefaultSpriteFileName.GetCStr()));
     }
-    auto index_file = AssetMgr->OpenAsset(SpriteFile::DefaultSpriteIndexName);
+    index_file = AssetMgr->OpenAsset(SpriteFile::DefaultSpriteIndexName);
+    return HError::None();
+}
+
+// Reads the sprite index, and sets up the sprite cache;
+// may be called on any thread, so long as nothing else uses the spriteset
+static HError engine_init_sprite_cache(std::unique_ptr<Stream> sprite_file,
+    std::unique_ptr<Stream> index_file)
+{
     HError err = spriteset.InitFile(std::move(sprite_file), std::move(index_file));
     if (!err) 
     {
@@ -594,6 +622,15 @@ HError engine_init_sprites()
     return HError::None();
 }
 
+HError engine_init_sprites()
+{
+    std::unique_ptr<Stream> sprite_file, index_file;
+    HError err = engine_open_sprite_files(sprite_file, index_file);
+    if (!err)
+        return err;
+    return engine_init_sprite_cache(std::move(sprite_file), std::move(index_file));
+}
+
 // TODO: this should not be a part of "engine_" function group,
 // move this elsewhere (InitGameState?).
 void engine_init_game_settings()
@@ -1176,19 +1213,39 @@ void engine_init_editor_debugging(const ConfigTree &cfg)
     ccSetDebugHook(scriptDebugHook);
 }
 
+// Time when the engine initialization has started, and ended
+static Clock::time_point engine_start_time;
+static Clock::time_point engine_init_end_time;
+static bool engine_first_frame_reported = false;
+
+// Logs the time spent in the engine initialization phase,
+// relative to the start of the engine initialization
+static void engine_log_init_phase(const char *name, const Clock::time_point &start,
+    const Clock::time_point &end, bool on_worker = false)
+{
+    Debug::Printf(kDbgGroup_Init, kDbgMsg_Debug, "%-18s %9.2f - %9.2f ms: %8.2f ms%s",
+        name, ToMillisecondsF(start - engine_start_time), ToMillisecondsF(end - engine_start_time),
+        ToMillisecondsF(end - start), on_worker ? " (worker thread)" : "");
+}
+
 // TODO: this function is still a big mess, engine/system-related initialization
 // is mixed with game-related data adjustments. Divide it in parts, move game
 // data init into either InitGameState() or other game method as appropriate.
 int initialize_engine(const ConfigTree &startup_opts)
 {
+    engine_start_time = Clock::now();
+    engine_first_frame_reported = false;
+
     if (engine_pre_init_callback) {
         engine_pre_init_callback();
     }
 
     //-----------------------------------------------------
     // Install backend
+    Clock::time_point phase_start = Clock::now();
     if (!engine_init_backend())
         return EXIT_ERROR;
+    engine_log_init_phase("Backend", phase_start, Clock::now());
 
     //-----------------------------------------------------
     // Connect to the external debugger, if required;
@@ -1208,8 +1265,10 @@ int initialize_engine(const ConfigTree &startup_opts)
         return EXIT_NORMAL;
     }
 
+    phase_start = Clock::now();
     if (!engine_init_gamedata())
         return EXIT_ERROR;
+    engine_log_init_phase("Locate game data", phase_start, Clock::now());
 
     // Test if need to run built-in setup program (where available)
     if (!justTellInfo && justRunSetup)
@@ -1221,6 +1280,7 @@ int initialize_engine(const ConfigTree &startup_opts)
     }
 
     // Set up game options from user config
+    phase_start = Clock::now();
     ConfigTree cfg;
     engine_prepare_config(cfg, nullptr, startup_opts);
     engine_set_config(cfg);
@@ -1230,103 +1290,155 @@ int initialize_engine(const ConfigTree &startup_opts)
         return EXIT_NORMAL;
     }
 
-    set_our_eip(-190);
+    engine_log_init_phase("Config", phase_start, Clock::now());
 
     //-----------------------------------------------------
-    // Init auxiliary data files and other directories, initialize asset manager
-    engine_init_user_directories();
-
-    set_our_eip(-191);
-
-    engine_locate_speech_pak();
-
-    set_our_eip(-192);
-
-    engine_locate_audio_pak();
-
-    set_our_eip(-193);
-
-    engine_assign_assetpaths();
-
-    //-----------------------------------------------------
-    // Begin setting up systems
-
-    set_our_eip(-194);
-
-    engine_init_fonts();
-
-    set_our_eip(-195);
-
-    engine_init_keyboard();
-
-    set_our_eip(-196);
-
-    engine_init_mouse();
-
-    set_our_eip(-198);
-
-    engine_init_audio();
-
-    set_our_eip(-199);
-
-    engine_init_debug();
-
-    set_our_eip(-10);
-
-    engine_init_exit_handler();
-
-    set_our_eip(-20);
-    set_our_eip(-19);
-
-    int res = engine_load_game_data();
-    if (res != 0)
-        return res;
-
-    set_our_eip(-189);
-
-    res = engine_check_disk_space();
-    if (res != 0)
-        return res;
-
-    // Make sure that at least one font was loaded in the process of loading
-    // the game data.
-    // TODO: Fold this check into engine_load_game_data()
-    res = engine_check_font_was_loaded();
-    if (res != 0)
-        return res;
-
-    set_our_eip(-179);
-
-    engine_adjust_for_rotation_settings();
-
-    // Attempt to initialize graphics mode
-    if (!engine_try_set_gfxmode_any(usetup.Display))
-        return EXIT_ERROR;
-
-    // Configure game window after renderer was initialized
-    engine_setup_window();
-
-    SetMultitasking(usetup.RunInBackground);
-
-    sys_window_show_cursor(false); // hide the system cursor
-
-    show_preload();
-    HError err = engine_init_sprites();
-    if (!err)
+    // Set up the engine systems and load the game. This is arranged as a
+    // graph of tasks, where each task is started as soon as the ones it
+    // depends on are complete. The tasks are run in the order they are added,
+    // unless told to run on "any thread", in which case they may be run on
+    // a worker thread in parallel with the rest. Only the tasks which do not
+    // use AssetManager, graphics, script or other non-thread-safe systems may
+    // be run on a worker thread.
+    TaskGraph graph;
+    auto assets_task = graph.AddTask("Asset paths", TaskGraph::kTask_MainThread, []()
+    {
+        set_our_eip(-190);
+        // Init auxiliary data files and other directories, initialize asset manager
+        engine_init_user_directories();
+        set_our_eip(-191);
+        engine_locate_speech_pak();
+        set_our_eip(-192);
+        engine_locate_audio_pak();
+        set_our_eip(-193);
+        engine_assign_assetpaths();
+        return 0;
+    });
+    auto fonts_task = graph.AddTask("Fonts", TaskGraph::kTask_MainThread, []()
+    {
+        set_our_eip(-194);
+        engine_init_fonts();
+        return 0;
+    }, { assets_task });
+    auto input_task = graph.AddTask("Input", TaskGraph::kTask_MainThread, []()
+    {
+        set_our_eip(-195);
+        engine_init_keyboard();
+        set_our_eip(-196);
+        engine_init_mouse();
+        return 0;
+    });
+    auto audio_driver_task = graph.AddTask("Audio driver", TaskGraph::kTask_MainThread, []()
+    {
+        set_our_eip(-198);
+        engine_init_audio_driver();
+        return 0;
+    });
+    auto audio_task = graph.AddTask("Audio", TaskGraph::kTask_AnyThread, []()
+    {
+        engine_init_audio();
+        return 0;
+    }, { audio_driver_task });
+    auto debug_task = graph.AddTask("Debug", TaskGraph::kTask_MainThread, []()
+    {
+        set_our_eip(-199);
+        engine_init_debug();
+        set_our_eip(-10);
+        engine_init_exit_handler();
+        return 0;
+    });
+    auto game_data_task = graph.AddTask("Game data", TaskGraph::kTask_MainThread, []()
+    {
+        set_our_eip(-20);
+        set_our_eip(-19);
+        int res = engine_load_game_data();
+        if (res != 0)
+            return res;
+        set_our_eip(-189);
+        res = engine_check_disk_space();
+        if (res != 0)
+            return res;
+        // Make sure that at least one font was loaded in the process of loading
+        // the game data.
+        // TODO: Fold this check into engine_load_game_data()
+        return engine_check_font_was_loaded();
+    }, { assets_task, fonts_task });
+    // Sprite files are opened on the main thread, but the sprite index is
+    // read on a worker, while the graphics mode is being set up
+    std::unique_ptr<Stream> sprite_file, index_file;
+    HError sprite_err = HError::None();
+    auto sprite_files_task = graph.AddTask("Sprite files", TaskGraph::kTask_MainThread,
+        [&sprite_file, &index_file, &sprite_err]()
+    {
+        sprite_err = engine_open_sprite_files(sprite_file, index_file);
+        return sprite_err ? 0 : EXIT_ERROR;
+    }, { game_data_task });
+    auto sprites_task = graph.AddTask("Sprite index", TaskGraph::kTask_AnyThread,
+        [&sprite_file, &index_file, &sprite_err]()
+    {
+        sprite_err = engine_init_sprite_cache(std::move(sprite_file), std::move(index_file));
+        return sprite_err ? 0 : EXIT_ERROR;
+    }, { sprite_files_task });
+    auto gfx_task = graph.AddTask("Graphics mode", TaskGraph::kTask_MainThread, []()
     {
-        platform->DisplayAlert("Could not load sprite set file:\n%s", err->FullMessage().GetCStr());
+        set_our_eip(-179);
+        engine_adjust_for_rotation_settings();
+        // Attempt to initialize graphics mode
+        if (!engine_try_set_gfxmode_any(usetup.Display))
+            return EXIT_ERROR;
+        // Configure game window after renderer was initialized
+        engine_setup_window();
+        SetMultitasking(usetup.RunInBackground);
+        sys_window_show_cursor(false); // hide the system cursor
+        show_preload();
+        return 0;
+    }, { game_data_task, input_task });
+    graph.AddTask("Game settings", TaskGraph::kTask_MainThread, []()
+    {
+        // TODO: move *init_game_settings to game init code unit
+        engine_init_game_settings();
+        return 0;
+    }, { gfx_task, sprites_task, audio_task, debug_task });
+
+    ThreadPool startup_pool;
+    startup_pool.Start(ThreadPool::GetDefaultThreadCount(2u));
+    const int res = graph.Run(startup_pool);
+    // Stop the pool now, as the game is run from this function
+    startup_pool.Stop();
+    for (const auto &task : graph.GetTasks())
+    {
+        if (task.StartTime != Clock::time_point())
+            engine_log_init_phase(task.Name.GetCStr(), task.StartTime, task.EndTime, task.RanOnWorker);
+    }
+    if (!sprite_err)
+    {
+        platform->DisplayAlert("Could not load sprite set file:\n%s", sprite_err->FullMessage().GetCStr());
         return EXIT_ERROR;
     }
+    if (res != 0)
+        return res;
 
-    // TODO: move *init_game_settings to game init code unit
-    engine_init_game_settings();
+    phase_start = Clock::now();
     engine_prepare_to_start_game();
+    engine_log_init_phase("Prepare to start", phase_start, Clock::now());
+    engine_init_end_time = Clock::now();
 
     initialize_start_and_play_game(override_start_room, loadSaveGameOnStartup);
 
     return EXIT_NORMAL;
 }
 
+void engine_report_first_frame()
+{
+    if (engine_first_frame_reported)
+        return;
+    engine_first_frame_reported = true;
+    const Clock::time_point now = Clock::now();
+    engine_log_init_phase("Game start", engine_init_end_time, now);
+    Debug::Printf(kDbgGroup_Init, kDbgMsg_Debug, "Time to first frame: %.2f ms",
+        ToMillisecondsF(now - engine_start_time));
+}
+
 bool engine_try_set_gfxmode_any(const DisplayModeSetup &setup)
 {
     const DisplayMode old_dm = gfxDriver ? gfxDriver->GetDisplayMode() : DisplayMode();
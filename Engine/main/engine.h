@@ -24,6 +24,9 @@ void        show_preload();
 void        engine_init_game_settings();
 AGS::Common::HError engine_init_sprites();
 int         initialize_engine(const AGS::Common::ConfigTree &startup_opts);
+// Reports the time passed since the engine start, when the first game frame
+// is rendered; only does this once, following calls are ignored
+void        engine_report_first_frame();
 
 struct DisplayModeSetup;
 // Try to set new graphics mode deduced from given configuration;
@@ -34,6 +34,7 @@
 #include "ac/global_display.h"
 #include "ac/global_game.h"
 #include "ac/global_gui.h"
+#include "ac/global_object.h"
 #include "ac/global_region.h"
 #include "ac/gui.h"
 #include "ac/hotspot.h"
@@ -60,6 +61,7 @@
 #include "main/game_run.h"
 #include "main/update.h"
 #include "media/audio/audio_system.h"
+#include "media/video/video.h"
 #include "platform/base/agsplatformdriver.h"
 #include "plugin/plugin_engine.h"
 #include "script/script.h"
@@ -803,14 +805,17 @@ extern std::vector<ViewStruct> views;
 
 static void update_objects_scale()
 {
+    // the hit test indexes follow the objects' new positions and sizes
     for (uint32_t objid = 0; objid < croom->numobj; ++objid)
     {
         update_object_scale(objid);
+        update_object_hit_index(objid);
     }
 
     for (int charid = 0; charid < game.numcharacters; ++charid)
     {
         update_character_scale(charid);
+        update_character_hit_index(charid);
     }
 }
 
@@ -1056,10 +1061,14 @@ void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int
     update_cursor_view();
 
     update_audio_system_on_game_loop();
+    update_video_system_on_game_loop();
 
     // Only render if we are not skipping a cutscene
     if (!play.fast_forward)
+    {
         render_graphics(extraBitmap, extraX, extraY);
+        engine_report_first_frame();
+    }
 
     set_our_eip(6);
 
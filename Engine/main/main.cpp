@@ -127,7 +127,8 @@ void main_print_help() {
           //--------------------------------------------------------------------------------|
            "  --gfxfilter FILTER [SCALING]\n"
            "                               Request graphics filter. Available options:\n"
-           "                                 stdscale, linear\n"
+           "                                 stdscale, linear,\n"
+           "                                 scale2x, scale3x, scale4x (software driver)\n"
            "                               (support may differ between graphic drivers);\n"
            "                               Scaling is specified as:\n"
            "                                 proportional, round, stretch,\n"
@@ -148,7 +149,7 @@ void main_print_help() {
            "                                 stdout, file, console\n"
            "                               (where \"console\" is internal engine's console)\n"
            "                               GROUPs are:\n"
-           "                                 all, main (m), game (g), manobj (o),\n"
+           "                                 all, main (m), game (g), init (i), manobj (o),\n"
            "                                 plugin (p), script (s), sdl(l), sprcache (c)\n"
            "                               LEVELs are:\n"
            "                                 all, alert (1), fatal (2), error (3), warn (4),\n"
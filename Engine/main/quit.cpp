@@ -24,6 +24,7 @@
 #include "ac/gamesetup.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/gamestate.h"
+#include "ac/roompreload.h"
 #include "ac/roomstatus.h"
 #include "ac/route_finder.h"
 #include "ac/translation.h"
@@ -202,6 +203,7 @@ void quit(const char *quitmsg)
         platform->ShutdownCDPlayer();
     video_shutdown();
     quit_shutdown_audio();
+    preload_room_shutdown();
 
     set_our_eip(9908);
 
@@ -16,17 +16,21 @@
 // Game update procedure
 //
 
+#include <algorithm>
 #include <math.h>
 #include "ac/common.h"
 #include "ac/character.h"
+#include "ac/character_update.h"
 #include "ac/characterextras.h"
 #include "ac/draw.h"
 #include "ac/game.h"
 #include "ac/gamestate.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/global_character.h"
+#include "ac/global_game.h"
 #include "ac/lipsync.h"
 #include "ac/movelist.h"
+#include "ac/movelist_stepper.h"
 #include "ac/overlay.h"
 #include "ac/screenoverlay.h"
 #include "ac/spritecache.h"
@@ -62,94 +66,17 @@ extern std::vector<SpeechLipSyncLine> splipsync;
 extern int numLipLines, curLipLine, curLipLinePhoneme;
 extern IGraphicsDriver *gfxDriver;
 
+// Movement and animation state of the characters, gathered on each update
+static CharacterUpdateState CharUpdate;
+// Movement of the room objects, advanced all at once on each update
+static MoveListStepper ObjectMoves;
 
-// Optionally fixes target position, when one axis is left to move along.
-// This is done only for backwards compatibility now.
-// Uses generic parameters.
-static void movelist_handle_targetfix(const fixed xpermove, const fixed ypermove, int &targety)
-{
-    // Old comment about ancient behavior:
-    // if the X-movement has finished, and the Y-per-move is < 1, finish
-    // This can cause jump at the end, but without it the character will
-    // walk on the spot for a while if the Y-per-move is for example 0.2
-    //    if ((ypermove & 0xfffff000) == 0) cmls.doneflag|=2;
-    //    int ypmm=(ypermove >> 16) & 0x0000ffff;
-
-    // NEW 2.15 SR-1 plan: if X-movement has finished, and Y-per-move is < 1,
-    // allow it to finish more easily by moving target zone
-    // NOTE: interesting fact: this fix was also done for the strictly vertical
-    // move, probably because of the logical mistake in condition.
-
-    int tfix = 3;
-    // 2.70: if the X permove is also <=1, don't skip as far
-    if (((xpermove & 0xffff0000) == 0xffff0000) ||
-        ((xpermove & 0xffff0000) == 0x00000000))
-        tfix = 2;
-
-    // 2.61 RC1: correct this to work with > -1 as well as < 1
-    if (ypermove == 0) {}
-    // Y per move is < 1, so finish the move
-    else if ((ypermove & 0xffff0000) == 0)
-        targety -= tfix;
-    // Y per move is -1 exactly, don't snap to finish
-    else if ((ypermove & 0xffffffff) == 0xffff0000) {}
-    // Y per move is > -1, so finish the move
-    else if ((ypermove & 0xffff0000) == 0xffff0000)
-        targety += tfix;
-}
-
-// Handle remaining move along a single axis; uses generic parameters.
-static void movelist_handle_remainer(const fixed xpermove, const fixed ypermove,
-    const int xdistance, const float step_length, fixed &fin_ymove, float &fin_from_part)
-{
-    // Walk along the remaining axis with the full walking speed
-    assert(xpermove != 0 && ypermove != 0 && step_length >= 0.f);
-    fin_ymove = ypermove > 0 ? ftofix(step_length) : -ftofix(step_length);
-    fin_from_part = (float)xdistance / fixtof(xpermove);
-    assert(fin_from_part >= 0);
-}
-
-// Handle remaining move fixup, but only if necessary
-static void movelist_handle_remainer(MoveList &m)
-{
-    assert(m.GetNumStages() > 0);
-    const fixed xpermove = m.permove[m.onstage].X;
-    const fixed ypermove = m.permove[m.onstage].Y;
-    const Point target = m.pos[m.onstage + 1];
-    // Apply remainer to movelists where LONGER axis was completed, and SHORTER remains
-    if ((xpermove != 0) && (ypermove != 0))
-    {
-        if ((m.doneflag & kMoveListDone_XY) == kMoveListDone_X && (abs(ypermove) < abs(xpermove)))
-            movelist_handle_remainer(xpermove, ypermove, (target.X - m.from.X),
-                m.GetStepLength(), m.fin_move, m.fin_from_part);
-        else if ((m.doneflag & kMoveListDone_XY) == kMoveListDone_Y && (abs(xpermove) < abs(ypermove)))
-            movelist_handle_remainer(ypermove, xpermove, (target.Y - m.from.Y),
-                m.GetStepLength(), m.fin_move, m.fin_from_part);
-    }
-}
 
-// Test if move completed, returns if just completed
-static bool movelist_handle_donemove(const uint8_t testflag, const fixed xpermove, const int targetx, uint8_t &doneflag, int &xps)
+static MoveStepOptions get_move_step_options()
 {
-    if ((doneflag & testflag) != 0)
-        return false; // already done before
-
-    if (((xpermove > 0) && (xps >= targetx)) || ((xpermove < 0) && (xps <= targetx)))
-    {
-        doneflag |= testflag;
-        xps = targetx; // snap to the target (in case run over)
-        // Comment about old engine behavior:
-        // if the Y is almost there too, finish it
-        // this is new in v2.40
-        // removed in 2.70
-        /*if (abs(yps - targety) <= 2)
-            yps = targety;*/
-    }
-    else if (xpermove == 0)
-    {
-        doneflag |= testflag;
-    }
-    return (doneflag & testflag) != 0;
+    MoveStepOptions opts;
+    opts.LegacyTargetFix = loaded_game_file_version < kGameVersion_361;
+    return opts;
 }
 
 int do_movelist_move(short &mslot, int &pos_x, int &pos_y)
@@ -159,90 +86,21 @@ int do_movelist_move(short &mslot, int &pos_x, int &pos_y)
     if (mslot < 1)
         return 0;
 
-    int need_to_fix_sprite = 0; // TODO: find out what this value means and refactor
-    MoveList &cmls = mls[mslot];
-    const fixed xpermove = cmls.permove[cmls.onstage].X;
-    const fixed ypermove = cmls.permove[cmls.onstage].Y;
-    const fixed fin_move = cmls.fin_move;
-    const float main_onpart = (cmls.fin_from_part > 0.f) ? cmls.fin_from_part : cmls.onpart;
-    const float fin_onpart = cmls.onpart - main_onpart;
-    Point target = cmls.pos[cmls.onstage + 1];
-    int xps = pos_x, yps = pos_y;
-
-    // Old-style optional move target fixup
-    if (loaded_game_file_version < kGameVersion_361)
-    {
-        if ((ypermove != 0) && (cmls.doneflag & kMoveListDone_X) != 0)
-        { // X-move has finished, handle the Y-move remainer
-            movelist_handle_targetfix(xpermove, ypermove, target.Y);
-        }
-        else if ((xpermove != 0) && (cmls.doneflag & kMoveListDone_Y) != 0)
-        { // Y-move has finished, handle the X-move remainer
-            movelist_handle_targetfix(xpermove, ypermove, target.Y);
-        }
-    }
-
-    // Calculate next positions, as required
-    if ((cmls.doneflag & kMoveListDone_X) == 0)
-    {
-        xps = cmls.from.X + (int)(fixtof(xpermove) * main_onpart) +
-          (int)(fixtof(fin_move) * fin_onpart);
-    }
-    if ((cmls.doneflag & kMoveListDone_Y) == 0)
-    {
-        yps = cmls.from.Y + (int)(fixtof(ypermove) * main_onpart) +
-          (int)(fixtof(fin_move) * fin_onpart);
-    }
-
-    // Check if finished either horizontal or vertical movement;
-    // if any was finished just now, then also handle remainer fixup
-    bool done_now = movelist_handle_donemove(kMoveListDone_X, xpermove, target.X, cmls.doneflag, xps);
-    done_now     |= movelist_handle_donemove(kMoveListDone_Y, ypermove, target.Y, cmls.doneflag, yps);
-    if (done_now)
-        movelist_handle_remainer(cmls);
-
-    // Handle end of move stage
-    if ((cmls.doneflag & kMoveListDone_XY) == kMoveListDone_XY)
-    {
-        // this stage is done, go on to the next stage
-        cmls.from = cmls.pos[cmls.onstage + 1];
-        cmls.onstage++;
-        cmls.onpart = -1.f;
-        cmls.fin_from_part = 0.f;
-        cmls.fin_move = 0;
-        cmls.doneflag = 0;
-        if (cmls.onstage < cmls.GetNumStages())
-        {
-            xps = cmls.from.X;
-            yps = cmls.from.Y;
-        }
-
-        if (cmls.onstage >= cmls.GetNumStages() - 1)
-        {  // last stage is just dest pos
-            cmls = {};
-            mslot = 0;
-            need_to_fix_sprite = 1; // TODO: find out what this means
-        }
-        else
-        {
-            need_to_fix_sprite = 2; // TODO: find out what this means
-        }
-    }
-
-    // Make a step along the current vector and return
-    cmls.onpart += 1.f;
-    pos_x = xps;
-    pos_y = yps;
-    return need_to_fix_sprite;
+    const MoveStepResult result = StepMoveList(mls[mslot], pos_x, pos_y, get_move_step_options());
+    if (result == kMoveStep_Finished)
+        mslot = 0;
+    return result;
 }
 
 void restore_movelists()
 {
+    // Movelists were restored, so the stages cached by the stepper are not valid
+    ObjectMoves.Clear();
     // Recalculate move remainer fixups, where necessary
     for (auto &m : mls)
     {
         if (m.GetNumStages() > 0)
-            movelist_handle_remainer(m);
+            UpdateMoveListRemainer(m);
     }
 }
 
@@ -254,8 +112,24 @@ void update_script_timers()
     }
 }
 
+// Makes a move step for all the moving room objects
+static void update_object_moves()
+{
+    ObjectMoves.SetCount(croom->numobj);
+    for (uint32_t i = 0; i < croom->numobj; ++i)
+    {
+        RoomObject &obj = objs[i];
+        const bool is_moving = (obj.on == 1) && (obj.moving > 0);
+        ObjectMoves.Sync(i, is_moving ? &mls[obj.moving] : nullptr, &obj.x, &obj.y);
+    }
+    ObjectMoves.Step(get_move_step_options());
+    for (int i : ObjectMoves.GetFinished())
+        objs[i].moving = 0;
+}
+
 void update_cycling_views()
 {
+    update_object_moves();
 	// update graphics for object if cycling view
   for (uint32_t i = 0; i < croom->numobj; ++i)
   {
@@ -282,17 +156,34 @@ void update_player_view()
         playerchar->view = playerchar->defview;
 }
 
-void update_character_move_and_anim(std::vector<int> &followingAsSheep)
+void reset_character_update()
 {
-	// move & animate characters
-  for (int aa=0;aa<game.numcharacters;aa++) {
-    if (game.chars[aa].on != 1) continue;
-
-    CharacterInfo*chi    = &game.chars[aa];
-	CharacterExtras*chex = &charextra[aa];
+    CharUpdate.Reset();
+}
 
-	UpdateCharacterMoveAndAnim(chi, chex, followingAsSheep);
+void update_character_move_and_anim(std::vector<int> &followingAsSheep)
+{
+  // count down the delays of the characters which do nothing else this frame,
+  // and write them back before the rest of the characters are updated;
+  // this is done by blocks, while the characters are still in cache
+  const bool idle_tick = (get_loop_counter() % GetGameSpeed()) == 0;
+  for (int first = 0; first < game.numcharacters; first += CharacterUpdateState::BlockSize) {
+    const int count = std::min(game.numcharacters - first, CharacterUpdateState::BlockSize);
+    CharUpdate.SyncFrom(game.chars.data(), charextra.data(), first, count);
+    CharUpdate.Update(displayed_room, idle_tick, views);
+    CharUpdate.SyncTo(game.chars.data(), charextra.data());
+
+    // move & animate the remaining characters
+    for (int aa : CharUpdate.GetFullUpdate()) {
+      CharacterInfo*chi    = &game.chars[aa];
+      CharacterExtras*chex = &charextra[aa];
+
+      UpdateCharacterMoveAndAnim(chi, chex, followingAsSheep);
+    }
   }
+
+  // start the walks which were queued by the following characters
+  walk_queued_characters();
 }
 
 void update_following_exactly_characters(const std::vector<int> &followingAsSheep)
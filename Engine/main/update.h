@@ -30,6 +30,8 @@ int do_movelist_move(short &mslot, int &pos_x, int &pos_y);
 void restore_movelists();
 // Update various things on the game frame (historical code mess...)
 void update_stuff();
+// Resets the characters' update state, when the game data is unloaded
+void reset_character_update();
 
 // Tells if a voice lipsyncing is currently active (enabled and speech playing)
 bool has_voice_lipsync();
@@ -28,6 +28,7 @@
 #include "ac/path_helper.h"
 #include "ac/view.h"
 #include "media/audio/sound.h"
+#include "media/audio/soundprefetch.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
 #include "ac/common.h"
@@ -684,6 +685,7 @@ void stop_all_sound_and_music()
 void shutdown_sound() 
 {
     stop_all_sound_and_music(); // game logic
+    soundprefetch_shutdown(); // prefetched sounds
     audio_core_shutdown(); // audio core system
     soundcache_clear(); // clear cached data
     sys_audio_shutdown(); // backend; NOTE: sys_main will know if it's required
@@ -930,6 +932,9 @@ void update_audio_system_on_game_loop ()
 
     // Sync logical game channels with the audio backend again
     sync_audio_playback();
+
+    // Pass any commands which are still waiting for the room in the queue
+    audio_core_flush_commands();
 }
 
 void stopmusic()
@@ -13,20 +13,66 @@
 //=============================================================================
 #include "media/audio/audio_core.h"
 #include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <stdexcept>
 #include <thread>
 #include <unordered_map>
 #include "debug/out.h"
 #include "media/audio/audioplayer.h"
+#include "media/audio/decodeahead.h"
+#include "media/audio/loopbackoutput.h"
 #include "media/audio/sdldecoder.h"
 #include "media/audio/openalsource.h"
 #include "util/memory_compat.h"
+#include "util/spsc_queue.h"
 
 using namespace AGS::Common;
 using namespace AGS::Engine;
 
+// Commands passed from the game thread to the audio thread
+enum AudioCommandType
+{
+    kAudioCmd_None,
+    kAudioCmd_AddSlot,      // take ownership of a new player
+    kAudioCmd_RemoveSlot,   // stop and dispose the player
+    kAudioCmd_Play,
+    kAudioCmd_Pause,
+    kAudioCmd_Seek,
+    kAudioCmd_Volume,
+    kAudioCmd_Panning,
+    kAudioCmd_Speed
+};
+
+struct AudioCommand
+{
+    AudioCommandType Type = kAudioCmd_None;
+    int Slot = -1;
+    float Value = 0.f;
+    // Command's sequence number, echoed in the player's status when applied
+    uint32_t Seq = 0u;
+    // New player for the AddSlot command, the command owns it until applied
+    AudioPlayer *Player = nullptr;
+
+    AudioCommand() = default;
+    AudioCommand(AudioCommandType type, int slot, float value = 0.f, AudioPlayer *player = nullptr)
+        : Type(type), Slot(slot), Value(value), Player(player) {}
+};
+
+// Max number of the commands waiting to be applied by the audio thread;
+// if there are more, they wait in the game thread's overflow list
+static const size_t AudioCommandQueueSize = 1024;
+// Max number of decoding threads chosen automatically
+static const size_t MaxDecodeThreads = 2;
+// Max and min time the audio thread sleeps in between the polls, in ms;
+// it wakes up earlier when there are new commands or decoded data
+static const int MaxPollWaitMs = 50;
+static const int MinPollWaitMs = 1;
+
 // Global audio core state and resources
 static struct 
 {
@@ -37,17 +83,41 @@ static struct
 
     // Audio thread: polls sound decoders, feeds OpenAL sources
     std::thread audio_core_thread;
-    bool audio_core_thread_running = false;
+    std::atomic<bool> audio_core_thread_running{false};
 
     // Sound slot id counter
     int nextId = 0;
-
-    // One mutex to lock them all... any operation on individual decoders
-    // is done under this only mutex, which means that they are currently
-    // polled one by one, any action like pause/resume is also synced.
+    // Command sequence counter, accessed only by the game thread
+    uint32_t commandSeq = 0u;
+
+    // Commands from the game thread, and ones which did not fit into the queue
+    // yet (the latter is only accessed by the game thread)
+    SpscQueue<AudioCommand> commands{AudioCommandQueueSize};
+    std::deque<AudioCommand> commands_overflow;
+    // Player status snapshots, accessed only by the game thread
+    std::unordered_map<int, std::shared_ptr<const AudioPlayerStatus>> slot_status;
+
+    // Audio thread's wait condition; the mutex is only locked by the audio
+    // thread itself, the game thread merely notifies it about new commands
     std::mutex mixer_mutex_m;
     std::condition_variable mixer_cv;
+    // Set by the decoding workers when there's new decoded data
+    std::atomic<bool> decoded_ready{false};
+    // Time to wait until the next poll, calculated by the audio thread
+    int next_poll_wait_ms = MaxPollWaitMs;
+    // Decoding workers
+    DecodeAheadPool decode_pool;
+    // Players, accessed only by the audio thread
     std::unordered_map<int, std::unique_ptr<AudioPlayer>> slots_;
+
+    // Headless output, renders the mix when there's no sound device;
+    // accessed only by the audio thread after init
+    std::unique_ptr<LoopbackOutput> loopback;
+    AudioOutputPace loopback_pace = kAudioPace_Realtime;
+    // Wall clock time when the next block of the mix is due (realtime pace)
+    std::chrono::steady_clock::time_point loopback_due;
+    // Sum of the playing sounds over all the rendered blocks
+    uint64_t loopback_mixed_sounds = 0u;
 } g_acore;
 
 // Prints any OpenAL errors to the log
@@ -64,18 +134,39 @@ void dump_al_errors()
 // -------------------------------------------------------------------------------------------------
 
 static void audio_core_entry();
+static void audio_core_run_command(const AudioCommand &cmd);
+static void audio_core_log_slot_stats(int slot, const AudioPlayer &player);
 
-void audio_core_init() 
+void audio_core_init(float decode_ahead_ms, size_t decode_threads, const AudioOutputSetup &output)
 {
     /* InitAL opens a device and sets up a context using default attributes, making
      * the program ready to call OpenAL functions. */
 
-    /* Open and initialize a device */
-    g_acore.alcDevice = alcOpenDevice(nullptr);
-    if (!g_acore.alcDevice) { throw std::runtime_error("AudioCore: error opening device"); }
+    if (output.Type == kAudioOutput_Device)
+    {
+        /* Open and initialize a device */
+        g_acore.alcDevice = alcOpenDevice(nullptr);
+        if (!g_acore.alcDevice) { throw std::runtime_error("AudioCore: error opening device"); }
 
-    g_acore.alcContext = alcCreateContext(g_acore.alcDevice, nullptr);
-    if (!g_acore.alcContext) { throw std::runtime_error("AudioCore: error creating context"); }
+        g_acore.alcContext = alcCreateContext(g_acore.alcDevice, nullptr);
+        if (!g_acore.alcContext) { throw std::runtime_error("AudioCore: error creating context"); }
+    }
+    else
+    {
+        /* Open a loopback device, which mix is rendered by the audio thread */
+        auto loopback = std::make_unique<LoopbackOutput>();
+        loopback->Open(output.Freq, output.Type == kAudioOutput_Wav ? output.WavFile : String());
+        g_acore.loopback = std::move(loopback);
+        g_acore.alcDevice = g_acore.loopback->GetDevice();
+        g_acore.alcContext = g_acore.loopback->GetContext();
+        g_acore.loopback_pace = output.Pace;
+        g_acore.loopback_due = std::chrono::steady_clock::now();
+        g_acore.loopback_mixed_sounds = 0u;
+        Debug::Printf(kDbgMsg_Info, "AudioCore: rendering without a sound device, %d Hz, %s pace%s%s",
+            output.Freq, output.Pace == kAudioPace_Fast ? "fast" : "realtime",
+            output.Type == kAudioOutput_Wav ? ", into " : "",
+            output.Type == kAudioOutput_Wav ? output.WavFile.GetCStr() : "");
+    }
 
     if (alcMakeContextCurrent(g_acore.alcContext) == ALC_FALSE) { throw std::runtime_error("AudioCore: error setting context"); }
 
@@ -97,6 +188,20 @@ void audio_core_init()
         Debug::Printf(kDbgMsg_Info, " - %s : %s", (*dec)->description, buf.GetCStr());
     }
 
+    // When rendering as fast as possible, decode right when the data is
+    // needed, as the mix would otherwise run ahead of the decoding workers
+    if (g_acore.loopback && (g_acore.loopback_pace == kAudioPace_Fast))
+        decode_threads = 0u;
+    else if (decode_threads == 0u)
+        decode_threads = ThreadPool::GetDefaultThreadCount(MaxDecodeThreads);
+    g_acore.decode_pool.Start(decode_threads, decode_ahead_ms, []()
+    {
+        g_acore.decoded_ready = true;
+        g_acore.mixer_cv.notify_all();
+    });
+    Debug::Printf(kDbgMsg_Info, "AudioCore: decoding ahead %.0f ms, on %zu thread(s)",
+        decode_ahead_ms, decode_threads);
+
     g_acore.audio_core_thread_running = true;
 #if !defined(AGS_DISABLE_THREADS)
     g_acore.audio_core_thread = std::thread(audio_core_entry);
@@ -110,9 +215,33 @@ void audio_core_shutdown()
     if (g_acore.audio_core_thread.joinable())
         g_acore.audio_core_thread.join();
 #endif
-
-    // dispose all the active slots
+    // finish any decoding in progress; after this the players decode
+    // right on the calling thread
+    g_acore.decode_pool.Stop();
+
+    // apply any remaining commands, so that no new players are lost,
+    // then dispose all the active slots
+    AudioCommand cmd;
+    while (g_acore.commands.TryPop(cmd))
+        audio_core_run_command(cmd);
+    for (const auto &overflow_cmd : g_acore.commands_overflow)
+        audio_core_run_command(overflow_cmd);
+    g_acore.commands_overflow.clear();
+    for (const auto &entry : g_acore.slots_)
+        audio_core_log_slot_stats(entry.first, *entry.second);
     g_acore.slots_.clear();
+    g_acore.slot_status.clear();
+
+    if (g_acore.loopback)
+    {
+        const float rendered_ms = g_acore.loopback->GetRenderedMs();
+        const float mix_ms = g_acore.loopback->GetMixTimeMs();
+        const uint64_t blocks = static_cast<uint64_t>(rendered_ms / g_acore.loopback->GetBlockMs() + 0.5f);
+        Debug::Printf(kDbgMsg_Info, "AudioCore: rendered %.0f ms of sound, mixing took %.2f ms (%.2f%%), %.2f sounds playing on average",
+            rendered_ms, mix_ms, rendered_ms > 0.f ? mix_ms * 100.f / rendered_ms : 0.f,
+            blocks > 0u ? static_cast<float>(g_acore.loopback_mixed_sounds) / blocks : 0.f);
+        g_acore.loopback->Close();
+    }
 
     // SDL_Sound
     Sound_Quit();
@@ -127,6 +256,7 @@ void audio_core_shutdown()
         alcCloseDevice(g_acore.alcDevice);
         g_acore.alcDevice = nullptr;
     }
+    g_acore.loopback.reset();
 }
 
 
@@ -152,12 +282,42 @@ static int avail_slot_id()
     return g_acore.nextId++;
 }
 
+// Moves as many of the overflow commands into the queue as it fits
+static void audio_core_push_overflow()
+{
+    while (!g_acore.commands_overflow.empty() &&
+           g_acore.commands.TryPush(g_acore.commands_overflow.front()))
+        g_acore.commands_overflow.pop_front();
+}
+
+// Passes the command to the audio thread, never waits for it;
+// returns the command's sequence number
+static uint32_t audio_core_push_command(AudioCommand cmd)
+{
+    cmd.Seq = ++g_acore.commandSeq;
+    // commands must be applied in order, so if some are already waiting
+    // in the overflow list, then the new one has to wait behind them
+    audio_core_push_overflow();
+    if (!g_acore.commands_overflow.empty() || !g_acore.commands.TryPush(cmd))
+        g_acore.commands_overflow.push_back(cmd);
+    g_acore.mixer_cv.notify_all();
+    return cmd.Seq;
+}
+
+void audio_core_flush_commands()
+{
+    if (g_acore.commands_overflow.empty())
+        return;
+    audio_core_push_overflow();
+    g_acore.mixer_cv.notify_all();
+}
+
 static int audio_core_slot_init(std::unique_ptr<SDLDecoder> decoder)
 {
     auto handle = avail_slot_id();
-    std::lock_guard<std::mutex> lk(g_acore.mixer_mutex_m);
-    g_acore.slots_[handle] = std::make_unique<AudioPlayer>(handle, std::move(decoder));
-    g_acore.mixer_cv.notify_all();
+    auto player = std::make_unique<AudioPlayer>(handle, std::move(decoder), &g_acore.decode_pool);
+    g_acore.slot_status[handle] = player->GetStatus();
+    audio_core_push_command(AudioCommand(kAudioCmd_AddSlot, handle, 0.f, player.release()));
     return handle;
 }
 
@@ -177,35 +337,177 @@ int audio_core_slot_init(std::unique_ptr<Stream> in, const String &extension_hin
     return audio_core_slot_init(std::move(decoder));
 }
 
-AudioPlayerLock audio_core_get_player(int slot_handle)
+int audio_core_slot_init(std::shared_ptr<const DecodedSound> pcm, bool repeat)
 {
-    std::unique_lock<std::mutex> ulk(g_acore.mixer_mutex_m);
-    auto it = g_acore.slots_.find(slot_handle);
-    if (it == g_acore.slots_.end())
-        return AudioPlayerLock(nullptr, std::move(ulk), &g_acore.mixer_cv);
-    return AudioPlayerLock(it->second.get(), std::move(ulk), &g_acore.mixer_cv);
+    auto decoder = std::make_unique<SDLDecoder>(pcm, repeat);
+    if (!decoder->Open())
+        return -1;
+    return audio_core_slot_init(std::move(decoder));
+}
+
+std::shared_ptr<DecodedSound> audio_core_decode_sound(const std::vector<uint8_t> &data,
+    const String &extension_hint, float max_duration_ms)
+{
+    auto pcm = SDLDecoder::DecodeAll(data, extension_hint, max_duration_ms);
+    if (!pcm)
+        return nullptr;
+    // Convert to the format accepted by OpenAL once, so that no conversion
+    // has to be done each time the sound is played
+    SDLResampler resampler;
+    if (!resampler.Setup(pcm->Format, OpenAlSource::GetPlaybackFormat(pcm->Format)))
+        return nullptr;
+    if (resampler.HasConversion())
+    {
+        size_t conv_sz;
+        const uint8_t *conv = static_cast<const uint8_t*>(
+            resampler.Convert(pcm->Data.data(), pcm->Data.size(), conv_sz));
+        if (!conv)
+            return nullptr;
+        pcm->Data.assign(conv, conv + conv_sz);
+        pcm->Format = OpenAlSource::GetPlaybackFormat(pcm->Format);
+    }
+    return pcm;
+}
+
+std::shared_ptr<const AudioPlayerStatus> audio_core_get_status(int slot_handle)
+{
+    auto it = g_acore.slot_status.find(slot_handle);
+    if (it == g_acore.slot_status.end())
+        return nullptr;
+    return it->second;
+}
+
+uint32_t audio_core_slot_play(int slot_handle)
+{
+    return audio_core_push_command(AudioCommand(kAudioCmd_Play, slot_handle));
+}
+
+uint32_t audio_core_slot_pause(int slot_handle)
+{
+    return audio_core_push_command(AudioCommand(kAudioCmd_Pause, slot_handle));
+}
+
+uint32_t audio_core_slot_seek(int slot_handle, float pos_ms)
+{
+    return audio_core_push_command(AudioCommand(kAudioCmd_Seek, slot_handle, pos_ms));
+}
+
+void audio_core_slot_set_volume(int slot_handle, float volume)
+{
+    audio_core_push_command(AudioCommand(kAudioCmd_Volume, slot_handle, volume));
+}
+
+void audio_core_slot_set_panning(int slot_handle, float panning)
+{
+    audio_core_push_command(AudioCommand(kAudioCmd_Panning, slot_handle, panning));
+}
+
+void audio_core_slot_set_speed(int slot_handle, float speed)
+{
+    audio_core_push_command(AudioCommand(kAudioCmd_Speed, slot_handle, speed));
 }
 
 void audio_core_slot_stop(int slot_handle)
 {
-    std::lock_guard<std::mutex> lk(g_acore.mixer_mutex_m);
-    auto it = g_acore.slots_.find(slot_handle);
-    if (it == g_acore.slots_.end())
+    if (g_acore.slot_status.erase(slot_handle) == 0)
         return;
-    it->second->Stop();
-    g_acore.slots_.erase(slot_handle);
-    g_acore.mixer_cv.notify_all();
+    audio_core_push_command(AudioCommand(kAudioCmd_RemoveSlot, slot_handle));
 }
 
 // -------------------------------------------------------------------------------------------------
 // AUDIO PROCESSING
 // -------------------------------------------------------------------------------------------------
 
+// Applies a game thread's command to the player
+static void audio_core_run_command(const AudioCommand &cmd)
+{
+    if (cmd.Type == kAudioCmd_AddSlot)
+    {
+        g_acore.slots_[cmd.Slot].reset(cmd.Player);
+        return;
+    }
+
+    auto it = g_acore.slots_.find(cmd.Slot);
+    if (it == g_acore.slots_.end())
+        return;
+    AudioPlayer *player = it->second.get();
+    switch (cmd.Type)
+    {
+    case kAudioCmd_RemoveSlot:
+        player->Stop();
+        audio_core_log_slot_stats(cmd.Slot, *player);
+        g_acore.slots_.erase(it);
+        return;
+    case kAudioCmd_Play: player->Play(); break;
+    case kAudioCmd_Pause: player->Pause(); break;
+    case kAudioCmd_Seek: player->Seek(cmd.Value); break;
+    case kAudioCmd_Volume: player->SetVolume(cmd.Value); break;
+    case kAudioCmd_Panning: player->SetPanning(cmd.Value); break;
+    case kAudioCmd_Speed: player->SetSpeed(cmd.Value); break;
+    default: break;
+    }
+    player->PublishStatus(cmd.Seq);
+}
+
+// Logs the time spent decoding the sound, when rendering without a device;
+// this is meant for measuring the audio performance
+static void audio_core_log_slot_stats(int slot, const AudioPlayer &player)
+{
+    if (!g_acore.loopback)
+        return;
+    const float decoded_ms = player.GetDecodedMs();
+    const float decode_time_ms = player.GetDecodeTimeMs();
+    Debug::Printf(kDbgMsg_Info, "AudioCore: slot %d decoded %.0f ms of sound in %.2f ms (%.2f%%)",
+        slot, decoded_ms, decode_time_ms, decoded_ms > 0.f ? decode_time_ms * 100.f / decoded_ms : 0.f);
+}
+
+// Renders the mix when there's no sound device, and shortens the time
+// until the next poll, so that the next block is rendered in time
+static void audio_core_render_output(int playing_count, float &wait_ms)
+{
+    LoopbackOutput &output = *g_acore.loopback;
+    if (g_acore.loopback_pace == kAudioPace_Fast)
+    {
+        // Render one block per poll, so that the players are fed in between;
+        // stay idle when there's nothing to play
+        if (playing_count > 0)
+        {
+            output.Render();
+            g_acore.loopback_mixed_sounds += playing_count;
+            wait_ms = 0.f;
+        }
+        return;
+    }
+
+    using namespace std::chrono;
+    const auto now = steady_clock::now();
+    // If fell too far behind, then skip ahead, rather than render a burst
+    // of blocks without feeding the players
+    if (now - g_acore.loopback_due > milliseconds(MaxPollWaitMs))
+        g_acore.loopback_due = now;
+    const auto block_dur = microseconds(static_cast<int64_t>(output.GetBlockMs() * 1000.f));
+    while (g_acore.loopback_due <= now)
+    {
+        output.Render();
+        g_acore.loopback_mixed_sounds += playing_count;
+        g_acore.loopback_due += block_dur;
+    }
+    wait_ms = std::min(wait_ms, duration<float, std::milli>(g_acore.loopback_due - now).count());
+}
+
 void audio_core_entry_poll()
 {
     // burn off any errors for new loop
     dump_al_errors();
 
+    AudioCommand cmd;
+    while (g_acore.commands.TryPop(cmd))
+        audio_core_run_command(cmd);
+
+    // Poll the players, and find out when the earliest of them will have
+    // its queued output half-played, so that it gets new data in time
+    float wait_ms = static_cast<float>(MaxPollWaitMs);
+    int playing_count = 0;
     for (auto &entry : g_acore.slots_) {
         auto &slot = entry.second;
 
@@ -214,7 +516,21 @@ void audio_core_entry_poll()
         } catch (const std::exception& e) {
             Debug::Printf(kDbgMsg_Error, "AudioCore poll exception: %s", e.what());
         }
+        slot->PublishStatus();
+        if (slot->GetPlayState() == PlayStatePlaying)
+        {
+            playing_count++;
+            const float queued_ms = slot->GetQueuedMs();
+            if (queued_ms > 0.f)
+                wait_ms = std::min(wait_ms, queued_ms * 0.5f);
+        }
     }
+
+    if (g_acore.loopback)
+        audio_core_render_output(playing_count, wait_ms);
+    // NOTE: zero wait is only requested by the headless output, rendering fast
+    g_acore.next_poll_wait_ms = (wait_ms > 0.f) ?
+        std::max(MinPollWaitMs, static_cast<int>(wait_ms)) : 0;
 }
 
 #if !defined(AGS_DISABLE_THREADS)
@@ -224,9 +540,16 @@ static void audio_core_entry()
 
     while (g_acore.audio_core_thread_running) {
 
+        g_acore.decoded_ready = false;
         audio_core_entry_poll();
 
-        g_acore.mixer_cv.wait_for(lk, std::chrono::milliseconds(50));
+        // Sleep until there are new commands or decoded data, or until
+        // any of the players needs more data.
+        // NOTE: a notification may be missed in between the checks,
+        // in which case the new commands will be picked up after timeout
+        g_acore.mixer_cv.wait_for(lk, std::chrono::milliseconds(g_acore.next_poll_wait_ms),
+            []() { return !g_acore.commands.IsEmpty() || g_acore.decoded_ready ||
+                !g_acore.audio_core_thread_running; });
     }
 }
 #endif
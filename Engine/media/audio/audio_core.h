@@ -17,61 +17,35 @@
 //=============================================================================
 #ifndef __AGS_EE_MEDIA__AUDIOCORE_H
 #define __AGS_EE_MEDIA__AUDIOCORE_H
-#include <condition_variable>
 #include <memory>
-#include <mutex>
 #include <vector>
 #include "media/audio/audiodefines.h"
 #include "media/audio/audioplayer.h"
 #include "util/string.h"
 
+// Default length of sound decoded ahead of the playback, in ms
+const float DEFAULT_AUDIO_DECODEAHEAD_MS = 250.f;
+// Default frequency of the mix rendered without a sound device
+const int DEFAULT_AUDIO_OUTPUT_FREQ = 44100;
 
-namespace AGS
+// Audio output configuration
+struct AudioOutputSetup
 {
-namespace Engine
-{
-
-// AudioPlayerLock wraps a AudioPlayer pointer guarded by a mutex lock.
-// Unlocks the mutex on destruction (e.g. when going out of scope).
-class AudioPlayerLock
-{
-public:
-    AudioPlayerLock(AudioPlayer *player, std::unique_lock<std::mutex> &&ulk, std::condition_variable *cv)
-        : _player(player)
-        , _ulock(std::move(ulk))
-        , _cv(cv)
-    {
-    }
-
-    AudioPlayerLock(AudioPlayerLock &&lock)
-        : _player(lock._player)
-        , _ulock(std::move(lock._ulock))
-        , _cv(lock._cv)
-    {
-        lock._cv = nullptr;
-    }
-
-    ~AudioPlayerLock()
-    {
-        if (_cv)
-            _cv->notify_all();
-    }
-
-    const AudioPlayer *operator ->() const { return _player; }
-    AudioPlayer *operator ->() { return _player; }
-
-private:
-    AudioPlayer *_player = nullptr;
-    std::unique_lock<std::mutex> _ulock;
-    std::condition_variable *_cv = nullptr;
+    AudioOutputType Type = kAudioOutput_Device;
+    // Following options are only used when there's no sound device
+    AudioOutputPace Pace = kAudioPace_Realtime;
+    int Freq = DEFAULT_AUDIO_OUTPUT_FREQ;
+    AGS::Common::String WavFile; // for kAudioOutput_Wav
 };
 
-} // namespace Engine
-} // namespace AGS
-
 // Initializes audio core system;
-// starts polling on a background thread.
-void audio_core_init(/*config, soundlib*/);
+// starts polling on a background thread, and decoding on the worker threads.
+// * decode_ahead_ms - target length of sound decoded ahead for each playback;
+// * decode_threads - number of decoding threads, 0 chooses one automatically;
+// * output - where to send the mixed sound; if it's not a sound device, then
+//   the mix is rendered by the audio thread, and decode and mix timings are logged.
+void audio_core_init(float decode_ahead_ms = DEFAULT_AUDIO_DECODEAHEAD_MS, size_t decode_threads = 0u,
+    const AudioOutputSetup &output = AudioOutputSetup());
 // Shut downs audio core system;
 // stops any associated threads.
 void audio_core_shutdown();
@@ -82,15 +56,45 @@ void audio_core_set_master_volume(float newvol);
 
 // Audio slot controls: slots are abstract holders for a playback.
 //
+// All the slot commands are passed to the audio thread through a lock-free
+// queue, and are applied asynchronously; the caller never waits for the audio
+// thread. The slot's state is read from the status snapshot, which the audio
+// thread updates after applying commands and polling the player.
+//
 // Initializes playback on a free playback slot (reuses spare one or allocates new if there's none).
 // Data array must contain full wave data to play.
 int audio_core_slot_init(std::shared_ptr<std::vector<uint8_t>> &data, const AGS::Common::String &extension_hint, bool repeat);
 // Initializes playback streaming
 int audio_core_slot_init(std::unique_ptr<AGS::Common::Stream> in, const AGS::Common::String &extension_hint, bool repeat);
-// Returns a AudioPlayer from the given slot, wrapped in a auto-locking struct.
-AGS::Engine::AudioPlayerLock audio_core_get_player(int slot_handle);
+// Initializes playback of the already decoded sound; the PCM data is shared
+// between all the slots which play it, and is never decoded again
+int audio_core_slot_init(std::shared_ptr<const AGS::Engine::DecodedSound> pcm, bool repeat);
+// Decodes complete wave data into PCM in the format used for the playback;
+// returns null if decoding failed, or the sound is longer than max_duration_ms
+std::shared_ptr<AGS::Engine::DecodedSound> audio_core_decode_sound(const std::vector<uint8_t> &data,
+    const AGS::Common::String &extension_hint, float max_duration_ms);
+// Returns the latest status snapshot of the player at the given slot,
+// or null if there's no such slot
+std::shared_ptr<const AGS::Engine::AudioPlayerStatus> audio_core_get_status(int slot_handle);
+// NOTE: the play, pause and seek functions return the command's sequence
+// number, which the slot's status reports in CommandSeq once it's applied.
+// Begin or resume the playback
+uint32_t audio_core_slot_play(int slot_handle);
+// Pause the playback
+uint32_t audio_core_slot_pause(int slot_handle);
+// Seek to the given time position
+uint32_t audio_core_slot_seek(int slot_handle, float pos_ms);
+// Set the playback volume (gain)
+void audio_core_slot_set_volume(int slot_handle, float volume);
+// Set the sound panning (-1.0f to 1.0)
+void audio_core_slot_set_panning(int slot_handle, float panning);
+// Set the playback speed (fraction of normal)
+void audio_core_slot_set_speed(int slot_handle, float speed);
 // Stop and release the audio player at the given slot
 void audio_core_slot_stop(int slot_handle);
+// Passes the commands which did not fit into the queue to the audio thread;
+// must be called regularly, otherwise these wait until the next command
+void audio_core_flush_commands();
 
 #if defined(AGS_DISABLE_THREADS)
 // polls the audio core if we have no threads, polled in Engine/ac/timer.cpp
@@ -48,6 +48,23 @@ inline bool IsPlaybackDone(PlaybackState state)
         state == PlayStateFinished || state == PlayStateError;
 }
 
+// Audio output type
+enum AudioOutputType
+{
+    kAudioOutput_Device,    // play on the system sound device
+    kAudioOutput_Null,      // render the mix without a device, and discard it
+    kAudioOutput_Wav,       // render the mix without a device, write into a WAV file
+    kNumAudioOutputTypes
+};
+
+// Pace of rendering the mix, when there's no sound device
+enum AudioOutputPace
+{
+    kAudioPace_Realtime,    // render in pace with the wall clock
+    kAudioPace_Fast,        // render as fast as possible, while anything plays
+    kNumAudioOutputPaces
+};
+
 // Max channels that are distributed among game's audio types
 #define MAX_GAME_CHANNELS         16
 #define SPECIAL_CROSSFADE_CHANNEL (MAX_GAME_CHANNELS)
@@ -19,22 +19,44 @@ namespace AGS
 namespace Engine
 {
 
-AudioPlayer::AudioPlayer(int handle, std::unique_ptr<SDLDecoder> decoder)
-    : handle_(handle), _decoder(std::move(decoder))
+AudioPlayer::AudioPlayer(int handle, std::unique_ptr<SDLDecoder> decoder, DecodeAheadPool *pool)
+    : handle_(handle)
 {
+    const size_t queue_len = pool ?
+        pool->GetQueueLength(decoder->GetFormat(), decoder->GetChannels(), decoder->GetFreq()) : 2u;
+    _stream = std::make_shared<DecodeAheadStream>(std::move(decoder), queue_len, pool);
     _source = std::make_unique<OpenAlSource>(
-        _decoder->GetFormat(), _decoder->GetChannels(), _decoder->GetFreq());
+        _stream->GetFormat(), _stream->GetChannels(), _stream->GetFreq());
+    _status = std::make_shared<AudioPlayerStatus>();
+    _status->Frequency = GetFrequency();
+    _status->DurationMs = GetDurationMs();
+    PublishStatus();
+}
+
+void AudioPlayer::PublishStatus()
+{
+    _status->State.store(GetPlayStateNormal(), std::memory_order_release);
+    _status->PositionMs.store(GetPositionMs(), std::memory_order_release);
+}
+
+void AudioPlayer::PublishStatus(uint32_t command_seq)
+{
+    PublishStatus();
+    _status->CommandSeq.store(command_seq, std::memory_order_release);
 }
 
 void AudioPlayer::Init()
 {
     bool success;
-    if (_decoder->IsValid()) // if already opened, then just seek to start
-        success = _decoder->Seek(_onLoadPositionMs) == _onLoadPositionMs;
+    float pos_ms = _onLoadPositionMs;
+    if (_stream->IsValid()) // if already opened, then just seek to start
+        success = (pos_ms = _stream->Seek(_onLoadPositionMs)) == _onLoadPositionMs;
     else
-        success = _decoder->Open(_onLoadPositionMs);
-    _source->SetPlaybackPosMs(_decoder->GetPositionMs());
+        success = _stream->Open(_onLoadPositionMs);
+    _source->SetPlaybackPosMs(pos_ms);
     _playState = success ? _onLoadPlayState : PlayStateError;
+    if (success)
+        _stream->Request();
     if (_playState == PlayStatePlaying)
         _source->Play();
 }
@@ -46,20 +68,18 @@ void AudioPlayer::Poll()
     if (_playState != PlayStatePlaying)
         return;
 
-    // Read data from Decoder and pass into the Al Source
-    if (!_bufferPending.Data() && !_decoder->EOS())
-    { // if no buffer saved, and still something to decode, then read a buffer
-        _bufferPending = _decoder->GetData();
-        assert(_bufferPending.Data() || (_bufferPending.Size() == 0));
-    }
-    if (_bufferPending.Data() && (_bufferPending.Size() > 0))
-    { // if having a buffer already, then try to put into source
-        if (_source->PutData(_bufferPending) > 0)
-            _bufferPending = SoundBufferPtr(); // clear buffer on success
+    // Pass the decoded chunks into the Al Source, for as long as it accepts them
+    for (const SoundBuffer *chunk = _stream->PeekData(); chunk; chunk = _stream->PeekData())
+    {
+        if (_source->PutData(*chunk) == 0)
+            break;
+        _stream->PopData();
     }
+    // Make sure that the decoding continues, in case the last request was missed
+    _stream->Request();
     _source->Poll();
     // If both finished decoding and playing, we done here.
-    if (_decoder->EOS() && _source->IsEmpty())
+    if (_stream->EOS() && _source->IsEmpty())
     {
         _playState = PlayStateFinished;
     }
@@ -73,7 +93,8 @@ void AudioPlayer::Play()
         _onLoadPlayState = PlayStatePlaying;
         break;
     case PlayStateStopped:
-        _decoder->Seek(0.0f);
+        _stream->Seek(0.0f);
+        _source->SetPlaybackPosMs(0.0f);
         /* fall-through */
     case PlayStatePaused:
         _playState = PlayStatePlaying;
@@ -111,7 +132,6 @@ void AudioPlayer::Stop()
     case PlayStatePaused:
         _playState = PlayStateStopped;
         _source->Stop();
-        _bufferPending = SoundBufferPtr(); // clear
         break;
     default:
         break;
@@ -131,8 +151,7 @@ void AudioPlayer::Seek(float pos_ms)
     case PlayStateStopped:
         {
             _source->Stop();
-            _bufferPending = SoundBufferPtr(); // clear
-            float new_pos = _decoder->Seek(pos_ms);
+            float new_pos = _stream->Seek(pos_ms);
             _source->SetPlaybackPosMs(new_pos);
         }
         break;
@@ -14,7 +14,8 @@
 //
 // Audio playback class.
 // Controls playback state. Retrieves audio data from decoder and passes into
-// the audio output.
+// the audio output. The data is decoded ahead, either by the worker pool,
+// or right when it's requested, if there's no pool.
 //
 // TODO: a virtual Decoder and AudioOutput interfaces, to let hide current
 // implementations, and also substitute default implementations
@@ -23,9 +24,10 @@
 //=============================================================================
 #ifndef __AGS_EE_MEDIA__AUDIOPLAYER_H
 #define __AGS_EE_MEDIA__AUDIOPLAYER_H
+#include <atomic>
 #include <memory>
 #include "media/audio/audiodefines.h" // PlaybackState etc
-#include "media/audio/sdldecoder.h"
+#include "media/audio/decodeahead.h"
 #include "media/audio/openalsource.h"
 
 namespace AGS
@@ -33,10 +35,33 @@ namespace AGS
 namespace Engine
 {
 
+// AudioPlayerStatus is a snapshot of the player's state, which is published
+// by the audio thread, and may be read from any other thread without locking.
+struct AudioPlayerStatus
+{
+    // Fixed properties, assigned when the player is created
+    float Frequency = 0.f;
+    float DurationMs = 0.f;
+    // Playback state, *excluding* temporary states such as Initial
+    std::atomic<int> State{PlayStateInitial};
+    std::atomic<float> PositionMs{0.f};
+    // Sequence number of the latest game thread's command applied to
+    // this player; published after the state, which already reflects it
+    std::atomic<uint32_t> CommandSeq{0u};
+};
+
 class AudioPlayer
 {
 public:
-    AudioPlayer(int handle, std::unique_ptr<SDLDecoder> decoder);
+    AudioPlayer(int handle, std::unique_ptr<SDLDecoder> decoder, DecodeAheadPool *pool = nullptr);
+
+    // Gets the status snapshot, shared with the readers on other threads
+    std::shared_ptr<const AudioPlayerStatus> GetStatus() const { return _status; }
+    // Updates the status snapshot with the current player's state
+    void PublishStatus();
+    // Updates the status snapshot after applying the command with the given
+    // sequence number, letting the game thread know that it's done
+    void PublishStatus(uint32_t command_seq);
 
     // Gets current playback state
     PlaybackState GetPlayState() const { return _playState; }
@@ -44,11 +69,17 @@ public:
     // FIXME: rework this! -- a quick hack to let external user know the future player state on init stage
     PlaybackState GetPlayStateNormal() const { return _playState == PlayStateInitial ? _onLoadPlayState : _playState; }
     // Gets frequency (sample rate)
-    float GetFrequency() const { return static_cast<float>(_decoder->GetFreq()); }
+    float GetFrequency() const { return static_cast<float>(_stream->GetFreq()); }
     // Gets duration, in ms
-    float GetDurationMs() const { return _decoder->GetDurationMs(); }
+    float GetDurationMs() const { return _stream->GetDurationMs(); }
     // Gets playback position, in ms
     float GetPositionMs() const { return _source->GetPositionMs(); }
+    // Gets the length of sound queued for the output and not played yet, in ms
+    float GetQueuedMs() const { return _source->GetQueuedMs(); }
+    // Gets the total time spent decoding this sound, in ms
+    float GetDecodeTimeMs() const { return _stream->GetDecodeTimeMs(); }
+    // Gets the total length of the decoded sound, in ms
+    float GetDecodedMs() const { return _stream->GetDecodedMs(); }
 
     // Sets the sound panning (-1.0f to 1.0)
     void SetPanning(float panning) { _source->SetPanning(panning); }
@@ -74,12 +105,12 @@ private:
     void Init();
 
     const int handle_ = -1; // for diagnostic purposes only
-    std::unique_ptr<SDLDecoder> _decoder;
+    std::shared_ptr<DecodeAheadStream> _stream;
     std::unique_ptr<OpenAlSource> _source;
     PlaybackState _playState = PlayStateInitial;
     PlaybackState _onLoadPlayState = PlayStatePaused;
     float _onLoadPositionMs = 0.0f;
-    SoundBufferPtr _bufferPending{};
+    std::shared_ptr<AudioPlayerStatus> _status;
 };
 
 } // namespace Engine
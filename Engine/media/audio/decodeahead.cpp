@@ -0,0 +1,168 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "media/audio/decodeahead.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace AGS
+{
+namespace Engine
+{
+
+//-----------------------------------------------------------------------------
+// DecodeAheadStream
+//-----------------------------------------------------------------------------
+
+DecodeAheadStream::DecodeAheadStream(std::unique_ptr<SDLDecoder> decoder, size_t queue_len,
+    DecodeAheadPool *pool)
+    : _decoder(std::move(decoder))
+    , _chunks(std::max<size_t>(1u, queue_len))
+    // decoded sounds are only copied, which is not worth passing to a worker
+    , _pool(_decoder->IsDecoded() ? nullptr : pool)
+    , _format(_decoder->GetFormat())
+    , _channels(_decoder->GetChannels())
+    , _freq(_decoder->GetFreq())
+    , _durationMs(_decoder->GetDurationMs())
+{
+}
+
+bool DecodeAheadStream::IsValid()
+{
+    std::lock_guard<std::mutex> lk(_decMutex);
+    return _decoder->IsValid();
+}
+
+bool DecodeAheadStream::Open(float pos_ms)
+{
+    std::lock_guard<std::mutex> lk(_decMutex);
+    DropChunks();
+    const bool success = _decoder->Open(pos_ms);
+    _durationMs = _decoder->GetDurationMs();
+    return success;
+}
+
+float DecodeAheadStream::Seek(float pos_ms)
+{
+    std::lock_guard<std::mutex> lk(_decMutex);
+    DropChunks();
+    return _decoder->Seek(pos_ms);
+}
+
+void DecodeAheadStream::PopData()
+{
+    _chunks.CommitPop();
+    Request();
+}
+
+void DecodeAheadStream::Request()
+{
+    if (_decoderEOS.load(std::memory_order_acquire) || (_chunks.GetCount() == _chunks.GetCapacity()))
+        return; // nothing to decode, or no space
+    if (!_pool)
+    {
+        DecodeAhead();
+        return;
+    }
+    if (!_scheduled.exchange(true))
+        _pool->Schedule(shared_from_this());
+}
+
+void DecodeAheadStream::DecodeAhead()
+{
+    // NOTE: the decoder is locked per chunk, which lets the consumer to
+    // seek in between, without waiting for the whole queue to fill
+    for (;;)
+    {
+        {
+            std::lock_guard<std::mutex> lk(_decMutex);
+            SoundBuffer *chunk = _chunks.PeekBack();
+            if (!chunk || _decoder->EOS() || !_decoder->IsValid())
+                break;
+            const auto t_start = std::chrono::steady_clock::now();
+            SoundBufferPtr data = _decoder->GetData();
+            _decodeTimeUs.store(_decodeTimeUs.load(std::memory_order_relaxed) +
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - t_start).count(), std::memory_order_relaxed);
+            if (data)
+            {
+                _decodedMs.store(_decodedMs.load(std::memory_order_relaxed) + data.DurationMs(),
+                    std::memory_order_relaxed);
+                chunk->AssignData(data.Data(), data.Size(), data.Timestamp(), data.DurationMs());
+                _chunks.CommitPush();
+            }
+            _decoderEOS.store(_decoder->EOS(), std::memory_order_release);
+        }
+        if (_pool)
+            _pool->NotifyReady();
+    }
+}
+
+void DecodeAheadStream::DropChunks()
+{
+    // the consumer is the caller, and producer is blocked by the decoder lock
+    while (_chunks.PeekFront())
+        _chunks.CommitPop();
+    _decoderEOS.store(false, std::memory_order_release);
+}
+
+//-----------------------------------------------------------------------------
+// DecodeAheadPool
+//-----------------------------------------------------------------------------
+
+DecodeAheadPool::~DecodeAheadPool()
+{
+    Stop();
+}
+
+void DecodeAheadPool::Start(size_t thread_count, float target_latency_ms, ReadyCallback on_ready)
+{
+    Stop();
+    _latencyMs = target_latency_ms;
+    _onReady = on_ready;
+    _threads.Start(thread_count);
+}
+
+void DecodeAheadPool::Stop()
+{
+    _threads.Stop();
+}
+
+size_t DecodeAheadPool::GetQueueLength(SDL_AudioFormat format, int channels, int freq) const
+{
+    // Keep at least two chunks, so that the next one is decoded while
+    // the previous is passed to the audio output
+    const float chunk_ms = SoundHelper::MillisecondsFromBytes(SoundDecodeChunkSize, format, channels, freq);
+    if (chunk_ms <= 0.f)
+        return 2u;
+    return std::max<size_t>(2u, static_cast<size_t>(std::ceil(_latencyMs / chunk_ms)));
+}
+
+void DecodeAheadPool::NotifyReady()
+{
+    if (_onReady)
+        _onReady();
+}
+
+void DecodeAheadPool::Schedule(std::shared_ptr<DecodeAheadStream> stream)
+{
+    _threads.Enqueue([this, stream]()
+    {
+        stream->DecodeAhead();
+        stream->_scheduled.store(false, std::memory_order_release);
+    });
+}
+
+} // namespace Engine
+} // namespace AGS
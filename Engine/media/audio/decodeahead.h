@@ -0,0 +1,145 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Decoding sound data ahead of the playback.
+//
+// DecodeAheadStream owns a sound decoder and a ring of decoded chunks.
+// The chunks are decoded in advance on the worker threads of the
+// DecodeAheadPool, up to the target latency, while the audio thread only
+// takes the ready chunks and passes them to the audio output. This way
+// a slow decoder does not hold the audio thread from feeding other sounds.
+//
+// Sounds which are already fully decoded are not scheduled on the workers,
+// because their "decoding" is only a copy of the memory.
+//
+//=============================================================================
+#ifndef __AGS_EE_MEDIA__DECODEAHEAD_H
+#define __AGS_EE_MEDIA__DECODEAHEAD_H
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "media/audio/sdldecoder.h"
+#include "util/spsc_queue.h"
+#include "util/thread_pool.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+class DecodeAheadPool;
+
+class DecodeAheadStream :
+    public std::enable_shared_from_this<DecodeAheadStream>
+{
+public:
+    // Creates a stream for the given decoder, which keeps up to the given
+    // number of chunks decoded ahead; the pool may be null, in which case
+    // all the decoding is done on the calling thread
+    DecodeAheadStream(std::unique_ptr<SDLDecoder> decoder, size_t queue_len,
+        DecodeAheadPool *pool);
+
+    // Format properties, these are fixed when the stream is created
+    SDL_AudioFormat GetFormat() const { return _format; }
+    int GetChannels() const { return _channels; }
+    int GetFreq() const { return _freq; }
+    float GetDurationMs() const { return _durationMs; }
+    // Gets the total time spent decoding this stream, in ms
+    float GetDecodeTimeMs() const { return _decodeTimeUs.load(std::memory_order_relaxed) / 1000.f; }
+    // Gets the total length of the decoded sound, in ms
+    float GetDecodedMs() const { return _decodedMs.load(std::memory_order_relaxed); }
+
+    // Following methods are called by the audio thread, which is the consumer.
+    //
+    // Tells if the decoder is in a valid state, ready to work
+    bool IsValid();
+    // Opens decoder at the given position, returns the result
+    bool Open(float pos_ms);
+    // Seeks to the given read position, drops any chunks decoded ahead;
+    // returns the new position
+    float Seek(float pos_ms);
+    // Gets the next decoded chunk, or null if there's none ready
+    const SoundBuffer *PeekData() { return _chunks.PeekFront(); }
+    // Removes the chunk returned by PeekData, and requests more decoding
+    void PopData();
+    // Tells if the decoder reached end of stream, and all the chunks were taken
+    bool EOS() { return _decoderEOS.load(std::memory_order_acquire) && !_chunks.PeekFront(); }
+    // Requests to decode more chunks, if there's a free space in the queue;
+    // decodes right away if there's no worker pool
+    void Request();
+
+    // Decodes chunks until the queue is full or the stream ends;
+    // called by a pool's worker, or by the consumer if there's no pool
+    void DecodeAhead();
+
+private:
+    friend class DecodeAheadPool;
+
+    // Drops all the chunks decoded ahead; expects decoder to be locked
+    void DropChunks();
+
+    std::mutex _decMutex; // locks decoder, and the queue's producer side
+    std::unique_ptr<SDLDecoder> _decoder;
+    SpscQueue<SoundBuffer> _chunks;
+    DecodeAheadPool *_pool = nullptr;
+    SDL_AudioFormat _format = 0;
+    int _channels = 0;
+    int _freq = 0;
+    float _durationMs = 0.f;
+    std::atomic<bool> _decoderEOS{false};
+    // Tells that the decoding is scheduled on the pool
+    std::atomic<bool> _scheduled{false};
+    // Decoding statistics, written by the producer
+    std::atomic<uint64_t> _decodeTimeUs{0u};
+    std::atomic<float> _decodedMs{0.f};
+};
+
+
+// DecodeAheadPool runs decoding of the streams on the worker threads,
+// and notifies when there are new chunks ready. The notification callback
+// is called on the worker threads.
+class DecodeAheadPool
+{
+public:
+    typedef std::function<void()> ReadyCallback;
+
+    DecodeAheadPool() = default;
+    ~DecodeAheadPool();
+
+    // Starts the given number of worker threads, and sets the target
+    // latency, which is the length of sound decoded ahead for each stream
+    void Start(size_t thread_count, float target_latency_ms, ReadyCallback on_ready);
+    // Waits for the scheduled decoding to complete, and stops worker threads
+    void Stop();
+    // Gets the number of chunks which a stream of the given format should
+    // keep decoded ahead
+    size_t GetQueueLength(SDL_AudioFormat format, int channels, int freq) const;
+
+    // Schedules decoding of the stream on a worker thread
+    void Schedule(std::shared_ptr<DecodeAheadStream> stream);
+    // Notifies that a stream has got new decoded data;
+    // called by the streams on a worker thread
+    void NotifyReady();
+
+private:
+    ThreadPool _threads;
+    float _latencyMs = 0.f;
+    ReadyCallback _onReady;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_MEDIA__DECODEAHEAD_H
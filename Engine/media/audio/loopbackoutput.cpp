@@ -0,0 +1,118 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "media/audio/loopbackoutput.h"
+#include <chrono>
+#include <stdexcept>
+#include "util/file.h"
+
+using namespace AGS::Common;
+
+namespace AGS
+{
+namespace Engine
+{
+
+// Size of the RIFF and "fmt " chunks, preceding the sound data
+static const uint32_t WavHeaderSize = 44u;
+// WAVE_FORMAT_IEEE_FLOAT
+static const uint16_t WavFormatFloat = 3u;
+
+LoopbackOutput::~LoopbackOutput()
+{
+    Close();
+}
+
+void LoopbackOutput::Open(int freq, const String &wav_path)
+{
+    if (!alcIsExtensionPresent(nullptr, "ALC_SOFT_loopback"))
+        throw std::runtime_error("LoopbackOutput: ALC_SOFT_loopback extension is not supported");
+    _alcLoopbackOpenDevice = reinterpret_cast<LPALCLOOPBACKOPENDEVICESOFT>(
+        alcGetProcAddress(nullptr, "alcLoopbackOpenDeviceSOFT"));
+    _alcRenderSamples = reinterpret_cast<LPALCRENDERSAMPLESSOFT>(
+        alcGetProcAddress(nullptr, "alcRenderSamplesSOFT"));
+    if (!_alcLoopbackOpenDevice || !_alcRenderSamples)
+        throw std::runtime_error("LoopbackOutput: failed to get ALC_SOFT_loopback functions");
+
+    _device = _alcLoopbackOpenDevice(nullptr);
+    if (!_device)
+        throw std::runtime_error("LoopbackOutput: error opening loopback device");
+    const ALCint attrs[] = {
+        ALC_FREQUENCY, freq,
+        ALC_FORMAT_CHANNELS_SOFT, ALC_STEREO_SOFT,
+        ALC_FORMAT_TYPE_SOFT, ALC_FLOAT_SOFT,
+        0
+    };
+    _context = alcCreateContext(_device, attrs);
+    if (!_context)
+    {
+        alcCloseDevice(_device);
+        _device = nullptr;
+        throw std::runtime_error("LoopbackOutput: error creating context");
+    }
+
+    _freq = freq;
+    _buffer.resize(BlockFrames * 2);
+    _renderedFrames = 0u;
+    _mixTimeUs = 0u;
+    if (!wav_path.IsEmpty())
+    {
+        _wavFile = File::CreateFile(wav_path);
+        if (!_wavFile)
+            throw std::runtime_error("LoopbackOutput: failed to create the output file");
+        WriteWavHeader(0u); // written again when closing
+    }
+}
+
+void LoopbackOutput::Close()
+{
+    if (!_wavFile)
+        return;
+    const soff_t data_size = _wavFile->GetPosition() - WavHeaderSize;
+    _wavFile->Seek(0, kSeekBegin);
+    WriteWavHeader(static_cast<uint32_t>(data_size));
+    _wavFile.reset();
+}
+
+void LoopbackOutput::Render()
+{
+    const auto t_start = std::chrono::steady_clock::now();
+    _alcRenderSamples(_device, _buffer.data(), BlockFrames);
+    _mixTimeUs += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - t_start).count();
+    _renderedFrames += BlockFrames;
+    if (_wavFile)
+        _wavFile->WriteArrayOfInt32(reinterpret_cast<const int32_t*>(_buffer.data()), _buffer.size());
+}
+
+void LoopbackOutput::WriteWavHeader(uint32_t data_size)
+{
+    const uint16_t channels = 2u;
+    const uint16_t frame_size = sizeof(float) * channels;
+    _wavFile->Write("RIFF", 4);
+    _wavFile->WriteInt32(WavHeaderSize - 8 + data_size);
+    _wavFile->Write("WAVE", 4);
+    _wavFile->Write("fmt ", 4);
+    _wavFile->WriteInt32(16);
+    _wavFile->WriteInt16(WavFormatFloat);
+    _wavFile->WriteInt16(channels);
+    _wavFile->WriteInt32(_freq);
+    _wavFile->WriteInt32(_freq * frame_size);
+    _wavFile->WriteInt16(frame_size);
+    _wavFile->WriteInt16(sizeof(float) * 8);
+    _wavFile->Write("data", 4);
+    _wavFile->WriteInt32(data_size);
+}
+
+} // namespace Engine
+} // namespace AGS
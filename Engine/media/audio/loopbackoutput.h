@@ -0,0 +1,88 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// LoopbackOutput is a headless audio output, which does not require any
+// sound device. It opens an OpenAL loopback device (ALC_SOFT_loopback),
+// and lets the caller render the OpenAL mix on demand. The rendered sound
+// is either discarded, or written into a WAV file.
+//
+// This runs the complete audio pipeline, including the OpenAL mixer, and is
+// meant for testing and measuring performance on systems without sound.
+//
+//=============================================================================
+#ifndef __AGS_EE_MEDIA__LOOPBACKOUTPUT_H
+#define __AGS_EE_MEDIA__LOOPBACKOUTPUT_H
+#include <memory>
+#include <vector>
+#include "media/audio/openal.h"
+#include "util/stream.h"
+#include "util/string.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+class LoopbackOutput
+{
+public:
+    // Number of sample frames rendered at once
+    static const int BlockFrames = 1024;
+
+    LoopbackOutput() = default;
+    ~LoopbackOutput();
+
+    // Opens the loopback device and creates a context, rendering stereo
+    // sound at the given frequency; if the wav path is not empty, then
+    // opens this file for writing the rendered sound.
+    // Throws std::runtime_error on failure.
+    void Open(int freq, const Common::String &wav_path);
+    // Finalizes the output file, if one is written; the device and
+    // context should be destroyed by the caller
+    void Close();
+
+    ALCdevice *GetDevice() const { return _device; }
+    ALCcontext *GetContext() const { return _context; }
+    int GetFreq() const { return _freq; }
+    // Gets the duration of a single render block, in ms
+    float GetBlockMs() const { return BlockFrames * 1000.f / _freq; }
+
+    // Renders a block of the current OpenAL mix
+    void Render();
+    // Gets the last rendered block, as interleaved stereo float samples
+    const float *GetBlock() const { return _buffer.data(); }
+
+    // Gets the total length of the rendered sound, in ms
+    float GetRenderedMs() const { return _renderedFrames * 1000.f / _freq; }
+    // Gets the total time spent in the OpenAL mixer, in ms
+    float GetMixTimeMs() const { return _mixTimeUs / 1000.f; }
+
+private:
+    void WriteWavHeader(uint32_t data_size);
+
+    LPALCLOOPBACKOPENDEVICESOFT _alcLoopbackOpenDevice = nullptr;
+    LPALCRENDERSAMPLESSOFT _alcRenderSamples = nullptr;
+    ALCdevice *_device = nullptr;
+    ALCcontext *_context = nullptr;
+    int _freq = 0;
+    std::vector<float> _buffer;
+    std::unique_ptr<Common::Stream> _wavFile;
+    uint64_t _renderedFrames = 0u;
+    uint64_t _mixTimeUs = 0u;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_MEDIA__LOOPBACKOUTPUT_H
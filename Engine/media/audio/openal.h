@@ -20,6 +20,19 @@
 // [sonneveld] disabled until I add extension detection
 // #include "alext.h"
 
+// ALC_SOFT_loopback extension, used for rendering the mix without a sound device;
+// defined here in case the system headers only declare it in alext.h
+#ifndef ALC_SOFT_loopback
+#define ALC_SOFT_loopback 1
+#define ALC_FORMAT_CHANNELS_SOFT 0x1990
+#define ALC_FORMAT_TYPE_SOFT 0x1991
+#define ALC_FLOAT_SOFT 0x1406
+#define ALC_STEREO_SOFT 0x1501
+typedef ALCdevice* (ALC_APIENTRY *LPALCLOOPBACKOPENDEVICESOFT)(const ALCchar *devicename);
+typedef ALCboolean (ALC_APIENTRY *LPALCISRENDERFORMATSUPPORTEDSOFT)(ALCdevice *device, ALCsizei freq, ALCenum channels, ALCenum type);
+typedef void (ALC_APIENTRY *LPALCRENDERSAMPLESSOFT)(ALCdevice *device, ALCvoid *buffer, ALCsizei samples);
+#endif
+
 // Prints any OpenAL errors to the log
 void dump_al_errors();
 
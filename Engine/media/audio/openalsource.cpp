@@ -95,6 +95,13 @@ static struct
 // OpenAlSource
 //-----------------------------------------------------------------------------
 
+Sound_AudioInfo OpenAlSource::GetPlaybackFormat(const Sound_AudioInfo &input)
+{
+    Sound_AudioInfo conv;
+    OpenAlFormatFromSDLFormat(input, conv);
+    return conv;
+}
+
 OpenAlSource::OpenAlSource(SDL_AudioFormat format, int channels, int freq)
 {
     _inputFmt.format = format;
@@ -152,6 +159,20 @@ float OpenAlSource::GetPositionMs() const
     return _predictTs;
 }
 
+float OpenAlSource::GetQueuedMs() const
+{
+    if (_bufferRecords.size() == 0)
+        return 0.f;
+
+    float al_offset = 0.f;
+    alGetSourcef(_source, AL_SEC_OFFSET, &al_offset);
+    dump_al_errors();
+    float queued_ms = 0.f;
+    for (const auto &r : _bufferRecords)
+        queued_ms += r.Duration / r.Speed;
+    return std::max(0.f, queued_ms - al_offset * 1000.f);
+}
+
 size_t OpenAlSource::PutData(const SoundBufferPtr &data)
 {
     Unqueue();
@@ -36,6 +36,10 @@ public:
     // Max sound buffers to queue before/during processing
     static const ALuint MaxQueue = 2;
 
+    // Gets the format which the sound data of the given input format is
+    // converted to before passing into OpenAL
+    static Sound_AudioInfo GetPlaybackFormat(const Sound_AudioInfo &input);
+
     // Initializes Al source for the given format; if there's no direct format equivalent
     // found, setups a resampler.
     OpenAlSource(SDL_AudioFormat format, int channels, int freq);
@@ -50,6 +54,8 @@ public:
     bool IsEmpty() const { return _queued == 0; }
     // Gets current playback position, in ms
     float GetPositionMs() const;
+    // Gets the length of queued data which is not played yet, in ms
+    float GetQueuedMs() const;
 
     // Try putting data into the queue; returns amount of data copied,
     // or 0 if data cannot be accepted at the moment.
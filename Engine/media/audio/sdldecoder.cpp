@@ -12,6 +12,7 @@
 //
 //=============================================================================
 #include "media/audio/sdldecoder.h"
+#include <algorithm>
 #include "util/sdl2_util.h"
 
 namespace AGS
@@ -55,7 +56,30 @@ const void *SDLResampler::Convert(const void *data, size_t sz, size_t &out_sz)
 //-----------------------------------------------------------------------------
 // SDLDecoder
 //-----------------------------------------------------------------------------
-const auto SampleDefaultBufferSize = 64 * 1024;
+const auto SampleDefaultBufferSize = SoundDecodeChunkSize;
+
+std::shared_ptr<DecodedSound> SDLDecoder::DecodeAll(const std::vector<uint8_t> &data,
+    const String &ext_hint, float max_duration_ms)
+{
+    SoundSampleUniquePtr sample(Sound_NewSampleFromMem(data.data(), data.size(),
+        ext_hint.GetCStr(), nullptr, SampleDefaultBufferSize));
+    if (!sample)
+        return nullptr;
+    const int dur = Sound_GetDuration(sample.get());
+    if ((dur <= 0) || (dur > max_duration_ms))
+        return nullptr; // unknown length, or too long
+    const size_t sz = Sound_DecodeAll(sample.get());
+    if ((sample->flags & SOUND_SAMPLEFLAG_ERROR) != 0 || (sz == 0))
+        return nullptr;
+
+    auto pcm = std::make_shared<DecodedSound>();
+    pcm->Format = sample->desired;
+    pcm->Data.assign(static_cast<const uint8_t*>(sample->buffer),
+        static_cast<const uint8_t*>(sample->buffer) + sz);
+    pcm->DurationMs = SoundHelper::MillisecondsFromBytes(sz,
+        pcm->Format.format, pcm->Format.channels, pcm->Format.rate);
+    return pcm;
+}
 
 SDLDecoder::SDLDecoder(std::shared_ptr<std::vector<uint8_t>> &data,
     const AGS::Common::String &ext_hint, bool repeat)
@@ -73,8 +97,15 @@ SDLDecoder::SDLDecoder(std::unique_ptr<Stream> in,
 {
 }
 
+SDLDecoder::SDLDecoder(std::shared_ptr<const DecodedSound> pcm, bool repeat)
+    : _pcm(pcm)
+    , _repeat(repeat)
+{
+}
+
 SDLDecoder::SDLDecoder(SDLDecoder &&dec)
 {
+    _pcm = std::move(dec._pcm);
     _sampleData = (std::move(dec._sampleData));
     _rwops = std::move(dec._rwops);
     dec._rwops = nullptr;
@@ -92,6 +123,17 @@ bool SDLDecoder::Open(float pos_ms)
         return true;
     }
 
+    if (_pcm)
+    {
+        _pcmOpen = true;
+        _durationMs = _pcm->DurationMs;
+        _posBytes = 0u;
+        _posMs = 0.f;
+        if (pos_ms > 0.f)
+            Seek(pos_ms);
+        return true;
+    }
+
     SoundSampleUniquePtr sample{};
     if (_rwops)
     {
@@ -124,12 +166,24 @@ bool SDLDecoder::Open(float pos_ms)
 void SDLDecoder::Close()
 {
     _sample.reset();
+    _pcm = nullptr;
+    _pcmOpen = false;
     _rwops = nullptr; // rwops was closed by the Sound_NewSample
     _sampleData = nullptr;
 }
 
 float SDLDecoder::Seek(float pos_ms)
 {
+    if (_pcmOpen && pos_ms >= 0.f)
+    {
+        const Sound_AudioInfo &fmt = _pcm->Format;
+        const size_t frame_sz = SoundHelper::BytesPerSample(fmt.format) * fmt.channels;
+        _posBytes = std::min(SoundHelper::BytesPerMs(pos_ms, fmt.format, fmt.channels, fmt.rate),
+            _pcm->Data.size()) / frame_sz * frame_sz;
+        _posMs = SoundHelper::MillisecondsFromBytes(_posBytes, fmt.format, fmt.channels, fmt.rate);
+        _EOS = false;
+        return _posMs;
+    }
     if (!_sample || pos_ms < 0.f)
         return _posMs;
     if (Sound_Seek(_sample.get(), static_cast<uint32_t>(pos_ms)) == 0)
@@ -142,6 +196,8 @@ float SDLDecoder::Seek(float pos_ms)
 
 SoundBufferPtr SDLDecoder::GetData()
 {
+    if (_pcmOpen)
+        return GetPCMData();
     if (!_sample || _EOS)
         return SoundBufferPtr();
     float old_pos = _posMs;
@@ -171,5 +227,34 @@ SoundBufferPtr SDLDecoder::GetData()
         SoundHelper::MillisecondsFromBytes(sz, _sample->desired.format, _sample->desired.channels, _sample->desired.rate));
 }
 
+SoundBufferPtr SDLDecoder::GetPCMData()
+{
+    if (_EOS || (_posBytes >= _pcm->Data.size()))
+        return SoundBufferPtr();
+    const Sound_AudioInfo &fmt = _pcm->Format;
+    const size_t frame_sz = SoundHelper::BytesPerSample(fmt.format) * fmt.channels;
+    const size_t sz = std::min<size_t>(SampleDefaultBufferSize / frame_sz * frame_sz,
+        _pcm->Data.size() - _posBytes);
+    const void *data = &_pcm->Data[_posBytes];
+    const float old_pos = _posMs;
+    _posBytes += sz;
+    _posMs = SoundHelper::MillisecondsFromBytes(_posBytes, fmt.format, fmt.channels, fmt.rate);
+    if (_posBytes >= _pcm->Data.size())
+    {
+        // if repeat, then continue from start, otherwise finish playing
+        if (_repeat)
+        {
+            _posBytes = 0u;
+            _posMs = 0.f;
+        }
+        else
+        {
+            _EOS = true;
+        }
+    }
+    return SoundBufferPtr(data, sz, old_pos,
+        SoundHelper::MillisecondsFromBytes(sz, fmt.format, fmt.channels, fmt.rate));
+}
+
 } // namespace Engine
 } // namespace AGS
@@ -175,32 +175,54 @@ private:
     std::vector<uint8_t> _buf;
 };
 
+// DecodedSound is a complete sound decoded into PCM data, which may be
+// played by any number of decoders at once without decoding again.
+struct DecodedSound
+{
+    Sound_AudioInfo Format{};
+    float DurationMs = 0.f;
+    std::vector<uint8_t> Data;
+};
+
+// Max size of a decoded chunk returned by SDLDecoder, in bytes
+const size_t SoundDecodeChunkSize = 64 * 1024;
+
 // SDLDecoder uses SDL_Sound library to decode audio and retrieve result
 // in parts of the requested size.
 class SDLDecoder
 {
 public:
+    // Decodes complete sound data into PCM; fails if the sound's duration
+    // is unknown or exceeds max_duration_ms. Returns null on failure.
+    static std::shared_ptr<DecodedSound> DecodeAll(const std::vector<uint8_t> &data,
+        const String &ext_hint, float max_duration_ms);
+
     // Initializes decoder with a complete sound data loaded to memory
     SDLDecoder(std::shared_ptr<std::vector<uint8_t>> &data, const String &ext_hint, bool repeat);
     // Initializes decoder with an input stream
     SDLDecoder(const std::unique_ptr<Stream> in, const String &ext_hint, bool repeat);
+    // Initializes decoder with an already decoded sound; this decoder
+    // only passes the parts of the shared PCM data and never decodes
+    SDLDecoder(std::shared_ptr<const DecodedSound> pcm, bool repeat);
     SDLDecoder(SDLDecoder&& dec);
     ~SDLDecoder() = default;
 
     // Tells if the decoder is in a valid state, ready to work
-    bool IsValid() const { return _sample != nullptr; }
+    bool IsValid() const { return _sample != nullptr || _pcmOpen; }
     // Gets the audio format
-    SDL_AudioFormat GetFormat() const { return _sample ? _sample->desired.format : 0; }
+    SDL_AudioFormat GetFormat() const { return GetAudioInfo().format; }
     // Gets the number of channels
-    int GetChannels() const { return _sample ? _sample->desired.channels : 0; }
+    int GetChannels() const { return GetAudioInfo().channels; }
     // Gets the audio rate (frequency)
-    int GetFreq() const { return _sample ? _sample->desired.rate : 0; }
+    int GetFreq() const { return GetAudioInfo().rate; }
     // Tells if the data reading has reached EOS
     bool EOS() const { return _EOS; }
     // Gets current reading position, in ms
     float GetPositionMs() const { return _posMs; }
     // Gets total duration, in ms
     float GetDurationMs() const { return _durationMs; }
+    // Tells if this decoder plays an already decoded sound
+    bool IsDecoded() const { return _pcm != nullptr; }
 
     // Try initializing the sound sample, returns the result
     bool Open(float pos_ms = 0.f);
@@ -212,10 +234,20 @@ public:
     SoundBufferPtr GetData();
 
 private:
+    const Sound_AudioInfo &GetAudioInfo() const
+    {
+        static const Sound_AudioInfo NoInfo{};
+        return _pcm ? _pcm->Format : (_sample ? _sample->desired : NoInfo);
+    }
+    // Returns the next chunk of the decoded sound data
+    SoundBufferPtr GetPCMData();
+
     SDL_RWops *_rwops = nullptr;
     std::shared_ptr<std::vector<uint8_t>> _sampleData{};
     String _sampleExt = "";
     SoundSampleUniquePtr _sample = nullptr;
+    std::shared_ptr<const DecodedSound> _pcm;
+    bool _pcmOpen = false;
     float _durationMs = 0.f;
     bool _repeat = false;
     bool _EOS = false;
@@ -12,13 +12,16 @@
 //
 //=============================================================================
 #include "media/audio/sound.h"
+#include <chrono>
 #include <list>
 #include <unordered_map>
+#include <unordered_set>
 #include "ac/game.h"
 #include "core/assetmanager.h"
 #include "debug/out.h"
 #include "media/audio/audio_core.h"
 #include "media/audio/audiodefines.h"
+#include "media/audio/soundprefetch.h"
 #include "util/path.h"
 #include "util/resourcecache.h"
 #include "util/stream.h"
@@ -81,10 +84,116 @@ private:
 };
 
 
+// Decoded sound cache, stores most recent used short sounds as PCM data,
+// ready to be played without decoding. The data is shared by all the
+// playbacks of the same sound.
+class SoundPCMCache final :
+    public ResourceCache<String, std::shared_ptr<const DecodedSound>>
+{
+public:
+    typedef std::shared_ptr<const DecodedSound> DataRef;
+
+    SoundPCMCache() : ResourceCache(DEFAULT_SOUNDPCMCACHESIZE_KB * 1024)
+    {
+    }
+
+    // Looks up the sound, and counts the cache hits and misses;
+    // returns null if there's no such sound in cache
+    DataRef Find(const String &name)
+    {
+        if (!Exists(name))
+        {
+            _misses++;
+            return nullptr;
+        }
+        _hits++;
+        return Get(name);
+    }
+
+    uint32_t GetHits() const { return _hits; }
+    uint32_t GetMisses() const { return _misses; }
+    void ResetStats() { _hits = _misses = 0u; }
+
+private:
+    size_t CalcSize(const DataRef &item) override
+    {
+        assert(item);
+        return item ? item->Data.size() : 0u;
+    }
+
+    uint32_t _hits = 0u;
+    uint32_t _misses = 0u;
+};
+
+
 // Maximal sound asset size which is allowed to be loaded at once;
 // anything larger will be streamed
 static size_t MaxLoadAtOnce = DEFAULT_SOUNDLOADATONCE_KB;
 static SoundCache SndCache;
+// Maximal length of a sound which is allowed to be kept decoded
+static float MaxPCMLengthMs = DEFAULT_SOUNDPCMMAXLENGTH_MS;
+static SoundPCMCache PCMCache;
+// Sounds which were found unsuitable for the decoded cache (too long,
+// or their length is unknown), so that they are not tried again
+static std::unordered_set<String> PCMRejected;
+// Sounds which are being decoded on a background thread
+static std::unordered_map<String, std::shared_future<SoundPCMCache::DataRef>> PCMPending;
+
+// Tells if the sound should be looked for in the decoded sound cache
+static bool pcmcache_is_candidate(const String &name)
+{
+    return (PCMCache.GetMaxCacheSize() > 0) && (PCMRejected.count(name) == 0);
+}
+
+// Puts the sounds which finished decoding in background into the decoded
+// sound cache; their complete data is no longer needed after that
+static void pcmcache_collect()
+{
+    for (auto it = PCMPending.begin(); it != PCMPending.end();)
+    {
+        if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++it;
+            continue;
+        }
+        auto pcm = it->second.get();
+        if (pcm)
+        {
+            PCMCache.Put(it->first, pcm);
+            SndCache.Dispose(it->first);
+        }
+        else
+        {
+            PCMRejected.insert(it->first);
+        }
+        it = PCMPending.erase(it);
+    }
+}
+
+// Schedules decoding of the sound for the decoded sound cache, which is done
+// on a background thread, not to stall the game. If threads are not available,
+// then decodes the sound right away, and returns the decoded sound on success.
+static SoundPCMCache::DataRef pcmcache_put(const String &name,
+    const std::shared_ptr<std::vector<uint8_t>> &data, const String &ext_hint)
+{
+    if (PCMPending.count(name) > 0)
+        return nullptr; // already decoding
+    auto decoding = soundprefetch_decode(data, ext_hint, MaxPCMLengthMs);
+    if (decoding.valid())
+    {
+        PCMPending[name] = decoding;
+        return nullptr;
+    }
+
+    auto pcm = audio_core_decode_sound(*data, ext_hint, MaxPCMLengthMs);
+    if (!pcm)
+    {
+        PCMRejected.insert(name);
+        return nullptr;
+    }
+    PCMCache.Put(name, pcm);
+    return pcm;
+}
 
 void soundcache_set_rules(size_t max_loadatonce, size_t max_cachesize)
 {
@@ -93,16 +202,43 @@ void soundcache_set_rules(size_t max_loadatonce, size_t max_cachesize)
     Debug::Printf("Sound cache set: %zu KB", max_cachesize / 1024);
 }
 
+void soundcache_set_pcm_rules(size_t max_cachesize, float max_length_ms)
+{
+    PCMCache.SetMaxCacheSize(max_cachesize);
+    MaxPCMLengthMs = max_length_ms;
+    Debug::Printf("Decoded sound cache set: %zu KB, max sound length: %.0f ms",
+        max_cachesize / 1024, max_length_ms);
+}
+
+void soundcache_get_pcm_stats(uint32_t &hits, uint32_t &misses)
+{
+    hits = PCMCache.GetHits();
+    misses = PCMCache.GetMisses();
+}
+
 void soundcache_clear()
 {
+    if (PCMCache.GetHits() + PCMCache.GetMisses() > 0)
+    {
+        Debug::Printf("Decoded sound cache: %u hits, %u misses, %zu KB used",
+            PCMCache.GetHits(), PCMCache.GetMisses(), PCMCache.GetCacheSize() / 1024);
+    }
     SndCache.Clear();
+    PCMCache.Clear();
+    PCMCache.ResetStats();
+    PCMRejected.clear();
+    // the pending decodes will finish in background, and results discarded
+    PCMPending.clear();
 }
 
 void soundcache_precache(const AssetPath &apath)
 {
-    if (SndCache.GetMaxCacheSize() == 0)
+    const bool use_pcm = pcmcache_is_candidate(apath.Name);
+    if ((SndCache.GetMaxCacheSize() == 0) && !use_pcm)
         return; // cache is disabled
-    if (SndCache.Exists(apath.Name))
+    pcmcache_collect();
+    if (SndCache.Exists(apath.Name) || PCMCache.Exists(apath.Name) ||
+        (PCMPending.count(apath.Name) > 0))
         return; // already in cache
     auto s_in = AssetMgr->OpenAsset(apath);
     if (!s_in)
@@ -110,14 +246,45 @@ void soundcache_precache(const AssetPath &apath)
     size_t asset_size = static_cast<size_t>(s_in->GetLength());
     if (asset_size > MaxLoadAtOnce)
         return; // too big for the cache
-    // Read and put into the cache
+    // Read and put into the cache; short sounds are also decoded,
+    // and replace the complete data when ready
     auto sounddata = std::make_shared<std::vector<uint8_t>>(asset_size);
     s_in->Read(sounddata->data(), asset_size);
+    if (use_pcm && pcmcache_put(apath.Name, sounddata, Path::GetFileExtension(apath.Name)))
+        return;
     SndCache.Put(apath.Name, sounddata);
 }
 
 std::unique_ptr<SoundClip> load_sound_clip(const AssetPath &apath, const char *extension_hint, bool loop)
 {
+    const auto asset_ext = AGS::Common::Path::GetFileExtension(apath.Name);
+    const auto ext_hint = asset_ext.IsEmpty() ? String(extension_hint) : asset_ext;
+    const auto sound_type = GuessSoundTypeFromExt(ext_hint);
+
+    // If the sound was prefetched ahead, then play the prefetched data
+    PrefetchedSound prefetched;
+    if (soundprefetch_take(apath, prefetched))
+    {
+        int slot = prefetched.PCM ? audio_core_slot_init(prefetched.PCM, loop) :
+            audio_core_slot_init(prefetched.Data, ext_hint, loop);
+        if (slot < 0) { return nullptr; }
+        return std::unique_ptr<SoundClip>(new SoundClip(slot, sound_type, loop));
+    }
+
+    // If the sound was decoded before, then play the decoded data
+    const bool use_pcm = pcmcache_is_candidate(apath.Name);
+    if (use_pcm)
+    {
+        pcmcache_collect();
+        auto pcm = PCMCache.Find(apath.Name);
+        if (pcm)
+        {
+            int slot = audio_core_slot_init(pcm, loop);
+            if (slot < 0) { return nullptr; }
+            return std::unique_ptr<SoundClip>(new SoundClip(slot, sound_type, loop));
+        }
+    }
+
     size_t asset_size;
     std::unique_ptr<Stream> s_in;
     auto sounddata = SndCache.Get(apath.Name);
@@ -133,21 +300,32 @@ std::unique_ptr<SoundClip> load_sound_clip(const AssetPath &apath, const char *e
         asset_size = static_cast<size_t>(s_in->GetLength());
     }
 
-    const auto asset_ext = AGS::Common::Path::GetFileExtension(apath.Name);
-    const auto ext_hint = asset_ext.IsEmpty() ? String(extension_hint) : asset_ext;
-
     int slot{};
     // If sound data was cached, or asset's size is small enough to load at once,
-    // then load/use it and update the cache if necessary
+    // then load/use it and update the cache if necessary;
+    // short sounds are decoded once in background and kept in the decoded
+    // sound cache, meanwhile they are played from the complete data
     if (sounddata || asset_size <= MaxLoadAtOnce)
     {
+        const bool was_cached = sounddata != nullptr;
         if (!sounddata)
         {
             sounddata.reset(new std::vector<uint8_t>(asset_size));
             s_in->Read(sounddata->data(), asset_size);
-            SndCache.Put(apath.Name, sounddata);
         }
-        slot = audio_core_slot_init(sounddata, ext_hint, loop);
+        auto pcm = use_pcm ? pcmcache_put(apath.Name, sounddata, ext_hint) : nullptr;
+        if (pcm)
+        {
+            if (was_cached)
+                SndCache.Dispose(apath.Name); // no longer needed
+            slot = audio_core_slot_init(pcm, loop);
+        }
+        else
+        {
+            if (!was_cached)
+                SndCache.Put(apath.Name, sounddata);
+            slot = audio_core_slot_init(sounddata, ext_hint, loop);
+        }
     }
     // Otherwise, if asset's size is too large, start streaming
     else
@@ -157,6 +335,5 @@ std::unique_ptr<SoundClip> load_sound_clip(const AssetPath &apath, const char *e
 
     if (slot < 0) { return nullptr; }
 
-    const auto sound_type = GuessSoundTypeFromExt(ext_hint);
     return std::unique_ptr<SoundClip>(new SoundClip(slot, sound_type, loop));
 }
@@ -26,11 +26,23 @@
 const size_t DEFAULT_SOUNDLOADATONCE_KB = 1024u;
 // Sound cache limit, in KB
 const size_t DEFAULT_SOUNDCACHESIZE_KB = 1024u * 32; // 32 MB
+// Decoded sound cache limit, in KB
+const size_t DEFAULT_SOUNDPCMCACHESIZE_KB = 1024u * 16; // 16 MB
+// Max length of a sound which may be put into the decoded sound cache, in ms
+const float DEFAULT_SOUNDPCMMAXLENGTH_MS = 3000.f;
 
 // Sets sound loading and caching rules:
 // * max_loadatonce - threshold in bytes for loading sounds immediately, vs streaming
 // * max_cachesize - sound cache limit, in bytes
 void soundcache_set_rules(size_t max_loadatonce, size_t max_cachesize);
+// Sets decoded sound caching rules; short sounds are kept fully decoded,
+// and are played from the shared PCM data without decoding. The sounds are
+// decoded on a background thread after their first play:
+// * max_cachesize - decoded sound cache limit, in bytes; 0 disables the cache
+// * max_length_ms - max length of a sound which may be kept decoded
+void soundcache_set_pcm_rules(size_t max_cachesize, float max_length_ms);
+// Gets decoded sound cache hits and misses since the last cache clear
+void soundcache_get_pcm_stats(uint32_t &hits, uint32_t &misses);
 void soundcache_clear();
 void soundcache_precache(const AssetPath &apath);
 
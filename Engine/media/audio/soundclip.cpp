@@ -11,6 +11,7 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <algorithm>
 #include <cmath>
 #include "media/audio/soundclip.h"
 #include "media/audio/audio_core.h"
@@ -37,10 +38,11 @@ SoundClip::SoundClip(int slot, int snd_type, bool loop)
     state = PlaybackState::PlayStateInitial;
     pos = posMs = -1;
     paramsChanged = true;
+    pendingSeq_ = 0u;
 
-    const auto player = audio_core_get_player(slot);
-    lengthMs = (int)std::round(player->GetDurationMs());
-    freq = static_cast<int>(player->GetFrequency());
+    status_ = audio_core_get_status(slot);
+    lengthMs = status_ ? (int)std::round(status_->DurationMs) : 0;
+    freq = status_ ? static_cast<int>(status_->Frequency) : 0;
 }
 
 SoundClip::~SoundClip()
@@ -67,9 +69,8 @@ void SoundClip::pause()
 {
     if (!is_ready())
         return;
-    auto player = audio_core_get_player(slot_);
-    player->Pause();
-    state = player->GetPlayStateNormal();
+    pendingSeq_ = audio_core_slot_pause(slot_);
+    state = PlaybackState::PlayStatePaused;
 }
 
 void SoundClip::resume()
@@ -116,22 +117,22 @@ void SoundClip::seek(int pos_)
 void SoundClip::seek_ms(int pos_ms)
 {
     if (slot_ < 0) { return; }
-    auto player = audio_core_get_player(slot_);
-    player->Pause();
+    audio_core_slot_pause(slot_);
     // TODO: for backward compatibility and MOD/XM music support
     // need to reimplement seeking to a position which units
     // are defined according to the sound type
-    player->Seek((float)pos_ms);
-    float posms_f = player->GetPositionMs();
-    posMs = static_cast<int>(posms_f);
+    pendingSeq_ = audio_core_slot_seek(slot_, (float)pos_ms);
+    // the seek is applied asynchronously, so assume the requested position
+    // until the audio core reports that it's done; the player will not seek
+    // past the clip's end
+    posMs = std::max(0, (lengthMs > 0) ? std::min(pos_ms, lengthMs) : pos_ms);
     pos = posms_to_pos(posMs);
 }
 
 bool SoundClip::update()
 {
-    if (!is_ready()) return false;
+    if (!is_ready() || !status_) return false;
 
-    auto player = audio_core_get_player(slot_);
     if (paramsChanged)
     {
         auto vol_f = static_cast<float>(get_final_volume()) / 255.0f;
@@ -146,14 +147,21 @@ bool SoundClip::update()
         if (panning_f < -1.0f) { panning_f = -1.0f; }
         if (panning_f > 1.0f) { panning_f = 1.0f; }
 
-        player->SetVolume(vol_f);
-        player->SetSpeed(speed_f);
-        player->SetPanning(panning_f);
+        audio_core_slot_set_volume(slot_, vol_f);
+        audio_core_slot_set_speed(slot_, speed_f);
+        audio_core_slot_set_panning(slot_, panning_f);
         paramsChanged = false;
     }
 
-    PlaybackState core_state = player->GetPlayStateNormal();
-    float posms_f = player->GetPositionMs();
+    // The status may be behind the latest commands, which will be applied
+    // by the audio thread later; until then keep the assumed state and
+    // position, and don't repeat the commands
+    const uint32_t applied_seq = status_->CommandSeq.load(std::memory_order_acquire);
+    if (static_cast<int32_t>(pendingSeq_ - applied_seq) > 0)
+        return is_ready();
+
+    PlaybackState core_state = static_cast<PlaybackState>(status_->State.load(std::memory_order_acquire));
+    float posms_f = status_->PositionMs.load(std::memory_order_acquire);
     posMs = static_cast<int>(posms_f);
     pos = posms_to_pos(posMs);
     if (state == core_state || IsPlaybackDone(core_state))
@@ -165,8 +173,7 @@ bool SoundClip::update()
     switch (state)
     {
     case PlaybackState::PlayStatePlaying:
-        player->Play();
-        state = player->GetPlayStateNormal();
+        pendingSeq_ = audio_core_slot_play(slot_);
         break;
     default: /* do nothing */
         break;
@@ -36,8 +36,11 @@
 //=============================================================================
 #ifndef __AGS_EE_MEDIA__SOUNDCLIP_H__
 #define __AGS_EE_MEDIA__SOUNDCLIP_H__
+#include <memory>
 #include "media/audio/audiodefines.h"
 
+namespace AGS { namespace Engine { struct AudioPlayerStatus; } }
+
 class SoundClip final
 {
 public:
@@ -174,12 +177,17 @@ private:
 
     // audio core slot handle
     const int slot_;
+    // audio core's player status snapshot
+    std::shared_ptr<const AGS::Engine::AudioPlayerStatus> status_;
     // Frequency, needed for position handling
     int freq;
     // current playback state
     PlaybackState state;
     // last synced position
     int pos, posMs;
+    // sequence number of the latest play, pause or seek command,
+    // until it's applied the clip keeps its assumed state and position
+    uint32_t pendingSeq_;
     // whether playback parameters changed and have to be reapplied
     bool paramsChanged;
     // current volume, in legacy units of 255
@@ -0,0 +1,168 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "media/audio/soundprefetch.h"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <future>
+#include <string>
+#include "ac/game.h"
+#include "core/assetmanager.h"
+#include "media/audio/audio_core.h"
+#include "util/path.h"
+#include "util/stream.h"
+#include "util/thread_pool.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+struct PrefetchEntry
+{
+    AssetPath Asset;
+    std::shared_future<PrefetchedSound> Sound;
+    // Tells the pending task to skip its work
+    std::shared_ptr<std::atomic<bool>> Cancel;
+};
+
+// Prefetched sounds, in the order of requests; only accessed by the main thread
+static std::deque<PrefetchEntry> PrefetchQueue;
+// Loads the sounds one by one, in the order of requests,
+// so that the sound which is expected first gets ready first
+static ThreadPool PrefetchThread;
+static bool PrefetchThreadStarted = false;
+
+static PrefetchedSound soundprefetch_load(std::shared_ptr<Stream> in, const std::string &ext, size_t asset_size,
+    std::shared_ptr<std::atomic<bool>> cancel)
+{
+    PrefetchedSound sound;
+    if (*cancel)
+        return sound;
+    auto data = std::make_shared<std::vector<uint8_t>>(asset_size);
+    if (in->Read(data->data(), asset_size) != asset_size)
+        return sound;
+    if (*cancel)
+        return sound;
+    sound.PCM = audio_core_decode_sound(*data, String(ext.c_str()), DEFAULT_SOUNDPREFETCH_DECODE_MS);
+    if (!sound.PCM)
+        sound.Data = data; // too long to keep decoded
+    return sound;
+}
+
+static void soundprefetch_cancel(PrefetchEntry &entry)
+{
+    *entry.Cancel = true;
+}
+
+static void soundprefetch_start_thread()
+{
+    if (!PrefetchThreadStarted)
+    {
+        PrefetchThread.Start(1);
+        PrefetchThreadStarted = true;
+    }
+}
+
+void soundprefetch_request(const AssetPath &apath)
+{
+    soundprefetch_start_thread();
+    if (PrefetchThread.GetThreadCount() == 0)
+        return; // no threads, the sound would be loaded right away anyway
+
+    for (const auto &entry : PrefetchQueue)
+    {
+        if ((entry.Asset.Name.CompareNoCase(apath.Name) == 0) && (entry.Asset.Filter == apath.Filter))
+            return; // already requested
+    }
+
+    auto in = AssetMgr->OpenAsset(apath);
+    if (!in)
+        return;
+    const size_t asset_size = static_cast<size_t>(in->GetLength());
+    if (asset_size > DEFAULT_SOUNDPREFETCH_MAXSIZE)
+        return; // too large, will be streamed
+
+    if (PrefetchQueue.size() >= DEFAULT_SOUNDPREFETCH_COUNT)
+    {
+        soundprefetch_cancel(PrefetchQueue.front());
+        PrefetchQueue.pop_front();
+    }
+
+    // NOTE: String's reference counter is not thread-safe, so pass a std::string;
+    // std::function requires a copyable callable, so share the task
+    PrefetchEntry entry;
+    entry.Asset = apath;
+    entry.Cancel = std::make_shared<std::atomic<bool>>(false);
+    auto task = std::make_shared<std::packaged_task<PrefetchedSound()>>(
+        std::bind(soundprefetch_load, std::shared_ptr<Stream>(std::move(in)),
+                  std::string(Path::GetFileExtension(apath.Name).GetCStr()), asset_size,
+                  entry.Cancel));
+    entry.Sound = task->get_future().share();
+    PrefetchQueue.push_back(std::move(entry));
+    PrefetchThread.Enqueue([task]() { (*task)(); });
+}
+
+bool soundprefetch_take(const AssetPath &apath, PrefetchedSound &sound)
+{
+    for (auto it = PrefetchQueue.begin(); it != PrefetchQueue.end(); ++it)
+    {
+        if ((it->Asset.Name.CompareNoCase(apath.Name) != 0) || (it->Asset.Filter != apath.Filter))
+            continue;
+        // Never wait for the worker here: it may still be busy with other
+        // requests, and loading the sound normally is not slower than that
+        if (it->Sound.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            soundprefetch_cancel(*it);
+            PrefetchQueue.erase(it);
+            return false;
+        }
+        sound = it->Sound.get();
+        PrefetchQueue.erase(it);
+        return sound.PCM || sound.Data;
+    }
+    return false;
+}
+
+std::shared_future<std::shared_ptr<const DecodedSound>>
+    soundprefetch_decode(std::shared_ptr<const std::vector<uint8_t>> data,
+                         const String &ext, float max_length_ms)
+{
+    soundprefetch_start_thread();
+    if (PrefetchThread.GetThreadCount() == 0)
+        return {};
+
+    // NOTE: String's reference counter is not thread-safe, so pass a std::string
+    const std::string ext_str(ext.GetCStr());
+    auto task = std::make_shared<std::packaged_task<std::shared_ptr<const DecodedSound>()>>(
+        [data, ext_str, max_length_ms]() -> std::shared_ptr<const DecodedSound>
+        { return audio_core_decode_sound(*data, String(ext_str.c_str()), max_length_ms); });
+    auto result = task->get_future().share();
+    PrefetchThread.Enqueue([task]() { (*task)(); });
+    return result;
+}
+
+void soundprefetch_clear()
+{
+    // Let pending requests finish quickly, the results are discarded
+    for (auto &entry : PrefetchQueue)
+        soundprefetch_cancel(entry);
+    PrefetchQueue.clear();
+}
+
+void soundprefetch_shutdown()
+{
+    soundprefetch_clear();
+    PrefetchThread.Stop();
+    PrefetchThreadStarted = false;
+}
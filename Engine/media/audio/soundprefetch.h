@@ -0,0 +1,68 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Sound prefetching: loads the sounds which are expected to be played soon,
+// such as the next voice-over lines, on a background thread. The asset is
+// opened on the calling thread, while reading and decoding are done by the
+// worker. Sounds which are short enough are decoded completely, the others
+// are kept as complete data in memory; either way the sound is handed to
+// the audio core without touching the storage.
+//
+// The number of prefetched sounds is limited: when a new request exceeds
+// the limit, the oldest prefetched sound is discarded. A sound which was
+// not loaded by the time it's needed is discarded too, and loaded normally.
+//
+//=============================================================================
+#ifndef __AGS_EE_MEDIA__SOUNDPREFETCH_H
+#define __AGS_EE_MEDIA__SOUNDPREFETCH_H
+
+#include <future>
+#include <memory>
+#include <vector>
+#include "ac/asset_helper.h"
+#include "media/audio/sdldecoder.h"
+
+// Max number of sounds that may be prefetched at once
+const size_t DEFAULT_SOUNDPREFETCH_COUNT = 6u;
+// Max length of a prefetched sound which is decoded completely, in ms
+const float DEFAULT_SOUNDPREFETCH_DECODE_MS = 10000.f;
+// Max size of a sound asset which may be prefetched, in bytes
+const size_t DEFAULT_SOUNDPREFETCH_MAXSIZE = 4u * 1024u * 1024u;
+
+// Prefetched sound: either decoded, or the complete sound data
+struct PrefetchedSound
+{
+    std::shared_ptr<std::vector<uint8_t>> Data;
+    std::shared_ptr<const AGS::Engine::DecodedSound> PCM;
+};
+
+// Schedules loading of the sound asset, if it's not prefetched already;
+// does nothing if threads are not available on this platform
+void soundprefetch_request(const AssetPath &apath);
+// Retrieves the prefetched sound and removes it from the prefetcher.
+// Returns false if the sound was not requested, failed to load, or is not
+// loaded yet, in which case the request is cancelled; never waits.
+bool soundprefetch_take(const AssetPath &apath, PrefetchedSound &sound);
+// Schedules decoding of the complete sound data on the prefetching thread;
+// the result is null if the sound could not be decoded, or is longer than
+// max_length_ms. Returns an invalid future if threads are not available.
+std::shared_future<std::shared_ptr<const AGS::Engine::DecodedSound>>
+    soundprefetch_decode(std::shared_ptr<const std::vector<uint8_t>> data,
+                         const AGS::Common::String &ext, float max_length_ms);
+// Discards all the prefetched sounds, and cancels pending requests
+void soundprefetch_clear();
+// Stops the prefetching thread
+void soundprefetch_shutdown();
+
+#endif // __AGS_EE_MEDIA__SOUNDPREFETCH_H
@@ -16,6 +16,7 @@
 #ifndef AGS_NO_VIDEO_PLAYER
 
 #include <inttypes.h>
+#include <string.h>
 #include "debug/out.h"
 
 namespace AGS
@@ -86,8 +87,16 @@ HError TheoraPlayer::OpenAPEGStream(Stream *data_stream, const Common::String &n
     // playing if the file is large because it seeks through the whole thing
     apeg_disable_length_detection(TRUE);
     apeg_ignore_audio((flags & kVideo_EnableAudio) == 0);
+    // For 32-bit output get frames in YUV format, and let VideoPlayer convert
+    // them, which is faster than APEG's own converter, and also may be done
+    // in parallel with decoding the next frames.
+    const bool yuv_frames = (target_depth == 32) && ((flags & kVideo_EnableVideo) != 0);
+    if (yuv_frames)
+        apeg_set_display_callbacks(InitYUVDisplay, DisplayYUVFrame, this);
 
     APEG_STREAM* apeg_stream = apeg_open_stream_ex(data_stream);
+    // display callbacks are global, and are remembered by the opened stream
+    apeg_set_display_callbacks(nullptr, nullptr, nullptr);
     if (!apeg_stream)
     {
         return new Error(String::FromFormat("Failed to open theora video '%s'; could be an invalid or unsupported format", name.GetCStr()));
@@ -101,6 +110,8 @@ HError TheoraPlayer::OpenAPEGStream(Stream *data_stream, const Common::String &n
     _apegStream = apeg_stream;
     _usedFlags = flags;
     _usedDepth = target_depth;
+    // APEG does not create its own bitmap if the display callbacks are used
+    _yuvFrames = yuv_frames && (_apegStream->bitmap == nullptr);
 
     _frameDepth = target_depth;
     _frameSize = Size(video_w, video_h);
@@ -113,7 +124,12 @@ HError TheoraPlayer::OpenAPEGStream(Stream *data_stream, const Common::String &n
     // Which means that the original content may end up positioned on a larger frame.
     // In such case we store this surface in a separate wrapper for the reference,
     // while the actual video frame is assigned a sub-bitmap (a portion of the full frame).
-    if (((flags & kVideo_LegacyFrameSize) == 0) &&
+    if (_yuvFrames)
+    {
+        _theoraFullFrame.reset();
+        _theoraSrcFrame.reset();
+    }
+    else if (((flags & kVideo_LegacyFrameSize) == 0) &&
         Size(_apegStream->bitmap->w, _apegStream->bitmap->h) != _frameSize)
     {
         _theoraFullFrame.reset(BitmapHelper::CreateRawBitmapWrapper(_apegStream->bitmap));
@@ -133,12 +149,13 @@ HError TheoraPlayer::OpenAPEGStream(Stream *data_stream, const Common::String &n
     _nextFrameTs = 0.f;
 
     const char *pixelfmt_str[] = { "APEG_420", "APEG_422", "APEG_444" };
-    Debug::Printf("TheoraPlayer: opened video \"%s\": %dx%d fmt: %s, fps: %.4f"
+    Debug::Printf("TheoraPlayer: opened video \"%s\": %dx%d fmt: %s, fps: %.4f, output: %s"
                   "\n\taudio: %d Hz, chans: %d",
                   name.GetCStr(),
                   apeg_stream->w, apeg_stream->h,
                   (apeg_stream->pixel_format >= APEG_STREAM::APEG_420 && apeg_stream->pixel_format <= APEG_STREAM::APEG_444) ? pixelfmt_str[apeg_stream->pixel_format] : "unknown",
                   static_cast<float>(apeg_stream->frame_rate),
+                  _yuvFrames ? "YUV" : "RGB",
                   _audioFreq, _audioChannels);
 
     return HError::None();
@@ -167,10 +184,8 @@ bool TheoraPlayer::RewindImpl()
     return _apegStream != nullptr;
 }
 
-bool TheoraPlayer::NextVideoFrame(Bitmap *dst, float &ts)
+bool TheoraPlayer::DecodeVideoFrame()
 {
-    ts = -1.f; // reset in case of error
-
     assert(_apegStream);
     assert((_apegStream->flags & APEG_HAS_VIDEO) != 0);
     if ((_apegStream->flags & APEG_HAS_VIDEO) == 0)
@@ -181,13 +196,23 @@ bool TheoraPlayer::NextVideoFrame(Bitmap *dst, float &ts)
     if (ret == APEG_ERROR)
         return false;
 
-    // Update the display frame (decode to RGB)
+    // Update the display frame (decode to RGB, or pass YUV to our callback)
     ret = apeg_display_video_frame(_apegStream);
     if (ret == APEG_ERROR || ret == APEG_EOF)
         return false; // NOTE: apeg_display_video_frame returns EOF when picture is NULL
 
     _videoFramesDecoded++;
     _videoFramesDecodedTotal++;
+    return true;
+}
+
+bool TheoraPlayer::NextVideoFrame(Bitmap *dst, float &ts)
+{
+    ts = -1.f; // reset in case of error
+    assert(!_yuvFrames);
+    if (!DecodeVideoFrame())
+        return false;
+
     // TODO: investigate if it's possible to optimize this by providing our own src bitmap directly;
     // but in theory the frame image may be composed of multiple frames which contain partial image,
     // in which case we probably cannot do this...
@@ -197,6 +222,52 @@ bool TheoraPlayer::NextVideoFrame(Bitmap *dst, float &ts)
     return true;
 }
 
+bool TheoraPlayer::NextVideoFrameYUV(YUVFrame &dst, float &ts)
+{
+    ts = -1.f; // reset in case of error
+    assert(_yuvFrames);
+    _yuvDst = &dst;
+    const bool res = DecodeVideoFrame();
+    _yuvDst = nullptr;
+    if (!res)
+        return false;
+
+    ts = _nextFrameTs;
+    _nextFrameTs = _apegStream->pos * 1000.f; // to milliseconds (FIXME: should we keep ours in seconds?)
+    return true;
+}
+
+int TheoraPlayer::InitYUVDisplay(APEG_STREAM *stream, int coded_w, int coded_h, void *arg)
+{
+    // We only handle 4:2:0 frames, let APEG convert other formats itself
+    if (stream->pixel_format != APEG_STREAM::APEG_420)
+        return 1;
+    static_cast<TheoraPlayer*>(arg)->_codedSize = Size(coded_w, coded_h);
+    return 0;
+}
+
+void TheoraPlayer::DisplayYUVFrame(APEG_STREAM *stream, unsigned char **src, void *arg)
+{
+    // Copy the visible portion of the decoder's picture, because the decoder
+    // will reuse its buffers for the next frame, while this one is converted
+    TheoraPlayer *player = static_cast<TheoraPlayer*>(arg);
+    YUVFrame *dst = player->_yuvDst;
+    if (!dst)
+        return;
+    if ((dst->Width != stream->w) || (dst->Height != stream->h))
+        dst->Allocate(stream->w, stream->h);
+    const int y_pitch = player->_codedSize.Width;
+    const int uv_pitch = player->_codedSize.Width / 2;
+    for (int y = 0; y < dst->Height; ++y)
+        memcpy(&dst->Y[y * dst->YPitch], src[0] + y * y_pitch, dst->Width);
+    const int uv_w = (dst->Width + 1) / 2, uv_h = (dst->Height + 1) / 2;
+    for (int y = 0; y < uv_h; ++y)
+    {
+        memcpy(&dst->U[y * dst->UVPitch], src[1] + y * uv_pitch, uv_w);
+        memcpy(&dst->V[y * dst->UVPitch], src[2] + y * uv_pitch, uv_w);
+    }
+}
+
 bool TheoraPlayer::NextAudioFrame(SoundBuffer &abuf)
 {
     assert(_apegStream);
@@ -41,6 +41,8 @@ private:
     bool RewindImpl() override;
     // Retrieves next video frame, implementation-specific
     bool NextVideoFrame(Common::Bitmap *dst, float &ts) override;
+    // Retrieves next video frame in YUV format
+    bool NextVideoFrameYUV(YUVFrame &dst, float &ts) override;
     // Retrieves next audio frame, implementation-specific
     bool NextAudioFrame(SoundBuffer &abuf) override;
     // Checks the next video frame in stream and returns its timestamp.
@@ -49,6 +51,13 @@ private:
     void DropVideoFrame() override;
 
     Common::HError OpenAPEGStream(Stream *data_stream, const String &name, int flags, int target_depth);
+    // Reads and decodes next video frame, passes the picture to the display
+    // callback or APEG's own converter; returns if a frame was decoded
+    bool DecodeVideoFrame();
+
+    // APEG display callbacks, used to get frames in YUV format
+    static int InitYUVDisplay(APEG_STREAM *stream, int coded_w, int coded_h, void *arg);
+    static void DisplayYUVFrame(APEG_STREAM *stream, unsigned char **src, void *arg);
 
     std::unique_ptr<Stream> _dataStream;
     int _usedFlags = 0;
@@ -58,6 +67,10 @@ private:
     std::unique_ptr<Common::Bitmap> _theoraFullFrame;
     // Wrapper over portion of theora frame which we want to use
     std::unique_ptr<Common::Bitmap> _theoraSrcFrame;
+    // Size of the decoder's YUV planes, which may be larger than the video frame
+    Size _codedSize;
+    // Destination for the YUV frame, assigned for the duration of the display callback
+    YUVFrame *_yuvDst = nullptr;
     uint64_t _videoFramesDecodedTotal = 0u; // how many frames loaded and decoded total (includes rewinds!)
     uint64_t _videoFramesDecoded = 0u; // sequential count of video frames since the video beginning
     float _nextFrameTs = 0.f; // next frame presentation time
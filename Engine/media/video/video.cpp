@@ -14,15 +14,19 @@
 #include "media/video/video.h"
 
 #ifndef AGS_NO_VIDEO_PLAYER
+#include <atomic>
 #include <chrono>
+#include <map>
 #include <mutex>
 #include <thread>
 #include "core/assetmanager.h"
 #include "ac/draw.h"
+#include "ac/dynamicsprite.h"
 #include "ac/game.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/gamestate.h"
 #include "ac/global_audio.h"
+#include "ac/spritecache.h"
 #include "ac/sys_events.h"
 #include "debug/debug_log.h"
 #include "gfx/graphicsdriver.h"
@@ -39,6 +43,7 @@ using namespace AGS::Engine;
 
 extern GameSetupStruct game;
 extern IGraphicsDriver *gfxDriver;
+extern SpriteCache spriteset;
 
 static bool video_check_user_input(VideoSkipType skip);
 
@@ -500,17 +505,314 @@ void video_single_stop()
     gl_Video = {};
 }
 
+//-----------------------------------------------------------------------------
+// VideoControl: non-blocking video playback
+//-----------------------------------------------------------------------------
+namespace AGS
+{
+namespace Engine
+{
+
+VideoControl::VideoControl(int id, std::unique_ptr<VideoPlayer> player, int sprite_id)
+    : _id(id)
+    , _spriteID(sprite_id)
+    , _player(std::move(player))
+{
+    _frameSize = _player->GetTargetSize();
+    _frameRate = _player->GetFramerate();
+    _frameCount = _player->GetFrameCount();
+    _durationMs = _player->GetDurationMs();
+    _playState = _player->GetPlayState();
+    _frameIndex = _player->GetFrameIndex();
+    _looping = _player->IsLooping();
+}
+
+VideoControl::~VideoControl()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    _player->Stop();
+}
+
+void VideoControl::Play()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    _player->Play();
+    _playState = _player->GetPlayState();
+    _suspended = false;
+}
+
+void VideoControl::Pause()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    _player->Pause();
+    _playState = _player->GetPlayState();
+    _suspended = false;
+}
+
+void VideoControl::Stop()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    _player->Stop();
+    _playState = _player->GetPlayState();
+}
+
+void VideoControl::SetLooping(bool loop)
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    _player->SetLooping(loop);
+    _looping = loop;
+}
+
+void VideoControl::SetSpeed(float speed)
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    _player->SetSpeed(speed);
+    _speed = speed;
+}
+
+void VideoControl::SetVolume(float volume)
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    _player->SetVolume(volume);
+    _volume = volume;
+}
+
+void VideoControl::SetSuspended(bool suspend)
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    if (suspend && (_player->GetPlayState() == PlayStatePlaying))
+    {
+        _player->Pause();
+        _suspended = true;
+    }
+    else if (!suspend && _suspended)
+    {
+        _player->Play();
+        _suspended = false;
+    }
+}
+
+void VideoControl::Poll()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    _player->Poll();
+}
+
+bool VideoControl::UpdateSprite()
+{
+    std::unique_ptr<Bitmap> frame;
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        frame = _player->GetReadyFrame();
+        _playState = _player->GetPlayState();
+        _frameIndex = _player->GetFrameIndex();
+        _posMs = _player->GetPositionMs();
+    }
+    if (!frame)
+        return false;
+
+    // Swap the new frame into the sprite slot, and give the previous frame
+    // back to the player, which will decode one of the next frames into it
+    std::unique_ptr<Bitmap> old_frame = spriteset.RemoveSprite(_spriteID);
+    add_dynamic_sprite(_spriteID, std::move(frame), false, SPF_OBJECTOWNED);
+    game_sprite_updated(_spriteID);
+    if (old_frame && (old_frame->GetSize() == _frameSize) && IsPlaybackReady(_playState))
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        _player->ReleaseFrame(std::move(old_frame));
+    }
+    return true;
+}
+
+} // namespace Engine
+} // namespace AGS
+
+
+//-----------------------------------------------------------------------------
+// Non-blocking video API
+//-----------------------------------------------------------------------------
+// Number of frames which a non-blocking video may buffer ahead;
+// kept low, as there may be multiple videos playing along with the game
+static const uint32_t VideoControlQueueFrames = 3u;
+// Non-blocking videos, by their IDs; the list is only modified on the main
+// thread, under the lock, and is read by the video thread under same lock
+static std::map<int, std::unique_ptr<VideoControl>> gl_VideoControls;
+static std::mutex gl_VideoControlsMutex;
+static int gl_NextVideoID = 1;
+#if !defined(AGS_DISABLE_THREADS)
+static std::thread gl_VideoControlThread;
+static std::atomic<bool> gl_VideoControlThreadRun{false};
+
+// Polls all the non-blocking videos, decoding their frames in background
+static void video_control_thread()
+{
+    while (gl_VideoControlThreadRun)
+    {
+        {
+            std::lock_guard<std::mutex> lk(gl_VideoControlsMutex);
+            for (auto &vc : gl_VideoControls)
+                vc.second->Poll();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(8));
+    }
+}
+
+static void video_control_thread_start()
+{
+    if (gl_VideoControlThread.joinable())
+        return;
+    gl_VideoControlThreadRun = true;
+    gl_VideoControlThread = std::thread(video_control_thread);
+}
+
+static void video_control_thread_stop()
+{
+    gl_VideoControlThreadRun = false;
+    if (gl_VideoControlThread.joinable())
+        gl_VideoControlThread.join();
+}
+#endif // !AGS_DISABLE_THREADS
+
+HError open_video(const char *name, int video_flags, int &video_id)
+{
+    auto video_stream = AssetMgr->OpenAsset(name);
+    if (!video_stream)
+    {
+        return new Error(String::FromFormat("Failed to open file: %s", name));
+    }
+
+    std::unique_ptr<VideoPlayer> player = std::make_unique<TheoraPlayer>();
+    player->SetQueueLimit(VideoControlQueueFrames);
+    HError err = player->Open(std::move(video_stream), name, video_flags, Size(), game.GetColorDepth());
+    if (!err)
+    {
+        return new Error(String::FromFormat("Failed to run video %s", name), err);
+    }
+
+    // The sprite displays a blank frame until the first frame is ready
+    const Size frame_sz = player->GetTargetSize();
+    std::unique_ptr<Bitmap> blank(BitmapHelper::CreateClearBitmap(
+        frame_sz.Width, frame_sz.Height, player->GetTargetDepth()));
+    const int sprite_id = add_dynamic_sprite(std::move(blank), false, SPF_OBJECTOWNED);
+    if (sprite_id <= 0)
+    {
+        return new Error(String::FromFormat("Failed to create a sprite for video %s", name));
+    }
+
+    // Poll player once in order to buffer at least one video frame
+    player->Poll();
+    video_id = gl_NextVideoID++;
+    {
+        std::lock_guard<std::mutex> lk(gl_VideoControlsMutex);
+        gl_VideoControls[video_id].reset(new VideoControl(video_id, std::move(player), sprite_id));
+    }
+#if !defined(AGS_DISABLE_THREADS)
+    video_control_thread_start();
+#endif
+    return HError::None();
+}
+
+VideoControl *get_video_control(int video_id)
+{
+    auto it = gl_VideoControls.find(video_id);
+    return (it != gl_VideoControls.end()) ? it->second.get() : nullptr;
+}
+
+void video_stop(int video_id)
+{
+    std::unique_ptr<VideoControl> video;
+    {
+        std::lock_guard<std::mutex> lk(gl_VideoControlsMutex);
+        auto it = gl_VideoControls.find(video_id);
+        if (it == gl_VideoControls.end())
+            return;
+        video = std::move(it->second);
+        gl_VideoControls.erase(it);
+    }
+
+    const int sprite_id = video->GetSpriteID();
+    video.reset();
+    free_dynamic_sprite(sprite_id);
+#if !defined(AGS_DISABLE_THREADS)
+    if (gl_VideoControls.empty())
+        video_control_thread_stop();
+#endif
+}
+
+void video_stop_all()
+{
+    while (!gl_VideoControls.empty())
+        video_stop(gl_VideoControls.begin()->first);
+}
+
+void update_video_system_on_game_loop()
+{
+    for (auto &vc : gl_VideoControls)
+    {
+#if defined(AGS_DISABLE_THREADS)
+        vc.second->Poll();
+#endif
+        vc.second->UpdateSprite();
+    }
+}
+
+void video_pause_all()
+{
+    video_single_pause();
+    for (auto &vc : gl_VideoControls)
+        vc.second->SetSuspended(true);
+}
+
+void video_resume_all()
+{
+    video_single_resume();
+    for (auto &vc : gl_VideoControls)
+        vc.second->SetSuspended(false);
+}
+
 void video_shutdown()
 {
     video_single_stop();
+#if !defined(AGS_DISABLE_THREADS)
+    video_control_thread_stop();
+#endif
+    // The game is shutting down, so the sprites are left for the game cleanup
+    std::lock_guard<std::mutex> lk(gl_VideoControlsMutex);
+    gl_VideoControls.clear();
 }
 
 #else
 
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
 HError play_theora_video(const char *name, int video_flags, int state_flags, AGS::Engine::VideoSkipType skip) { return HError::None(); }
 HError play_flc_video(int numb, int video_flags, int state_flags, AGS::Engine::VideoSkipType skip) { return HError::None(); }
-void video_pause() {}
-void video_resume() {}
+void video_single_pause() {}
+void video_single_resume() {}
+void video_single_stop() {}
 void video_shutdown() {}
 
+namespace AGS { namespace Engine {
+VideoControl::VideoControl(int id, std::unique_ptr<VideoPlayer>, int sprite_id) : _id(id), _spriteID(sprite_id) {}
+VideoControl::~VideoControl() {}
+void VideoControl::Play() {}
+void VideoControl::Pause() {}
+void VideoControl::Stop() {}
+void VideoControl::SetLooping(bool) {}
+void VideoControl::SetSpeed(float) {}
+void VideoControl::SetVolume(float) {}
+void VideoControl::SetSuspended(bool) {}
+void VideoControl::Poll() {}
+bool VideoControl::UpdateSprite() { return false; }
+} }
+
+HError open_video(const char *name, int video_flags, int &video_id) { return new Error("Video playback is not supported"); }
+AGS::Engine::VideoControl *get_video_control(int video_id) { return nullptr; }
+void video_stop(int video_id) {}
+void video_stop_all() {}
+void update_video_system_on_game_loop() {}
+void video_pause_all() {}
+void video_resume_all() {}
+
 #endif
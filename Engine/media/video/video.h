@@ -12,12 +12,16 @@
 //
 //=============================================================================
 //
-// Game-blocking video interface.
+// Video playback interface: game-blocking video, which takes over the game
+// screen, and non-blocking video, which runs along with the game and
+// shows its frames through a dynamic sprite.
 //
 //=============================================================================
 #ifndef __AGS_EE_MEDIA__VIDEO_H
 #define __AGS_EE_MEDIA__VIDEO_H
 
+#include <memory>
+#include <mutex>
 #include "media/video/videoplayer.h"
 #include "util/geometry.h"
 #include "util/string.h"
@@ -50,6 +54,75 @@ enum VideoSkipType
     VideoSkipKeyOrMouse   = 3
 };
 
+// VideoControl runs a non-blocking video playback. The video is decoded on
+// a background thread into a small queue of frames, and the current frame
+// is exposed as a dynamic sprite, which may be assigned to room objects,
+// overlays, GUI backgrounds and anything else that displays a sprite.
+// The frames are swapped into the sprite slot without copying, and the
+// replaced frame is returned to the decoder for reuse; so the memory used
+// by the video is limited by the size of its frame queue.
+class VideoControl
+{
+public:
+    VideoControl(int id, std::unique_ptr<VideoPlayer> player, int sprite_id);
+    ~VideoControl();
+
+    int GetID() const { return _id; }
+    // Gets the dynamic sprite which displays the current video frame
+    int GetSpriteID() const { return _spriteID; }
+    const Size &GetFrameSize() const { return _frameSize; }
+    float GetFramerate() const { return _frameRate; }
+    uint32_t GetFrameCount() const { return _frameCount; }
+    float GetDurationMs() const { return _durationMs; }
+    // Following properties are updated along with the sprite,
+    // once per game update
+    PlaybackState GetPlayState() const { return _playState; }
+    uint32_t GetFrameIndex() const { return _frameIndex; }
+    float GetPositionMs() const { return _posMs; }
+    bool IsLooping() const { return _looping; }
+    float GetSpeed() const { return _speed; }
+    float GetVolume() const { return _volume; }
+
+    void Play();
+    void Pause();
+    // Stops the playback and releases the decoder;
+    // the sprite keeps displaying the last frame
+    void Stop();
+    void SetLooping(bool loop);
+    void SetSpeed(float speed);
+    void SetVolume(float volume);
+    // Pauses or resumes the playback for the time the game is suspended
+    void SetSuspended(bool suspend);
+
+    // Updates the decoder, buffers next video frames;
+    // called from the video thread
+    void Poll();
+    // Puts the latest ready frame into the sprite, updates the playback
+    // properties; called from the main thread once per game update.
+    // Returns if the sprite has changed.
+    bool UpdateSprite();
+
+private:
+    const int _id;
+    const int _spriteID;
+    std::unique_ptr<VideoPlayer> _player;
+    // Guards the player, which is polled from the video thread
+    std::mutex _mutex;
+    // Static video properties
+    Size _frameSize;
+    float _frameRate = 0.f;
+    uint32_t _frameCount = 0u;
+    float _durationMs = 0.f;
+    // Playback properties, updated on the main thread
+    PlaybackState _playState = PlayStateInvalid;
+    uint32_t _frameIndex = 0u;
+    float _posMs = 0.f;
+    bool _looping = false;
+    float _speed = 1.f;
+    float _volume = 1.f;
+    bool _suspended = false;
+};
+
 } // namespace Engine
 } // namespace AGS
 
@@ -67,6 +140,25 @@ void video_single_resume();
 // Stop current blocking video playback and dispose all video resource
 void video_single_stop();
 
+// Non-blocking video API
+//
+// Opens a OGV video for the non-blocking playback, assigns it a new dynamic
+// sprite, and returns the new video's ID
+AGS::Common::HError open_video(const char *name, int video_flags, int &video_id);
+// Gets the non-blocking video by its ID, returns null if there's none
+AGS::Engine::VideoControl *get_video_control(int video_id);
+// Stops and disposes the non-blocking video, deletes its sprite
+void video_stop(int video_id);
+// Stops and disposes all the non-blocking videos, deletes their sprites
+void video_stop_all();
+// Updates the sprites of all the non-blocking videos
+void update_video_system_on_game_loop();
+
+// Pause all videos, for the time the game is suspended
+void video_pause_all();
+// Resume all videos, after the game was suspended
+void video_resume_all();
+
 // Stop all videos and video thread
 void video_shutdown();
 
@@ -62,7 +62,11 @@ HError VideoPlayer::Open(std::unique_ptr<Common::Stream> data_stream,
     if (HasVideo())
     {
         _targetDepth = target_depth > 0 ? target_depth : _frameDepth;
+        if (_yuvFrames && ((_targetDepth != 32) || ((_flags & kVideo_AccumFrame) != 0)))
+            return new Error("Internal error: YUV frames are only supported for 32-bit frames without accumulation");
         SetTargetFrame(target_sz);
+        if (_yuvFrames)
+            _convThreads.Start(ThreadPool::GetDefaultThreadCount(MaxConvertThreads));
     }
 
     // TODO: actually support dynamic FPS, need to adjust audio speed
@@ -76,8 +80,13 @@ void VideoPlayer::SetTargetFrame(const Size &target_sz)
 {
     _targetSize = target_sz.IsNull() ? _frameSize : target_sz;
 
-    // Create helper bitmaps in case of stretching or color depth conversion
-    if ((_targetSize != _frameSize) || (_targetDepth != _frameDepth)
+    // Create helper bitmaps in case of stretching or color depth conversion;
+    // YUV frames are converted and stretched right into the target frame
+    if (_yuvFrames)
+    {
+        _vframeBuf.reset();
+    }
+    else if ((_targetSize != _frameSize) || (_targetDepth != _frameDepth)
         || ((_flags & kVideo_AccumFrame) != 0))
     {
         _vframeBuf.reset(new Bitmap(_frameSize.Width, _frameSize.Height, _frameDepth));
@@ -89,7 +98,7 @@ void VideoPlayer::SetTargetFrame(const Size &target_sz)
 
     // If we are decoding a 8-bit frame in a hi-color game, and stretching,
     // then create a hi-color buffer, as bitmap lib cannot stretch with depth change
-    if ((_targetSize != _frameSize) && (_frameDepth == 8) && (_targetDepth > 8))
+    if (!_yuvFrames && (_targetSize != _frameSize) && (_frameDepth == 8) && (_targetDepth > 8))
     {
         _hicolBuf.reset(BitmapHelper::CreateBitmap(_frameSize.Width, _frameSize.Height, _targetDepth));
     }
@@ -115,10 +124,13 @@ void VideoPlayer::Stop()
     // Close video decoder and free resources
     CloseImpl();
 
+    // Wait for the frames being converted, before releasing them
+    _convThreads.Stop();
     _vframeBuf = nullptr;
     _hicolBuf = nullptr;
     _videoFramePool = std::stack<std::unique_ptr<Bitmap>>();
     _videoFrameQueue = std::deque<std::unique_ptr<VideoFrame>>();
+    _yuvFramePool = std::stack<std::unique_ptr<YUVFrame>>();
 
     PrintStats(true);
     _statsReady = false;
@@ -272,6 +284,9 @@ std::unique_ptr<Common::Bitmap> VideoPlayer::GetReadyFrame()
     if (_videoFrameQueue.front()->Timestamp() > _playbackDurationMs)
         return nullptr; // not the time yet
 
+    if (!_videoFrameQueue.front()->IsReady())
+        return nullptr; // still converting
+
 #if (VIDEO_TEST_DESYNC)
     // FIXME: this is for testing audio desync with video -- remove later
     static int skip_video_instance = 0;
@@ -420,16 +435,43 @@ void VideoPlayer::BufferVideo()
     // Try to retrieve one video frame from decoder
     const bool must_conv = (_targetSize != _frameSize || _targetDepth != _frameDepth
         || ((_flags & kVideo_AccumFrame) != 0));
-    Bitmap *usebuf = must_conv ? _vframeBuf.get() : target_frame.get();
+    Bitmap *usebuf = nullptr;
+    std::unique_ptr<YUVFrame> yuv_frame;
     float frame_ts = -1.f;
-    if (!NextVideoFrame(usebuf, frame_ts))
+    size_t decoded_frame_sz = 0u;
+    if (_yuvFrames)
     {
-        // failed to get frame, so move prepared target frame into the pool for now
-        _videoFramePool.push(std::move(target_frame));
-        return;
+        if (_yuvFramePool.empty())
+        {
+            yuv_frame.reset(new YUVFrame());
+        }
+        else
+        {
+            yuv_frame = std::move(_yuvFramePool.top());
+            _yuvFramePool.pop();
+        }
+
+        if (!NextVideoFrameYUV(*yuv_frame, frame_ts))
+        {
+            // failed to get frame, so move prepared frames into the pools for now
+            _videoFramePool.push(std::move(target_frame));
+            _yuvFramePool.push(std::move(yuv_frame));
+            return;
+        }
+        decoded_frame_sz = yuv_frame->GetDataSize();
+    }
+    else
+    {
+        usebuf = must_conv ? _vframeBuf.get() : target_frame.get();
+        if (!NextVideoFrame(usebuf, frame_ts))
+        {
+            // failed to get frame, so move prepared target frame into the pool for now
+            _videoFramePool.push(std::move(target_frame));
+            return;
+        }
+        decoded_frame_sz = usebuf->GetDataSize();
     }
 
-    const auto decoded_frame_sz = usebuf->GetDataSize();
     // Convert frame_ts to our playback speed
     frame_ts = frame_ts * _targetFrameTime / _frameTime;
 #if (VIDEO_DEBUG_VERBOSE)
@@ -439,7 +481,13 @@ void VideoPlayer::BufferVideo()
     _inputFrameCount++;
 
     // Convert frame if necessary
-    if (must_conv)
+    std::future<void> conversion;
+    if (yuv_frame)
+    {
+        // YUV frame is converted on a worker thread, while we read next ones
+        conversion = ScheduleConversion(yuv_frame.get(), target_frame.get());
+    }
+    else if (must_conv)
     {
         // Use intermediate hi-color buffer if necessary
         if (_hicolBuf)
@@ -471,7 +519,24 @@ void VideoPlayer::BufferVideo()
     _stats.BufferedVideoAccum += _videoFrameQueue.size();
 
     // Push final frame to the queue
-    _videoFrameQueue.push_back(std::make_unique<VideoFrame>(std::move(target_frame), frame_ts));
+    _videoFrameQueue.push_back(std::make_unique<VideoFrame>(std::move(target_frame), frame_ts,
+        std::move(yuv_frame), std::move(conversion)));
+}
+
+std::future<void> VideoPlayer::ScheduleConversion(const YUVFrame *src, Bitmap *dst)
+{
+    // NOTE: the frames are owned by the VideoFrame in queue, which waits
+    // for the conversion to complete before releasing them
+    auto task = std::make_shared<std::packaged_task<void()>>([this, src, dst]()
+    {
+        const auto conv_start = Clock::now();
+        YUVConvert::ToARGB(*src, dst);
+        _convTimeUs += std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now() - conv_start).count();
+    });
+    std::future<void> result = task->get_future();
+    _convThreads.Enqueue([task]() { (*task)(); });
+    return result;
 }
 
 void VideoPlayer::BufferAudio()
@@ -620,6 +685,10 @@ std::unique_ptr<VideoPlayer::VideoFrame> VideoPlayer::NextFrameFromQueue()
 
     auto frame = std::move(_videoFrameQueue.front());
     _videoFrameQueue.pop_front();
+    // Wait for the frame's conversion, and recycle its source
+    auto yuv_frame = frame->RetrieveSource();
+    if (yuv_frame)
+        _yuvFramePool.push(std::move(yuv_frame));
     _frameIndex++;
     _videoPosMs = frame->Timestamp() + _frameTime;
 
@@ -753,6 +822,7 @@ void VideoPlayer::PrintStats(bool close)
             "\n\tmax time per input video frame: %.2f ms"
             "\n\tavg time per input video frame: %.2f ms"
             "\n\ttotal time on input video frames: %llu ms"
+            "\n\ttotal time converting video frames (workers): %llu ms"
             "\n\tmax buffered video frames: %u / %u"
             "\n\tavg buffered video frames: %u"
             "\n\tvideo output frames: %u"
@@ -770,6 +840,7 @@ void VideoPlayer::PrintStats(bool close)
             _stats.VideoIn.MaxTimePerFrame,
             _stats.VideoIn.AvgTimePerFrame,
             _stats.VideoIn.TotalTime,
+            static_cast<uint64_t>(_convTimeUs.load() / 1000u),
             _stats.MaxBufferedVideo,
             _queueMax,
             _stats.BufferedVideoAccum / _stats.VideoIn.Frames,
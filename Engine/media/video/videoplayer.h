@@ -17,6 +17,12 @@
 // where active bitmap is switched each next time.
 // Renders audio frames using OpenAlSource output.
 //
+// If the decoder provides frames in YUV format, then the video frames are
+// processed in a pipeline: the decoding is done on the polling thread, while
+// the conversion to RGB and scaling to the target size is done on the worker
+// threads, so that the previous frames are converted while the next ones
+// are being decoded.
+//
 // TODO: separate Video Decoder class, would be useful e.g. for plugins.
 // TODO:
 //     - allow skip frames if late (add to settings);
@@ -31,15 +37,20 @@
 #ifndef __AGS_EE_MEDIA__VIDEOPLAYER_H
 #define __AGS_EE_MEDIA__VIDEOPLAYER_H
 
+#include <algorithm>
+#include <atomic>
 #include <deque>
+#include <future>
 #include <memory>
 #include <stack>
 #include "ac/timer.h"
 #include "gfx/bitmap.h"
 #include "media/audio/audiodefines.h"
 #include "media/audio/openalsource.h"
+#include "media/video/yuv_convert.h"
 #include "util/error.h"
 #include "util/stream.h"
+#include "util/thread_pool.h"
 #include "util/time_util.h"
 
 namespace AGS
@@ -120,6 +131,11 @@ public:
     float GetPositionMs() const { return _posMs; }
     // Gets current video frame index
     uint32_t GetFrameIndex() const { return _frameIndex; }
+    // Gets total number of frames in video, or 0 if not known
+    uint32_t GetFrameCount() const { return _frameCount; }
+    // Sets the max number of video frames buffered ahead of playback;
+    // must be called before Open
+    void  SetQueueLimit(uint32_t frames) { _queueMax = std::max(1u, frames); }
 
     void  SetSpeed(float speed);
     void  SetVolume(float volume);
@@ -148,6 +164,9 @@ protected:
     virtual bool RewindImpl() { return false; }
     // Retrieves next video frame, implementation-specific
     virtual bool NextVideoFrame(Common::Bitmap *dst, float &ts) { return false; };
+    // Retrieves next video frame in YUV 4:2:0 format, implementation-specific;
+    // used instead of NextVideoFrame if the decoder has set _yuvFrames flag
+    virtual bool NextVideoFrameYUV(YUVFrame &dst, float &ts) { return false; };
     // Retrieves next audio frame, implementation-specific
     // TODO: change return type to a proper allocated buffer
     // when we support a proper audio queue here.
@@ -178,6 +197,10 @@ protected:
     float _frameTime = 0.f;
     uint32_t _frameCount = 0; // total number of frames in video (if available)
     float _durationMs = 0.f;
+    // Tells that the decoder provides video frames in YUV format, which are
+    // retrieved with NextVideoFrameYUV; this is only supported for 32-bit
+    // target frames, and without kVideo_AccumFrame flag.
+    bool _yuvFrames = false;
 
 private:
     struct VideoFrame
@@ -185,27 +208,57 @@ private:
         VideoFrame() = default;
         VideoFrame(std::unique_ptr<Common::Bitmap> &&bmp, float ts = -1.f)
             : _bmp(std::move(bmp)), _ts(ts) {}
+        // Creates a frame which bitmap is being converted from the YUV source
+        VideoFrame(std::unique_ptr<Common::Bitmap> &&bmp, float ts,
+                   std::unique_ptr<YUVFrame> &&src, std::future<void> &&conversion)
+            : _bmp(std::move(bmp)), _ts(ts), _src(std::move(src)), _conversion(std::move(conversion)) {}
 
         const Common::Bitmap *Bitmap() const { return _bmp.get(); }
         float Timestamp() const { return _ts; }
         void SetTimestamp(float ts) { _ts = ts; }
+        // Tells if the frame's bitmap is ready to use (not being converted)
+        bool IsReady() const
+        {
+            return !_conversion.valid() ||
+                (_conversion.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+        }
+        // Waits until the frame's bitmap is ready to use
+        void Wait()
+        {
+            if (_conversion.valid())
+                _conversion.get();
+        }
 
         std::unique_ptr<Common::Bitmap> Retrieve()
         {
             return std::move(_bmp);
         }
+        // Retrieves the source frame, after conversion is complete
+        std::unique_ptr<YUVFrame> RetrieveSource()
+        {
+            Wait();
+            return std::move(_src);
+        }
 
     private:
         std::unique_ptr<Common::Bitmap> _bmp;
         float _ts = -1.f; // negative means undefined
+        std::unique_ptr<YUVFrame> _src;
+        std::future<void> _conversion;
     };
 
+    // Max number of threads for converting YUV frames
+    static const size_t MaxConvertThreads = 2u;
+
     // Rewind the stream to start and reset playback pos
     bool Rewind();
     // Resume after pause
     void ResumeImpl();
     // Read and queue video frames
     void BufferVideo();
+    // Schedules conversion of the YUV frame into the target bitmap
+    // on a worker thread
+    std::future<void> ScheduleConversion(const YUVFrame *src, Common::Bitmap *dst);
     // Read and queue audio frames
     void BufferAudio();
     // Update statistic records
@@ -284,6 +337,9 @@ private:
     // Buffered frame queue and pool
     std::stack<std::unique_ptr<Common::Bitmap>> _videoFramePool;
     std::deque<std::unique_ptr<VideoFrame>> _videoFrameQueue;
+    // Pool of YUV frames, and the threads converting them to the target frames
+    std::stack<std::unique_ptr<YUVFrame>> _yuvFramePool;
+    ThreadPool _convThreads;
 
     // Statistics
     struct Statistics
@@ -324,6 +380,8 @@ private:
         float SyncMaxFw = 0.f;
         float SyncMaxBw = 0.f;
     } _stats;
+    // Time spent converting YUV frames on worker threads, in microseconds
+    std::atomic<uint64_t> _convTimeUs{0u};
 
     static const uint32_t PrintStatsEachMs = 0u;
     bool _statsReady = false;
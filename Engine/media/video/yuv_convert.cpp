@@ -0,0 +1,268 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "media/video/yuv_convert.h"
+#include <algorithm>
+#include <string.h>
+#include "gfx/image_scale.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define AGS_YUVCONVERT_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AGS_YUVCONVERT_NEON
+#include <arm_neon.h>
+#endif
+
+namespace AGS
+{
+namespace Engine
+{
+
+using namespace Common;
+
+void YUVFrame::Allocate(int width, int height)
+{
+    Width = width;
+    Height = height;
+    YPitch = width;
+    UVPitch = (width + 1) / 2;
+    Y.resize(YPitch * height);
+    U.resize(UVPitch * ((height + 1) / 2));
+    V.resize(UVPitch * ((height + 1) / 2));
+}
+
+namespace YUVConvert
+{
+
+// BT.601 coefficients, in fixed point with 6 fractional bits:
+//  R = 1.164 * (Y - 16)                     + 1.596 * (V - 128)
+//  G = 1.164 * (Y - 16) - 0.391 * (U - 128) - 0.813 * (V - 128)
+//  B = 1.164 * (Y - 16) + 2.018 * (U - 128)
+// With these all the intermediate values fit into 16-bit integers, except
+// for the largest blue values, which saturate in SIMD, and are clamped to
+// 255 in the end either way; so SIMD and scalar code give the same results.
+static const int YMul = 75;
+static const int VtoR = 102;
+static const int UtoG = 25;
+static const int VtoG = 52;
+static const int UtoB = 129;
+static const int Round = 32;
+
+inline static uint32_t Clamp8(int v)
+{
+    return static_cast<uint32_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+inline static uint32_t PixelToARGB(int y, int u, int v)
+{
+    const int yy = (y - 16) * YMul + Round;
+    u -= 128;
+    v -= 128;
+    return 0xFF000000u
+        | (Clamp8((yy + VtoR * v) >> 6) << 16)
+        | (Clamp8((yy - UtoG * u - VtoG * v) >> 6) << 8)
+        | Clamp8((yy + UtoB * u) >> 6);
+}
+
+#if defined(AGS_YUVCONVERT_SSE2)
+// Converts 8 pixels, given as 16-bit Y, U, V values, and stores them as ARGB
+inline static void Convert8(const __m128i y, const __m128i u, const __m128i v, uint32_t *dst)
+{
+    const __m128i yy = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(y, _mm_set1_epi16(16)),
+        _mm_set1_epi16(YMul)), _mm_set1_epi16(Round));
+    const __m128i uu = _mm_sub_epi16(u, _mm_set1_epi16(128));
+    const __m128i vv = _mm_sub_epi16(v, _mm_set1_epi16(128));
+    const __m128i r = _mm_srai_epi16(_mm_adds_epi16(yy, _mm_mullo_epi16(vv, _mm_set1_epi16(VtoR))), 6);
+    const __m128i g = _mm_srai_epi16(_mm_subs_epi16(_mm_subs_epi16(yy,
+        _mm_mullo_epi16(uu, _mm_set1_epi16(UtoG))), _mm_mullo_epi16(vv, _mm_set1_epi16(VtoG))), 6);
+    const __m128i b = _mm_srai_epi16(_mm_adds_epi16(yy, _mm_mullo_epi16(uu, _mm_set1_epi16(UtoB))), 6);
+    // pack to bytes, and interleave into B, G, R, A memory order
+    const __m128i bg = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), _mm_packus_epi16(g, g));
+    const __m128i ra = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), _mm_set1_epi8(static_cast<char>(0xFF)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4), _mm_unpackhi_epi16(bg, ra));
+}
+
+// Converts a row of pixels, where each pixel has its own U and V values
+static void ConvertRow(const uint8_t *ys, const uint8_t *us, const uint8_t *vs, uint32_t *dst, int count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        Convert8(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(ys + i)), zero),
+                 _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(us + i)), zero),
+                 _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(vs + i)), zero),
+                 dst + i);
+    }
+    for (; i < count; ++i)
+        dst[i] = PixelToARGB(ys[i], us[i], vs[i]);
+}
+
+// Converts a row of pixels, where U and V values are shared by each 2 pixels
+static void ConvertRow420(const uint8_t *ys, const uint8_t *us, const uint8_t *vs, uint32_t *dst, int count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ys + i));
+        __m128i u = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(us + i / 2));
+        __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(vs + i / 2));
+        u = _mm_unpacklo_epi8(u, u); // duplicate each chroma value
+        v = _mm_unpacklo_epi8(v, v);
+        Convert8(_mm_unpacklo_epi8(y, zero), _mm_unpacklo_epi8(u, zero), _mm_unpacklo_epi8(v, zero), dst + i);
+        Convert8(_mm_unpackhi_epi8(y, zero), _mm_unpackhi_epi8(u, zero), _mm_unpackhi_epi8(v, zero), dst + i + 8);
+    }
+    for (; i < count; ++i)
+        dst[i] = PixelToARGB(ys[i], us[i / 2], vs[i / 2]);
+}
+#elif defined(AGS_YUVCONVERT_NEON)
+inline static void Convert8(const int16x8_t y, const int16x8_t u, const int16x8_t v, uint32_t *dst)
+{
+    const int16x8_t yy = vaddq_s16(vmulq_n_s16(vsubq_s16(y, vdupq_n_s16(16)), YMul), vdupq_n_s16(Round));
+    const int16x8_t uu = vsubq_s16(u, vdupq_n_s16(128));
+    const int16x8_t vv = vsubq_s16(v, vdupq_n_s16(128));
+    uint8x8x4_t px;
+    px.val[0] = vqmovun_s16(vshrq_n_s16(vqaddq_s16(yy, vmulq_n_s16(uu, UtoB)), 6));
+    px.val[1] = vqmovun_s16(vshrq_n_s16(vqsubq_s16(vqsubq_s16(yy, vmulq_n_s16(uu, UtoG)), vmulq_n_s16(vv, VtoG)), 6));
+    px.val[2] = vqmovun_s16(vshrq_n_s16(vqaddq_s16(yy, vmulq_n_s16(vv, VtoR)), 6));
+    px.val[3] = vdup_n_u8(0xFF);
+    vst4_u8(reinterpret_cast<uint8_t*>(dst), px);
+}
+
+inline static int16x8_t Widen(const uint8x8_t v)
+{
+    return vreinterpretq_s16_u16(vmovl_u8(v));
+}
+
+static void ConvertRow(const uint8_t *ys, const uint8_t *us, const uint8_t *vs, uint32_t *dst, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+        Convert8(Widen(vld1_u8(ys + i)), Widen(vld1_u8(us + i)), Widen(vld1_u8(vs + i)), dst + i);
+    for (; i < count; ++i)
+        dst[i] = PixelToARGB(ys[i], us[i], vs[i]);
+}
+
+static void ConvertRow420(const uint8_t *ys, const uint8_t *us, const uint8_t *vs, uint32_t *dst, int count)
+{
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const uint8x16_t y = vld1q_u8(ys + i);
+        const uint8x8x2_t u = vzip_u8(vld1_u8(us + i / 2), vld1_u8(us + i / 2));
+        const uint8x8x2_t v = vzip_u8(vld1_u8(vs + i / 2), vld1_u8(vs + i / 2));
+        Convert8(Widen(vget_low_u8(y)), Widen(u.val[0]), Widen(v.val[0]), dst + i);
+        Convert8(Widen(vget_high_u8(y)), Widen(u.val[1]), Widen(v.val[1]), dst + i + 8);
+    }
+    for (; i < count; ++i)
+        dst[i] = PixelToARGB(ys[i], us[i / 2], vs[i / 2]);
+}
+#else
+static void ConvertRow(const uint8_t *ys, const uint8_t *us, const uint8_t *vs, uint32_t *dst, int count)
+{
+    for (int i = 0; i < count; ++i)
+        dst[i] = PixelToARGB(ys[i], us[i], vs[i]);
+}
+
+static void ConvertRow420(const uint8_t *ys, const uint8_t *us, const uint8_t *vs, uint32_t *dst, int count)
+{
+    for (int i = 0; i < count; ++i)
+        dst[i] = PixelToARGB(ys[i], us[i / 2], vs[i / 2]);
+}
+#endif
+
+void ToARGB(const YUVFrame &src, Bitmap *dst)
+{
+    ToARGB(src, dst, 0, dst->GetHeight());
+}
+
+void ToARGB(const YUVFrame &src, Bitmap *dst, int dst_y1, int dst_y2)
+{
+    assert(dst->GetColorDepth() == 32);
+    const int dw = dst->GetWidth();
+    const int dh = dst->GetHeight();
+    dst_y1 = std::max(0, dst_y1);
+    dst_y2 = std::min(dh, dst_y2);
+    if ((src.Width <= 0) || (src.Height <= 0) || (dw <= 0) || (dst_y1 >= dst_y2))
+        return;
+
+    std::vector<int> ys;
+    ImageScale::CalcNearestSteps(0, src.Height, 0, dh, dst_y1, dst_y2, ys);
+    // When enlarging, convert each source row at its native width, and then
+    // pick the converted pixels; when shrinking, pick the source pixels
+    // first, and convert only those which are used.
+    const bool stretch_x = (dw != src.Width);
+    const bool enlarge_x = (dw > src.Width);
+    std::vector<int> xs;
+    std::vector<uint32_t> row_argb;
+    std::vector<uint8_t> row_y, row_u, row_v;
+    if (stretch_x)
+        ImageScale::CalcNearestSteps(0, src.Width, 0, dw, 0, dw, xs);
+    if (enlarge_x)
+    {
+        row_argb.resize(src.Width);
+    }
+    else if (stretch_x)
+    {
+        row_y.resize(dw);
+        row_u.resize(dw);
+        row_v.resize(dw);
+    }
+
+    int last_sy = -1;
+    for (int y = dst_y1; y < dst_y2; ++y)
+    {
+        uint32_t *dst_row = reinterpret_cast<uint32_t*>(dst->GetScanLineForWriting(y));
+        const int sy = ys[y - dst_y1];
+        if (sy == last_sy)
+        {
+            // enlarged image repeats the previous row
+            memcpy(dst_row, dst->GetScanLine(y - 1), dw * sizeof(uint32_t));
+            continue;
+        }
+        last_sy = sy;
+
+        const uint8_t *src_y = &src.Y[sy * src.YPitch];
+        const uint8_t *src_u = &src.U[(sy / 2) * src.UVPitch];
+        const uint8_t *src_v = &src.V[(sy / 2) * src.UVPitch];
+        if (enlarge_x)
+        {
+            ConvertRow420(src_y, src_u, src_v, row_argb.data(), src.Width);
+            for (int x = 0; x < dw; ++x)
+                dst_row[x] = row_argb[xs[x]];
+        }
+        else if (stretch_x)
+        {
+            for (int x = 0; x < dw; ++x)
+            {
+                const int sx = xs[x];
+                row_y[x] = src_y[sx];
+                row_u[x] = src_u[sx / 2];
+                row_v[x] = src_v[sx / 2];
+            }
+            ConvertRow(row_y.data(), row_u.data(), row_v.data(), dst_row, dw);
+        }
+        else
+        {
+            ConvertRow420(src_y, src_u, src_v, dst_row, dw);
+        }
+    }
+}
+
+} // namespace YUVConvert
+
+} // namespace Engine
+} // namespace AGS
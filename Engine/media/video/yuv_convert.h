@@ -0,0 +1,70 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Conversion of the decoded YUV video frames to the 32-bit ARGB bitmaps.
+//
+// The conversion is fused with the "nearest neighbour" scaling: each row of
+// the destination bitmap is converted right from the corresponding source
+// pixels, so that the video frame does not have to be converted at its
+// native size first, and stretched after. The result is exactly the same as
+// of StretchBlt of the converted frame. Uses SIMD (SSE2 or NEON) where
+// available.
+//
+// The color conversion follows ITU-R BT.601 with "studio" range, same as
+// the APEG's own converter.
+//
+//=============================================================================
+#ifndef __AGS_EE_MEDIA__YUVCONVERT_H
+#define __AGS_EE_MEDIA__YUVCONVERT_H
+
+#include <vector>
+#include "core/types.h"
+#include "gfx/bitmap.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+// A video frame in planar YUV 4:2:0 format: full resolution luma plane,
+// and two chroma planes, subsampled by 2 in both directions
+struct YUVFrame
+{
+    int Width = 0; // image size, in pixels
+    int Height = 0;
+    int YPitch = 0; // lengths of plane rows, in bytes
+    int UVPitch = 0;
+    std::vector<uint8_t> Y;
+    std::vector<uint8_t> U;
+    std::vector<uint8_t> V;
+
+    // Sets image size, and allocates the planes with the tightly packed rows
+    void Allocate(int width, int height);
+    // Gets the total size of the planes, in bytes
+    size_t GetDataSize() const { return Y.size() + U.size() + V.size(); }
+};
+
+namespace YUVConvert
+{
+    // Converts YUV 4:2:0 frame to ARGB, scaling it over the whole destination
+    // bitmap; the destination must be a 32-bit bitmap
+    void ToARGB(const YUVFrame &src, Common::Bitmap *dst);
+    // Converts only a range of the destination rows [dst_y1, dst_y2)
+    void ToARGB(const YUVFrame &src, Common::Bitmap *dst, int dst_y1, int dst_y2);
+} // namespace YUVConvert
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_MEDIA__YUVCONVERT_H
@@ -36,6 +36,7 @@
 #include "ac/string.h"
 #include "ac/sys_events.h"
 #include "ac/view.h"
+#include "ac/walkablearea.h"
 #include "ac/dynobj/dynobj_manager.h"
 #include "ac/dynobj/cc_dynamicarray.h"
 #include "ac/dynobj/scriptstring.h"
@@ -453,7 +454,11 @@ BITMAP *IAGSEngine::GetSpriteGraphic (int32 num) {
 }
 BITMAP *IAGSEngine::GetRoomMask (int32 index) {
     if (index == MASK_WALKABLE)
+    {
+        // plugin may modify the mask, so have the pathfinding mask redone
+        invalidate_walkable_areas();
         return (BITMAP*)thisroom.WalkAreaMask->GetAllegroBitmap();
+    }
     else if (index == MASK_WALKBEHIND)
         return (BITMAP*)thisroom.WalkBehindMask->GetAllegroBitmap();
     else if (index == MASK_HOTSPOT)
@@ -52,6 +52,7 @@ extern void RegisterSpeechAPI(ScriptAPIVersion base_api, ScriptAPIVersion compat
 extern void RegisterStringAPI();
 extern void RegisterSystemAPI();
 extern void RegisterTextBoxAPI();
+extern void RegisterVideoAPI();
 extern void RegisterViewFrameAPI();
 extern void RegisterViewportAPI();
 extern void RegisterSaveInfoAPI();
@@ -94,6 +95,7 @@ void setup_script_exports(ScriptAPIVersion base_api, ScriptAPIVersion compat_api
     RegisterStringAPI();
     RegisterSystemAPI();
     RegisterTextBoxAPI();
+    RegisterVideoAPI();
     RegisterViewFrameAPI();
     RegisterViewportAPI();
     RegisterSaveInfoAPI();
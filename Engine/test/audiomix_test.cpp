@@ -0,0 +1,127 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include "gtest/gtest.h"
+#include "media/audio/loopbackoutput.h"
+
+using namespace AGS::Engine;
+
+static const int MixFreq = 44100;
+
+// Renders OpenAL mix without a sound device, keeps its context current
+class TestMixer
+{
+public:
+    TestMixer()
+    {
+        _output.Open(MixFreq, "");
+        alcMakeContextCurrent(_output.GetContext());
+    }
+
+    ~TestMixer()
+    {
+        if (!_sources.empty())
+        {
+            alSourceStopv(static_cast<ALsizei>(_sources.size()), _sources.data());
+            alDeleteSources(static_cast<ALsizei>(_sources.size()), _sources.data());
+        }
+        if (!_buffers.empty())
+            alDeleteBuffers(static_cast<ALsizei>(_buffers.size()), _buffers.data());
+        alcMakeContextCurrent(nullptr);
+        alcDestroyContext(_output.GetContext());
+        alcCloseDevice(_output.GetDevice());
+    }
+
+    LoopbackOutput &Output() { return _output; }
+    const std::vector<ALuint> &Sources() const { return _sources; }
+
+    // Adds a looping source, playing one second of float samples made by
+    // the given function of the frame index and channel
+    template <typename TSampleFn>
+    ALuint AddSource(int channels, int freq, TSampleFn sample_fn)
+    {
+        std::vector<float> data(freq * channels);
+        for (int i = 0; i < freq; ++i)
+            for (int ch = 0; ch < channels; ++ch)
+                data[i * channels + ch] = sample_fn(i, ch);
+        ALuint buf, src;
+        alGenBuffers(1, &buf);
+        alBufferData(buf, alGetEnumValue(channels == 1 ? "AL_FORMAT_MONO_FLOAT32" : "AL_FORMAT_STEREO_FLOAT32"),
+            data.data(), static_cast<ALsizei>(data.size() * sizeof(float)), freq);
+        alGenSources(1, &src);
+        alSourcei(src, AL_BUFFER, buf);
+        alSourcei(src, AL_LOOPING, AL_TRUE);
+        alSourcePlay(src);
+        _buffers.push_back(buf);
+        _sources.push_back(src);
+        return src;
+    }
+
+private:
+    LoopbackOutput _output;
+    std::vector<ALuint> _buffers;
+    std::vector<ALuint> _sources;
+};
+
+TEST(AudioMix, SumAndGainRamp) {
+    TestMixer mixer;
+    for (int i = 0; i < 4; ++i)
+        mixer.AddSource(2, MixFreq, [](int, int) { return 0.125f; });
+    // sources are summed right from the start
+    mixer.Output().Render();
+    const float *block = mixer.Output().GetBlock();
+    for (int i = 0; i < LoopbackOutput::BlockFrames * 2; ++i)
+        ASSERT_NEAR(block[i], 0.5f, 0.0001f);
+
+    // changing the gain fades to the new level, instead of a sudden jump
+    for (ALuint src : mixer.Sources())
+        alSourcef(src, AL_GAIN, 0.5f);
+    mixer.Output().Render();
+    block = mixer.Output().GetBlock();
+    for (int i = 2; i < LoopbackOutput::BlockFrames * 2; ++i)
+        ASSERT_LE(block[i], block[i - 2] + 0.0001f);
+    ASSERT_NEAR(block[LoopbackOutput::BlockFrames * 2 - 1], 0.25f, 0.0001f);
+}
+
+// Measures mixing many simultaneous sources, a mix of mono and stereo,
+// some at the output frequency and some requiring resampling,
+// with the gains of a quarter of them changing on every block
+TEST(AudioMix, DISABLED_Benchmark) {
+    const int blocks = 10 * MixFreq / LoopbackOutput::BlockFrames; // ~10 seconds
+    for (int count : { 32, 64 })
+    {
+        TestMixer mixer;
+        for (int i = 0; i < count; ++i)
+        {
+            const float freq_hz = 220.f + 20.f * i;
+            const int rate = (i % 4 < 2) ? MixFreq : 22050;
+            mixer.AddSource(1 + i % 2, rate, [freq_hz, rate](int f, int ch)
+                { return 0.02f * std::sin(6.2831853f * freq_hz * (f + ch) / rate); });
+        }
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (int b = 0; b < blocks; ++b)
+        {
+            for (size_t i = b % 4; i < mixer.Sources().size(); i += 4)
+                alSourcef(mixer.Sources()[i], AL_GAIN, (b % 2) ? 0.5f : 1.f);
+            mixer.Output().Render();
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        const double total_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        printf("%2d sources: %8.2f ms to mix %.0f ms of sound (%.2f%% of real time)\n",
+            count, total_ms, mixer.Output().GetRenderedMs(),
+            total_ms * 100.0 / mixer.Output().GetRenderedMs());
+    }
+}
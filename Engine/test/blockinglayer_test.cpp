@@ -0,0 +1,107 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "ac/blocking_layer.h"
+#include "gfx/bitmap.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+// Composes the reference mask, the way it was done before the blocking layer
+static void ComposeFull(const Bitmap *base, Bitmap *result, const std::vector<Rect> &blockers)
+{
+    result->Blit(base, 0, 0, 0, 0, base->GetWidth(), base->GetHeight());
+    for (const auto &r : blockers)
+        for (int y = r.Top; y <= r.Bottom; ++y)
+            for (int x = r.Left; x <= r.Right; ++x)
+                result->PutPixel(x, y, 0);
+}
+
+static std::vector<Rect> RandomRects(int count, int w, int h)
+{
+    std::vector<Rect> rects;
+    for (int i = 0; i < count; ++i)
+    {
+        const int x = rand() % (w + 10) - 5, y = rand() % (h + 10) - 5;
+        rects.push_back(RectWH(x, y, rand() % 12, rand() % 12));
+    }
+    return rects;
+}
+
+TEST(BlockingLayer, Update) {
+    const int w = 61, h = 47;
+    Bitmap base(w, h, 8), result(w, h, 8), expect(w, h, 8);
+    srand(1);
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x)
+            base.PutPixel(x, y, rand() % 4);
+
+    BlockingLayer layer;
+    std::vector<Rect> rects = RandomRects(6, w, h);
+    for (int step = 0; step < 50; ++step)
+    {
+        // move some of the blockers, add or remove others
+        if (step > 0)
+        {
+            for (auto &r : rects)
+                if (rand() % 3 == 0)
+                    r = Rect::MoveBy(r, rand() % 5 - 2, rand() % 5 - 2);
+            if (rand() % 4 == 0)
+                rects.pop_back();
+            if (rand() % 4 == 0)
+                rects.push_back(RandomRects(1, w, h)[0]);
+        }
+        if (step == 20)
+        { // modify the base, and tell about it
+            base.PutPixel(3, 3, 9);
+            layer.Invalidate();
+        }
+
+        const MaskRowStamps old_stamps = layer.GetRowStamps();
+        std::vector<uint32_t> old_rows(h, 0u);
+        if (old_stamps.Rows)
+            old_rows.assign(old_stamps.Rows, old_stamps.Rows + h);
+
+        layer.Update(&base, &result, rects);
+        ComposeFull(&base, &expect, rects);
+        for (int y = 0; y < h; ++y)
+            ASSERT_EQ(memcmp(result.GetScanLine(y), expect.GetScanLine(y), w), 0);
+
+        // only the redrawn rows must have their stamps updated
+        const MaskRowStamps stamps = layer.GetRowStamps();
+        ASSERT_NE(stamps.Rows, nullptr);
+        int changed_rows = 0;
+        for (int y = 0; y < h; ++y)
+        {
+            if (stamps.Rows[y] != old_rows[y])
+            {
+                ASSERT_EQ(stamps.Rows[y], stamps.Version);
+                changed_rows++;
+            }
+        }
+        ASSERT_EQ(changed_rows, layer.GetLastUpdatedRows());
+        if ((step == 0) || (step == 20))
+            ASSERT_EQ(changed_rows, h);
+    }
+
+    // same set of blockers in a different order must not redraw anything
+    std::vector<Rect> reversed(rects.rbegin(), rects.rend());
+    const uint32_t version = layer.GetRowStamps().Version;
+    layer.Update(&base, &result, reversed);
+    ASSERT_EQ(layer.GetLastUpdatedRows(), 0);
+    ASSERT_EQ(layer.GetRowStamps().Version, version);
+}
@@ -0,0 +1,283 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "ac/character.h"
+#include "ac/character_update.h"
+#include "ac/characterextras.h"
+#include "ac/characterinfo.h"
+#include "ac/gamestate.h"
+#include "ac/global_game.h"
+#include "ac/view.h"
+#include "main/game_run.h"
+
+using namespace AGS::Engine;
+
+extern std::vector<ViewStruct> views;
+extern int displayed_room;
+
+// Makes views with a varied number of loops and frames; loop 5 is empty
+static void MakeViews(std::vector<ViewStruct> &v)
+{
+    v.resize(4);
+    for (size_t i = 0; i < v.size(); ++i)
+    {
+        v[i].Initialize(8);
+        for (int l = 0; l < 8; ++l)
+        {
+            v[i].loops[l].Initialize((l == 5) ? 0 : 2 + (l + static_cast<int>(i)) % 6);
+            for (auto &frame : v[i].loops[l].frames)
+                frame.speed = rand() % 4;
+        }
+    }
+}
+
+// Makes characters which stand, animate, walk or turn around, spread over
+// the rooms; the walk and idle delays are long enough to not run out
+// during the given number of frames
+static void MakeCharacters(std::vector<CharacterInfo> &chars, std::vector<CharacterExtras> &chex,
+    int count, int rooms, int frames)
+{
+    chars.resize(count);
+    chex.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        CharacterInfo &chi = chars[i];
+        chi.index_id = i;
+        chi.on = (rand() % 10 != 0) ? 1 : 0;
+        chi.room = rand() % rooms;
+        chi.view = rand() % 4;
+        chi.loop = rand() % 5;
+        chi.idleview = (rand() % 2) ? 2 : 0;
+        chi.idletime = 20;
+        chi.idleleft = frames;
+        chex[i].following = -1;
+        switch (rand() % 4)
+        {
+        case 0:
+            chi.set_animating(true, (rand() % 2) != 0, rand() % 3);
+            chi.wait = rand() % 5;
+            break;
+        case 1:
+            chi.walking = 1 + rand() % 9;
+            chi.walkwait = frames + 1 + rand() % 5;
+            chex[i].animwait = frames + 1 + rand() % 5;
+            break;
+        case 2:
+            chi.walking = TURNING_AROUND;
+            chi.walkwait = rand() % 3;
+            chi.animspeed = rand() % 3;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+static void UpdateOneByOne(std::vector<CharacterInfo> &chars, std::vector<CharacterExtras> &chex)
+{
+    std::vector<int> following_as_sheep;
+    for (size_t i = 0; i < chars.size(); ++i)
+        UpdateCharacterMoveAndAnim(&chars[i], &chex[i], following_as_sheep);
+}
+
+// Returns the number of characters which were given the full update
+static size_t UpdateWithState(CharacterUpdateState &state,
+    std::vector<CharacterInfo> &chars, std::vector<CharacterExtras> &chex)
+{
+    size_t full_updates = 0;
+    std::vector<int> following_as_sheep;
+    const bool idle_tick = (get_loop_counter() % GetGameSpeed()) == 0;
+    const int total = static_cast<int>(chars.size());
+    for (int first = 0; first < total; first += CharacterUpdateState::BlockSize)
+    {
+        state.SyncFrom(chars.data(), chex.data(), first, std::min(total - first, CharacterUpdateState::BlockSize));
+        state.Update(displayed_room, idle_tick, views);
+        state.SyncTo(chars.data(), chex.data());
+        for (int i : state.GetFullUpdate())
+            UpdateCharacterMoveAndAnim(&chars[i], &chex[i], following_as_sheep);
+        full_updates += state.GetFullUpdate().size();
+    }
+    return full_updates;
+}
+
+static void AssertSameCharacters(const std::vector<CharacterInfo> &chars1, const std::vector<CharacterExtras> &chex1,
+    const std::vector<CharacterInfo> &chars2, const std::vector<CharacterExtras> &chex2)
+{
+    for (size_t i = 0; i < chars1.size(); ++i)
+    {
+        const CharacterInfo &a = chars1[i], &b = chars2[i];
+        ASSERT_EQ(a.room, b.room);
+        ASSERT_EQ(a.x, b.x);
+        ASSERT_EQ(a.y, b.y);
+        ASSERT_EQ(a.view, b.view);
+        ASSERT_EQ(a.loop, b.loop);
+        ASSERT_EQ(a.frame, b.frame);
+        ASSERT_EQ(a.wait, b.wait);
+        ASSERT_EQ(a.walkwait, b.walkwait);
+        ASSERT_EQ(a.walking, b.walking);
+        ASSERT_EQ(a.animating, b.animating);
+        ASSERT_EQ(a.idleleft, b.idleleft);
+        ASSERT_EQ(a.flags, b.flags);
+        ASSERT_EQ(chex1[i].animwait, chex2[i].animwait);
+        ASSERT_EQ(chex1[i].process_idle_this_time, chex2[i].process_idle_this_time);
+    }
+}
+
+TEST(CharacterUpdate, Timers) {
+    std::vector<ViewStruct> test_views;
+    MakeViews(test_views);
+    std::vector<CharacterInfo> chars(3);
+    std::vector<CharacterExtras> chex(3);
+    for (int i = 0; i < 3; ++i)
+    {
+        chars[i].on = 1;
+        chars[i].room = 1;
+        chars[i].idleview = 2;
+        chars[i].idletime = 20;
+        chars[i].idleleft = 1;
+    }
+    // animating, walking, and standing still
+    chars[0].set_animating(true, true, 0);
+    chars[0].wait = 1;
+    chars[1].walking = 1;
+    chars[1].walkwait = 2;
+    chex[1].animwait = 1;
+    chex[2].process_idle_this_time = 1;
+
+    CharacterUpdateState state;
+    state.SyncFrom(chars.data(), chex.data(), 0, 3);
+    state.Update(1, false, test_views);
+    state.SyncTo(chars.data(), chex.data());
+    ASSERT_EQ(state.GetFullUpdate().size(), 0u);
+    ASSERT_EQ(chars[0].wait, 0);
+    ASSERT_EQ(chars[0].idleleft, 20); // doing something resets the idle timer
+    ASSERT_EQ(chars[1].walkwait, 1);
+    ASSERT_EQ(chex[1].animwait, 0);
+    ASSERT_EQ(chars[1].idleleft, 20);
+    ASSERT_EQ(chars[2].idleleft, 0); // pending idle update counts down
+    ASSERT_EQ(chex[2].process_idle_this_time, 0);
+
+    // the delays ran out, so the next frames have to be made by the full update
+    state.SyncFrom(chars.data(), chex.data(), 0, 3);
+    state.Update(1, true, test_views);
+    ASSERT_EQ(state.GetFullUpdate(), std::vector<int>({ 0, 1, 2 }));
+}
+
+TEST(CharacterUpdate, OffRoomLoopFixup) {
+    std::vector<ViewStruct> test_views;
+    MakeViews(test_views);
+    std::vector<CharacterInfo> chars(2);
+    std::vector<CharacterExtras> chex(2);
+    for (auto &chi : chars)
+    {
+        chi.on = 1;
+        chi.room = 2;
+        chi.loop = 1;
+    }
+
+    CharacterUpdateState state;
+    state.SyncFrom(chars.data(), chex.data(), 0, 2);
+    state.Update(1, false, test_views);
+    // characters outside of the room are skipped
+    ASSERT_EQ(state.GetFullUpdate().size(), 0u);
+
+    // but when script assigns an empty loop, or a frame out of range,
+    // they are given the full update, which fixes the loop and frame
+    chars[0].loop = 5;
+    chars[1].frame = 100;
+    state.SyncFrom(chars.data(), chex.data(), 0, 2);
+    state.Update(1, false, test_views);
+    ASSERT_EQ(state.GetFullUpdate(), std::vector<int>({ 0, 1 }));
+    chars[0].loop = 0;
+    chars[1].frame = 0;
+    state.SyncFrom(chars.data(), chex.data(), 0, 2);
+    state.Update(1, false, test_views);
+    ASSERT_EQ(state.GetFullUpdate().size(), 0u);
+}
+
+// Runs the characters both through the state and one by one, and tests
+// that the results match; the script changes loops of some characters
+// outside of the room midway
+TEST(CharacterUpdate, MatchesUpdateOneByOne) {
+    srand(35);
+    const int frames = 200;
+    MakeViews(views);
+    mls.resize(10);
+    std::vector<CharacterInfo> chars1, chars2;
+    std::vector<CharacterExtras> chex1, chex2;
+    MakeCharacters(chars1, chex1, 500, 3, frames);
+    chars2 = chars1;
+    chex2 = chex1;
+    charextra = chex1; // followers look up their settings there
+    displayed_room = 1;
+
+    CharacterUpdateState state;
+    for (int f = 0; f < frames; ++f)
+    {
+        if (f == frames / 2)
+        {
+            for (size_t i = 0; i < chars1.size(); i += 7)
+            {
+                if (chars1[i].room != displayed_room)
+                    chars1[i].loop = chars2[i].loop = 5;
+            }
+        }
+        UpdateOneByOne(chars1, chex1);
+        UpdateWithState(state, chars2, chex2);
+        AssertSameCharacters(chars1, chex1, chars2, chex2);
+        increment_loop_counter();
+    }
+}
+
+// Measures the character update with thousands of characters, either all in
+// the displayed room, or spread over many rooms, comparing updating them one
+// by one with updating through the state
+TEST(CharacterUpdate, DISABLED_Benchmark) {
+    srand(36);
+    const int frames = 1000;
+    MakeViews(views);
+    mls.resize(10);
+    displayed_room = 0;
+    for (int rooms : { 1, 100 })
+    {
+        for (int count : { 1000, 5000, 20000 })
+        {
+            std::vector<CharacterInfo> chars1, chars2;
+            std::vector<CharacterExtras> chex1, chex2;
+            MakeCharacters(chars1, chex1, count, rooms, frames);
+            chars2 = chars1;
+            chex2 = chex1;
+            charextra = chex1;
+
+            const auto t0 = std::chrono::high_resolution_clock::now();
+            for (int f = 0; f < frames; ++f)
+                UpdateOneByOne(chars1, chex1);
+            const auto t1 = std::chrono::high_resolution_clock::now();
+            CharacterUpdateState state;
+            size_t full_updates = 0;
+            for (int f = 0; f < frames; ++f)
+                full_updates += UpdateWithState(state, chars2, chex2);
+            const auto t2 = std::chrono::high_resolution_clock::now();
+            const double us1 = std::chrono::duration<double, std::micro>(t1 - t0).count() / frames;
+            const double us2 = std::chrono::duration<double, std::micro>(t2 - t1).count() / frames;
+            printf("%6d characters in %3d rooms: one by one %8.2f us, state %8.2f us per frame, %6.1f full updates per frame\n",
+                count, rooms, us1, us2, static_cast<double>(full_updates) / frames);
+        }
+    }
+}
@@ -0,0 +1,94 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gtest/gtest.h"
+#include "media/audio/decodeahead.h"
+
+using namespace AGS::Engine;
+
+// Makes a decoded 16-bit stereo sound of the given length,
+// where each sample frame contains its own index
+static std::shared_ptr<DecodedSound> MakeSound(size_t frames)
+{
+    auto pcm = std::make_shared<DecodedSound>();
+    pcm->Format.format = AUDIO_S16SYS;
+    pcm->Format.channels = 2;
+    pcm->Format.rate = 44100;
+    pcm->Data.resize(frames * 4);
+    for (size_t i = 0; i < frames; ++i)
+        reinterpret_cast<uint32_t*>(pcm->Data.data())[i] = static_cast<uint32_t>(i);
+    pcm->DurationMs = SoundHelper::MillisecondsFromBytes(pcm->Data.size(), AUDIO_S16SYS, 2, 44100);
+    return pcm;
+}
+
+static std::shared_ptr<DecodeAheadStream> MakeStream(std::shared_ptr<DecodedSound> pcm, bool repeat)
+{
+    std::unique_ptr<SDLDecoder> decoder(new SDLDecoder(pcm, repeat));
+    EXPECT_TRUE(decoder->Open());
+    return std::make_shared<DecodeAheadStream>(std::move(decoder), 3, nullptr);
+}
+
+// Reads all the chunks from stream, tests that they come in order,
+// returns the number of read sample frames
+static size_t ReadStream(DecodeAheadStream &stream, uint32_t first_frame)
+{
+    uint32_t next_frame = first_frame;
+    stream.Request();
+    while (!stream.EOS())
+    {
+        const SoundBuffer *chunk = stream.PeekData();
+        EXPECT_NE(chunk, nullptr);
+        if (!chunk)
+            break;
+        const uint32_t *frames = static_cast<const uint32_t*>(chunk->Data());
+        for (size_t i = 0; i < chunk->Size() / 4; ++i, ++next_frame)
+            EXPECT_EQ(frames[i], next_frame);
+        stream.PopData();
+    }
+    return next_frame - first_frame;
+}
+
+TEST(DecodeAhead, ReadAll) {
+    const size_t frames = 100000; // several chunks
+    auto stream = MakeStream(MakeSound(frames), false);
+    ASSERT_EQ(stream->GetFreq(), 44100);
+    ASSERT_EQ(stream->GetChannels(), 2);
+    ASSERT_EQ(ReadStream(*stream, 0), frames);
+    ASSERT_TRUE(stream->EOS());
+}
+
+TEST(DecodeAhead, Seek) {
+    const size_t frames = 100000;
+    auto stream = MakeStream(MakeSound(frames), false);
+    stream->Request();
+    ASSERT_NE(stream->PeekData(), nullptr);
+    // seeking drops all the chunks decoded ahead
+    const float pos_ms = stream->Seek(1000.f);
+    ASSERT_FLOAT_EQ(pos_ms, 1000.f);
+    ASSERT_EQ(stream->PeekData(), nullptr);
+    ASSERT_EQ(ReadStream(*stream, 44100), frames - 44100);
+    // seeking after the end restarts the stream
+    ASSERT_TRUE(stream->EOS());
+    stream->Seek(0.f);
+    ASSERT_FALSE(stream->EOS());
+    ASSERT_EQ(ReadStream(*stream, 0), frames);
+}
+
+TEST(DecodeAhead, QueueLength) {
+    DecodeAheadPool pool;
+    pool.Start(0, 1000.f, nullptr);
+    // chunk of 16-bit stereo 44100 Hz is ~370 ms
+    ASSERT_EQ(pool.GetQueueLength(AUDIO_S16SYS, 2, 44100), 3u);
+    // but there are at least two chunks at any rate
+    ASSERT_EQ(pool.GetQueueLength(AUDIO_S16SYS, 1, 11025), 2u);
+}
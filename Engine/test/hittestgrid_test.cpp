@@ -0,0 +1,160 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <stdlib.h>
+#include "gtest/gtest.h"
+#include "ac/hit_test_grid.h"
+#include "ac/sprite_hitmask.h"
+#include "gfx/bitmap.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+TEST(HitTestGrid, QueryMatchesBruteForce) {
+    srand(11);
+    const Size area(500, 300);
+    const int count = 60;
+    std::vector<Rect> boxes(count);
+    std::vector<bool> active(count);
+    HitTestGrid grid;
+    grid.Reset(area, 32);
+    std::vector<int> ids;
+    for (int step = 0; step < 50; ++step)
+    {
+        // move, add and remove entries; some are partially outside of the area
+        for (int id = 0; id < count; ++id)
+        {
+            if (rand() % 4 == 0)
+                continue; // keep as is
+            active[id] = (rand() % 5 != 0);
+            if (!active[id])
+            {
+                grid.Remove(id);
+                continue;
+            }
+            if (rand() % 10 == 0)
+                boxes[id] = Rect(); // unbounded
+            else
+                boxes[id] = RectWH(rand() % 600 - 50, rand() % 400 - 50, 1 + rand() % 120, 1 + rand() % 120);
+            grid.Update(id, boxes[id]);
+        }
+
+        for (int i = 0; i < 100; ++i)
+        {
+            const int x = rand() % 640 - 70, y = rand() % 440 - 70;
+            std::vector<int> expect;
+            for (int id = 0; id < count; ++id)
+                if (active[id] && (boxes[id].IsEmpty() || boxes[id].IsInside(x, y)))
+                    expect.push_back(id);
+            grid.Query(x, y, ids);
+            ASSERT_EQ(ids, expect);
+        }
+    }
+}
+
+TEST(SpriteHitMask, MatchesPixels) {
+    srand(12);
+    for (int depth : { 8, 16, 32 })
+    {
+        Bitmap bmp(37, 21, depth);
+        bmp.ClearTransparent();
+        for (int i = 0; i < 200; ++i)
+            bmp.PutPixel(rand() % bmp.GetWidth(), rand() % bmp.GetHeight(), 1 + rand() % 100);
+        SpriteHitMask mask(&bmp);
+        ASSERT_EQ(mask.GetWidth(), bmp.GetWidth());
+        ASSERT_EQ(mask.GetHeight(), bmp.GetHeight());
+        for (int y = -1; y <= bmp.GetHeight(); ++y)
+        {
+            for (int x = -1; x <= bmp.GetWidth(); ++x)
+            {
+                const bool opaque = RectWH(bmp.GetSize()).IsInside(x, y) &&
+                    (bmp.GetPixel(x, y) != static_cast<int>(bmp.GetMaskColor()));
+                ASSERT_EQ(mask.IsOpaque(x, y), opaque);
+            }
+        }
+    }
+}
+
+TEST(SpriteHitMask, Cache) {
+    Bitmap bmp1(10, 10, 8), bmp2(10, 10, 8);
+    bmp1.Clear(1);
+    bmp2.ClearTransparent();
+    SpriteHitMaskCache cache;
+    ASSERT_TRUE(cache.Get(5, &bmp1).IsOpaque(3, 3));
+    // a modified sprite keeps the old mask until invalidated
+    bmp1.ClearTransparent();
+    ASSERT_TRUE(cache.Get(5, &bmp1).IsOpaque(3, 3));
+    cache.Invalidate(5);
+    ASSERT_FALSE(cache.Get(5, &bmp1).IsOpaque(3, 3));
+    // another bitmap for the same sprite recreates the mask
+    bmp2.Clear(1);
+    ASSERT_TRUE(cache.Get(5, &bmp2).IsOpaque(3, 3));
+    ASSERT_EQ(cache.GetMemorySize(), 10u * sizeof(uint32_t));
+    cache.Clear();
+    ASSERT_EQ(cache.GetMemorySize(), 0u);
+}
+
+static void MakeRandomMask(Bitmap &bmp, int pixels)
+{
+    bmp.ClearTransparent();
+    for (int i = 0; i < pixels; ++i)
+        bmp.PutPixel(rand() % bmp.GetWidth(), rand() % bmp.GetHeight(), 1);
+}
+
+TEST(SpriteHitMask, OverlapsMatchesBruteForce) {
+    srand(13);
+    Bitmap bmp1(45, 30, 8), bmp2(70, 9, 8);
+    for (int i = 0; i < 300; ++i)
+    {
+        MakeRandomMask(bmp1, 1 + rand() % 40);
+        MakeRandomMask(bmp2, 1 + rand() % 40);
+        SpriteHitMask m1(&bmp1), m2(&bmp2);
+        const int x1 = rand() % 40 - 20, y1 = rand() % 20 - 10;
+        const int x2 = rand() % 80 - 40, y2 = rand() % 40 - 20;
+        bool expect = false;
+        for (int y = 0; y < m1.GetHeight() && !expect; ++y)
+            for (int x = 0; x < m1.GetWidth() && !expect; ++x)
+                expect = m1.IsOpaque(x, y) && m2.IsOpaque(x + x1 - x2, y + y1 - y2);
+        ASSERT_EQ(SpriteHitMask::Overlaps(m1, x1, y1, m2, x2, y2), expect);
+        ASSERT_EQ(SpriteHitMask::Overlaps(m2, x2, y2, m1, x1, y1), expect);
+    }
+}
+
+TEST(SpriteHitMask, Transformed) {
+    srand(14);
+    Bitmap bmp(23, 17, 8);
+    MakeRandomMask(bmp, 80);
+    SpriteHitMask src(&bmp), dst;
+    for (int width : { 23, 11, 50 })
+    {
+        for (bool flip : { false, true })
+        {
+            const int height = width * 2 / 3;
+            dst.CreateTransformed(src, width, height, flip);
+            ASSERT_EQ(dst.GetWidth(), width);
+            ASSERT_EQ(dst.GetHeight(), height);
+            for (int y = 0; y < height; ++y)
+            {
+                for (int x = 0; x < width; ++x)
+                {
+                    // same sampling as in is_pos_in_sprite
+                    int sx = (x * bmp.GetWidth()) / width;
+                    if (flip)
+                        sx = bmp.GetWidth() - 1 - sx;
+                    const int sy = (y * bmp.GetHeight()) / height;
+                    ASSERT_EQ(dst.IsOpaque(x, y), bmp.GetPixel(sx, sy) != 0);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,228 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "ac/movelist.h"
+#include "ac/movelist_stepper.h"
+#include "ac/route_finder.h"
+
+using namespace AGS::Engine;
+
+struct Mover
+{
+    MoveList mls;
+    int X = 0;
+    int Y = 0;
+    bool Moving = true;
+};
+
+// Makes movers with random paths and speeds, including fractional speeds
+static std::vector<Mover> MakeMovers(int count, int max_stages)
+{
+    std::vector<Mover> movers(count);
+    for (auto &m : movers)
+    {
+        std::vector<Point> path;
+        const int stages = 1 + rand() % max_stages;
+        for (int i = 0; i <= stages; ++i)
+            path.emplace_back(rand() % 640, rand() % 400);
+        int speed_x = 1 + rand() % 8, speed_y = 1 + rand() % 8;
+        if (rand() % 4 == 0)
+            speed_x = -(2 + rand() % 3);
+        if (rand() % 4 == 0)
+            speed_y = -(2 + rand() % 3);
+        Pathfinding::CalculateMoveList(m.mls, path, speed_x, speed_y, 0);
+        m.X = path[0].X;
+        m.Y = path[0].Y;
+    }
+    return movers;
+}
+
+static void StepMoversOneByOne(std::vector<Mover> &movers, const MoveStepOptions &opts)
+{
+    for (auto &m : movers)
+    {
+        if (m.Moving && (StepMoveList(m.mls, m.X, m.Y, opts) == kMoveStep_Finished))
+            m.Moving = false;
+    }
+}
+
+static void StepMoversBatched(std::vector<Mover> &movers, MoveListStepper &stepper, const MoveStepOptions &opts)
+{
+    const int count = static_cast<int>(movers.size());
+    stepper.SetCount(count);
+    for (int i = 0; i < count; ++i)
+        stepper.Sync(i, movers[i].Moving ? &movers[i].mls : nullptr, &movers[i].X, &movers[i].Y);
+    stepper.Step(opts);
+    for (int i : stepper.GetFinished())
+        movers[i].Moving = false;
+}
+
+TEST(MoveList, ReachesDestination) {
+    srand(31);
+    for (bool legacy_fix : { false, true })
+    {
+        std::vector<Mover> movers = MakeMovers(300, 6);
+        std::vector<Point> dest;
+        for (const auto &m : movers)
+            dest.push_back(m.mls.GetLastPos());
+        MoveStepOptions opts;
+        opts.LegacyTargetFix = legacy_fix;
+        bool any_moving = true;
+        for (int step = 0; any_moving; ++step)
+        {
+            ASSERT_LT(step, 100000);
+            StepMoversOneByOne(movers, opts);
+            any_moving = false;
+            for (const auto &m : movers)
+                any_moving |= m.Moving;
+        }
+        // every mover ends exactly at its destination, with the movelist reset
+        for (size_t i = 0; i < movers.size(); ++i)
+        {
+            ASSERT_EQ(Point(movers[i].X, movers[i].Y), dest[i]);
+            ASSERT_EQ(movers[i].mls.GetNumStages(), 0u);
+        }
+    }
+}
+
+static void TestBatchMatchesOneByOne(const MoveStepOptions &opts)
+{
+    std::vector<Mover> movers = MakeMovers(300, 6);
+    std::vector<Mover> batch_movers = movers;
+    const std::vector<Mover> new_paths = MakeMovers(300, 3);
+    MoveListStepper stepper;
+    bool any_moving = true;
+    for (int step = 0; any_moving; ++step)
+    {
+        ASSERT_LT(step, 100000);
+        // give some movers new paths midway, reusing their movelists
+        if (step == 20)
+        {
+            for (size_t i = 0; i < movers.size(); i += 5)
+            {
+                movers[i] = new_paths[i];
+                batch_movers[i] = new_paths[i];
+            }
+        }
+        StepMoversOneByOne(movers, opts);
+        StepMoversBatched(batch_movers, stepper, opts);
+        any_moving = false;
+        for (size_t i = 0; i < movers.size(); ++i)
+        {
+            const MoveList &a = movers[i].mls, &b = batch_movers[i].mls;
+            ASSERT_EQ(movers[i].X, batch_movers[i].X);
+            ASSERT_EQ(movers[i].Y, batch_movers[i].Y);
+            ASSERT_EQ(movers[i].Moving, batch_movers[i].Moving);
+            ASSERT_EQ(a.onstage, b.onstage);
+            ASSERT_EQ(a.onpart, b.onpart);
+            ASSERT_EQ(a.doneflag, b.doneflag);
+            ASSERT_EQ(a.fin_move, b.fin_move);
+            ASSERT_EQ(a.fin_from_part, b.fin_from_part);
+            any_moving |= movers[i].Moving;
+        }
+    }
+}
+
+TEST(MoveList, BatchMatchesOneByOne) {
+    srand(32);
+    MoveStepOptions opts;
+    TestBatchMatchesOneByOne(opts);
+    opts.LegacyTargetFix = true;
+    TestBatchMatchesOneByOne(opts);
+    opts.LegacyTargetFix = false;
+    opts.InterpolateStages = true;
+    TestBatchMatchesOneByOne(opts);
+}
+
+TEST(MoveList, SubPixelPosition) {
+    srand(33);
+    std::vector<Mover> movers = MakeMovers(100, 3);
+    MoveListStepper stepper;
+    MoveStepOptions opts;
+    for (int step = 0; step < 200; ++step)
+    {
+        StepMoversBatched(movers, stepper, opts);
+        for (size_t i = 0; i < movers.size(); ++i)
+        {
+            if (!movers[i].Moving)
+                continue;
+            // integer position is made of the whole steps along each part of
+            // the move, so it may lag behind the exact one by up to two pixels
+            ASSERT_LT(abs(stepper.GetSubX(i) - itofix(movers[i].X)), itofix(2));
+            ASSERT_LT(abs(stepper.GetSubY(i) - itofix(movers[i].Y)), itofix(2));
+        }
+    }
+}
+
+TEST(MoveList, InterpolateStages) {
+    srand(34);
+    std::vector<Mover> movers = MakeMovers(200, 8);
+    std::vector<Mover> smooth_movers = movers;
+    std::vector<Point> dest;
+    for (const auto &m : movers)
+        dest.push_back(m.mls.GetLastPos());
+    MoveStepOptions opts, smooth_opts;
+    smooth_opts.InterpolateStages = true;
+    std::vector<int> steps(movers.size()), smooth_steps(movers.size());
+    for (int step = 1; step < 100000; ++step)
+    {
+        StepMoversOneByOne(movers, opts);
+        StepMoversOneByOne(smooth_movers, smooth_opts);
+        bool any_moving = false;
+        for (size_t i = 0; i < movers.size(); ++i)
+        {
+            if (movers[i].Moving)
+                steps[i] = step + 1;
+            if (smooth_movers[i].Moving)
+                smooth_steps[i] = step + 1;
+            any_moving |= movers[i].Moving || smooth_movers[i].Moving;
+        }
+        if (!any_moving)
+            break;
+    }
+    // smooth movers arrive at the same destination, and never later
+    for (size_t i = 0; i < movers.size(); ++i)
+    {
+        ASSERT_FALSE(smooth_movers[i].Moving);
+        ASSERT_EQ(Point(smooth_movers[i].X, smooth_movers[i].Y), dest[i]);
+        ASSERT_LE(smooth_steps[i], steps[i]);
+    }
+}
+
+// Measures stepping many concurrent movers one by one and all at once
+TEST(MoveList, DISABLED_Benchmark) {
+    srand(35);
+    const int frames = 200;
+    for (int count : { 100, 1000, 10000, 50000 })
+    {
+        const std::vector<Mover> movers = MakeMovers(count, 20);
+        std::vector<Mover> one_movers = movers, batch_movers = movers;
+        MoveStepOptions opts;
+        MoveListStepper stepper;
+        const auto t0 = std::chrono::high_resolution_clock::now();
+        for (int f = 0; f < frames; ++f)
+            StepMoversOneByOne(one_movers, opts);
+        const auto t1 = std::chrono::high_resolution_clock::now();
+        for (int f = 0; f < frames; ++f)
+            StepMoversBatched(batch_movers, stepper, opts);
+        const auto t2 = std::chrono::high_resolution_clock::now();
+        const double one_us = std::chrono::duration<double, std::micro>(t1 - t0).count() / frames;
+        const double batch_us = std::chrono::duration<double, std::micro>(t2 - t1).count() / frames;
+        printf("%6d movers: one by one %9.2f us, stepper %9.2f us per frame\n", count, one_us, batch_us);
+    }
+}
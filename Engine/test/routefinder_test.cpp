@@ -0,0 +1,579 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "ac/movelist.h"
+#include "ac/route_finder.h"
+#include "ac/route_finder_flowfield.h"
+#include "ac/route_finder_hpa.h"
+#include "ac/route_finder_impl.h"
+#include "ac/route_finder_impl_legacy.h"
+#include "gfx/bitmap.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+// Walls with a single random gap each, forcing a winding route
+static std::unique_ptr<Bitmap> MakeWallsMask(int w, int h, int wall_step)
+{
+    std::unique_ptr<Bitmap> mask(new Bitmap(w, h, 8));
+    mask->Clear(1);
+    for (int x = wall_step; x < w; x += wall_step)
+    {
+        const int gap = rand() % (h - 20);
+        mask->FillRect(Rect(x, 0, x + 3, gap - 1), 0);
+        mask->FillRect(Rect(x, gap + 16, x + 3, h - 1), 0);
+    }
+    return mask;
+}
+
+// Open area with many random rectangular obstacles
+static std::unique_ptr<Bitmap> MakeObstaclesMask(int w, int h, int count)
+{
+    std::unique_ptr<Bitmap> mask(new Bitmap(w, h, 8));
+    mask->Clear(1);
+    for (int i = 0; i < count; ++i)
+        mask->FillRect(RectWH(rand() % w, rand() % h, 5 + rand() % 60, 5 + rand() % 60), 0);
+    return mask;
+}
+
+static Point RandomWalkablePoint(const Bitmap *mask)
+{
+    for (;;)
+    {
+        const Point pt(rand() % mask->GetWidth(), rand() % mask->GetHeight());
+        if (mask->GetPixel(pt.X, pt.Y) != 0)
+            return pt;
+    }
+}
+
+static float PathLength(const std::vector<Point> &path)
+{
+    float len = 0.f;
+    for (size_t i = 1; i < path.size(); ++i)
+    {
+        const float dx = path[i].X - path[i - 1].X, dy = path[i].Y - path[i - 1].Y;
+        len += sqrtf(dx * dx + dy * dy);
+    }
+    return len;
+}
+
+TEST(RouteFinder, Hierarchical) {
+    srand(3);
+    std::unique_ptr<Bitmap> masks[] = { MakeWallsMask(600, 200, 50), MakeObstaclesMask(400, 300, 60) };
+    for (const auto &mask : masks)
+    {
+        JPSRouteFinder plain, hpa(true);
+        plain.SetWalkableArea(mask.get());
+        hpa.SetWalkableArea(mask.get());
+        for (int i = 0; i < 50; ++i)
+        {
+            const Point src = RandomWalkablePoint(mask.get()), dst = RandomWalkablePoint(mask.get());
+            std::vector<Point> plain_path, hpa_path;
+            const bool plain_found = plain.FindRoute(plain_path, src.X, src.Y, dst.X, dst.Y, true);
+            const bool hpa_found = hpa.FindRoute(hpa_path, src.X, src.Y, dst.X, dst.Y, true);
+            ASSERT_EQ(plain_found, hpa_found);
+            if (!hpa_found)
+                continue;
+            // plain search may end at the closest point if the destination is unreachable
+            if (plain_path.back() != dst)
+                continue;
+            ASSERT_EQ(hpa_path.front(), src);
+            ASSERT_EQ(hpa_path.back(), dst);
+            for (size_t p = 1; p < hpa_path.size(); ++p)
+                ASSERT_TRUE(plain.CanSeeFrom(hpa_path[p - 1].X, hpa_path[p - 1].Y, hpa_path[p].X, hpa_path[p].Y));
+            ASSERT_LE(PathLength(hpa_path), PathLength(plain_path) * 1.3f + 4.f);
+        }
+    }
+}
+
+TEST(RouteFinder, ClusterGraphUpdate) {
+    srand(4);
+    std::unique_ptr<Bitmap> mask = MakeObstaclesMask(320, 200, 30);
+    std::vector<uint32_t> row_stamps(mask->GetHeight(), 1u);
+    MaskRowStamps stamps;
+    stamps.Version = 1u;
+    stamps.Rows = row_stamps.data();
+
+    ClusterGraph graph(32);
+    graph.Update(mask.get(), stamps);
+    ASSERT_EQ(graph.GetLastRebuiltClusters(), 10 * 7);
+    // no changes
+    stamps.Version = 2u;
+    row_stamps[5] = 2u;
+    graph.Update(mask.get(), stamps);
+    ASSERT_EQ(graph.GetLastRebuiltClusters(), 0);
+
+    // put a wall in the middle of one cluster, and the paths
+    // must match ones found by the graph built from scratch
+    const Rect wall(100, 70, 120, 90);
+    mask->FillRect(wall, 0);
+    stamps.Version = 3u;
+    for (int y = wall.Top; y <= wall.Bottom; ++y)
+        row_stamps[y] = 3u;
+    graph.Update(mask.get(), stamps);
+    ASSERT_EQ(graph.GetLastRebuiltClusters(), 1);
+
+    ClusterGraph fresh(32);
+    fresh.Update(mask.get(), MaskRowStamps());
+    ASSERT_EQ(graph.GetNodeCount(), fresh.GetNodeCount());
+    for (int i = 0; i < 50; ++i)
+    {
+        const Point src = RandomWalkablePoint(mask.get()), dst = RandomWalkablePoint(mask.get());
+        std::vector<Point> path1, path2;
+        ASSERT_EQ(graph.FindPath(src, dst, path1), fresh.FindPath(src, dst, path2));
+        ASSERT_EQ(path1, path2);
+    }
+}
+
+// Composes the mask for a single batch request, the way it was done before batching
+static std::unique_ptr<Bitmap> ComposeRequestMask(const RouteBatch &batch, const RouteRequest &req)
+{
+    std::unique_ptr<Bitmap> mask(BitmapHelper::CreateBitmapCopy(batch.BaseMask));
+    for (size_t i = 0; i < batch.Blockers.size(); ++i)
+    {
+        if (std::find(req.Excluded.begin(), req.Excluded.end(), static_cast<int>(i)) == req.Excluded.end())
+            mask->FillRect(batch.Blockers[i], 0);
+    }
+    return mask;
+}
+
+static void TestBatchMatchesSerial(MaskRouteFinder &batch_finder, MaskRouteFinder &serial_finder)
+{
+    srand(6);
+    const int scale = 2;
+    std::unique_ptr<Bitmap> base = MakeObstaclesMask(320, 200, 25);
+    RouteBatch batch;
+    batch.BaseMask = base.get();
+    std::vector<Point> walkers;
+    for (int i = 0; i < 40; ++i)
+    {
+        // each walker stands inside its own blocker
+        const Point pt = RandomWalkablePoint(base.get());
+        walkers.push_back(pt);
+        batch.Blockers.push_back(Rect(pt.X - 4, pt.Y - 2, pt.X + 4, pt.Y + 1));
+    }
+    std::unique_ptr<Bitmap> shared(BitmapHelper::CreateBitmapCopy(base.get()));
+    for (const auto &r : batch.Blockers)
+        shared->FillRect(r, 0);
+
+    for (size_t i = 0; i < walkers.size(); ++i)
+    {
+        RouteRequest req;
+        req.Src = walkers[i] * scale;
+        req.Dst = RandomWalkablePoint(base.get()) * scale;
+        req.MoveSpeedX = 1 + rand() % 4;
+        req.MoveSpeedY = 1 + rand() % 4;
+        req.ExactDest = (i % 3) == 0;
+        req.IgnoreWalls = (i % 10) == 9;
+        if (i % 4 != 3)
+            req.Excluded.push_back(static_cast<int>(i));
+        if (i % 5 == 0)
+            req.Excluded.push_back(static_cast<int>((i + 1) % walkers.size()));
+        batch.Requests.push_back(req);
+    }
+
+    batch_finder.SetWalkableArea(shared.get(), scale);
+    std::vector<MoveList> results, results2;
+    batch_finder.FindRoutes(batch, results);
+    batch_finder.FindRoutes(batch, results2);
+    ASSERT_EQ(results.size(), batch.Requests.size());
+    int found = 0;
+    for (size_t i = 0; i < batch.Requests.size(); ++i)
+    {
+        const RouteRequest &req = batch.Requests[i];
+        std::unique_ptr<Bitmap> mask = ComposeRequestMask(batch, req);
+        serial_finder.SetWalkableArea(mask.get(), scale);
+        MoveList mls;
+        const bool serial_found = Pathfinding::FindRoute(mls, &serial_finder, req.Src.X, req.Src.Y,
+            req.Dst.X, req.Dst.Y, req.MoveSpeedX, req.MoveSpeedY, req.ExactDest, req.IgnoreWalls);
+        ASSERT_EQ(!results[i].IsEmpty(), serial_found);
+        ASSERT_EQ(results[i].pos, mls.pos);
+        ASSERT_EQ(results[i].permove, mls.permove);
+        ASSERT_EQ(results[i].stageflags, mls.stageflags);
+        ASSERT_EQ(results2[i].pos, mls.pos);
+        found += serial_found ? 1 : 0;
+    }
+    ASSERT_GT(found, 0);
+}
+
+TEST(RouteFinder, BatchMatchesSerial) {
+    JPSRouteFinder batch_finder, serial_finder;
+    TestBatchMatchesSerial(batch_finder, serial_finder);
+}
+
+TEST(RouteFinder, BatchMatchesSerialLegacy) {
+    // legacy pathfinder keeps its data in globals, so only one instance may exist
+    LegacyRouteFinder finder;
+    TestBatchMatchesSerial(finder, finder);
+}
+
+TEST(RouteFinder, BatchHierarchical) {
+    // batched requests over the common mask use the cluster graph too
+    srand(10);
+    const int scale = 2;
+    std::unique_ptr<Bitmap> mask = MakeWallsMask(800, 400, 60);
+    JPSRouteFinder batch_finder(true), serial_finder(true);
+    batch_finder.SetWalkableArea(mask.get(), scale);
+    serial_finder.SetWalkableArea(mask.get(), scale);
+    RouteBatch batch;
+    for (int i = 0; i < 30; ++i)
+    {
+        RouteRequest req;
+        req.Src = RandomWalkablePoint(mask.get()) * scale;
+        req.Dst = RandomWalkablePoint(mask.get()) * scale;
+        req.MoveSpeedX = req.MoveSpeedY = 1 + rand() % 4;
+        batch.Requests.push_back(req);
+    }
+    std::vector<MoveList> results;
+    batch_finder.FindRoutes(batch, results);
+    for (size_t i = 0; i < batch.Requests.size(); ++i)
+    {
+        const RouteRequest &req = batch.Requests[i];
+        MoveList mls;
+        const bool serial_found = Pathfinding::FindRoute(mls, &serial_finder, req.Src.X, req.Src.Y,
+            req.Dst.X, req.Dst.Y, req.MoveSpeedX, req.MoveSpeedY, false, false);
+        ASSERT_EQ(!results[i].IsEmpty(), serial_found);
+        ASSERT_EQ(results[i].pos, mls.pos);
+        ASSERT_EQ(results[i].permove, mls.permove);
+    }
+}
+
+TEST(RouteFinder, BatchRouteCache) {
+    srand(11);
+    const int scale = 2;
+    std::unique_ptr<Bitmap> mask = MakeWallsMask(300, 200, 50);
+    std::vector<uint32_t> rows(mask->GetHeight(), 1u);
+    MaskRowStamps stamps;
+    stamps.Version = 1u;
+    stamps.Rows = rows.data();
+    JPSRouteFinder finder;
+    finder.SetWalkableArea(mask.get(), scale, &stamps);
+    RouteBatch batch;
+    for (int i = 0; i < 20; ++i)
+    {
+        RouteRequest req;
+        req.Src = RandomWalkablePoint(mask.get()) * scale;
+        req.Dst = RandomWalkablePoint(mask.get()) * scale;
+        req.ExactDest = (i % 2) == 0;
+        // requests which ignore walls are not cached
+        req.IgnoreWalls = (i % 10) == 9;
+        batch.Requests.push_back(req);
+    }
+    const uint32_t cached_count = 18u;
+
+    std::vector<MoveList> results, results2;
+    finder.FindRoutes(batch, results);
+    uint32_t hits, misses;
+    finder.GetRouteCacheStats(hits, misses);
+    ASSERT_EQ(hits, 0u);
+    ASSERT_EQ(misses, cached_count);
+    finder.FindRoutes(batch, results2);
+    finder.GetRouteCacheStats(hits, misses);
+    ASSERT_EQ(hits, cached_count);
+    ASSERT_EQ(misses, cached_count);
+    for (size_t i = 0; i < batch.Requests.size(); ++i)
+        ASSERT_EQ(results[i].pos, results2[i].pos);
+
+    // the regular search shares the cache with the batched one
+    const RouteRequest &req = batch.Requests[0];
+    std::vector<Point> path;
+    finder.FindRoute(path, req.Src.X, req.Src.Y, req.Dst.X, req.Dst.Y, req.ExactDest);
+    finder.GetRouteCacheStats(hits, misses);
+    ASSERT_EQ(hits, cached_count + 1);
+    ASSERT_EQ(path, results[0].pos);
+}
+
+// Plain Dijkstra search over the 8-connected grid, for comparison
+static std::vector<uint32_t> BruteFlowCosts(const Bitmap *mask, const Point &target)
+{
+    const int w = mask->GetWidth(), h = mask->GetHeight();
+    std::vector<uint32_t> cost(w * h, FlowField::Unreachable);
+    std::vector<std::pair<uint32_t, int>> queue;
+    auto walkable = [&](int x, int y) { return (x >= 0) && (y >= 0) && (x < w) && (y < h) && (mask->GetPixel(x, y) != 0); };
+    cost[target.Y * w + target.X] = 0;
+    queue.emplace_back(0, target.Y * w + target.X);
+    while (!queue.empty())
+    {
+        std::pop_heap(queue.begin(), queue.end(), std::greater<std::pair<uint32_t, int>>());
+        const auto e = queue.back();
+        queue.pop_back();
+        if (e.first != cost[e.second])
+            continue;
+        const int x = e.second % w, y = e.second / w;
+        for (int dy = -1; dy <= 1; ++dy)
+        {
+            for (int dx = -1; dx <= 1; ++dx)
+            {
+                if (((dx == 0) && (dy == 0)) || !walkable(x + dx, y + dy))
+                    continue;
+                if ((dx != 0) && (dy != 0) && (!walkable(x + dx, y) || !walkable(x, y + dy)))
+                    continue;
+                const uint32_t c = e.first + (((dx != 0) && (dy != 0)) ? FlowField::DiagonalCost : FlowField::StraightCost);
+                const int n = (y + dy) * w + x + dx;
+                if (c < cost[n])
+                {
+                    cost[n] = c;
+                    queue.emplace_back(c, n);
+                    std::push_heap(queue.begin(), queue.end(), std::greater<std::pair<uint32_t, int>>());
+                }
+            }
+        }
+    }
+    return cost;
+}
+
+TEST(RouteFinder, FlowField) {
+    srand(7);
+    std::unique_ptr<Bitmap> mask = MakeWallsMask(200, 120, 40);
+    FlowField field;
+    ASSERT_FALSE(field.Build(mask.get(), Point(40, 0))); // on the wall
+    ASSERT_FALSE(field.Build(mask.get(), Point(-1, 5)));
+    ASSERT_FALSE(field.IsBuilt());
+    for (int t = 0; t < 3; ++t)
+    {
+        const Point target = RandomWalkablePoint(mask.get());
+        ASSERT_TRUE(field.Build(mask.get(), target));
+        const std::vector<uint32_t> costs = BruteFlowCosts(mask.get(), target);
+        for (int y = 0; y < mask->GetHeight(); ++y)
+            for (int x = 0; x < mask->GetWidth(); ++x)
+                ASSERT_EQ(field.GetCost(x, y), costs[y * mask->GetWidth() + x]);
+
+        std::vector<Point> path;
+        for (int i = 0; i < 50; ++i)
+        {
+            const Point from = RandomWalkablePoint(mask.get());
+            ASSERT_TRUE(field.TracePath(from, path));
+            ASSERT_GE(path.size(), 2u);
+            ASSERT_EQ(path.front(), from);
+            ASSERT_EQ(path.back(), target);
+            for (const auto &pt : path)
+                ASSERT_NE(mask->GetPixel(pt.X, pt.Y), 0);
+        }
+    }
+}
+
+TEST(RouteFinder, BatchCommonTarget) {
+    srand(8);
+    const int scale = 2;
+    std::unique_ptr<Bitmap> mask = MakeWallsMask(300, 200, 50);
+    JPSRouteFinder finder, serial_finder;
+    finder.SetWalkableArea(mask.get(), scale);
+    serial_finder.SetWalkableArea(mask.get(), scale);
+    const Point target = RandomWalkablePoint(mask.get());
+    RouteBatch batch;
+    for (int i = 0; i < 30; ++i)
+    {
+        RouteRequest req;
+        req.Src = RandomWalkablePoint(mask.get()) * scale;
+        // few requests lead into a wall, and are solved by the regular search
+        req.Dst = ((i % 10) == 9) ? Point(50, 100) * scale : target * scale;
+        req.MoveSpeedX = req.MoveSpeedY = 1 + rand() % 4;
+        batch.Requests.push_back(req);
+    }
+    std::vector<MoveList> results;
+    finder.FindRoutes(batch, results);
+    ASSERT_EQ(results.size(), batch.Requests.size());
+    for (size_t i = 0; i < batch.Requests.size(); ++i)
+    {
+        const RouteRequest &req = batch.Requests[i];
+        MoveList mls;
+        const bool serial_found = Pathfinding::FindRoute(mls, &serial_finder, req.Src.X, req.Src.Y,
+            req.Dst.X, req.Dst.Y, req.MoveSpeedX, req.MoveSpeedY, false, false);
+        ASSERT_EQ(!results[i].IsEmpty(), serial_found);
+        if (req.Dst != target * scale)
+        {
+            ASSERT_EQ(results[i].pos, mls.pos);
+            continue;
+        }
+        // flow field routes may take a different way, but have same ends
+        ASSERT_EQ(results[i].pos.front(), req.Src);
+        ASSERT_EQ(results[i].pos.back(), req.Dst);
+        for (const auto &pt : results[i].pos)
+            ASSERT_NE(mask->GetPixel(pt.X / scale, pt.Y / scale), 0);
+    }
+}
+
+TEST(RouteFinder, BatchAlternatingTargets) {
+    // requests to several common destinations, mixed together,
+    // need only one flow field per destination
+    srand(12);
+    const int scale = 2;
+    std::unique_ptr<Bitmap> mask = MakeWallsMask(300, 200, 50);
+    std::vector<uint32_t> rows(mask->GetHeight(), 1u);
+    MaskRowStamps stamps;
+    stamps.Version = 1u;
+    stamps.Rows = rows.data();
+    JPSRouteFinder finder, serial_finder;
+    finder.SetWalkableArea(mask.get(), scale, &stamps);
+    serial_finder.SetWalkableArea(mask.get(), scale);
+    const Point targets[] = { RandomWalkablePoint(mask.get()), RandomWalkablePoint(mask.get()),
+        RandomWalkablePoint(mask.get()) };
+    RouteBatch batch;
+    for (int i = 0; i < 30; ++i)
+    {
+        RouteRequest req;
+        req.Src = RandomWalkablePoint(mask.get()) * scale;
+        req.Dst = targets[i % 3] * scale;
+        batch.Requests.push_back(req);
+    }
+    std::vector<MoveList> results;
+    finder.FindRoutes(batch, results);
+    ASSERT_EQ(finder.GetFlowFieldBuilds(), 3u);
+    for (size_t i = 0; i < batch.Requests.size(); ++i)
+    {
+        const RouteRequest &req = batch.Requests[i];
+        MoveList mls;
+        ASSERT_EQ(!results[i].IsEmpty(), Pathfinding::FindRoute(mls, &serial_finder, req.Src.X, req.Src.Y,
+            req.Dst.X, req.Dst.Y, req.MoveSpeedX, req.MoveSpeedY, false, false));
+        ASSERT_EQ(results[i].pos.front(), req.Src);
+        ASSERT_EQ(results[i].pos.back(), req.Dst);
+    }
+
+    // the fields are kept for the next batches, until the mask changes;
+    // new sources are used, because the found routes are cached
+    const uint32_t builds = finder.GetFlowFieldBuilds();
+    for (auto &req : batch.Requests)
+        req.Src = RandomWalkablePoint(mask.get()) * scale;
+    finder.FindRoutes(batch, results);
+    ASSERT_EQ(finder.GetFlowFieldBuilds(), builds);
+    stamps.Version = 2u;
+    finder.SetWalkableArea(mask.get(), scale, &stamps);
+    finder.FindRoutes(batch, results);
+    ASSERT_GT(finder.GetFlowFieldBuilds(), builds);
+}
+
+TEST(RouteFinder, RouteCache) {
+    srand(9);
+    const int scale = 2;
+    std::unique_ptr<Bitmap> mask = MakeWallsMask(300, 200, 50);
+    std::vector<uint32_t> rows(mask->GetHeight(), 1u);
+    MaskRowStamps stamps;
+    stamps.Version = 1u;
+    stamps.Rows = rows.data();
+    JPSRouteFinder finder, plain_finder;
+    finder.SetWalkableArea(mask.get(), scale, &stamps);
+    plain_finder.SetWalkableArea(mask.get(), scale);
+    std::vector<std::pair<Point, Point>> routes;
+    for (int i = 0; i < 20; ++i)
+        routes.emplace_back(RandomWalkablePoint(mask.get()) * scale, RandomWalkablePoint(mask.get()) * scale);
+    // one route leads into a wall, and fails with exact destination
+    routes.emplace_back(RandomWalkablePoint(mask.get()) * scale, Point(50, 100) * scale);
+
+    uint32_t hits, misses;
+    std::vector<Point> path, plain_path;
+    for (int pass = 0; pass < 3; ++pass)
+    {
+        for (const auto &r : routes)
+        {
+            for (bool exact : { false, true })
+            {
+                const bool found = finder.FindRoute(path, r.first.X, r.first.Y, r.second.X, r.second.Y, exact);
+                const bool plain_found = plain_finder.FindRoute(plain_path, r.first.X, r.first.Y, r.second.X, r.second.Y, exact);
+                ASSERT_EQ(found, plain_found);
+                if (found)
+                    ASSERT_EQ(path, plain_path);
+            }
+        }
+        finder.GetRouteCacheStats(hits, misses);
+        ASSERT_EQ(misses, routes.size() * 2);
+        ASSERT_EQ(hits, routes.size() * 2 * pass);
+    }
+
+    // mask version change makes the search anew
+    stamps.Version = 2u;
+    finder.SetWalkableArea(mask.get(), scale, &stamps);
+    finder.FindRoute(path, routes[0].first.X, routes[0].first.Y, routes[0].second.X, routes[0].second.Y);
+    finder.GetRouteCacheStats(hits, misses);
+    ASSERT_EQ(misses, routes.size() * 2 + 1);
+    // without the row stamps the mask version is unknown, and cache is not used
+    finder.SetWalkableArea(mask.get(), scale);
+    finder.FindRoute(path, routes[0].first.X, routes[0].first.Y, routes[0].second.X, routes[0].second.Y);
+    uint32_t hits2, misses2;
+    finder.GetRouteCacheStats(hits2, misses2);
+    ASSERT_EQ(hits2, hits);
+    ASSERT_EQ(misses2, misses);
+}
+
+// Benchmarks long routes, comparing plain and hierarchical searches.
+// Set AGS_TEST_ROOM_MASKS to a list of 8-bit mask images, separated by ';',
+// to include real room masks.
+TEST(RouteFinder, DISABLED_RouteBenchmark) {
+    srand(5);
+    std::vector<std::pair<String, std::unique_ptr<Bitmap>>> masks;
+    masks.emplace_back("walls 3000x600", MakeWallsMask(3000, 600, 120));
+    masks.emplace_back("obstacles 3000x1000", MakeObstaclesMask(3000, 1000, 1200));
+    const char *room_masks = getenv("AGS_TEST_ROOM_MASKS");
+    if (room_masks)
+    {
+        for (const auto &filename : String(room_masks).Split(';'))
+        {
+            std::unique_ptr<Bitmap> mask(BitmapHelper::LoadFromFile(filename));
+            if (mask && (mask->GetColorDepth() == 8))
+                masks.emplace_back(filename, std::move(mask));
+            else
+                printf("Failed to load 8-bit mask: %s\n", filename.GetCStr());
+        }
+    }
+
+    const int query_count = 100;
+    for (const auto &m : masks)
+    {
+        const Bitmap *mask = m.second.get();
+        // long queries: between the opposite sides of the mask
+        std::vector<std::pair<Point, Point>> queries;
+        for (int i = 0; i < query_count; ++i)
+        {
+            Point src, dst;
+            do
+            {
+                src = RandomWalkablePoint(mask);
+                dst = RandomWalkablePoint(mask);
+            } while (abs(src.X - dst.X) < mask->GetWidth() / 2);
+            queries.emplace_back(src, dst);
+        }
+
+        for (int hierarchical = 0; hierarchical <= 1; ++hierarchical)
+        {
+            JPSRouteFinder finder(hierarchical != 0);
+            std::vector<Point> path;
+            // assigning a mask also builds the cluster graph
+            auto t0 = std::chrono::high_resolution_clock::now();
+            finder.SetWalkableArea(mask);
+            auto t1 = std::chrono::high_resolution_clock::now();
+            int found = 0;
+            float total_len = 0.f;
+            for (const auto &q : queries)
+            {
+                if (finder.FindRoute(path, q.first.X, q.first.Y, q.second.X, q.second.Y))
+                {
+                    found++;
+                    total_len += PathLength(path);
+                }
+            }
+            auto t2 = std::chrono::high_resolution_clock::now();
+            printf("%-24s %-12s: prepare %7.2f ms, avg %6.3f ms/route, found %d, avg length %.1f\n",
+                m.first.GetCStr(), hierarchical ? "hierarchical" : "plain",
+                std::chrono::duration<double, std::milli>(t1 - t0).count(),
+                std::chrono::duration<double, std::milli>(t2 - t1).count() / query_count,
+                found, found ? total_len / found : 0.f);
+        }
+    }
+}
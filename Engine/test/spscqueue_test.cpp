@@ -0,0 +1,106 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "util/spsc_queue.h"
+
+using namespace AGS::Engine;
+
+TEST(SpscQueue, PushPop) {
+    SpscQueue<int> queue(5);
+    ASSERT_GE(queue.GetCapacity(), 5u);
+    ASSERT_TRUE(queue.IsEmpty());
+    int value = -1;
+    ASSERT_FALSE(queue.TryPop(value));
+
+    // fill up to capacity, then fail
+    const int capacity = static_cast<int>(queue.GetCapacity());
+    for (int i = 0; i < capacity; ++i)
+        ASSERT_TRUE(queue.TryPush(i));
+    ASSERT_FALSE(queue.TryPush(capacity));
+    ASSERT_FALSE(queue.IsEmpty());
+
+    // items come out in order, and the freed space may be reused
+    ASSERT_TRUE(queue.TryPop(value));
+    ASSERT_EQ(value, 0);
+    ASSERT_TRUE(queue.TryPush(capacity));
+    for (int i = 1; i <= capacity; ++i)
+    {
+        ASSERT_TRUE(queue.TryPop(value));
+        ASSERT_EQ(value, i);
+    }
+    ASSERT_FALSE(queue.TryPop(value));
+    ASSERT_TRUE(queue.IsEmpty());
+}
+
+TEST(SpscQueue, TwoThreads) {
+    SpscQueue<int> queue(16);
+    const int count = 200000;
+    std::thread producer([&queue, count]()
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            while (!queue.TryPush(i))
+                std::this_thread::yield();
+        }
+    });
+
+    // the consumer receives every item exactly once, in order
+    int expect = 0;
+    while (expect < count)
+    {
+        int value;
+        if (queue.TryPop(value))
+        {
+            ASSERT_EQ(value, expect);
+            expect++;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    ASSERT_TRUE(queue.IsEmpty());
+}
+
+TEST(SpscQueue, InPlace) {
+    SpscQueue<std::vector<int>> queue(3);
+    ASSERT_EQ(queue.PeekFront(), nullptr);
+    const int capacity = static_cast<int>(queue.GetCapacity());
+    for (int i = 0; i < capacity; ++i)
+    {
+        std::vector<int> *item = queue.PeekBack();
+        ASSERT_NE(item, nullptr);
+        item->assign(static_cast<size_t>(i + 1), i);
+        ASSERT_EQ(queue.GetCount(), static_cast<size_t>(i));
+        queue.CommitPush();
+    }
+    ASSERT_EQ(queue.PeekBack(), nullptr);
+    ASSERT_EQ(queue.GetCount(), static_cast<size_t>(capacity));
+
+    for (int i = 0; i < capacity; ++i)
+    {
+        std::vector<int> *item = queue.PeekFront();
+        ASSERT_NE(item, nullptr);
+        ASSERT_EQ(item->size(), static_cast<size_t>(i + 1));
+        ASSERT_EQ(item->front(), i);
+        // not removed until committed
+        ASSERT_EQ(queue.PeekFront(), item);
+        queue.CommitPop();
+    }
+    ASSERT_EQ(queue.PeekFront(), nullptr);
+    ASSERT_EQ(queue.GetCount(), 0u);
+}
@@ -0,0 +1,70 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "util/task_graph.h"
+
+using namespace AGS::Engine;
+
+TEST(TaskGraph, Dependencies) {
+    ThreadPool pool;
+    for (size_t threads = 0; threads <= 2; ++threads)
+    {
+        pool.Start(threads);
+        // diamond-shaped graph: a -> (b, c) -> d; records order of completion
+        std::mutex order_mutex;
+        std::vector<int> order;
+        auto make_task = [&order, &order_mutex](int n)
+            { return [&order, &order_mutex, n]() { std::lock_guard<std::mutex> lk(order_mutex); order.push_back(n); return 0; }; };
+        const std::thread::id main_id = std::this_thread::get_id();
+        bool main_on_main = false;
+        TaskGraph graph;
+        auto a = graph.AddTask("a", TaskGraph::kTask_AnyThread, make_task(0));
+        auto b = graph.AddTask("b", TaskGraph::kTask_AnyThread, make_task(1), { a });
+        auto c = graph.AddTask("c", TaskGraph::kTask_MainThread,
+            [&]() { main_on_main = std::this_thread::get_id() == main_id; return make_task(2)(); }, { a });
+        graph.AddTask("d", TaskGraph::kTask_MainThread, make_task(3), { b, c });
+        ASSERT_EQ(graph.Run(pool), 0);
+        ASSERT_TRUE(main_on_main);
+        ASSERT_EQ(order.size(), 4u);
+        ASSERT_EQ(order.front(), 0);
+        ASSERT_EQ(order.back(), 3);
+        for (const auto &task : graph.GetTasks())
+        {
+            ASSERT_LE(task.StartTime, task.EndTime);
+            for (auto dep : task.Deps)
+                ASSERT_LE(graph.GetTasks()[dep].EndTime, task.StartTime);
+        }
+    }
+    pool.Stop();
+}
+
+TEST(TaskGraph, Failure) {
+    ThreadPool pool;
+    for (size_t threads = 0; threads <= 2; ++threads)
+    {
+        pool.Start(threads);
+        std::atomic<int> run_count(0);
+        TaskGraph graph;
+        auto a = graph.AddTask("a", TaskGraph::kTask_AnyThread, [&run_count]() { run_count++; return 5; });
+        graph.AddTask("b", TaskGraph::kTask_AnyThread, [&run_count]() { run_count++; return 0; });
+        // dependents of the failed task must not run
+        graph.AddTask("c", TaskGraph::kTask_MainThread, [&run_count]() { run_count += 100; return 0; }, { a });
+        ASSERT_EQ(graph.Run(pool), 5);
+        ASSERT_LT(run_count.load(), 100);
+    }
+    pool.Stop();
+}
@@ -0,0 +1,57 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <atomic>
+#include <vector>
+#include "gtest/gtest.h"
+#include "util/thread_pool.h"
+
+using namespace AGS::Engine;
+
+TEST(ThreadPool, ParallelFor) {
+    ThreadPool pool;
+    for (size_t threads = 0; threads <= 3; ++threads)
+    {
+        pool.Start(threads);
+        for (size_t count : { 0u, 1u, 7u, 100u, 1001u })
+        {
+            std::vector<int> hits(count, 0);
+            // every item must be processed exactly once
+            pool.ParallelFor(count, 4, [&hits](size_t begin, size_t end)
+                {
+                    for (size_t i = begin; i < end; ++i)
+                        hits[i]++;
+                });
+            for (size_t i = 0; i < count; ++i)
+                ASSERT_EQ(hits[i], 1);
+        }
+    }
+    pool.Stop();
+}
+
+TEST(ThreadPool, Enqueue) {
+    std::atomic<int> done(0);
+    {
+        ThreadPool pool;
+        pool.Start(2);
+        for (int i = 0; i < 100; ++i)
+            pool.Enqueue([&done]() { done++; });
+        // pool must complete all queued tasks before stopping
+        pool.Stop();
+        ASSERT_EQ(done.load(), 100);
+    }
+    // pool without threads runs tasks immediately
+    ThreadPool pool;
+    pool.Enqueue([&done]() { done++; });
+    ASSERT_EQ(done.load(), 101);
+}
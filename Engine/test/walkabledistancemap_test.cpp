@@ -0,0 +1,131 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <stdlib.h>
+#include "gtest/gtest.h"
+#include "ac/route_finder.h"
+#include "ac/walkable_distance_map.h"
+#include "gfx/bitmap.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+// Few small walkable blobs, far from each other
+static void MakeSparseMask(Bitmap &mask, int count)
+{
+    mask.Clear(0);
+    for (int i = 0; i < count; ++i)
+        mask.FillRect(RectWH(rand() % mask.GetWidth(), rand() % mask.GetHeight(), 1 + rand() % 8, 1 + rand() % 8),
+            1 + rand() % 4);
+}
+
+static uint32_t BruteSqDistance(const Bitmap &mask, int x, int y)
+{
+    uint32_t best = WalkableDistanceMap::NoWalkable;
+    for (int my = 0; my < mask.GetHeight(); ++my)
+        for (int mx = 0; mx < mask.GetWidth(); ++mx)
+            if (mask.GetPixel(mx, my) != 0)
+                best = std::min<uint32_t>(best, (mx - x) * (mx - x) + (my - y) * (my - y));
+    return best;
+}
+
+TEST(WalkableDistanceMap, Distances) {
+    srand(7);
+    Bitmap mask(131, 77, 8);
+    for (int tile_size : { 0, 16, 7 })
+    {
+        WalkableDistanceMap map;
+        map.SetMask(&mask, tile_size);
+        for (int blobs : { 0, 1, 3, 40 })
+        {
+            MakeSparseMask(mask, blobs);
+            map.Invalidate();
+            map.SetMask(&mask, tile_size);
+            for (int i = 0; i < 200; ++i)
+            {
+                const int x = rand() % mask.GetWidth(), y = rand() % mask.GetHeight();
+                ASSERT_EQ(map.GetSqDistance(x, y), BruteSqDistance(mask, x, y));
+            }
+        }
+    }
+}
+
+TEST(WalkableDistanceMap, LazyTiles) {
+    srand(8);
+    Bitmap mask(640, 480, 8);
+    MakeSparseMask(mask, 30);
+    WalkableDistanceMap full, tiled;
+    full.SetMask(&mask);
+    tiled.SetMask(&mask, 64);
+    ASSERT_EQ(full.GetSqDistance(10, 10), tiled.GetSqDistance(10, 10));
+    ASSERT_EQ(full.GetMemoryUsed(), 640u * 480u * sizeof(uint32_t));
+    ASSERT_EQ(tiled.GetMemoryUsed(), 64u * 64u * sizeof(uint32_t));
+    tiled.Invalidate();
+    ASSERT_EQ(tiled.GetMemoryUsed(), 0u);
+    ASSERT_EQ(tiled.GetMask(), nullptr);
+}
+
+// The mask may be recreated at the same address with a different size
+// (e.g. on a room change), the map must not keep the old layout
+TEST(WalkableDistanceMap, ReplacedMask) {
+    srand(10);
+    Bitmap mask(200, 150, 8);
+    for (int tile_size : { 0, 32 })
+    {
+        WalkableDistanceMap map;
+        mask.Create(200, 150, 8);
+        MakeSparseMask(mask, 20);
+        map.SetMask(&mask, tile_size);
+        ASSERT_EQ(map.GetSqDistance(199, 149), BruteSqDistance(mask, 199, 149));
+        mask.Create(90, 310, 8);
+        MakeSparseMask(mask, 20);
+        map.Invalidate();
+        // same as the engine does before the lookup
+        if (map.GetMask() != &mask)
+            map.SetMask(&mask, tile_size);
+        for (int i = 0; i < 200; ++i)
+        {
+            const int x = rand() % mask.GetWidth(), y = rand() % mask.GetHeight();
+            ASSERT_EQ(map.GetSqDistance(x, y), BruteSqDistance(mask, x, y));
+        }
+    }
+}
+
+TEST(WalkableDistanceMap, FindNearestWalkablePoint) {
+    srand(9);
+    Bitmap mask(160, 120, 8);
+    for (int tile_size : { 0, 32 })
+    {
+        WalkableDistanceMap map;
+        map.SetMask(&mask, tile_size);
+        for (int blobs : { 0, 2, 15, 100 })
+        {
+            MakeSparseMask(mask, blobs);
+            map.Invalidate();
+            map.SetMask(&mask, tile_size);
+            for (int i = 0; i < 300; ++i)
+            {
+                const Point from(rand() % 200 - 20, rand() % 160 - 20);
+                Rect limits = RectWH(mask.GetSize());
+                if (i % 2 == 1)
+                    limits = RectWH(rand() % 100, rand() % 80, rand() % 100, rand() % 80);
+                const int range = (i % 5 == 4) ? rand() % 50 : 0;
+                Point scan_pt(-1, -1), map_pt(-1, -1);
+                const bool scan_found = Pathfinding::FindNearestWalkablePoint(&mask, from, scan_pt, limits, range, 1);
+                const bool map_found = Pathfinding::FindNearestWalkablePoint(map, from, map_pt, limits, range, 1);
+                ASSERT_EQ(scan_found, map_found);
+                ASSERT_EQ(scan_pt, map_pt);
+            }
+        }
+    }
+}
@@ -0,0 +1,109 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <chrono>
+#include <cmath>
+#include "gtest/gtest.h"
+#include "media/video/yuv_convert.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+// Makes a frame filled with a pattern of all the possible plane values
+static YUVFrame MakeFrame(int width, int height)
+{
+    YUVFrame frame;
+    frame.Allocate(width, height);
+    for (size_t i = 0; i < frame.Y.size(); ++i)
+        frame.Y[i] = static_cast<uint8_t>(i * 7);
+    for (size_t i = 0; i < frame.U.size(); ++i)
+    {
+        frame.U[i] = static_cast<uint8_t>(i * 13);
+        frame.V[i] = static_cast<uint8_t>(i * 29 + 100);
+    }
+    return frame;
+}
+
+static int ToRGB8(float v)
+{
+    return std::min(255, std::max(0, static_cast<int>(std::lround(v))));
+}
+
+TEST(YUVConvert, ToARGB) {
+    // odd size, to test both SIMD and remaining pixels
+    const int w = 37, h = 9;
+    YUVFrame frame = MakeFrame(w, h);
+    Bitmap dst(w, h, 32);
+    YUVConvert::ToARGB(frame, &dst);
+    for (int y = 0; y < h; ++y)
+    {
+        const uint32_t *row = reinterpret_cast<const uint32_t*>(dst.GetScanLine(y));
+        for (int x = 0; x < w; ++x)
+        {
+            const float yy = 1.164f * (frame.Y[y * frame.YPitch + x] - 16);
+            const float u = frame.U[(y / 2) * frame.UVPitch + x / 2] - 128.f;
+            const float v = frame.V[(y / 2) * frame.UVPitch + x / 2] - 128.f;
+            ASSERT_EQ(row[x] >> 24, 0xFFu);
+            ASSERT_NEAR(static_cast<int>((row[x] >> 16) & 0xFF), ToRGB8(yy + 1.596f * v), 2);
+            ASSERT_NEAR(static_cast<int>((row[x] >> 8) & 0xFF), ToRGB8(yy - 0.391f * u - 0.813f * v), 2);
+            ASSERT_NEAR(static_cast<int>(row[x] & 0xFF), ToRGB8(yy + 2.018f * u), 2);
+        }
+    }
+}
+
+TEST(YUVConvert, ToARGBScaled) {
+    // scaled conversion must match a conversion followed by the stretch
+    const int w = 37, h = 9;
+    YUVFrame frame = MakeFrame(w, h);
+    Bitmap conv(w, h, 32);
+    YUVConvert::ToARGB(frame, &conv);
+    for (const Size &sz : { Size(100, 30), Size(20, 5), Size(37, 20), Size(64, 9) })
+    {
+        Bitmap stretched(sz.Width, sz.Height, 32);
+        stretched.StretchBlt(&conv, RectWH(sz));
+        Bitmap fused(sz.Width, sz.Height, 32);
+        // convert in two bands, like the parallel workers would do
+        YUVConvert::ToARGB(frame, &fused, 0, sz.Height / 2);
+        YUVConvert::ToARGB(frame, &fused, sz.Height / 2, sz.Height);
+        for (int y = 0; y < sz.Height; ++y)
+            ASSERT_EQ(memcmp(stretched.GetScanLine(y), fused.GetScanLine(y), sz.Width * 4), 0);
+    }
+}
+
+// Measures conversion of HD video frames, at native size and upscaled
+TEST(YUVConvert, DISABLED_Benchmark) {
+    const int frames = 200;
+    YUVFrame frame = MakeFrame(1280, 720);
+    for (const Size &sz : { Size(1280, 720), Size(1920, 1080) })
+    {
+        Bitmap dst(sz.Width, sz.Height, 32);
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < frames; ++i)
+            YUVConvert::ToARGB(frame, &dst);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        const double fused_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        // convert at native size, and stretch after, for a comparison
+        Bitmap conv(frame.Width, frame.Height, 32);
+        t0 = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < frames; ++i)
+        {
+            YUVConvert::ToARGB(frame, &conv);
+            if (sz != Size(frame.Width, frame.Height))
+                dst.StretchBlt(&conv, RectWH(sz));
+        }
+        t1 = std::chrono::high_resolution_clock::now();
+        const double separate_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        printf("1280x720 -> %dx%d: %6.3f ms per frame (fused), %6.3f ms per frame (convert + stretch)\n",
+            sz.Width, sz.Height, fused_ms / frames, separate_ms / frames);
+    }
+}
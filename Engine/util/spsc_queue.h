@@ -0,0 +1,138 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// SpscQueue is a fixed-size lock-free ring buffer for passing items from
+// a single producer thread to a single consumer thread. Neither side ever
+// waits for another: pushing into a full queue and popping from an empty
+// one simply fail.
+//
+// Only one thread may push, and only one (other) thread may pop at a time.
+// Items may also be written and read in place, which lets reuse the items'
+// own storage instead of copying them in and out.
+//
+//=============================================================================
+#ifndef __AGS_EE_UTIL_SPSCQUEUE_H
+#define __AGS_EE_UTIL_SPSCQUEUE_H
+
+#include <atomic>
+#include <vector>
+
+namespace AGS
+{
+namespace Engine
+{
+
+template <typename T>
+class SpscQueue
+{
+public:
+    // Creates a queue, which is able to hold at least the given number of items
+    explicit SpscQueue(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity + 1)
+            size <<= 1;
+        _items.resize(size);
+        _mask = size - 1;
+    }
+
+    // Gets the max number of items which may be in queue at once
+    size_t GetCapacity() const { return _mask; }
+    // Tells if the queue is empty; the result is only exact when
+    // called from the consumer thread, otherwise it's a hint
+    bool IsEmpty() const
+    {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+    // Pushes an item to the queue; producer thread only.
+    // Returns false if the queue is full.
+    bool TryPush(const T &item)
+    {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        const size_t next = (tail + 1) & _mask;
+        if (next == _head.load(std::memory_order_acquire))
+            return false;
+        _items[tail] = item;
+        _tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Pops an item from the queue; consumer thread only.
+    // Returns false if the queue is empty.
+    bool TryPop(T &item)
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire))
+            return false;
+        item = _items[head];
+        _head.store((head + 1) & _mask, std::memory_order_release);
+        return true;
+    }
+
+    // Gets the free item at the back of the queue, for writing in place;
+    // producer thread only. Returns null if the queue is full.
+    // The item is not passed to consumer until CommitPush() is called.
+    T *PeekBack()
+    {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        if (((tail + 1) & _mask) == _head.load(std::memory_order_acquire))
+            return nullptr;
+        return &_items[tail];
+    }
+    // Passes the item written with PeekBack() to consumer
+    void CommitPush()
+    {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        _tail.store((tail + 1) & _mask, std::memory_order_release);
+    }
+
+    // Gets the item at the front of the queue, for reading in place;
+    // consumer thread only. Returns null if the queue is empty.
+    // The item stays in queue until CommitPop() is called.
+    T *PeekFront()
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire))
+            return nullptr;
+        return &_items[head];
+    }
+    // Removes the item at the front of the queue, returning it to producer
+    void CommitPop()
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        _head.store((head + 1) & _mask, std::memory_order_release);
+    }
+
+    // Gets the number of items in queue; the result is only exact when
+    // called from the producer or consumer thread, when the other one is idle
+    size_t GetCount() const
+    {
+        return (_tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire)) & _mask;
+    }
+
+private:
+    std::vector<T> _items;
+    size_t _mask = 0u;
+    // Read position, advanced by consumer, and write position, advanced by
+    // producer; padded to keep them in separate cache lines
+    std::atomic<size_t> _head{0u};
+    char _pad[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> _tail{0u};
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_UTIL_SPSCQUEUE_H
@@ -0,0 +1,127 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "util/task_graph.h"
+#include <assert.h>
+#include <deque>
+
+using namespace AGS::Common;
+
+namespace AGS
+{
+namespace Engine
+{
+
+TaskGraph::TaskID TaskGraph::AddTask(const String &name, TaskThread thread, TaskFunc func,
+    const std::vector<TaskID> &deps)
+{
+    TaskInfo task;
+    task.Name = name;
+    task.Thread = thread;
+    task.Func = std::move(func);
+    task.Deps = deps;
+    for (TaskID dep : deps)
+        assert(dep < _tasks.size());
+    _tasks.push_back(std::move(task));
+    return _tasks.size() - 1;
+}
+
+int TaskGraph::Run(ThreadPool &pool)
+{
+    // For each task: a number of incomplete dependencies, and dependent tasks
+    std::vector<size_t> wait_count(_tasks.size());
+    std::vector<std::vector<TaskID>> dependents(_tasks.size());
+    for (TaskID id = 0; id < _tasks.size(); ++id)
+    {
+        wait_count[id] = _tasks[id].Deps.size();
+        for (TaskID dep : _tasks[id].Deps)
+            dependents[dep].push_back(id);
+    }
+
+    std::mutex mutex;
+    std::condition_variable done_cv;
+    std::deque<TaskID> main_ready; // tasks ready to run on this thread
+    size_t running_workers = 0u;
+    int result = 0;
+    const bool use_workers = pool.GetThreadCount() > 0u;
+
+    // NOTE: the following functions are called with the mutex locked;
+    // the worker tasks only access their own TaskInfo, and the shared
+    // state under the same mutex
+    std::function<void(TaskID)> schedule;
+    auto complete = [&](TaskID id, int res)
+    {
+        _tasks[id].EndTime = Clock::now();
+        if (res != 0 && result == 0)
+            result = res;
+        for (TaskID next : dependents[id])
+        {
+            if ((--wait_count[next] == 0u) && (result == 0))
+                schedule(next);
+        }
+    };
+    schedule = [&](TaskID id)
+    {
+        if (!use_workers || _tasks[id].Thread == kTask_MainThread)
+        {
+            main_ready.push_back(id);
+            return;
+        }
+        _tasks[id].RanOnWorker = true;
+        running_workers++;
+        pool.Enqueue([this, id, &mutex, &done_cv, &running_workers, &complete]()
+        {
+            TaskInfo &task = _tasks[id];
+            {
+                std::lock_guard<std::mutex> lk(mutex);
+                task.StartTime = Clock::now();
+            }
+            const int res = task.Func();
+            std::lock_guard<std::mutex> lk(mutex);
+            complete(id, res);
+            running_workers--;
+            done_cv.notify_one();
+        });
+    };
+
+    std::unique_lock<std::mutex> lk(mutex);
+    for (TaskID id = 0; id < _tasks.size(); ++id)
+    {
+        if (wait_count[id] == 0u)
+            schedule(id);
+    }
+
+    // Run the main thread tasks as they become ready, until nothing is left
+    for (;;)
+    {
+        if (!main_ready.empty() && (result == 0))
+        {
+            const TaskID id = main_ready.front();
+            main_ready.pop_front();
+            TaskInfo &task = _tasks[id];
+            task.StartTime = Clock::now();
+            lk.unlock();
+            const int res = task.Func();
+            lk.lock();
+            complete(id, res);
+            continue;
+        }
+        if (running_workers == 0u)
+            break;
+        done_cv.wait(lk);
+    }
+    return result;
+}
+
+} // namespace Engine
+} // namespace AGS
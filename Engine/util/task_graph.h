@@ -0,0 +1,85 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// TaskGraph runs a set of tasks, each of which may depend on the completion
+// of other tasks. A task is started as soon as all of its dependencies are
+// complete: the ones marked to run on the main thread are run by the thread
+// which called Run(), others are queued to the thread pool, and so may run
+// in parallel with anything else.
+//
+// The graph records the time when each task has started and finished,
+// which may be used to report the performance of the whole process.
+//
+//=============================================================================
+#ifndef __AGS_EE_UTIL_TASKGRAPH_H
+#define __AGS_EE_UTIL_TASKGRAPH_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "util/string.h"
+#include "util/thread_pool.h"
+#include "util/time_util.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+class TaskGraph
+{
+public:
+    typedef size_t TaskID;
+    // Task returns 0 on success, or an error code
+    typedef std::function<int()> TaskFunc;
+
+    enum TaskThread
+    {
+        kTask_MainThread, // must run on the thread which calls Run()
+        kTask_AnyThread   // may run on a worker thread
+    };
+
+    struct TaskInfo
+    {
+        Common::String Name;
+        TaskThread Thread = kTask_MainThread;
+        TaskFunc Func;
+        std::vector<TaskID> Deps;
+        // Whether the task was run on a worker thread
+        bool RanOnWorker = false;
+        Clock::time_point StartTime;
+        Clock::time_point EndTime;
+    };
+
+    // Adds a new task, which depends on the previously added tasks
+    TaskID AddTask(const Common::String &name, TaskThread thread, TaskFunc func,
+        const std::vector<TaskID> &deps = {});
+    // Runs all tasks; the "any thread" ones are run using the given pool,
+    // or on the calling thread if the pool has no threads. If any task fails,
+    // then stops starting the new ones, waits for those already running,
+    // and returns the error code of the first failed task.
+    int Run(ThreadPool &pool);
+
+    // Gets the list of tasks, with their run times
+    const std::vector<TaskInfo> &GetTasks() const { return _tasks; }
+
+private:
+    std::vector<TaskInfo> _tasks;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_UTIL_TASKGRAPH_H
@@ -0,0 +1,135 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "util/thread_pool.h"
+#include <algorithm>
+
+namespace AGS
+{
+namespace Engine
+{
+
+ThreadPool::~ThreadPool()
+{
+    Stop();
+}
+
+size_t ThreadPool::GetDefaultThreadCount(size_t max_count)
+{
+#if defined(AGS_DISABLE_THREADS)
+    (void)max_count;
+    return 0u;
+#else
+    // NOTE: hardware_concurrency may return 0 if the value is not computable
+    const size_t hw_threads = std::thread::hardware_concurrency();
+    size_t count = (hw_threads > 0u) ? hw_threads - 1u : 1u;
+    if (max_count > 0u)
+        count = std::min(count, max_count);
+    return count;
+#endif
+}
+
+void ThreadPool::Start(size_t thread_count)
+{
+    Stop();
+#if !defined(AGS_DISABLE_THREADS)
+    _stop = false;
+    for (size_t i = 0; i < thread_count; ++i)
+        _threads.emplace_back(&ThreadPool::WorkerLoop, this);
+#else
+    (void)thread_count;
+#endif
+}
+
+void ThreadPool::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        _stop = true;
+    }
+    _taskCV.notify_all();
+    for (auto &thread : _threads)
+        thread.join();
+    _threads.clear();
+}
+
+void ThreadPool::Enqueue(Task task)
+{
+    if (_threads.empty())
+    {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        _tasks.push_back(std::move(task));
+    }
+    _taskCV.notify_one();
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t min_chunk, const RangeTask &task)
+{
+    if (count == 0u)
+        return;
+    min_chunk = std::max<size_t>(1u, min_chunk);
+    const size_t max_chunks = (count + min_chunk - 1) / min_chunk;
+    const size_t num_chunks = std::min(_threads.size() + 1, max_chunks);
+    if (num_chunks <= 1u)
+    {
+        task(0u, count);
+        return;
+    }
+
+    // Schedule all chunks but the first on the workers, run first chunk here
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    size_t remaining = num_chunks - 1;
+    for (size_t i = 1; i < num_chunks; ++i)
+    {
+        const size_t begin = count * i / num_chunks;
+        const size_t end = count * (i + 1) / num_chunks;
+        Enqueue([&task, &done_mutex, &done_cv, &remaining, begin, end]()
+        {
+            task(begin, end);
+            std::lock_guard<std::mutex> lk(done_mutex);
+            if (--remaining == 0u)
+                done_cv.notify_one();
+        });
+    }
+    task(0u, count / num_chunks);
+
+    std::unique_lock<std::mutex> lk(done_mutex);
+    done_cv.wait(lk, [&remaining]() { return remaining == 0u; });
+}
+
+void ThreadPool::WorkerLoop()
+{
+    for (;;)
+    {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lk(_mutex);
+            _taskCV.wait(lk, [this]() { return _stop || !_tasks.empty(); });
+            // NOTE: finish all the queued tasks before stopping
+            if (_tasks.empty())
+                return;
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+        task();
+    }
+}
+
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,84 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2025 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// ThreadPool is a simple fixed-size pool of worker threads, executing
+// queued tasks in the order of arrival.
+//
+// ParallelFor splits a range of work items into contiguous chunks, and runs
+// them on the workers and on the calling thread, waiting until all are done.
+//
+// When the threads are disabled for the platform (AGS_DISABLE_THREADS),
+// pool does not start any threads, and runs all the tasks immediately
+// on the calling thread.
+//
+//=============================================================================
+#ifndef __AGS_EE_UTIL_THREADPOOL_H
+#define __AGS_EE_UTIL_THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace AGS
+{
+namespace Engine
+{
+
+class ThreadPool
+{
+public:
+    typedef std::function<void()> Task;
+    // Range task receives [begin, end) indexes of the work items
+    typedef std::function<void(size_t, size_t)> RangeTask;
+
+    ThreadPool() = default;
+    ThreadPool(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    // Gets a suggested number of worker threads, which is the number of
+    // available hardware threads minus the calling one (may be 0);
+    // optionally limits the result by the given max value.
+    static size_t GetDefaultThreadCount(size_t max_count = 0u);
+
+    // Starts the given number of worker threads; stops previous ones if any
+    void Start(size_t thread_count);
+    // Waits for all the queued tasks to complete, and stops worker threads
+    void Stop();
+    // Gets the number of running worker threads
+    size_t GetThreadCount() const { return _threads.size(); }
+    // Queues a task for execution on a worker thread;
+    // runs it immediately if there are no worker threads
+    void Enqueue(Task task);
+    // Splits [0, count) range into chunks of at least min_chunk items,
+    // and runs these on the worker threads and the calling thread;
+    // returns only after all the chunks were processed.
+    void ParallelFor(size_t count, size_t min_chunk, const RangeTask &task);
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> _threads;
+    std::deque<Task> _tasks;
+    std::mutex _mutex;
+    std::condition_variable _taskCV;
+    bool _stop = false;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_UTIL_THREADPOOL_H
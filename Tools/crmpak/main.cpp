@@ -1,6 +1,9 @@
+#include <algorithm>
 #include <cerrno>
+#include <chrono>
 #include <cinttypes>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include "game/room_file.h"
 #include "util/data_ext.h"
@@ -8,6 +11,9 @@
 #include "util/memory_compat.h"
 #include "util/memorystream.h"
 #include "util/string_compat.h"
+#if defined(CRMPAK_ROOM_DATA)
+#include "game/roomstruct.h"
+#endif
 
 using namespace AGS::Common;
 
@@ -57,6 +63,130 @@ void UnpackScriptText(Stream *in, Stream *out)
 }
 
 
+#if defined(CRMPAK_ROOM_DATA)
+// Reimplementation of project-dependent functions from Common
+void quit(const char *message)
+{
+    printf("Error: %s\n", message);
+    exit(EXIT_FAILURE);
+}
+
+String cc_format_error(const String &message)
+{
+    return message;
+}
+
+String cc_get_callstack(int /*max_lines*/)
+{
+    return "";
+}
+
+static const char *ImgCompressionNames[kRoomImgCompress_Last + 1] =
+    { "legacy", "deflate", "deflate-filtered" };
+
+// Reads the full room from the memory buffer; measures the time it takes,
+// choosing the best of several runs, for the less noisy results
+static HError read_room_timed(const std::vector<uint8_t> &data, RoomStruct &room, double &time_ms)
+{
+    const int runs = 5;
+    time_ms = 0.0;
+    for (int i = 0; i < runs; ++i)
+    {
+        room.Free();
+        room.InitDefaults();
+        RoomDataSource src;
+        src.InputStream = std::make_unique<Stream>(std::make_unique<VectorStream>(data));
+        const auto t0 = std::chrono::high_resolution_clock::now();
+        HError err = static_cast<PError>(ReadRoomHeader(src));
+        if (err)
+            err = static_cast<PError>(ReadRoomData(&room, std::move(src.InputStream), src.DataVersion));
+        const auto t1 = std::chrono::high_resolution_clock::now();
+        if (!err)
+            return err;
+        const double run_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        time_ms = (i == 0) ? run_ms : std::min(time_ms, run_ms);
+    }
+    return HError::None();
+}
+
+// Rewrites the room with the new compression of backgrounds and masks,
+// and prints how this changes the room's size and loading time
+static int recompress_room(const char *in_roomfile, const char *compress_name, const char *out_roomfile)
+{
+    int compress = -1;
+    for (int i = 0; i <= kRoomImgCompress_Last; ++i)
+    {
+        if (strcmp(compress_name, ImgCompressionNames[i]) == 0)
+            compress = i;
+    }
+    if (compress < 0)
+    {
+        printf("Error: unknown compression type: %s\n", compress_name);
+        return -1;
+    }
+    printf("Compression: %s\n", compress_name);
+    printf("Write modified room into: %s\n", out_roomfile ? out_roomfile : in_roomfile);
+
+    std::vector<uint8_t> in_data;
+    {
+        std::unique_ptr<Stream> in(File::OpenFileRead(in_roomfile));
+        if (!in)
+        {
+            printf("Error: failed to open room file for reading.\n");
+            return -1;
+        }
+        in_data.resize(static_cast<size_t>(in->GetLength()));
+        in->Read(in_data.data(), in_data.size());
+    }
+
+    // NOTE: older rooms would have to be upgraded by the engine on load,
+    // so only accept the ones which may be saved back without changes
+    RoomStruct room;
+    double in_ms = 0.0;
+    HError err = read_room_timed(in_data, room, in_ms);
+    if (err && (room.DataVersion < kRoomVersion_3508))
+        err = new Error(String::FromFormat("Room format version %d is too old, please resave it in the Editor first.", room.DataVersion));
+    if (!err)
+    {
+        printf("Error: failed to read the input room:\n");
+        printf("%s\n", err->FullMessage().GetCStr());
+        return -1;
+    }
+    const char *old_compress = ImgCompressionNames[room.ImageCompression];
+
+    std::vector<uint8_t> out_data;
+    room.ImageCompression = static_cast<RoomImageCompression>(compress);
+    {
+        Stream out(std::make_unique<VectorStream>(out_data, kStream_Write));
+        err = static_cast<PError>(WriteRoomData(&room, &out, GetMinRoomFileVersion(&room)));
+    }
+    double out_ms = 0.0;
+    if (err)
+        err = read_room_timed(out_data, room, out_ms);
+    if (!err)
+    {
+        printf("Error: failed to write the room:\n");
+        printf("%s\n", err->FullMessage().GetCStr());
+        return -1;
+    }
+
+    std::unique_ptr<Stream> room_out(File::CreateFile(out_roomfile ? out_roomfile : in_roomfile));
+    if (!room_out)
+    {
+        printf("Error: failed to open room file for writing.\n");
+        return -1;
+    }
+    room_out->Write(out_data.data(), out_data.size());
+    printf("Compression: %s -> %s\n", old_compress, compress_name);
+    printf("Room size: %zu -> %zu bytes (%.1f%%)\n", in_data.size(), out_data.size(),
+        out_data.size() * 100.0 / in_data.size());
+    printf("Load time: %.2f -> %.2f ms\n", in_ms, out_ms);
+    printf("Done.\n");
+    return 0;
+}
+#endif // CRMPAK_ROOM_DATA
+
+
 const char *BIN_STRING = "crmpak v0.1.0 - AGS compiled room's (re)packer\n"
 "Copyright (c) 2021 AGS Team and contributors";
 
@@ -65,6 +195,12 @@ const char *HELP_STRING =
 "Options:\n"
 "  --tell-blockids        print a list of the known block ids\n"
 "Commands:\n"
+#if defined(CRMPAK_ROOM_DATA)
+"  -c <compression>       compress: rewrite room backgrounds and masks using\n"
+"                         the new compression: legacy, deflate or\n"
+"                         deflate-filtered; prints the resulting room size\n"
+"                         and loading time\n"
+#endif
 "  -d <blockid>           delete: remove a block from the compiled room\n"
 "  -e <blockid> <file>    export: write a block into this file\n"
 "  -i <blockid> <file>    import: add/replace a block with this file contents\n"
@@ -115,7 +251,7 @@ int main(int argc, char *argv[])
                 arg_blockfile = argv[++i];
             }
             break;
-        case 'd':
+        case 'c': case 'd':
             command = arg;
             if (argc > i + 1) arg_block = argv[++i];
             break;
@@ -138,13 +274,27 @@ int main(int argc, char *argv[])
         return -1;
     }
     else if ((command != 'l') &&
-        (!arg_block || ((command != 'd') && !arg_blockfile)))
+        (!arg_block || ((command != 'c') && (command != 'd') && !arg_blockfile)))
     {
         printf("Error: not enough arguments\n");
         printf("%s\n", HELP_STRING);
         return -1;
     }
 
+#if defined(CRMPAK_ROOM_DATA)
+    if (command == 'c')
+    {
+        printf("Room file: %s\n", in_roomfile);
+        return recompress_room(in_roomfile, arg_block, out_roomfile);
+    }
+#else
+    if (command == 'c')
+    {
+        printf("Error: this build does not support recompressing rooms\n");
+        return -1;
+    }
+#endif
+
     // Print working info
     int block_numid = 0;
     String block_strid;
@@ -234,6 +234,19 @@ typedef void           (ALC_APIENTRY *LPALCCAPTURESAMPLES)(ALCdevice *device, AL
 typedef void          (AL_APIENTRY *LPALCTRACEDEVICELABEL)(ALCdevice *device, const ALCchar *str);
 typedef void          (AL_APIENTRY *LPALCTRACECONTEXTLABEL)(ALCcontext *ctx, const ALCchar *str);
 
+/* ALC_SOFT_loopback: rendering the mix into the application's buffer */
+#define ALC_SOFT_loopback 1
+#define ALC_FORMAT_CHANNELS_SOFT                 0x1990
+#define ALC_FORMAT_TYPE_SOFT                     0x1991
+#define ALC_FLOAT_SOFT                           0x1406
+#define ALC_STEREO_SOFT                          0x1501
+typedef ALCdevice*    (ALC_APIENTRY *LPALCLOOPBACKOPENDEVICESOFT)(const ALCchar *devicename);
+typedef ALCboolean    (ALC_APIENTRY *LPALCISRENDERFORMATSUPPORTEDSOFT)(ALCdevice *device, ALCsizei freq, ALCenum channels, ALCenum type);
+typedef void          (ALC_APIENTRY *LPALCRENDERSAMPLESSOFT)(ALCdevice *device, ALCvoid *buffer, ALCsizei samples);
+ALC_API ALCdevice*  ALC_APIENTRY alcLoopbackOpenDeviceSOFT(const ALCchar *devicename);
+ALC_API ALCboolean  ALC_APIENTRY alcIsRenderFormatSupportedSOFT(ALCdevice *device, ALCsizei freq, ALCenum channels, ALCenum type);
+ALC_API void        ALC_APIENTRY alcRenderSamplesSOFT(ALCdevice *device, ALCvoid *buffer, ALCsizei samples);
+
 #if defined(__cplusplus)
 }
 #endif
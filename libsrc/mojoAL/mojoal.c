@@ -61,6 +61,24 @@
 #include <xmmintrin.h>
 #endif
 
+/* AVX2 mixers are built with a per-function target, and picked at runtime if the CPU has AVX2. */
+#if defined(__SSE__) && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+#  if defined(__GNUC__) || defined(__clang__)
+#    define MOJOAL_HAS_AVX2 1
+#    define MOJOAL_TARGET_AVX2 __attribute__((target("avx2")))
+#  elif defined(_MSC_VER)
+#    define MOJOAL_HAS_AVX2 1
+#    define MOJOAL_TARGET_AVX2
+#  endif
+#endif
+#ifndef MOJOAL_HAS_AVX2
+#define MOJOAL_HAS_AVX2 0
+#endif
+
+#if MOJOAL_HAS_AVX2
+#include <immintrin.h>
+#endif
+
 #ifdef __ARM_NEON__
 #include <arm_neon.h>
 #endif
@@ -77,6 +95,7 @@
 
 #define DEFAULT_PLAYBACK_DEVICE "Default OpenAL playback device"
 #define DEFAULT_CAPTURE_DEVICE "Default OpenAL capture device"
+#define DEFAULT_LOOPBACK_DEVICE "OpenAL loopback device"
 
 /* Number of buffers to allocate at once when we need a new block during alGenBuffers(). */
 #ifndef OPENAL_BUFFER_BLOCK_SIZE
@@ -244,6 +263,13 @@ static int has_neon = 0;
 #endif
 #endif
 
+#if MOJOAL_HAS_AVX2
+static int has_avx2 = 0;
+#endif
+
+/* number of sample frames to fade the source's gains over, when they change. */
+#define MIX_RAMP_FRAMES 256
+
 /* no threads in Emscripten (at the moment...!) */
 #if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
 #define init_api_lock() 1
@@ -464,6 +490,10 @@ SIMDALIGNEDSTRUCT ALsource
     ALfloat velocity[4];
     ALfloat direction[4];
     ALfloat panning[2];  /* we only do stereo for now */
+    ALfloat mixpanning[2];  /* gains currently applied by the mixer, these ramp towards panning. */
+    ALfloat ramptarget[2];  /* the panning which mixpanning ramps to. */
+    ALsizei rampframes;  /* sample frames left until mixpanning reaches ramptarget. */
+    ALboolean mixpanning_set;  /* false until mixed first time after alSourcePlay; there's no ramp then. */
     SDL_atomic_t mixer_accessible;
     SDL_atomic_t state;  /* initial, playing, paused, stopped */
     ALuint name;
@@ -516,7 +546,9 @@ struct ALCdevice_struct
     ALCenum error;
     SDL_atomic_t connected;
     ALCboolean iscapture;
+    ALCboolean isloopback;  /* mixed by alcRenderSamplesSOFT, without an SDL device */
     SDL_AudioDeviceID sdldevice;
+    SDL_mutex *loopback_lock;  /* only used if isloopback, in place of the SDL device lock */
 
     ALint channels;
     ALint frequency;
@@ -666,7 +698,8 @@ static ALCenum null_device_error = ALC_NO_ERROR;
 #define ALC_EXTENSION_ITEMS \
     ALC_EXTENSION_ITEM(ALC_ENUMERATION_EXT) \
     ALC_EXTENSION_ITEM(ALC_EXT_CAPTURE) \
-    ALC_EXTENSION_ITEM(ALC_EXT_DISCONNECT)
+    ALC_EXTENSION_ITEM(ALC_EXT_DISCONNECT) \
+    ALC_EXTENSION_ITEM(ALC_SOFT_loopback)
 
 #define AL_EXTENSION_ITEMS \
     AL_EXTENSION_ITEM(AL_EXT_FLOAT32)
@@ -685,50 +718,91 @@ static void set_alc_error(ALCdevice *device, const ALCenum error)
 #define context_needs_recalc(ctx) SDL_MemoryBarrierRelease(); ctx->recalc = AL_TRUE;
 #define source_needs_recalc(src) SDL_MemoryBarrierRelease(); src->recalc = AL_TRUE;
 
-static ALCdevice *prep_alc_device(const char *devicename, const ALCboolean iscapture)
+/* loopback devices never open an SDL audio device, so they don't need the audio subsystem */
+static void quit_audio_subsystem(const ALCboolean isloopback)
+{
+    if (!isloopback) {
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+    }
+}
+
+/* locks the device against its mixer; loopback devices are mixed by the app's thread. */
+static void lock_playback_device(ALCdevice *device)
+{
+    if (device->isloopback) {
+        SDL_LockMutex(device->loopback_lock);
+    } else {
+        SDL_LockAudioDevice(device->sdldevice);
+    }
+}
+
+static void unlock_playback_device(ALCdevice *device)
+{
+    if (device->isloopback) {
+        SDL_UnlockMutex(device->loopback_lock);
+    } else {
+        SDL_UnlockAudioDevice(device->sdldevice);
+    }
+}
+
+static ALCdevice *prep_alc_device(const char *devicename, const ALCboolean iscapture, const ALCboolean isloopback)
 {
     ALCdevice *dev = NULL;
 
-    if (SDL_InitSubSystem(SDL_INIT_AUDIO) == -1) {
+    if (!isloopback && (SDL_InitSubSystem(SDL_INIT_AUDIO) == -1)) {
         return NULL;
     }
 
     #ifdef __SSE__
     if (!SDL_HasSSE()) {
-        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        quit_audio_subsystem(isloopback);
         return NULL;  /* whoa! Better order a new Pentium III from Gateway 2000! */
     }
     #endif
 
     #if defined(__ARM_NEON__) && !NEED_SCALAR_FALLBACK
     if (!SDL_HasNEON()) {
-        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        quit_audio_subsystem(isloopback);
         return NULL;  /* :( */
     }
     #elif defined(__ARM_NEON__) && NEED_SCALAR_FALLBACK
     has_neon = SDL_HasNEON();
     #endif
 
+    #if MOJOAL_HAS_AVX2
+    has_avx2 = SDL_HasAVX2();
+    #endif
+
     if (!init_api_lock()) {
-        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        quit_audio_subsystem(isloopback);
         return NULL;
     }
 
     dev = (ALCdevice *) SDL_calloc(1, sizeof (ALCdevice));
     if (!dev) {
-        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        quit_audio_subsystem(isloopback);
         return NULL;
     }
 
     dev->name = SDL_strdup(devicename);
     if (!dev->name) {
         SDL_free(dev);
-        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        quit_audio_subsystem(isloopback);
         return NULL;
     }
 
+    if (isloopback) {
+        dev->loopback_lock = SDL_CreateMutex();
+        if (!dev->loopback_lock) {
+            SDL_free(dev->name);
+            SDL_free(dev);
+            return NULL;
+        }
+    }
+
     SDL_AtomicSet(&dev->connected, ALC_TRUE);
     dev->iscapture = iscapture;
+    dev->isloopback = isloopback;
 
     return dev;
 }
@@ -740,7 +814,7 @@ ALCdevice *alcOpenDevice(const ALCchar *devicename)
         devicename = DEFAULT_PLAYBACK_DEVICE;  /* so ALC_DEVICE_SPECIFIER is meaningful */
     }
 
-    return prep_alc_device(devicename, ALC_FALSE);
+    return prep_alc_device(devicename, ALC_FALSE, ALC_FALSE);
 
     /* we don't open an SDL audio device until the first context is
        created, so we can attempt to match audio formats. */
@@ -749,6 +823,7 @@ ALCdevice *alcOpenDevice(const ALCchar *devicename)
 /* no api lock; this requires you to not destroy a device that's still in use */
 ALCboolean alcCloseDevice(ALCdevice *device)
 {
+    ALCboolean isloopback;
     BufferQueueItem *item;
     SourcePlayTodo *todo;
     ALCsizei i;
@@ -791,13 +866,45 @@ ALCboolean alcCloseDevice(ALCdevice *device)
         todo = next;
     }
 
+    isloopback = device->isloopback;
+    if (device->loopback_lock) {
+        SDL_DestroyMutex(device->loopback_lock);
+    }
     SDL_free(device->name);
     SDL_free(device);
-    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+    quit_audio_subsystem(isloopback);
 
     return ALC_TRUE;
 }
 
+/* no api lock; this creates it and otherwise doesn't have any state that can race */
+ALCdevice *alcLoopbackOpenDeviceSOFT(const ALCchar *devicename)
+{
+    ALCdevice *device;
+
+    if (!devicename) {
+        devicename = DEFAULT_LOOPBACK_DEVICE;
+    }
+
+    device = prep_alc_device(devicename, ALC_FALSE, ALC_TRUE);
+    if (device) {
+        /* we always mix in float32 stereo; frequency is set by the context attributes. */
+        device->channels = 2;
+        device->framesize = sizeof (float) * device->channels;
+    }
+    return device;
+}
+
+/* no api lock; immutable */
+ALCboolean alcIsRenderFormatSupportedSOFT(ALCdevice *device, ALCsizei freq, ALCenum channels, ALCenum type)
+{
+    if (!device || !device->isloopback) {
+        set_alc_error(device, ALC_INVALID_DEVICE);
+        return ALC_FALSE;
+    }
+    return ((freq > 0) && (channels == ALC_STEREO_SOFT) && (type == ALC_FLOAT_SOFT)) ? ALC_TRUE : ALC_FALSE;
+}
+
 
 static ALCboolean alcfmt_to_sdlfmt(const ALCenum alfmt, SDL_AudioFormat *sdlfmt, Uint8 *channels, ALCsizei *framesize)
 {
@@ -1163,6 +1270,224 @@ static void mix_float32_c2_neon(const ALfloat * restrict panning, const float *
 }
 #endif
 
+/* Ramped mixers: the gains start at panning[], and change by step[] every
+   sample frame. These are used to fade between the old and new gains over
+   MIX_RAMP_FRAMES, when the source's gain or position changes, so that the
+   change does not click. */
+static void mix_float32_c1_ramp_scalar(const ALfloat * restrict panning, const ALfloat * restrict step, const float * restrict data, float * restrict stream, const ALsizei mixframes)
+{
+    ALfloat left = panning[0];
+    ALfloat right = panning[1];
+    ALsizei i;
+
+    for (i = 0; i < mixframes; i++, stream += 2, left += step[0], right += step[1]) {
+        const float samp = *(data++);
+        stream[0] += samp * left;
+        stream[1] += samp * right;
+    }
+}
+
+static void mix_float32_c2_ramp_scalar(const ALfloat * restrict panning, const ALfloat * restrict step, const float * restrict data, float * restrict stream, const ALsizei mixframes)
+{
+    ALfloat left = panning[0];
+    ALfloat right = panning[1];
+    ALsizei i;
+
+    for (i = 0; i < mixframes; i++, stream += 2, data += 2, left += step[0], right += step[1]) {
+        stream[0] += data[0] * left;
+        stream[1] += data[1] * right;
+    }
+}
+
+#ifdef __ARM_NEON__
+static void mix_float32_c1_ramp_neon(const ALfloat * restrict panning, const ALfloat * restrict step, const float * restrict data, float * restrict stream, const ALsizei mixframes)
+{
+    const int unrolled = mixframes / 4;
+    const int leftover = mixframes % 4;
+    const ALfloat left = panning[0];
+    const ALfloat right = panning[1];
+    const float32x4_t vstep = { step[0] * 4.0f, step[1] * 4.0f, step[0] * 4.0f, step[1] * 4.0f };
+    float32x4_t vgain1 = { left, right, left + step[0], right + step[1] };
+    float32x4_t vgain2 = { left + step[0] * 2.0f, right + step[1] * 2.0f, left + step[0] * 3.0f, right + step[1] * 3.0f };
+    ALfloat rest[2];
+    ALsizei i;
+
+    /* vld1q/vst1q don't require aligned pointers, so we don't special-case alignment here. */
+    for (i = 0; i < unrolled; i++, data += 4, stream += 8) {
+        const float32x4_t vdataload = vld1q_f32(data);
+        const float32x4x2_t vzipped = vzipq_f32(vdataload, vdataload);
+        vst1q_f32(stream, vmlaq_f32(vld1q_f32(stream), vzipped.val[0], vgain1));
+        vst1q_f32(stream+4, vmlaq_f32(vld1q_f32(stream+4), vzipped.val[1], vgain2));
+        vgain1 = vaddq_f32(vgain1, vstep);
+        vgain2 = vaddq_f32(vgain2, vstep);
+    }
+
+    rest[0] = left + step[0] * (unrolled * 4);
+    rest[1] = right + step[1] * (unrolled * 4);
+    mix_float32_c1_ramp_scalar(rest, step, data, stream, leftover);
+}
+
+static void mix_float32_c2_ramp_neon(const ALfloat * restrict panning, const ALfloat * restrict step, const float * restrict data, float * restrict stream, const ALsizei mixframes)
+{
+    const int unrolled = mixframes / 4;
+    const int leftover = mixframes % 4;
+    const ALfloat left = panning[0];
+    const ALfloat right = panning[1];
+    const float32x4_t vstep = { step[0] * 4.0f, step[1] * 4.0f, step[0] * 4.0f, step[1] * 4.0f };
+    float32x4_t vgain1 = { left, right, left + step[0], right + step[1] };
+    float32x4_t vgain2 = { left + step[0] * 2.0f, right + step[1] * 2.0f, left + step[0] * 3.0f, right + step[1] * 3.0f };
+    ALfloat rest[2];
+    ALsizei i;
+
+    for (i = 0; i < unrolled; i++, data += 8, stream += 8) {
+        vst1q_f32(stream, vmlaq_f32(vld1q_f32(stream), vld1q_f32(data), vgain1));
+        vst1q_f32(stream+4, vmlaq_f32(vld1q_f32(stream+4), vld1q_f32(data+4), vgain2));
+        vgain1 = vaddq_f32(vgain1, vstep);
+        vgain2 = vaddq_f32(vgain2, vstep);
+    }
+
+    rest[0] = left + step[0] * (unrolled * 4);
+    rest[1] = right + step[1] * (unrolled * 4);
+    mix_float32_c2_ramp_scalar(rest, step, data, stream, leftover);
+}
+#endif
+
+#if MOJOAL_HAS_AVX2
+/* The AVX2 mixers handle both the constant gains (zero step) and ramps, and
+   use unaligned loads, as these are as fast as aligned ones on AVX2 chips. */
+MOJOAL_TARGET_AVX2 static void mix_float32_c1_avx2(const ALfloat * restrict panning, const ALfloat * restrict step, const float * restrict data, float * restrict stream, const ALsizei mixframes)
+{
+    const int unrolled = mixframes / 8;
+    const int leftover = mixframes % 8;
+    const ALfloat left = panning[0];
+    const ALfloat right = panning[1];
+    const __m256i vlowdup = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+    const __m256i vhighdup = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+    const __m256 vstep = _mm256_setr_ps(step[0] * 8.0f, step[1] * 8.0f, step[0] * 8.0f, step[1] * 8.0f, step[0] * 8.0f, step[1] * 8.0f, step[0] * 8.0f, step[1] * 8.0f);
+    __m256 vgain1 = _mm256_setr_ps(left, right, left + step[0], right + step[1], left + step[0] * 2.0f, right + step[1] * 2.0f, left + step[0] * 3.0f, right + step[1] * 3.0f);
+    __m256 vgain2 = _mm256_add_ps(vgain1, _mm256_mul_ps(vstep, _mm256_set1_ps(0.5f)));
+    ALfloat rest[2];
+    ALsizei i;
+
+    for (i = 0; i < unrolled; i++, data += 8, stream += 16) {
+        const __m256 vdataload = _mm256_loadu_ps(data);
+        const __m256 vdata1 = _mm256_permutevar8x32_ps(vdataload, vlowdup);
+        const __m256 vdata2 = _mm256_permutevar8x32_ps(vdataload, vhighdup);
+        _mm256_storeu_ps(stream, _mm256_add_ps(_mm256_loadu_ps(stream), _mm256_mul_ps(vdata1, vgain1)));
+        _mm256_storeu_ps(stream+8, _mm256_add_ps(_mm256_loadu_ps(stream+8), _mm256_mul_ps(vdata2, vgain2)));
+        vgain1 = _mm256_add_ps(vgain1, vstep);
+        vgain2 = _mm256_add_ps(vgain2, vstep);
+    }
+
+    rest[0] = left + step[0] * (unrolled * 8);
+    rest[1] = right + step[1] * (unrolled * 8);
+    mix_float32_c1_ramp_scalar(rest, step, data, stream, leftover);
+}
+
+MOJOAL_TARGET_AVX2 static void mix_float32_c2_avx2(const ALfloat * restrict panning, const ALfloat * restrict step, const float * restrict data, float * restrict stream, const ALsizei mixframes)
+{
+    const int unrolled = mixframes / 8;
+    const int leftover = mixframes % 8;
+    const ALfloat left = panning[0];
+    const ALfloat right = panning[1];
+    const __m256 vstep = _mm256_setr_ps(step[0] * 8.0f, step[1] * 8.0f, step[0] * 8.0f, step[1] * 8.0f, step[0] * 8.0f, step[1] * 8.0f, step[0] * 8.0f, step[1] * 8.0f);
+    __m256 vgain1 = _mm256_setr_ps(left, right, left + step[0], right + step[1], left + step[0] * 2.0f, right + step[1] * 2.0f, left + step[0] * 3.0f, right + step[1] * 3.0f);
+    __m256 vgain2 = _mm256_add_ps(vgain1, _mm256_mul_ps(vstep, _mm256_set1_ps(0.5f)));
+    ALfloat rest[2];
+    ALsizei i;
+
+    for (i = 0; i < unrolled; i++, data += 16, stream += 16) {
+        _mm256_storeu_ps(stream, _mm256_add_ps(_mm256_loadu_ps(stream), _mm256_mul_ps(_mm256_loadu_ps(data), vgain1)));
+        _mm256_storeu_ps(stream+8, _mm256_add_ps(_mm256_loadu_ps(stream+8), _mm256_mul_ps(_mm256_loadu_ps(data+8), vgain2)));
+        vgain1 = _mm256_add_ps(vgain1, vstep);
+        vgain2 = _mm256_add_ps(vgain2, vstep);
+    }
+
+    rest[0] = left + step[0] * (unrolled * 8);
+    rest[1] = right + step[1] * (unrolled * 8);
+    mix_float32_c2_ramp_scalar(rest, step, data, stream, leftover);
+}
+#endif
+
+/* Mixes with constant gains, picking the best mixer available. */
+static void mix_float32(const ALint channels, const ALfloat * restrict panning, const float * restrict data, float * restrict stream, const ALsizei mixframes)
+{
+    FIXME("currently expects output to be stereo");
+    #if MOJOAL_HAS_AVX2
+    if (has_avx2) {
+        static const ALfloat nostep[2] = { 0.0f, 0.0f };
+        if (channels == 1) {
+            mix_float32_c1_avx2(panning, nostep, data, stream, mixframes);
+        } else {
+            mix_float32_c2_avx2(panning, nostep, data, stream, mixframes);
+        }
+        return;
+    }
+    #endif
+
+    if (channels == 1) {
+        #ifdef __SSE__
+        if (has_sse) { mix_float32_c1_sse(panning, data, stream, mixframes); } else
+        #elif defined(__ARM_NEON__)
+        if (has_neon) { mix_float32_c1_neon(panning, data, stream, mixframes); } else
+        #endif
+        {
+        #if NEED_SCALAR_FALLBACK
+        mix_float32_c1_scalar(panning, data, stream, mixframes);
+        #else
+        SDL_assert(!"uhoh, we didn't compile in enough mixers!");
+        #endif
+        }
+    } else {
+        SDL_assert(channels == 2);
+        #ifdef __SSE__
+        if (has_sse) { mix_float32_c2_sse(panning, data, stream, mixframes); } else
+        #elif defined(__ARM_NEON__)
+        if (has_neon) { mix_float32_c2_neon(panning, data, stream, mixframes); } else
+        #endif
+        {
+        #if NEED_SCALAR_FALLBACK
+        mix_float32_c2_scalar(panning, data, stream, mixframes);
+        #else
+        SDL_assert(!"uhoh, we didn't compile in enough mixers!");
+        #endif
+        }
+    }
+}
+
+/* Mixes with the gains ramping by step[] each sample frame, picking the best mixer available. */
+static void mix_float32_ramp(const ALint channels, const ALfloat * restrict panning, const ALfloat * restrict step, const float * restrict data, float * restrict stream, const ALsizei mixframes)
+{
+    #if MOJOAL_HAS_AVX2
+    if (has_avx2) {
+        if (channels == 1) {
+            mix_float32_c1_avx2(panning, step, data, stream, mixframes);
+        } else {
+            mix_float32_c2_avx2(panning, step, data, stream, mixframes);
+        }
+        return;
+    }
+    #endif
+
+    #ifdef __ARM_NEON__
+    if (has_neon) {
+        if (channels == 1) {
+            mix_float32_c1_ramp_neon(panning, step, data, stream, mixframes);
+        } else {
+            mix_float32_c2_ramp_neon(panning, step, data, stream, mixframes);
+        }
+        return;
+    }
+    #endif
+
+    /* ramps are short, so the scalar version does fine for SSE, too. */
+    if (channels == 1) {
+        mix_float32_c1_ramp_scalar(panning, step, data, stream, mixframes);
+    } else {
+        mix_float32_c2_ramp_scalar(panning, step, data, stream, mixframes);
+    }
+}
+
 
 /****************************************************************************
 *
@@ -1374,44 +1699,48 @@ static void pitch_shift(ALsource *src, const ALbuffer *buffer, int numSampsToPro
 
 static void mix_buffer(ALsource *src, const ALbuffer *buffer, const ALfloat * restrict panning, const float * restrict data, float * restrict stream, const ALsizei mixframes)
 {
+    const ALint channels = buffer->channels;
+    ALsizei frames = mixframes;
+
     if ((src->pitch != 1.0f) && (src->pitchstate != NULL)) {
         float *pitched = (float *) alloca(mixframes * buffer->channels * sizeof (float));
         pitch_shift(src, buffer, mixframes * buffer->channels, data, pitched);
         data = pitched;
     }
 
-    const ALfloat left = panning[0];
-    const ALfloat right = panning[1];
-    FIXME("currently expects output to be stereo");
-    if ((left != 0.0f) || (right != 0.0f)) {  /* don't bother mixing in silence. */
-        if (buffer->channels == 1) {
-            #ifdef __SSE__
-            if (has_sse) { mix_float32_c1_sse(panning, data, stream, mixframes); } else
-            #elif defined(__ARM_NEON__)
-            if (has_neon) { mix_float32_c1_neon(panning, data, stream, mixframes); } else
-            #endif
-            {
-            #if NEED_SCALAR_FALLBACK
-            mix_float32_c1_scalar(panning, data, stream, mixframes);
-            #else
-            SDL_assert(!"uhoh, we didn't compile in enough mixers!");
-            #endif
-            }
+    /* fade to the new gains if they changed, instead of jumping there. */
+    if (!src->mixpanning_set) {
+        src->mixpanning[0] = src->ramptarget[0] = panning[0];
+        src->mixpanning[1] = src->ramptarget[1] = panning[1];
+        src->rampframes = 0;
+        src->mixpanning_set = AL_TRUE;
+    } else if ((src->ramptarget[0] != panning[0]) || (src->ramptarget[1] != panning[1])) {
+        src->ramptarget[0] = panning[0];
+        src->ramptarget[1] = panning[1];
+        src->rampframes = MIX_RAMP_FRAMES;
+    }
+
+    if (src->rampframes > 0) {
+        const ALsizei rampframes = SDL_min(src->rampframes, frames);
+        ALfloat step[2];
+        step[0] = (src->ramptarget[0] - src->mixpanning[0]) / src->rampframes;
+        step[1] = (src->ramptarget[1] - src->mixpanning[1]) / src->rampframes;
+        mix_float32_ramp(channels, src->mixpanning, step, data, stream, rampframes);
+        src->rampframes -= rampframes;
+        if (src->rampframes == 0) {
+            src->mixpanning[0] = src->ramptarget[0];
+            src->mixpanning[1] = src->ramptarget[1];
         } else {
-            SDL_assert(buffer->channels == 2);
-            #ifdef __SSE__
-            if (has_sse) { mix_float32_c2_sse(panning, data, stream, mixframes); } else
-            #elif defined(__ARM_NEON__)
-            if (has_neon) { mix_float32_c2_neon(panning, data, stream, mixframes); } else
-            #endif
-            {
-            #if NEED_SCALAR_FALLBACK
-            mix_float32_c2_scalar(panning, data, stream, mixframes);
-            #else
-            SDL_assert(!"uhoh, we didn't compile in enough mixers!");
-            #endif
-            }
+            src->mixpanning[0] += step[0] * rampframes;
+            src->mixpanning[1] += step[1] * rampframes;
         }
+        data += rampframes * channels;
+        stream += rampframes * 2;
+        frames -= rampframes;
+    }
+
+    if ((frames > 0) && ((src->mixpanning[0] != 0.0f) || (src->mixpanning[1] != 0.0f))) {  /* don't bother mixing in silence. */
+        mix_float32(channels, src->mixpanning, data, stream, frames);
     }
 }
 
@@ -1446,7 +1775,7 @@ static ALboolean mix_source_buffer(ALCcontext *ctx, ALsource *src, BufferQueueIt
             mixframes = SDL_min(mixlen / bufferframesize, framesneeded);
             remainingmixframes = mixframes;
             while (remainingmixframes > 0) {
-                float mixbuf[256];
+                float mixbuf[1024];
                 const int mixbuflen = sizeof (mixbuf);
                 const int mixbufframes = mixbuflen / bufferframesize;
                 const int getframes = SDL_min(remainingmixframes, mixbufframes);
@@ -1988,6 +2317,7 @@ static void migrate_playlist_requests(ALCcontext *ctx)
     for (i = todo; i != NULL; i = i->next) {
         todoend = i;
         if ((i->source != ctx->playlist_tail) && (!i->source->playlist_next)) {
+            i->source->mixpanning_set = AL_FALSE;  /* start at the current gains, don't fade in. */
             i->source->playlist_next = ctx->playlist;
             if (!ctx->playlist) {
                 ctx->playlist_tail = i->source;
@@ -2069,23 +2399,13 @@ static void mix_disconnected_context(ALCcontext *ctx)
 }
 
 /* We process all unsuspended ALC contexts during this call, mixing their
-   output to (stream). SDL then plays this mixed audio to the hardware. */
-static void SDLCALL playback_device_callback(void *userdata, Uint8 *stream, int len)
+   output to (stream). */
+static void mix_device(ALCdevice *device, Uint8 *stream, int len, const ALCboolean connected)
 {
-    ALCdevice *device = (ALCdevice *) userdata;
     ALCcontext *ctx;
-    ALCboolean connected = ALC_FALSE;
 
     SDL_memset(stream, '\0', len);
 
-    if (SDL_AtomicGet(&device->connected)) {
-        if (SDL_GetAudioDeviceStatus(device->sdldevice) == SDL_AUDIO_STOPPED) {
-            SDL_AtomicSet(&device->connected, ALC_FALSE);
-        } else {
-            connected = ALC_TRUE;
-        }
-    }
-
     for (ctx = device->playback.contexts; ctx != NULL; ctx = ctx->next) {
         if (SDL_AtomicGet(&ctx->processing)) {
             if (connected) {
@@ -2097,6 +2417,40 @@ static void SDLCALL playback_device_callback(void *userdata, Uint8 *stream, int
     }
 }
 
+/* SDL plays the mixed audio to the hardware. */
+static void SDLCALL playback_device_callback(void *userdata, Uint8 *stream, int len)
+{
+    ALCdevice *device = (ALCdevice *) userdata;
+    ALCboolean connected = ALC_FALSE;
+
+    if (SDL_AtomicGet(&device->connected)) {
+        if (SDL_GetAudioDeviceStatus(device->sdldevice) == SDL_AUDIO_STOPPED) {
+            SDL_AtomicSet(&device->connected, ALC_FALSE);
+        } else {
+            connected = ALC_TRUE;
+        }
+    }
+
+    mix_device(device, stream, len, connected);
+}
+
+/* no api lock; the app calls this in place of the SDL audio callback */
+void alcRenderSamplesSOFT(ALCdevice *device, ALCvoid *buffer, ALCsizei samples)
+{
+    if (!device || !device->isloopback) {
+        set_alc_error(device, ALC_INVALID_DEVICE);
+        return;
+    }
+    if (!buffer || (samples < 0)) {
+        set_alc_error(device, ALC_INVALID_VALUE);
+        return;
+    }
+
+    SDL_LockMutex(device->loopback_lock);
+    mix_device(device, (Uint8 *) buffer, samples * device->framesize, (ALCboolean) SDL_AtomicGet(&device->connected));
+    SDL_UnlockMutex(device->loopback_lock);
+}
+
 static ALCcontext *_alcCreateContext(ALCdevice *device, const ALCint* attrlist)
 {
     ALCcontext *retval = NULL;
@@ -2104,6 +2458,8 @@ static ALCcontext *_alcCreateContext(ALCdevice *device, const ALCint* attrlist)
     ALCint freq = 48000;
     ALCboolean sync = ALC_FALSE;
     ALCint refresh = 100;
+    ALCint loopback_channels = ALC_STEREO_SOFT;
+    ALCint loopback_type = ALC_FLOAT_SOFT;
     /* we don't care about ALC_MONO_SOURCES or ALC_STEREO_SOURCES as we have no hardware limitation. */
 
     if (!device) {
@@ -2123,6 +2479,8 @@ static ALCcontext *_alcCreateContext(ALCdevice *device, const ALCint* attrlist)
                 case ALC_FREQUENCY: freq = attrlist[attrcount++]; break;
                 case ALC_REFRESH: refresh = attrlist[attrcount++]; break;
                 case ALC_SYNC: sync = (attrlist[attrcount++] ? ALC_TRUE : ALC_FALSE); break;
+                case ALC_FORMAT_CHANNELS_SOFT: loopback_channels = attrlist[attrcount++]; break;
+                case ALC_FORMAT_TYPE_SOFT: loopback_type = attrlist[attrcount++]; break;
                 default: FIXME("fail for unknown attributes?"); break;
             }
         }
@@ -2130,6 +2488,12 @@ static ALCcontext *_alcCreateContext(ALCdevice *device, const ALCint* attrlist)
 
     FIXME("use these variables at some point"); (void) refresh; (void) sync;
 
+    /* loopback devices only render in the format we mix in */
+    if (device->isloopback && ((freq <= 0) || (loopback_channels != ALC_STEREO_SOFT) || (loopback_type != ALC_FLOAT_SOFT))) {
+        set_alc_error(device, ALC_INVALID_VALUE);
+        return NULL;
+    }
+
     retval = (ALCcontext *) calloc_simd_aligned(sizeof (ALCcontext));
     if (!retval) {
         set_alc_error(device, ALC_OUT_OF_MEMORY);
@@ -2158,7 +2522,9 @@ static ALCcontext *_alcCreateContext(ALCdevice *device, const ALCint* attrlist)
     SDL_memcpy(retval->attributes, attrlist, attrcount * sizeof (ALCint));
     retval->attributes_count = attrcount;
 
-    if (!device->sdldevice) {
+    if (device->isloopback) {
+        device->frequency = freq;
+    } else if (!device->sdldevice) {
         SDL_AudioSpec desired;
         const char *devicename = device->name;
 
@@ -2200,14 +2566,14 @@ static ALCcontext *_alcCreateContext(ALCdevice *device, const ALCint* attrlist)
     context_needs_recalc(retval);
     SDL_AtomicSet(&retval->processing, 1);  /* contexts default to processing */
 
-    SDL_LockAudioDevice(device->sdldevice);
+    lock_playback_device(device);
     if (device->playback.contexts != NULL) {
         SDL_assert(device->playback.contexts->prev == NULL);
         device->playback.contexts->prev = retval;
     }
     retval->next = device->playback.contexts;
     device->playback.contexts = retval;
-    SDL_UnlockAudioDevice(device->sdldevice);
+    unlock_playback_device(device);
 
     return retval;
 }
@@ -2266,7 +2632,7 @@ static void _alcDestroyContext(ALCcontext *ctx)
     /* do this first in case the mixer is running _right now_. */
     SDL_AtomicSet(&ctx->processing, 0);
 
-    SDL_LockAudioDevice(ctx->device->sdldevice);
+    lock_playback_device(ctx->device);
     if (ctx->prev) {
         ctx->prev->next = ctx->next;
     } else {
@@ -2276,7 +2642,7 @@ static void _alcDestroyContext(ALCcontext *ctx)
     if (ctx->next) {
         ctx->next->prev = ctx->prev;
     }
-    SDL_UnlockAudioDevice(ctx->device->sdldevice);
+    unlock_playback_device(ctx->device);
 
     for (blocki = 0; blocki < ctx->num_source_blocks; blocki++) {
         SourceBlock *sb = ctx->source_blocks[blocki];
@@ -2364,6 +2730,9 @@ void *alcGetProcAddress(ALCdevice *device, const ALCchar *funcname)
     FN_TEST(alcCaptureStart);
     FN_TEST(alcCaptureStop);
     FN_TEST(alcCaptureSamples);
+    FN_TEST(alcLoopbackOpenDeviceSOFT);
+    FN_TEST(alcIsRenderFormatSupportedSOFT);
+    FN_TEST(alcRenderSamplesSOFT);
     #undef FN_TEST
 
     set_alc_error(device, ALC_INVALID_VALUE);
@@ -2384,6 +2753,10 @@ ALCenum alcGetEnumValue(ALCdevice *device, const ALCchar *enumname)
     ENUM_TEST(ALC_FREQUENCY);
     ENUM_TEST(ALC_REFRESH);
     ENUM_TEST(ALC_SYNC);
+    ENUM_TEST(ALC_FORMAT_CHANNELS_SOFT);
+    ENUM_TEST(ALC_FORMAT_TYPE_SOFT);
+    ENUM_TEST(ALC_FLOAT_SOFT);
+    ENUM_TEST(ALC_STEREO_SOFT);
     ENUM_TEST(ALC_MONO_SOURCES);
     ENUM_TEST(ALC_STEREO_SOURCES);
     ENUM_TEST(ALC_NO_ERROR);
@@ -2650,7 +3023,7 @@ ALCdevice *alcCaptureOpenDevice(const ALCchar *devicename, ALCuint frequency, AL
         sdldevname = devicename;  /* we want NULL for the best SDL default unless app is explicit. */
     }
 
-    device = prep_alc_device(devicename, ALC_TRUE);
+    device = prep_alc_device(devicename, ALC_TRUE, ALC_FALSE);
     if (!device) {
         return NULL;
     }
@@ -4325,11 +4698,11 @@ static void source_set_offset(ALsource *src, ALenum param, ALfloat value)
             ALsizei i; \
             if (n > 1) { \
                 FIXME("Can we do this without a full device lock?"); \
-                SDL_LockAudioDevice(ctx->device->sdldevice);  /* lock the SDL device so these all start mixing in the same callback. */ \
+                lock_playback_device(ctx->device);  /* lock the device so these all start mixing in the same callback. */ \
                 for (i = 0; i < n; i++) { \
                     source_##fn(ctx, sources[i]); \
                 } \
-                SDL_UnlockAudioDevice(ctx->device->sdldevice); \
+                unlock_playback_device(ctx->device); \
             } else if (n == 1) { \
                 source_##fn(ctx, *sources); \
             } \